@@ -376,7 +376,7 @@ static int process_command_line(int argc, char **argv)
 	    {"config", 'c', POPT_ARG_STRING, (void *)&config_arg, 0,
 	     "Specify configuration file [" DEFAULT_CONFIGFILE "]", "FILE"},
 	    {"address", 'a', POPT_ARG_STRING, (void *)&addr_arg, 0,
-	     "DNS name or IP address of the LCDd server [localhost]", "ADDRESS"},
+	     "DNS name, IP address or unix:<path> of the LCDd server [localhost]", "ADDRESS"},
 	    {"port", 'p', POPT_ARG_INT, &port_arg, 0, "Port of the LCDd server [13666]", "PORT"},
 	    {"foreground", 'f', POPT_ARG_NONE, &foreground, 0, "Run in foreground", NULL},
 	    {"reportlevel", 'r', POPT_ARG_INT, &level_arg, 0,
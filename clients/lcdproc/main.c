@@ -276,7 +276,7 @@ int main(int argc, char **argv)
 	    {"config", 'c', POPT_ARG_STRING, (void *)&config_arg, 0, "Specify configuration file",
 	     "FILE"},
 	    {"server", 's', POPT_ARG_STRING, (void *)&server_arg, 0,
-	     "Set LCDd server hostname or IP address", "HOST"},
+	     "Set LCDd server hostname, IP address or unix:<path>", "HOST"},
 	    {"port", 'p', POPT_ARG_INT, &port_arg, 0, "Set LCDd server port number", "PORT"},
 	    {"delay", 'e', POPT_ARG_INT, &delay_arg, 0, "Set update delay between screen refreshes",
 	     "SECONDS"},
@@ -858,6 +858,10 @@ void main_loop(void)
 									    "client_set -name "
 									    "{LCDproc %s}\n",
 									    get_hostname());
+
+							// Replies to screen updates are ignored anyway,
+							// so only let the server send errors
+							sock_send_string(sock, "client_set -ack errors\n");
 #ifdef LCDPROC_MENUS
 							menus_init();
 #endif
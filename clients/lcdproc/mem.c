@@ -291,13 +291,12 @@ int mem_top_screen(int rep, int display, int *flags_ptr)
 
 	machine_get_procs(procs);
 
-	// Sort processes by memory usage (descending)
-	LL_Rewind(procs);
-	LL_Sort(procs, sort_procs);
-	LL_Rewind(procs);
+	// Pick the processes with the highest memory usage (descending)
+	void *top[lines];
+	int found = LL_TopK(procs, sort_procs, top, lines);
 
 	for (i = 1; i <= lines; i++) {
-		procinfo_type *p = LL_Get(procs);
+		procinfo_type *p = (i <= found) ? top[i - 1] : NULL;
 
 		if (p != NULL) {
 			char mem[10];
@@ -314,8 +313,6 @@ int mem_top_screen(int rep, int display, int *flags_ptr)
 		} else {
 			sock_printf(sock, "widget_set S %i 1 %i { }\n", i, i);
 		}
-
-		LL_Next(procs);
 	}
 
 	// Clean up allocated memory
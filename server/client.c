@@ -12,7 +12,7 @@
  * \features
  * - Implementation of client management functions for LCDd server core
  * - Client creation and destruction with complete resource management
- * - Message queue management using linked list data structures
+ * - Growable per-client receive buffer with partial-line reassembly
  * - Screen list operations for client-owned display screens
  * - Menu hierarchy cleanup and menuitem destruction handling
  * - Socket handling with proper connection management
@@ -20,13 +20,13 @@
  * - Memory management with error handling and proper cleanup
  * - Debug logging throughout all client operations
  * - Client state management (NEW, ACTIVE, GONE) with lifecycle tracking
- * - Linked list integration for message queues and screen collections
+ * - Linked list integration for screen collections
  * - Automatic resource cleanup on client disconnect or destruction
  *
  * \usage
  * - Used by LCDd server core for managing client connections and operations
  * - Client creation when new TCP connections are established via client_create()
- * - Message handling for client command processing via add/get_message functions
+ * - Line reassembly for client command processing via recv_space/get_message functions
  * - Screen management for organizing client display content via add/remove/find functions
  * - Client cleanup during disconnect or server shutdown via client_destroy()
  * - Screen counting for resource monitoring via client_screen_count()
@@ -35,13 +35,15 @@
  * - Key reservation handling for input event routing to specific clients
  *
  * \details Implementation of client management functions for LCDd server
- * handling client lifecycle, message queuing, screen management, and cleanup.
+ * handling client lifecycle, input line reassembly, screen management, and cleanup.
  */
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -52,9 +54,17 @@
 #include "render.h"
 #include "screen.h"
 #include "screenlist.h"
+#include "shmvalues.h"
+#include "sock.h"
 
 #include "shared/LL.h"
+#include "shared/arena.h"
+#include "shared/intern.h"
 #include "shared/report.h"
+#include "shared/sockets.h"
+
+/** \brief Maximum length of a formatted message */
+#define CLIENT_MESSAGE_SIZE 8192
 
 // Create a new client structure for incoming connection
 Client *client_create(int sock)
@@ -70,25 +80,65 @@ Client *client_create(int sock)
 	}
 
 	c->sock = sock;
-	c->messages = NULL;
 	c->backlight = BACKLIGHT_OPEN;
 	c->heartbeat = HEARTBEAT_OPEN;
-
-	c->messages = LL_new();
-	if (!c->messages) {
+	c->ack = ACK_ALL;
+	c->peer_pid = 0;
+	c->peer_uid = (uid_t)-1;
+	c->peer_gid = (gid_t)-1;
+	c->replies_suppressed = 0;
+
+	c->inbuf = malloc(CLIENT_INBUF_INITIAL);
+	if (!c->inbuf) {
 		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
 		free(c);
 		return NULL;
 	}
+	c->inbuf_size = CLIENT_INBUF_INITIAL;
+	c->inbuf_len = 0;
+	c->inbuf_pos = 0;
+	c->inbuf_scan = 0;
+
+	c->outq_head = NULL;
+	c->outq_tail = NULL;
+	c->outq_len = 0;
+	c->throttled = 0;
+
+	c->runnable = 0;
+	c->runq_link.prev = NULL;
+	c->runq_link.next = NULL;
+	c->deficit = 0;
+	c->queued_at.tv_sec = 0;
+	c->queued_at.tv_nsec = 0;
+	c->wait_usec = 0;
+	c->wait_max_usec = 0;
+	c->commands = 0;
+	c->deferred = 0;
+
+	c->shm_fd = -1;
+	c->shm_base = NULL;
+	c->shm_size = 0;
+	c->shm_slots = 0;
+
+	c->batch = 0;
+	c->batch_start = 0;
+	c->batch_replies = 0;
+	c->batch_errors = 0;
 
 	c->state = NEW;
 	c->name = NULL;
 	c->menu = NULL;
+	c->link.prev = NULL;
+	c->link.next = NULL;
+	ilist_init(&c->keys);
 
 	c->screenlist = LL_new();
-	if (!c->screenlist) {
+	c->arena = arena_create();
+	if (!c->screenlist || !c->arena) {
 		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
-		LL_Destroy(c->messages);
+		LL_Destroy(c->screenlist);
+		arena_destroy(c->arena);
+		free(c->inbuf);
 		free(c);
 		return NULL;
 	}
@@ -101,24 +151,34 @@ int client_destroy(Client *c)
 {
 	Screen *s;
 	Menu *m;
-	char *str;
 
 	if (!c)
 		return -1;
 
 	debug(RPT_DEBUG, "%s(c=[%d])", __FUNCTION__, c->sock);
 
-	while ((str = client_get_message(c))) {
-		free(str);
-	}
-	LL_Destroy(c->messages);
+	if (c->replies_suppressed > 0)
+		report(RPT_INFO, "Client [%d] saved %lu replies through its ack mode", c->sock,
+		       c->replies_suppressed);
+	if (c->deferred > 0)
+		report(RPT_INFO, "Client [%d] had input deferred %lu times, longest wait %ld us",
+		       c->sock, c->deferred, c->wait_max_usec);
+
+	free(c->inbuf);
+	client_outq_consume(c, c->outq_len);
+
+	if (c->shm_fd >= 0)
+		close(c->shm_fd);
+	shm_values_detach(c);
 
 	debug(RPT_DEBUG, "%s: Cleaning screenlist", __FUNCTION__);
 
+	// Screens and widgets only need unregistering, their memory goes with the arena
 	for (s = LL_GetFirst(c->screenlist); s; s = LL_GetNext(c->screenlist)) {
-		screen_destroy(s);
+		screen_discard(s);
 	}
 	LL_Destroy(c->screenlist);
+	arena_destroy(c->arena);
 
 	m = (Menu *)c->menu;
 	if (m) {
@@ -156,42 +216,257 @@ void client_close_sock(Client *c)
 	}
 }
 
-// Add message to client's incoming message queue
-int client_add_message(Client *c, char *message)
+// Get free space in the receive buffer, compacting and growing it as needed
+char *client_recv_space(Client *c, size_t *avail)
 {
-	int err = 0;
+	size_t pending;
+
+	*avail = 0;
 
 	if (!c)
-		return -1;
-	if (!message)
-		return -1;
+		return NULL;
+
+	// Drop messages already handed to the parser and move the partial line to the front
+	if (c->inbuf_pos > 0) {
+		pending = c->inbuf_len - c->inbuf_pos;
+		if (pending > 0)
+			memmove(c->inbuf, c->inbuf + c->inbuf_pos, pending);
+		c->inbuf_len = pending;
+		c->inbuf_scan -= c->inbuf_pos;
+		c->inbuf_pos = 0;
+	}
+
+	if ((c->inbuf_len == c->inbuf_size) && (c->inbuf_size < CLIENT_INBUF_MAX)) {
+		size_t new_size = c->inbuf_size * 2;
+		char *tmp;
 
-	if (strlen(message) > 0) {
-		debug(RPT_DEBUG, "%s(c=[%d], message=\"%s\")", __FUNCTION__, c->sock, message);
-		err = LL_Enqueue(c->messages, (void *)message);
+		if (new_size > CLIENT_INBUF_MAX)
+			new_size = CLIENT_INBUF_MAX;
+
+		tmp = realloc(c->inbuf, new_size);
+		if (tmp != NULL) {
+			c->inbuf = tmp;
+			c->inbuf_size = new_size;
+		}
+	}
+
+	// Full buffer: fine if complete lines wait for the parser, fatal otherwise
+	if (c->inbuf_len == c->inbuf_size) {
+		size_t i;
+
+		for (i = c->inbuf_scan; i < c->inbuf_len; i++) {
+			char ch = c->inbuf[i];
+
+			if (ch == '\n' || ch == '\r' || ch == '\0')
+				return c->inbuf + c->inbuf_len;
+		}
+		return NULL;
 	}
 
-	return err;
+	*avail = c->inbuf_size - c->inbuf_len;
+	return c->inbuf + c->inbuf_len;
 }
 
-// Get next message from client's message queue
-char *client_get_message(Client *c)
+// Account for bytes written into the receive buffer
+void client_recv_commit(Client *c, size_t nbytes)
 {
-	char *str;
+	if (!c)
+		return;
 
-	debug(RPT_DEBUG, "%s(c=[%d])", __FUNCTION__, c->sock);
+	c->inbuf_len += nbytes;
+}
 
+// Take the next complete line from the client's receive buffer
+char *client_get_message(Client *c)
+{
 	if (!c)
 		return NULL;
 
-	str = (char *)LL_Dequeue(c->messages);
+	debug(RPT_DEBUG, "%s(c=[%d])", __FUNCTION__, c->sock);
+
+	// Scan only bytes not looked at before so split lines are not rescanned
+	while (c->inbuf_scan < c->inbuf_len) {
+		char ch = c->inbuf[c->inbuf_scan];
+
+		if (ch == '\n' || ch == '\r' || ch == '\0') {
+			char *str = c->inbuf + c->inbuf_pos;
+
+			c->inbuf[c->inbuf_scan] = '\0';
+			c->inbuf_scan++;
+			c->inbuf_pos = c->inbuf_scan;
+
+			if (*str != '\0')
+				return str;
+		} else {
+			c->inbuf_scan++;
+		}
+	}
+
+	return NULL;
+}
+
+// Send a string, queueing what the socket does not take right away
+int client_send_string(Client *c, const char *str) { return sock_send_client(c, str, strlen(str)); }
+
+// Format a message and pass it to client_send_string()
+int client_printf(Client *c, const char *format, ...)
+{
+	char buf[CLIENT_MESSAGE_SIZE];
+	va_list ap;
+	int size;
+
+	va_start(ap, format);
+	size = vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
+
+	if (size < 0) {
+		report(RPT_ERR, "%s: vsnprintf failed", __FUNCTION__);
+		return -1;
+	}
+
+	if (size >= sizeof(buf))
+		report(RPT_WARNING, "%s: vsnprintf truncated message", __FUNCTION__);
+
+	return client_send_string(c, buf);
+}
+
+// Send "success", or count it if a batch is open or the ack mode suppresses it
+void client_send_success(Client *c)
+{
+	if (c->batch) {
+		c->batch_replies++;
+		return;
+	}
+
+	if (c->ack != ACK_ALL) {
+		c->replies_suppressed++;
+		return;
+	}
+
+	client_send_string(c, "success\n");
+}
+
+// Send an error reply, or log and count it if a batch is open or the ack mode is ACK_NONE
+void client_send_error(Client *c, const char *message)
+{
+	if (c->batch) {
+		c->batch_replies++;
+		c->batch_errors++;
+		report(RPT_WARNING, "client error in batch: %s", message);
+		return;
+	}
+
+	if (c->ack == ACK_NONE) {
+		c->replies_suppressed++;
+		report(RPT_WARNING, "client error (not sent): %s", message);
+		return;
+	}
+
+	report(RPT_WARNING, "client error: huh? %s", message);
+	client_printf(c, "huh? %s", message);
+}
+
+// Format an error reply and pass it to client_send_error()
+void client_printf_error(Client *c, const char *format, ...)
+{
+	char buf[CLIENT_MESSAGE_SIZE];
+	va_list ap;
+
+	va_start(ap, format);
+	vsnprintf(buf, sizeof(buf), format, ap);
+	va_end(ap);
 
-	return str;
+	client_send_error(c, buf);
+}
+
+// Append data to the output queue, filling the tail block before adding new ones
+int client_outq_append(Client *c, const char *data, size_t len)
+{
+	while (len > 0) {
+		ClientOutBlock *b = c->outq_tail;
+		size_t n;
+
+		if ((b == NULL) || (b->len == CLIENT_OUTBLOCK_SIZE)) {
+			b = malloc(sizeof(ClientOutBlock));
+			if (b == NULL) {
+				report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
+				return -1;
+			}
+			b->next = NULL;
+			b->len = 0;
+			b->pos = 0;
+
+			if (c->outq_tail != NULL)
+				c->outq_tail->next = b;
+			else
+				c->outq_head = b;
+			c->outq_tail = b;
+		}
+
+		n = CLIENT_OUTBLOCK_SIZE - b->len;
+		if (n > len)
+			n = len;
+
+		memcpy(b->data + b->len, data, n);
+		b->len += n;
+		c->outq_len += n;
+		data += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+// Fill an iovec array with the unsent parts of the queued blocks
+int client_outq_iov(Client *c, struct iovec *iov, int max)
+{
+	ClientOutBlock *b;
+	int n = 0;
+
+	for (b = c->outq_head; (b != NULL) && (n < max); b = b->next, n++) {
+		iov[n].iov_base = b->data + b->pos;
+		iov[n].iov_len = b->len - b->pos;
+	}
+
+	return n;
+}
+
+// Advance the queue head by nbytes and free blocks that were sent completely
+void client_outq_consume(Client *c, size_t nbytes)
+{
+	while ((nbytes > 0) && (c->outq_head != NULL)) {
+		ClientOutBlock *b = c->outq_head;
+		size_t n = b->len - b->pos;
+
+		if (n > nbytes)
+			n = nbytes;
+
+		b->pos += n;
+		c->outq_len -= n;
+		nbytes -= n;
+
+		if (b->pos == b->len) {
+			c->outq_head = b->next;
+			if (c->outq_head == NULL)
+				c->outq_tail = NULL;
+			free(b);
+		}
+	}
+}
+
+// Hold rendering while a batch is open, but not longer than CLIENT_BATCH_MAX_FRAMES
+int client_batch_holds_render(Client *c, long timer)
+{
+	if ((c == NULL) || !c->batch)
+		return 0;
+
+	return (timer - c->batch_start) < CLIENT_BATCH_MAX_FRAMES;
 }
 
 // Find screen by ID in client's screen list
 Screen *client_find_screen(Client *c, char *id)
 {
+	const char *atom;
 	Screen *s;
 
 	if (!c)
@@ -201,10 +476,15 @@ Screen *client_find_screen(Client *c, char *id)
 
 	debug(RPT_DEBUG, "%s(c=[%d], id=\"%s\")", __FUNCTION__, c->sock, id);
 
+	// An id nobody uses is not interned, so most misses end here
+	atom = intern_find(id);
+	if (atom == NULL)
+		return NULL;
+
 	LL_Rewind(c->screenlist);
 	do {
 		s = LL_Get(c->screenlist);
-		if ((s) && (0 == strcmp(s->id, id))) {
+		if ((s) && (s->id == atom)) {
 			debug(RPT_DEBUG, "%s: Found %s", __FUNCTION__, id);
 			return s;
 		}
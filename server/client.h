@@ -13,14 +13,16 @@
  * - Header file defining client data structures and function declarations for LCDd server
  * - Client connection management with socket handling and state tracking
  * - Client state enumeration (NEW, ACTIVE, GONE) for connection lifecycle management
- * - Message queue handling for client command processing and communication
+ * - Growable receive buffer with partial-line reassembly for client commands
  * - Screen list management for client-owned display screens
  * - Menu hierarchy support for interactive client menus
  * - Client structure with name, state, socket, backlight, and heartbeat properties
- * - Linked list integration for message queues and screen collections
+ * - Linked list integration for screen collections
  * - Function declarations for client lifecycle management (create, destroy, close)
  * - Screen management functions for adding, removing, and finding client screens
- * - Message handling functions for queuing and retrieving client commands
+ * - Receive buffer functions for appending socket data and taking complete lines
+ * - Command reply functions honouring batches and the client's ack mode
+ * - Bounded output queue for data the socket did not accept yet
  * - Conditional compilation support for type-only includes
  *
  * \usage
@@ -31,7 +33,7 @@
  * - Client creation when new TCP connections are established
  * - State management during client hello/bye protocol handling
  * - Screen management for client display content organization
- * - Message queuing for command processing and client communication
+ * - Line reassembly for command processing and client communication
  * - Menu system integration for interactive client applications
  *
  * \details Defines all the client data and actions for LCDd server
@@ -41,9 +43,19 @@
 #ifndef CLIENT_H_TYPES
 #define CLIENT_H_TYPES
 
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+
 #include "shared/LL.h"
+#include "shared/ilist.h"
 
 #define CLIENT_NAME_SIZE 256 ///< Maximum size for client name strings including null terminator
+#define CLIENT_INBUF_INITIAL 4096 ///< Initial size of a client's receive buffer
+#define CLIENT_INBUF_MAX 262144	  ///< Maximum size of a client's receive buffer
+#define CLIENT_BATCH_MAX_FRAMES 16 ///< Frames an open batch may hold back rendering
+#define CLIENT_OUTBLOCK_SIZE 4096  ///< Payload size of one output queue block
 
 /**
  * \brief Possible states of a client connection
@@ -58,6 +70,34 @@ typedef enum _clientstate {
 	GONE
 } ClientState;
 
+/**
+ * \brief Which command replies a client wants to receive
+ * \details Set with "client_set -ack {all|errors|none}"
+ */
+typedef enum _clientack {
+	// Send "success" and error replies (protocol default)
+	ACK_ALL,
+	// Send error replies only
+	ACK_ERRORS,
+	// Send neither; errors are only logged
+	ACK_NONE
+} ClientAck;
+
+/**
+ * \brief Block of the per-client output queue
+ * \details Blocks form a singly linked list that is flushed with writev().
+ */
+typedef struct ClientOutBlock {
+	// Next block in the queue, NULL for the tail
+	struct ClientOutBlock *next;
+	// Number of valid bytes in data
+	size_t len;
+	// Number of bytes already written to the socket
+	size_t pos;
+	// Queued output
+	char data[CLIENT_OUTBLOCK_SIZE];
+} ClientOutBlock;
+
 /**
  * \brief Structure representing a client connection to the LCDd server
  * \details Contains all client-specific data, state, and associated resources
@@ -73,11 +113,80 @@ typedef struct Client {
 	int backlight;
 	// Heartbeat mode setting for connection monitoring
 	int heartbeat;
+	// Process ID of a Unix domain peer (SO_PEERCRED), 0 for TCP clients
+	pid_t peer_pid;
+	// User ID of a Unix domain peer, (uid_t)-1 for TCP clients
+	uid_t peer_uid;
+	// Group ID of a Unix domain peer, (gid_t)-1 for TCP clients
+	gid_t peer_gid;
+	// Command replies the client wants to receive
+	ClientAck ack;
+	// Number of replies not sent because of the ack mode
+	unsigned long replies_suppressed;
+
+	// Receive buffer holding raw bytes read from the client socket
+	char *inbuf;
+	// Allocated size of inbuf
+	size_t inbuf_size;
+	// Number of valid bytes in inbuf
+	size_t inbuf_len;
+	// Offset of the first byte not yet handed out as a message
+	size_t inbuf_pos;
+	// Offset where the search for the next line terminator resumes
+	size_t inbuf_scan;
+
+	// Nonzero between batch_begin and batch_end
+	int batch;
+	// Frame timer value when the open batch started
+	long batch_start;
+	// Replies collected in the open batch
+	int batch_replies;
+	// Error replies collected in the open batch
+	int batch_errors;
+
+	// First block of output that could not be written yet
+	ClientOutBlock *outq_head;
+	// Last block of the output queue
+	ClientOutBlock *outq_tail;
+	// Number of bytes waiting in the output queue
+	size_t outq_len;
+	// Nonzero while reading is paused because the output queue is too long
+	int throttled;
+
+	// Nonzero while the client waits in the parser's run queue
+	int runnable;
+	// Position in the parser's run queue while runnable
+	ilist_link runq_link;
+	// Commands left in the client's current scheduler turn
+	int deficit;
+	// When the client last joined the back of the run queue
+	struct timespec queued_at;
+	// Time its last turn waited in the run queue, in microseconds
+	long wait_usec;
+	// Longest wait for a turn so far, in microseconds
+	long wait_max_usec;
+	// Number of commands parsed
+	unsigned long commands;
+	// Number of turns that used the whole quantum and were sent to the back
+	unsigned long deferred;
+
+	// Descriptor received for the next shm_attach, -1 if none
+	int shm_fd;
+	// Read-only mapping of the client's value region, NULL if none
+	void *shm_base;
+	// Size of the mapping
+	size_t shm_size;
+	// Number of value slots in the region
+	unsigned int shm_slots;
 
-	// Queue of messages received from the client
-	LinkedList *messages;
 	// List of screens owned by this client
 	LinkedList *screenlist;
+	// Allocator of the client's screens, widgets and their strings
+	struct arena *arena;
+	// Position in the global client list
+	ilist_link link;
+	// Key reservations of this client, see input.c
+	ilist keys;
 
 	// Optional menu hierarchy for interactive clients
 	void *menu;
@@ -119,22 +228,118 @@ int client_destroy(Client *c);
 void client_close_sock(Client *c);
 
 /**
- * \brief Add a message to the client's incoming message queue
+ * \brief Get free space at the end of the client's receive buffer
  * \param c Pointer to Client structure
- * \param message Message string to add to queue
- * \return 0 on success, -1 on error
- * \details Queues incoming messages from client for later processing.
+ * \param avail Returns the number of bytes that may be written
+ * \return Pointer to write position, or NULL if a single line exceeds
+ *         CLIENT_INBUF_MAX
+ * \details Compacts already consumed messages and grows the buffer as needed.
+ * *avail is 0 when the buffer is full of complete lines that still have to be
+ * parsed. Invalidates pointers returned by client_get_message().
  */
-int client_add_message(Client *c, char *message);
+char *client_recv_space(Client *c, size_t *avail);
 
 /**
- * \brief Retrieve the next message from client's message queue
+ * \brief Mark bytes written into the receive buffer as valid
  * \param c Pointer to Client structure
- * \return Pointer to message string, or NULL if queue is empty
- * \details Returns and removes the oldest message from the queue.
+ * \param nbytes Number of bytes written at the position from client_recv_space()
+ */
+void client_recv_commit(Client *c, size_t nbytes);
+
+/**
+ * \brief Take the next complete line from the client's receive buffer
+ * \param c Pointer to Client structure
+ * \return Pointer to NUL-terminated message, or NULL if no complete line
+ * \details Lines end at \\r, \\n or \\0; empty lines are skipped. The
+ * message points into the receive buffer and stays valid until the next
+ * client_recv_space() call. An incomplete trailing line is kept for the next read.
  */
 char *client_get_message(Client *c);
 
+/**
+ * \brief Send a string to the client
+ * \param c Pointer to Client structure
+ * \param str NUL-terminated string
+ * \retval 0 Sent or queued
+ * \retval -1 Client is gone or the connection failed
+ * \details Never blocks: output the socket does not take right away is
+ * queued and written once the socket becomes writable.
+ */
+int client_send_string(Client *c, const char *str);
+
+/**
+ * \brief Send formatted output to the client
+ * \param c Pointer to Client structure
+ * \param format printf-style format string
+ * \retval 0 Sent or queued
+ * \retval -1 Client is gone, the connection failed or formatting failed
+ * \details Same as client_send_string() with printf-style formatting.
+ */
+int client_printf(Client *c, const char *format, ...);
+
+/**
+ * \brief Append data to the client's output queue
+ * \param c Pointer to Client structure
+ * \param data Bytes to queue
+ * \param len Number of bytes
+ * \retval 0 Success
+ * \retval -1 Allocation failed
+ */
+int client_outq_append(Client *c, const char *data, size_t len);
+
+/**
+ * \brief Describe the queued output for writev()
+ * \param c Pointer to Client structure
+ * \param iov Array to fill
+ * \param max Number of entries in iov
+ * \return Number of entries filled, 0 if the queue is empty
+ */
+int client_outq_iov(Client *c, struct iovec *iov, int max);
+
+/**
+ * \brief Drop output that has been written to the socket
+ * \param c Pointer to Client structure
+ * \param nbytes Number of bytes written from the head of the queue
+ */
+void client_outq_consume(Client *c, size_t nbytes);
+
+/**
+ * \brief Acknowledge a successful command
+ * \param c Pointer to Client structure
+ * \details Sends "success" unless a batch is open, in which case the reply
+ * is only counted for the aggregated batch_end reply, or the client's ack
+ * mode is not ACK_ALL, in which case it is counted as suppressed.
+ */
+void client_send_success(Client *c);
+
+/**
+ * \brief Report a failed command
+ * \param c Pointer to Client structure
+ * \param message Error text, sent with a "huh? " prefix
+ * \details Inside a batch the error is logged and counted instead of sent.
+ * With ACK_NONE it is only logged and counted as suppressed.
+ */
+void client_send_error(Client *c, const char *message);
+
+/**
+ * \brief Report a failed command with a formatted message
+ * \param c Pointer to Client structure
+ * \param format printf-style format string
+ * \details Same as client_send_error() with printf-style formatting.
+ */
+void client_printf_error(Client *c, const char *format, ...);
+
+/**
+ * \brief Check whether an open batch holds back rendering of the client's screens
+ * \param c Pointer to Client structure
+ * \param timer Current frame timer value
+ * \retval 1 Batch open for less than CLIENT_BATCH_MAX_FRAMES frames
+ * \retval 0 No batch open, or the batch timed out
+ * \details Keeps half-applied updates off the display. A client that never
+ * sends batch_end cannot freeze its screens for longer than the limit.
+ */
+int client_batch_holds_render(Client *c, long timer);
+
 /**
  * \brief Find a screen by ID in the client's screen list
  * \param c Pointer to Client structure
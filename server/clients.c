@@ -12,16 +12,15 @@
  * \features
  * - Implementation of client list management for LCDd server core
  * - Client list initialization and shutdown with proper resource management
- * - Client addition and removal from global linked list with error handling
+ * - Client addition and removal from an intrusive global list without allocation
  * - Client search functionality by socket descriptor for message routing
- * - Client list iteration support for traversing connected clients
- * - Global client list maintenance using LinkedList data structure
+ * - Reentrant client list iteration, the caller holds the position
+ * - Global client list maintenance using an intrusive ilist
  * - Proper cleanup of all clients during server shutdown
  * - Debug logging for all client list operations and state changes
  * - Error handling with proper reporting for all operations
  * - Memory management with automatic resource cleanup
  * - Client count tracking for server monitoring
- * - Direction-based client removal for list traversal control
  *
  * \usage
  * - Used by LCDd server core for managing the global list of connected clients
@@ -47,26 +46,22 @@
 #include "clients.h"
 #include "render.h"
 
-#include "shared/LL.h"
+#include "shared/ilist.h"
 #include "shared/report.h"
 
-/** \brief Global linked list containing all connected clients
+/** \brief Global list containing all connected clients
  *
- * \details Initialized by clients_init(), destroyed by clients_shutdown().
- * Stores Client* pointers for all active client connections to LCDd server.
+ * \details Initialized by clients_init(). Clients are linked through
+ * Client.link, so adding and removing them never allocates.
  */
-LinkedList *clientlist = NULL;
+static ilist clientlist;
 
 // Initialize the global client list data structure
 int clients_init(void)
 {
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	clientlist = LL_new();
-	if (!clientlist) {
-		report(RPT_ERR, "%s: Unable to create client list", __FUNCTION__);
-		return -1;
-	}
+	ilist_init(&clientlist);
 
 	return 0;
 }
@@ -74,30 +69,20 @@ int clients_init(void)
 // Shutdown client list and free all resources
 int clients_shutdown(void)
 {
-	Client *c;
+	Client *c, *next;
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	if (!clientlist) {
-		return -1;
-	}
-
-	for (c = LL_GetFirst(clientlist); c; c = LL_GetNext(clientlist)) {
-		debug(RPT_DEBUG, "%s: ...", __FUNCTION__);
-		if (c) {
-			debug(RPT_DEBUG, "%s: ... %i ...", __FUNCTION__, c->sock);
-			if (client_destroy(c) != 0) {
-				report(RPT_ERR, "%s: Error freeing client", __FUNCTION__);
-			} else {
-				debug(RPT_DEBUG, "%s: Freed client...", __FUNCTION__);
-			}
+	ilist_foreach_safe(c, next, &clientlist, link) {
+		debug(RPT_DEBUG, "%s: ... %i ...", __FUNCTION__, c->sock);
+		ilist_remove(&clientlist, &c->link);
+		if (client_destroy(c) != 0) {
+			report(RPT_ERR, "%s: Error freeing client", __FUNCTION__);
 		} else {
-			debug(RPT_DEBUG, "%s: No client!", __FUNCTION__);
+			debug(RPT_DEBUG, "%s: Freed client...", __FUNCTION__);
 		}
 	}
 
-	LL_Destroy(clientlist);
-
 	debug(RPT_DEBUG, "%s: done", __FUNCTION__);
 
 	return 0;
@@ -106,28 +91,41 @@ int clients_shutdown(void)
 // Add client to the global client list
 Client *clients_add_client(Client *c)
 {
-	if (LL_Push(clientlist, c) == 0)
-		return c;
+	if (ilist_linked(&c->link))
+		return NULL;
 
-	return NULL;
+	ilist_push(&clientlist, &c->link);
+	return c;
 }
 
 // Remove client from the global client list
-Client *clients_remove_client(Client *c, Direction whereto)
+Client *clients_remove_client(Client *c)
 {
-	Client *client = LL_Remove(clientlist, c, whereto);
+	if (!ilist_linked(&c->link))
+		return NULL;
 
-	return client;
+	ilist_remove(&clientlist, &c->link);
+	return c;
 }
 
 // Get first client in the client list
-Client *clients_getfirst(void) { return (Client *)LL_GetFirst(clientlist); }
+Client *clients_getfirst(void)
+{
+	ilist_link *link = ilist_first(&clientlist);
+
+	return (link != NULL) ? ilist_entry(link, Client, link) : NULL;
+}
 
-// Get next client in the client list
-Client *clients_getnext(void) { return (Client *)LL_GetNext(clientlist); }
+// Get the client following c in the client list
+Client *clients_getnext(Client *c)
+{
+	ilist_link *link = ilist_next(&clientlist, &c->link);
+
+	return (link != NULL) ? ilist_entry(link, Client, link) : NULL;
+}
 
 // Get total number of clients in the list
-int clients_client_count(void) { return LL_Length(clientlist); }
+int clients_client_count(void) { return clientlist.count; }
 
 // Find client by socket file descriptor
 Client *clients_find_client_by_sock(int sock)
@@ -136,7 +134,7 @@ Client *clients_find_client_by_sock(int sock)
 
 	debug(RPT_DEBUG, "%s(sock=%i)", __FUNCTION__, sock);
 
-	for (c = LL_GetFirst(clientlist); c; c = LL_GetNext(clientlist)) {
+	ilist_foreach(c, &clientlist, link) {
 		if (c->sock == sock) {
 			return c;
 		}
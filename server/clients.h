@@ -11,13 +11,12 @@
  * \features
  * - Header file for client list management interface in LCDd server
  * - Client list initialization and shutdown functions for server lifecycle
- * - Client addition and removal operations with directional positioning
+ * - Constant-time client addition and removal through links embedded in Client
  * - Client search functionality by socket descriptor for message routing
- * - Client list iteration functions for traversing connected clients
+ * - Reentrant client list iteration, the caller holds the position
  * - Client count tracking for server monitoring and resource management
  * - Function declarations for client list operations and management
  * - Integration with client.h for Client structure and related definitions
- * - Direction enumeration support for client list positioning operations
  *
  * \usage
  * - Used by LCDd server core for managing the global list of connected clients
@@ -66,28 +65,28 @@ Client *clients_add_client(Client *c);
 /**
  * \brief Remove a client from the client list
  * \param c Pointer to Client structure to remove
- * \param whereto Direction for list positioning after removal
- * \return Pointer to next Client in specified direction, or NULL
- * \details Removes the specified client from the global client list
- * and returns the next client in the specified direction.
+ * \return c, or NULL if it was not in the list
+ * \details Unlinks the specified client from the global client list
+ * in constant time.
  */
-Client *clients_remove_client(Client *c, Direction whereto);
+Client *clients_remove_client(Client *c);
 
 /**
  * \brief Get the first client in the client list
  * \return Pointer to first Client, or NULL if list is empty
- * \details Positions the list iterator at the first client and
- * returns a pointer to it for iteration purposes.
+ * \details Starts an iteration; pass the result to clients_getnext()
+ * for the following client.
  */
 Client *clients_getfirst(void);
 
 /**
  * \brief Get the next client in the client list
- * \return Pointer to next Client, or NULL if at end of list
- * \details Advances the list iterator to the next client and
- * returns a pointer to it for continued iteration.
+ * \param c Current client of the iteration
+ * \return Pointer to the client following c, or NULL if at end of list
+ * \details The list keeps no cursor, so iterations may nest. The loop body
+ * must not remove c from the list unless it fetched the next client first.
  */
-Client *clients_getnext(void);
+Client *clients_getnext(Client *c);
 
 /**
  * \brief Get the total number of clients in the list
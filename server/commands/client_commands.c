@@ -10,6 +10,7 @@
  * - Client connection establishment (hello command)
  * - Client termination handling (bye command)
  * - Client configuration management (client_set command)
+ * - Atomic command batches with one aggregated reply (batch_begin, batch_end)
  * - Key event registration and deregistration (client_add_key, client_del_key)
  * - Display backlight control (backlight command)
  * - G15 macro LED control (macro_leds command)
@@ -50,6 +51,7 @@
 #include "../client.h"
 #include "../drivers.h"
 #include "../input.h"
+#include "../main.h"
 #include "../render.h"
 #include "client_commands.h"
 
@@ -60,7 +62,7 @@ int test_func_func(Client *c, int argc, char **argv)
 
 	for (i = 0; i < argc; i++) {
 		report(RPT_INFO, "%s: %i -> %s", __FUNCTION__, i, argv[i]);
-		sock_printf(c->sock, "%s:  %i -> %s\n", __FUNCTION__, i, argv[i]);
+		client_printf(c, "%s:  %i -> %s\n", __FUNCTION__, i, argv[i]);
 	}
 
 	return 0;
@@ -70,16 +72,15 @@ int test_func_func(Client *c, int argc, char **argv)
 int hello_func(Client *c, int argc, char **argv)
 {
 	if (argc > 1) {
-		sock_send_error(c->sock, "extra parameters ignored\n");
+		client_send_error(c, "extra parameters ignored\n");
 	}
 
 	debug(RPT_INFO, "Hello!");
 
 	// Send connection confirmation with display capabilities
-	sock_printf(c->sock,
-		    "connect LCDproc %s protocol %s lcd wid %i hgt %i cellwid %i cellhgt %i\n",
-		    VERSION, PROTOCOL_VERSION, display_props->width, display_props->height,
-		    display_props->cellwidth, display_props->cellheight);
+	client_printf(c, "connect LCDproc %s protocol %s lcd wid %i hgt %i cellwid %i cellhgt %i\n",
+		      VERSION, PROTOCOL_VERSION, display_props->width, display_props->height,
+		      display_props->cellwidth, display_props->cellheight);
 
 	c->state = ACTIVE;
 
@@ -93,55 +94,110 @@ int bye_func(Client *c, int argc, char **argv)
 		debug(RPT_INFO, "Bye, %s!", (c->name != NULL) ? c->name : "unknown client");
 
 		c->state = GONE;
-		sock_send_error(c->sock, "\"bye\" is currently ignored\n");
+		client_send_error(c, "\"bye\" is currently ignored\n");
 	}
 
 	return 0;
 }
 
-// Handle client_set command for client configuration
-int client_set_func(Client *c, int argc, char **argv)
+// Handle batch_begin command: hold rendering and collect replies until batch_end
+int batch_begin_func(Client *c, int argc, char **argv)
 {
-	int i;
+	if (c->state != ACTIVE)
+		return 1;
 
+	if (c->batch) {
+		client_send_error(c, "Batch already open\n");
+		return 0;
+	}
+
+	c->batch = 1;
+	c->batch_start = timer;
+	c->batch_replies = 0;
+	c->batch_errors = 0;
+
+	return 0;
+}
+
+// Handle batch_end command: release rendering and send the aggregated reply
+int batch_end_func(Client *c, int argc, char **argv)
+{
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 3) {
-		sock_send_error(c->sock, "Usage: client_set -name <name>\n");
+	if (!c->batch) {
+		client_send_error(c, "No batch open\n");
 		return 0;
 	}
 
-	i = 1;
-	do {
+	c->batch = 0;
+
+	if (c->batch_errors == 0)
+		client_send_success(c);
+	else
+		client_printf_error(c, "batch: %d of %d replies were errors\n", c->batch_errors,
+				    c->batch_replies);
+
+	return 0;
+}
+
+// Handle client_set command for client configuration
+int client_set_func(Client *c, int argc, char **argv)
+{
+	int errors = 0;
+	int i;
+
+	if (c->state != ACTIVE)
+		return 1;
+
+	for (i = 1; i < argc; i++) {
 		char *p = argv[i];
 
 		// Allow both -name and name parameter formats
 		if (*p == '-')
 			p++;
 
-		if (strcmp(p, "name") == 0) {
-			i++;
-			if (argv[i] == NULL) {
-				sock_printf_error(c->sock, "internal error: no parameter #%d\n", i);
-				continue;
-			}
+		if ((strcmp(p, "name") != 0) && (strcmp(p, "ack") != 0)) {
+			client_printf_error(c, "invalid parameter (%s)\n", p);
+			errors++;
+			continue;
+		}
+
+		if (++i >= argc) {
+			client_printf_error(c, "-%s requires a parameter\n", p);
+			errors++;
+			break;
+		}
 
+		if (strcmp(p, "name") == 0) {
 			debug(RPT_DEBUG, "client_set: name=\"%s\"", argv[i]);
 
 			if (c->name != NULL)
 				free(c->name);
 
 			if ((c->name = strdup(argv[i])) == NULL) {
-				sock_send_error(c->sock, "error allocating memory!\n");
-			} else {
-				sock_send_string(c->sock, "success\n");
-				i++;
+				client_send_error(c, "error allocating memory!\n");
+				errors++;
 			}
 		} else {
-			sock_printf_error(c->sock, "invalid parameter (%s)\n", p);
+			debug(RPT_DEBUG, "client_set: ack=\"%s\"", argv[i]);
+
+			if (strcmp(argv[i], "all") == 0) {
+				c->ack = ACK_ALL;
+			} else if (strcmp(argv[i], "errors") == 0) {
+				c->ack = ACK_ERRORS;
+			} else if (strcmp(argv[i], "none") == 0) {
+				c->ack = ACK_NONE;
+			} else {
+				client_send_error(c, "Invalid ack mode, use all, errors or none\n");
+				errors++;
+			}
 		}
-	} while (++i < argc);
+	}
+
+	// A single reply for all options, already subject to a changed ack mode
+	if (errors == 0)
+		client_send_success(c);
 
 	return 0;
 }
@@ -155,11 +211,6 @@ int client_add_key_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc < 2) {
-		sock_send_error(c->sock, "Usage: client_add_key [-exclusively|-shared] {<key>}+\n");
-		return 0;
-	}
-
 	argnr = 1;
 	if (argv[argnr][0] == '-') {
 		if (strcmp(argv[argnr], "-shared") == 0) {
@@ -167,16 +218,16 @@ int client_add_key_func(Client *c, int argc, char **argv)
 		} else if (strcmp(argv[argnr], "-exclusively") == 0) {
 			exclusively = 1;
 		} else {
-			sock_printf_error(c->sock, "Invalid option: %s\n", argv[argnr]);
+			client_printf_error(c, "Invalid option: %s\n", argv[argnr]);
 		}
 		argnr++;
 	}
 
 	for (; argnr < argc; argnr++)
 		if (input_reserve_key(argv[argnr], exclusively, c) < 0)
-			sock_printf_error(c->sock, "Could not reserve key \"%s\"\n", argv[argnr]);
+			client_printf_error(c, "Could not reserve key \"%s\"\n", argv[argnr]);
 		else
-			sock_send_string(c->sock, "success\n");
+			client_send_success(c);
 
 	return 0;
 }
@@ -189,15 +240,10 @@ int client_del_key_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc < 2) {
-		sock_send_error(c->sock, "Usage: client_del_key {<key>}+\n");
-		return 0;
-	}
-
 	for (argnr = 1; argnr < argc; argnr++) {
 		input_release_key(argv[argnr], c);
 	}
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -208,11 +254,6 @@ int backlight_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 2) {
-		sock_send_error(c->sock, "Usage: backlight {on|off|toggle|blink|flash}\n");
-		return 0;
-	}
-
 	debug(RPT_DEBUG, "backlight(%s)", argv[1]);
 
 	if (strcmp("on", argv[1]) == 0) {
@@ -230,7 +271,7 @@ int backlight_func(Client *c, int argc, char **argv)
 		c->backlight |= BACKLIGHT_FLASH;
 	}
 
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -241,11 +282,6 @@ int macro_leds_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 5) {
-		sock_send_error(c->sock, "Usage: macro_leds <m1> <m2> <m3> <mr>\n");
-		return 0;
-	}
-
 	debug(RPT_DEBUG, "macro_leds(%s %s %s %s)", argv[1], argv[2], argv[3], argv[4]);
 
 	// Parse LED states from string arguments to binary values
@@ -255,9 +291,9 @@ int macro_leds_func(Client *c, int argc, char **argv)
 	int mr = (strcmp("1", argv[4]) == 0) ? 1 : 0;
 
 	if (drivers_set_macro_leds(m1, m2, m3, mr) == 0) {
-		sock_send_string(c->sock, "success\n");
+		client_send_success(c);
 	} else {
-		sock_send_error(c->sock, "Failed to set macro LEDs\n");
+		client_send_error(c, "Failed to set macro LEDs\n");
 	}
 
 	return 0;
@@ -270,10 +306,10 @@ int info_func(Client *c, int argc, char **argv)
 		return 1;
 
 	if (argc > 1) {
-		sock_send_error(c->sock, "Extra arguments ignored...\n");
+		client_send_error(c, "Extra arguments ignored...\n");
 	}
 
-	sock_printf(c->sock, "%s\n", drivers_get_info());
+	client_printf(c, "%s\n", drivers_get_info());
 
 	return 0;
 }
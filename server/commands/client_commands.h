@@ -10,6 +10,7 @@
  * - **hello_func()**: Client connection establishment and protocol negotiation
  * - **bye_func()**: Clean client connection termination
  * - **client_set_func()**: Client name and configuration management
+ * - **batch_begin_func()**, **batch_end_func()**: Atomic command batches
  * - **client_add_key_func()**: Key event registration for clients
  * - **client_del_key_func()**: Key event deregistration
  * - **backlight_func()**: Display backlight state control
@@ -35,6 +36,7 @@
  * **Supported client commands:**
  * - Connection management (hello, bye, info)
  * - Client configuration (client_set)
+ * - Command batches (batch_begin, batch_end)
  * - Key event handling (client_add_key, client_del_key)
  * - Display control (backlight)
  * - G15 macro LED control (macro_leds)
@@ -77,6 +79,35 @@ int hello_func(Client *c, int argc, char **argv);
  */
 int bye_func(Client *c, int argc, char **argv);
 
+/**
+ * \brief Handle batch_begin command to open a command batch.
+ * \param c Client connection context
+ * \param argc Number of command arguments
+ * \param argv Array of command argument strings
+ * \retval 0 Success
+ * \retval 1 Client has not sent hello yet
+ *
+ * \details Commands up to the matching "batch_end" are applied as usual,
+ * but their replies are collected instead of sent and the client's screens
+ * are not rendered in between, so a frame never shows a half-applied update.
+ * Rendering is held for at most CLIENT_BATCH_MAX_FRAMES frames.
+ */
+int batch_begin_func(Client *c, int argc, char **argv);
+
+/**
+ * \brief Handle batch_end command to close a command batch.
+ * \param c Client connection context
+ * \param argc Number of command arguments
+ * \param argv Array of command argument strings
+ * \retval 0 Success
+ * \retval 1 Client has not sent hello yet
+ *
+ * \details Sends a single reply for the whole batch: "success" if every
+ * command succeeded, otherwise one error with the number of failures. The
+ * individual errors are written to the server log.
+ */
+int batch_end_func(Client *c, int argc, char **argv);
+
 /**
  * \brief Handle client_set command for client configuration.
  * \param c Client connection context
@@ -85,9 +116,11 @@ int bye_func(Client *c, int argc, char **argv);
  * \retval 0 Success
  * \retval -1 Error
  *
- * \details Processes "client_set" commands to configure client properties
- * such as name, heartbeat settings, and other client-specific options.
- * Updates the client configuration and stores settings in the client context.
+ * \details Processes "client_set" commands to configure client properties.
+ * Supported options are -name <name> and -ack {all|errors|none}; several
+ * options may be given on one line. -ack selects which command replies the
+ * client receives: all (default), errors only, or none. One reply is sent
+ * for the whole line, already following a newly set ack mode.
  */
 int client_set_func(Client *c, int argc, char **argv);
 
@@ -8,20 +8,22 @@
  *
  * \features
  * - Master command lookup table with keyword-to-function mappings
- * - Linear search algorithm for command resolution
+ * - Switch-on-length trie for command resolution with a single string compare
+ * - Central argument count validation with per-command usage messages
  * - Support for 20+ client protocol commands across multiple categories
  * - Client management commands (hello, bye, client_set, key management)
+ * - Batch commands (batch_begin, batch_end)
  * - Screen management commands (screen_add, screen_del, screen_set)
  * - Widget management commands (widget_add, widget_del, widget_set)
  * - Menu system commands (menu operations and navigation)
  * - Display control commands (backlight, macro_leds, output)
  * - Server utility commands (info, sleep, noop, test_func)
- * - Null-terminated command table for safe iteration
  * - Case-sensitive command keyword matching
  *
  * \usage
  * - Used by the LCDd server protocol parser for command dispatch
- * - get_command_function() is called to resolve command keywords
+ * - get_command() is called to resolve command keywords
+ * - command_args_valid() checks argc before the handler runs
  * - Command table is statically defined and does not change at runtime
  * - Used by main server loop to process client protocol requests
  * - Provides central registry of all supported client commands
@@ -41,72 +43,230 @@
 #include "menu_commands.h"
 #include "screen_commands.h"
 #include "server_commands.h"
+#include "shm_commands.h"
 #include "widget_commands.h"
 
+/** \brief Index of each command in the lookup table
+ *
+ * \details Used by command_index() to pick a table slot without scanning.
+ */
+enum {
+	CMD_TEST_FUNC,
+	CMD_HELLO,
+	CMD_CLIENT_SET,
+	CMD_CLIENT_ADD_KEY,
+	CMD_CLIENT_DEL_KEY,
+	CMD_BYE,
+	CMD_BATCH_BEGIN,
+	CMD_BATCH_END,
+	CMD_SCREEN_ADD,
+	CMD_SCREEN_DEL,
+	CMD_SCREEN_SET,
+	CMD_KEY_ADD,
+	CMD_KEY_DEL,
+	CMD_WIDGET_ADD,
+	CMD_WIDGET_DEL,
+	CMD_WIDGET_SET,
+	CMD_SHM_ATTACH,
+	CMD_SHM_BIND,
+	CMD_MENU_ADD_ITEM,
+	CMD_MENU_DEL_ITEM,
+	CMD_MENU_SET_ITEM,
+	CMD_MENU_GOTO,
+	CMD_MENU_SET_MAIN,
+	CMD_BACKLIGHT,
+	CMD_MACRO_LEDS,
+	CMD_OUTPUT,
+	CMD_INFO,
+	CMD_NOOP,
+	CMD_CLIENT_STATS,
+	CMD_COUNT
+};
+
 /** \brief Master command lookup table mapping keywords to handler functions
  *
  * \details Static array defining all supported client protocol commands.
- * Maps command keywords (strings) to their corresponding handler functions.
- * Table is null-terminated and searched linearly by get_command_function().
- * Organized by functional category for maintainability.
+ * Maps command keywords (strings) to their corresponding handler functions
+ * together with the accepted argument count (argv[0] included) and the usage
+ * message sent when a client gets it wrong. Organized by functional category
+ * for maintainability.
  */
-static client_function commands[] = {
+static const client_function commands[CMD_COUNT] = {
     // Development and debugging commands
-    {"test_func", test_func_func},
+    [CMD_TEST_FUNC] = {"test_func", test_func_func, 1, CMD_ARGS_UNLIMITED, NULL},
 
     // Client connection management commands
-    {"hello", hello_func},
-    {"client_set", client_set_func},
-    {"client_add_key", client_add_key_func},
-    {"client_del_key", client_del_key_func},
-    {"bye", bye_func},
+    [CMD_HELLO] = {"hello", hello_func, 1, CMD_ARGS_UNLIMITED, NULL},
+    [CMD_CLIENT_SET] = {"client_set", client_set_func, 3, CMD_ARGS_UNLIMITED,
+			"Usage: client_set {-name <name>|-ack {all|errors|none}}+\n"},
+    [CMD_CLIENT_ADD_KEY] = {"client_add_key", client_add_key_func, 2, CMD_ARGS_UNLIMITED,
+			    "Usage: client_add_key [-exclusively|-shared] {<key>}+\n"},
+    [CMD_CLIENT_DEL_KEY] = {"client_del_key", client_del_key_func, 2, CMD_ARGS_UNLIMITED,
+			    "Usage: client_del_key {<key>}+\n"},
+    [CMD_BYE] = {"bye", bye_func, 1, CMD_ARGS_UNLIMITED, NULL},
+    [CMD_BATCH_BEGIN] = {"batch_begin", batch_begin_func, 1, 1, "Usage: batch_begin\n"},
+    [CMD_BATCH_END] = {"batch_end", batch_end_func, 1, 1, "Usage: batch_end\n"},
 
     // Screen management commands
-    {"screen_add", screen_add_func},
-    {"screen_del", screen_del_func},
-    {"screen_set", screen_set_func},
+    [CMD_SCREEN_ADD] = {"screen_add", screen_add_func, 2, 2, "Usage: screen_add <screenid>\n"},
+    [CMD_SCREEN_DEL] = {"screen_del", screen_del_func, 2, 2, "Usage: screen_del <screenid>\n"},
+    [CMD_SCREEN_SET] = {"screen_set", screen_set_func, 2, CMD_ARGS_UNLIMITED,
+			"Usage: screen_set <id> [-name <name>]"
+			" [-wid <width>] [-hgt <height>] [-priority <prio>]"
+			" [-duration <int>] [-timeout <int>]"
+			" [-heartbeat <type>] [-backlight <type>]"
+			" [-cursor <type>]"
+			" [-cursor_x <xpos>] [-cursor_y <ypos>]\n"},
 
     // Key event management commands
-    {"key_add", key_add_func},
-    {"key_del", key_del_func},
+    [CMD_KEY_ADD] = {"key_add", key_add_func, 3, CMD_ARGS_UNLIMITED,
+		     "Usage: key_add screen_id {<key>}+\n"},
+    [CMD_KEY_DEL] = {"key_del", key_del_func, 3, CMD_ARGS_UNLIMITED,
+		     "Usage: key_del screen_id {<key>}+\n"},
 
     // Widget management commands
-    {"widget_add", widget_add_func},
-    {"widget_del", widget_del_func},
-    {"widget_set", widget_set_func},
+    [CMD_WIDGET_ADD] = {"widget_add", widget_add_func, 4, 6,
+			"Usage: widget_add <screenid> <widgetid> <widgettype> [-in <id>]\n"},
+    [CMD_WIDGET_DEL] = {"widget_del", widget_del_func, 3, 3,
+			"Usage: widget_del <screenid> <widgetid>\n"},
+    [CMD_WIDGET_SET] = {"widget_set", widget_set_func, 4, CMD_ARGS_UNLIMITED,
+			"Usage: widget_set <screenid> <widgetid> <widget-SPECIFIC-data>\n"},
+
+    // Shared-memory value channel commands
+    [CMD_SHM_ATTACH] = {"shm_attach", shm_attach_func, 1, 1, "Usage: shm_attach\n"},
+    [CMD_SHM_BIND] = {"shm_bind", shm_bind_func, 4, 4,
+		      "Usage: shm_bind <screenid> <widgetid> {<slot>|none}\n"},
 
     // Menu system commands
-    {"menu_add_item", menu_add_item_func},
-    {"menu_del_item", menu_del_item_func},
-    {"menu_set_item", menu_set_item_func},
-    {"menu_goto", menu_goto_func},
-    {"menu_set_main", menu_set_main_func},
+    [CMD_MENU_ADD_ITEM] = {"menu_add_item", menu_add_item_func, 4, CMD_ARGS_UNLIMITED,
+			   "Usage: menu_add_item <menuid> <newitemid> <type> [<text>] "
+			   "[<option>]+\n"},
+    [CMD_MENU_DEL_ITEM] = {"menu_del_item", menu_del_item_func, 2, 3,
+			   "Usage: menu_del_item [ignored] <itemid>\n"},
+    [CMD_MENU_SET_ITEM] = {"menu_set_item", menu_set_item_func, 4, CMD_ARGS_UNLIMITED,
+			   "Usage: menu_set_item <menuid> <itemid> {<option>}+\n"},
+    [CMD_MENU_GOTO] = {"menu_goto", menu_goto_func, 2, 3,
+		       "Usage: menu_goto <menuid> [<predecessor_id>]\n"},
+    [CMD_MENU_SET_MAIN] = {"menu_set_main", menu_set_main_func, 2, 2,
+			   "Usage: menu_set_main <menuid>\n"},
 
     // Display and hardware control commands
-    {"backlight", backlight_func},
-    {"macro_leds", macro_leds_func},
-    {"output", output_func},
+    [CMD_BACKLIGHT] = {"backlight", backlight_func, 2, 2,
+		       "Usage: backlight {on|off|toggle|blink|flash}\n"},
+    [CMD_MACRO_LEDS] = {"macro_leds", macro_leds_func, 5, 5,
+			"Usage: macro_leds <m1> <m2> <m3> <mr>\n"},
+    [CMD_OUTPUT] = {"output", output_func, 2, 2, "Usage: output {on|off|<num>}\n"},
 
     // Server utility commands
-    {"info", info_func},
-    {"noop", noop_func},
-
-    // Terminator entry for safe iteration
-    {NULL, NULL},
+    [CMD_INFO] = {"info", info_func, 1, CMD_ARGS_UNLIMITED, NULL},
+    [CMD_NOOP] = {"noop", noop_func, 1, CMD_ARGS_UNLIMITED, NULL},
+    [CMD_CLIENT_STATS] = {"client_stats", client_stats_func, 1, 1, "Usage: client_stats\n"},
 };
 
-// Look up command function by keyword
-CommandFunc get_command_function(char *cmd)
+/**
+ * \brief Map a keyword to its candidate table index
+ * \param cmd Command keyword
+ * \param len Length of cmd
+ * \retval >=0 Only table slot that can match cmd
+ * \retval -1 No command has this shape
+ *
+ * \details Switch-on-length trie: the keyword length and at most two
+ * distinguishing characters select a single candidate, which the caller then
+ * verifies with one string compare. Keep in sync with commands[] when adding
+ * a command; test_unit_g15 checks every keyword round-trips.
+ */
+static int command_index(const char *cmd, size_t len)
+{
+	switch (len) {
+	case 3:
+		return CMD_BYE;
+	case 4:
+		return (cmd[0] == 'i') ? CMD_INFO : CMD_NOOP;
+	case 5:
+		return CMD_HELLO;
+	case 6:
+		return CMD_OUTPUT;
+	case 7:
+		return (cmd[4] == 'a') ? CMD_KEY_ADD : CMD_KEY_DEL;
+	case 8:
+		return CMD_SHM_BIND;
+	case 9:
+		switch (cmd[0]) {
+		case 't':
+			return CMD_TEST_FUNC;
+		case 'm':
+			return CMD_MENU_GOTO;
+		case 'b':
+			return (cmd[2] == 't') ? CMD_BATCH_END : CMD_BACKLIGHT;
+		}
+		break;
+	case 10:
+		// client_set, macro_leds, shm_attach, screen_{add,del,set}, widget_{add,del,set}
+		switch (cmd[0]) {
+		case 'c':
+			return CMD_CLIENT_SET;
+		case 'm':
+			return CMD_MACRO_LEDS;
+		case 's':
+			if (cmd[1] == 'h')
+				return CMD_SHM_ATTACH;
+			// fall through
+		case 'w':
+			switch (cmd[7]) {
+			case 'a':
+				return (cmd[0] == 's') ? CMD_SCREEN_ADD : CMD_WIDGET_ADD;
+			case 'd':
+				return (cmd[0] == 's') ? CMD_SCREEN_DEL : CMD_WIDGET_DEL;
+			case 's':
+				return (cmd[0] == 's') ? CMD_SCREEN_SET : CMD_WIDGET_SET;
+			}
+			break;
+		}
+		break;
+	case 11:
+		return CMD_BATCH_BEGIN;
+	case 12:
+		return CMD_CLIENT_STATS;
+	case 13:
+		// menu_{add,del,set}_item, menu_set_main
+		switch (cmd[5]) {
+		case 'a':
+			return CMD_MENU_ADD_ITEM;
+		case 'd':
+			return CMD_MENU_DEL_ITEM;
+		case 's':
+			return (cmd[9] == 'i') ? CMD_MENU_SET_ITEM : CMD_MENU_SET_MAIN;
+		}
+		break;
+	case 14:
+		return (cmd[7] == 'a') ? CMD_CLIENT_ADD_KEY : CMD_CLIENT_DEL_KEY;
+	}
+
+	return -1;
+}
+
+// Look up command table entry by keyword
+const client_function *get_command(const char *cmd)
 {
 	int i;
 
 	if (cmd == NULL)
 		return NULL;
 
-	for (i = 0; commands[i].keyword != NULL; i++) {
-		if (0 == strcmp(cmd, commands[i].keyword))
-			return commands[i].function;
-	}
+	i = command_index(cmd, strlen(cmd));
+	if ((i < 0) || (strcmp(cmd, commands[i].keyword) != 0))
+		return NULL;
+
+	return &commands[i];
+}
+
+// Check argument count against the command table entry
+int command_args_valid(const client_function *cmd, int argc)
+{
+	if (argc < cmd->min_args)
+		return 0;
+	if ((cmd->max_args != CMD_ARGS_UNLIMITED) && (argc > cmd->max_args))
+		return 0;
 
-	return NULL;
+	return 1;
 }
@@ -9,8 +9,8 @@
  * \features
  * - **CommandFunc**: Function pointer type for standardized command handlers
  * - **client_function**: Structure mapping command keywords to handler functions
- * - **get_command_function()**: Command lookup and dispatch function
- * - Linear search command table with null terminator
+ * - **get_command()**: Command lookup via switch-on-length trie
+ * - **command_args_valid()**: Central argument count check per command
  * - Case-sensitive command keyword matching
  * - Standardized function signature for all command handlers
  * - Support for multiple command categories (client, screen, widget, menu, etc.)
@@ -21,6 +21,7 @@
  * - Used by protocol parser to dispatch client commands to handlers
  * - Command table is populated in command_list.c implementation
  * - All command handlers must follow the CommandFunc signature
+ * - Handlers may rely on argc being within the range of their table entry
  * - Used for client-server protocol command routing
  *
  * \details
@@ -48,6 +49,9 @@
  */
 typedef int (*CommandFunc)(Client *c, int argc, char **argv);
 
+/** \brief max_args value for commands taking any number of arguments */
+#define CMD_ARGS_UNLIMITED -1
+
 /**
  * \brief Structure defining an entry in the command lookup table.
  *
@@ -56,20 +60,32 @@ typedef int (*CommandFunc)(Client *c, int argc, char **argv);
  * execute the appropriate function when a client sends a command.
  */
 typedef struct client_function {
-	char *keyword;	      // Command string in the protocol
+	const char *keyword;  // Command string in the protocol
 	CommandFunc function; // Pointer to the associated handler function
+	int min_args;	      // Minimum argc, command keyword included
+	int max_args;	      // Maximum argc or CMD_ARGS_UNLIMITED
+	const char *usage;    // Error message sent when argc is out of range
 } client_function;
 
 /**
- * \brief Look up a command function by keyword.
+ * \brief Look up a command table entry by keyword.
  * \param cmd Command keyword string to search for
- * \retval function Pointer to command handler function
+ * \retval entry Pointer to the command table entry
  * \retval NULL Command not found
  *
- * \details Searches the command table for the specified keyword and
- * returns the associated function pointer. Used by the command parser
- * to dispatch commands to their handlers.
+ * \details Selects the only possible candidate by keyword length and a few
+ * characters, then confirms it with a single string compare. Used by the
+ * command parser to dispatch commands to their handlers.
+ */
+const client_function *get_command(const char *cmd);
+
+/**
+ * \brief Check an argument count against a command's accepted range.
+ * \param cmd Command table entry
+ * \param argc Number of arguments including the command keyword
+ * \retval 1 argc is accepted
+ * \retval 0 argc is out of range; send cmd->usage to the client
  */
-CommandFunc get_command_function(char *cmd);
+int command_args_valid(const client_function *cmd, int argc);
 
 #endif
@@ -73,14 +73,7 @@ int menu_add_item_func(Client *c, int argc, char **argv)
 		return 1;
 
 	if (c->name == NULL) {
-		sock_send_error(c->sock, "You need to give your client a name first\n");
-		return 0;
-	}
-
-	if (argc < 4) {
-		sock_send_error(
-		    c->sock,
-		    "Usage: menu_add_item <menuid> <newitemid> <type> [<text>] [<option>]+\n");
+		client_send_error(c, "You need to give your client a name first\n");
 		return 0;
 	}
 
@@ -92,7 +85,7 @@ int menu_add_item_func(Client *c, int argc, char **argv)
 		report(RPT_INFO, "Client [%d] is using the menu", c->sock);
 		c->menu = menu_create("_client_menu_", menu_commands_handler, c->name, c);
 		if (c->menu == NULL) {
-			sock_send_error(c->sock, "Cannot create menu\n");
+			client_send_error(c, "Cannot create menu\n");
 			return 1;
 		}
 		menu_add_item(main_menu, c->menu);
@@ -101,19 +94,19 @@ int menu_add_item_func(Client *c, int argc, char **argv)
 	// Use either the given menu or the client's main menu if none was specified
 	menu = (menu_id[0] != '\0') ? menu_find_item(c->menu, menu_id, true) : c->menu;
 	if (menu == NULL) {
-		sock_send_error(c->sock, "Cannot find menu id\n");
+		client_send_error(c, "Cannot find menu id\n");
 		return 0;
 	}
 
 	item = menu_find_item(c->menu, item_id, true);
 	if (item != NULL) {
-		sock_printf_error(c->sock, "Item id '%s' already in use\n", item_id);
+		client_printf_error(c, "Item id '%s' already in use\n", item_id);
 		return 0;
 	}
 
 	itemtype = menuitem_typename_to_type(argv[3]);
 	if (itemtype == MENUITEM_INVALID) {
-		sock_send_error(c->sock, "Invalid menuitem type\n");
+		client_send_error(c, "Invalid menuitem type\n");
 		return 0;
 	}
 
@@ -202,7 +195,7 @@ int menu_add_item_func(Client *c, int argc, char **argv)
 		menu_set_item_func(c, j, tmp_argv);
 		free((void *)tmp_argv);
 	} else
-		sock_send_string(c->sock, "success\n");
+		client_send_success(c);
 
 	return 0;
 }
@@ -216,21 +209,16 @@ int menu_del_item_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 3 && argc != 2) {
-		sock_send_error(c->sock, "Usage: menu_del_item [ignored] <itemid>\n");
-		return 0;
-	}
-
 	item_id = argv[argc - 1];
 
 	if (c->menu == NULL) {
-		sock_send_error(c->sock, "Client has no menu\n");
+		client_send_error(c, "Client has no menu\n");
 		return 0;
 	}
 
 	item = menu_find_item(c->menu, item_id, true);
 	if (item == NULL) {
-		sock_send_error(c->sock, "Cannot find item\n");
+		client_send_error(c, "Cannot find item\n");
 		return 0;
 	}
 	menuscreen_inform_item_destruction(item);
@@ -246,7 +234,7 @@ int menu_del_item_func(Client *c, int argc, char **argv)
 		menu_destroy(c->menu);
 		c->menu = NULL;
 	}
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -324,17 +312,11 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc < 4) {
-		sock_send_error(c->sock, "Usage: menu_set_item "
-					 " <itemid> {<option>}+\n");
-		return 0;
-	}
-
 	item_id = argv[2];
 
 	item = menu_find_item(c->menu, item_id, true);
 	if (item == NULL) {
-		sock_send_error(c->sock, "Cannot find item\n");
+		client_send_error(c, "Cannot find item\n");
 		return 0;
 	}
 
@@ -361,17 +343,17 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 			}
 
 		} else {
-			sock_printf_error(c->sock, "Found non-option: \"%.40s\"\n", argv[argnr]);
+			client_printf_error(c, "Found non-option: \"%.40s\"\n", argv[argnr]);
 			continue;
 		}
 		if (option_nr == -1) {
 			if (found_option_name) {
-				sock_printf_error(c->sock,
-						  "Option not valid for menuitem type: \"%.40s\"\n",
-						  argv[argnr]);
+				client_printf_error(c,
+						    "Option not valid for menuitem type: "
+						    "\"%.40s\"\n",
+						    argv[argnr]);
 			} else {
-				sock_printf_error(c->sock, "Unknown option: \"%.40s\"\n",
-						  argv[argnr]);
+				client_printf_error(c, "Unknown option: \"%.40s\"\n", argv[argnr]);
 			}
 			continue;
 		}
@@ -379,8 +361,8 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 		// Check for value
 		if (option_table[option_nr].attr_type != NOVALUE) {
 			if (argnr + 1 >= argc) {
-				sock_printf_error(c->sock, "Missing value at option: \"%.40s\"\n",
-						  argv[argnr]);
+				client_printf_error(c, "Missing value at option: \"%.40s\"\n",
+						    argv[argnr]);
 				continue;
 			}
 		}
@@ -479,9 +461,9 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 
 		// Value parsing error occurred
 		case 1:
-			sock_printf_error(c->sock,
-					  "Could not interpret value at option: \"%.40s\"\n",
-					  argv[argnr]);
+			client_printf_error(c,
+					    "Could not interpret value at option: \"%.40s\"\n",
+					    argv[argnr]);
 			argnr++;
 			continue;
 
@@ -588,15 +570,15 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 
 		// Value interpretation error
 		case 1:
-			sock_printf_error(c->sock,
-					  "Could not interpret value at option: \"%.40s\"\n",
-					  argv[argnr]);
+			client_printf_error(c,
+					    "Could not interpret value at option: \"%.40s\"\n",
+					    argv[argnr]);
 			continue;
 
 		// Value out of range error
 		case 2:
-			sock_printf_error(c->sock, "Value out of range at option: \"%.40s\"\n",
-					  argv[argnr]);
+			client_printf_error(c, "Value out of range at option: \"%.40s\"\n",
+					    argv[argnr]);
 			argnr++;
 			continue;
 
@@ -610,7 +592,7 @@ int menu_set_item_func(Client *c, int argc, char **argv)
 			argnr++;
 		}
 	}
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -627,11 +609,6 @@ int menu_goto_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if ((argc < 2) || (argc > 3)) {
-		sock_send_error(c->sock, "Usage: menu_goto <menuid> [<predecessor_id>]\n");
-		return 0;
-	}
-
 	menu_id = argv[1];
 
 	if (strcmp("_quit_", menu_id) == 0) {
@@ -639,7 +616,7 @@ int menu_goto_func(Client *c, int argc, char **argv)
 	} else {
 		menu = (menu_id[0] != '\0') ? menuitem_search(menu_id, c) : c->menu;
 		if (menu == NULL) {
-			sock_send_error(c->sock, "Cannot find menu id\n");
+			client_send_error(c, "Cannot find menu id\n");
 			return 0;
 		}
 
@@ -648,7 +625,7 @@ int menu_goto_func(Client *c, int argc, char **argv)
 	}
 
 	menuscreen_goto(menu);
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -676,10 +653,10 @@ int set_predecessor(MenuItem *item, char *itemid, Client *c)
 		MenuItem *predecessor = menuitem_search(itemid, c);
 
 		if (predecessor == NULL) {
-			sock_printf_error(c->sock,
-					  "Cannot find predecessor '%s'"
-					  " for item '%s'\n",
-					  itemid, item->id);
+			client_printf_error(c,
+					    "Cannot find predecessor '%s'"
+					    " for item '%s'\n",
+					    itemid, item->id);
 			return -1;
 		}
 	}
@@ -719,20 +696,20 @@ int set_successor(MenuItem *item, char *itemid, Client *c)
 		MenuItem *successor = menuitem_search(itemid, c);
 
 		if (successor == NULL) {
-			sock_printf_error(c->sock,
-					  "Cannot find successor '%s'"
-					  " for item '%s'\n",
-					  itemid, item->id);
+			client_printf_error(c,
+					    "Cannot find successor '%s'"
+					    " for item '%s'\n",
+					    itemid, item->id);
 			return -1;
 		}
 	}
 
 	// Menu items cannot have successors
 	if (item->type == MENUITEM_MENU) {
-		sock_printf_error(c->sock,
-				  "Cannot set successor of '%s':"
-				  " wrong type '%s'\n",
-				  item->id, menuitem_type_to_typename(item->type));
+		client_printf_error(c,
+				    "Cannot set successor of '%s':"
+				    " wrong type '%s'\n",
+				    item->id, menuitem_type_to_typename(item->type));
 		return -1;
 	}
 	debug(RPT_DEBUG,
@@ -759,11 +736,6 @@ int menu_set_main_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 2) {
-		sock_send_error(c->sock, "Usage: menu_set_main <menuid>\n");
-		return 0;
-	}
-
 	menu_id = argv[1];
 
 	if (menu_id[0] == '\0') {
@@ -773,13 +745,13 @@ int menu_set_main_func(Client *c, int argc, char **argv)
 	} else {
 		menu = menu_find_item(c->menu, menu_id, true);
 		if (menu == NULL) {
-			sock_send_error(c->sock, "Cannot find menu id\n");
+			client_send_error(c, "Cannot find menu id\n");
 			return 0;
 		}
 	}
 
 	menuscreen_set_main(menu);
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -804,56 +776,56 @@ MenuEventFunc(menu_commands_handler)
 
 		// Checkbox events report current state as text
 		case MENUITEM_CHECKBOX:
-			sock_printf(c->sock, "menuevent %s %.40s %s\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    ((char *[]){"off", "on", "gray"})[item->data.checkbox.value]);
+			client_printf(c, "menuevent %s %.40s %s\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      ((char *[]){"off", "on", "gray"})[item->data.checkbox.value]);
 			break;
 
 		// Slider events report current numeric value
 		case MENUITEM_SLIDER:
-			sock_printf(c->sock, "menuevent %s %.40s %d\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    item->data.slider.value);
+			client_printf(c, "menuevent %s %.40s %d\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      item->data.slider.value);
 			break;
 
 		// Ring events report selected index
 		case MENUITEM_RING:
-			sock_printf(c->sock, "menuevent %s %.40s %d\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    item->data.ring.value);
+			client_printf(c, "menuevent %s %.40s %d\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      item->data.ring.value);
 			break;
 
 		// Numeric events report current integer value
 		case MENUITEM_NUMERIC:
-			sock_printf(c->sock, "menuevent %s %.40s %d\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    item->data.numeric.value);
+			client_printf(c, "menuevent %s %.40s %d\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      item->data.numeric.value);
 			break;
 
 		// Alpha events report current text string
 		case MENUITEM_ALPHA:
-			sock_printf(c->sock, "menuevent %s %.40s %.40s\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    item->data.alpha.value);
+			client_printf(c, "menuevent %s %.40s %.40s\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      item->data.alpha.value);
 			break;
 
 		// IP events report current IP address string
 		case MENUITEM_IP:
-			sock_printf(c->sock, "menuevent %s %.40s %.40s\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id,
-				    item->data.ip.value);
+			client_printf(c, "menuevent %s %.40s %.40s\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id,
+				      item->data.ip.value);
 			break;
 
 		// Default events for unsupported item types
 		default:
-			sock_printf(c->sock, "menuevent %s %.40s\n",
-				    menuitem_eventtype_to_eventtypename(event), item->id);
+			client_printf(c, "menuevent %s %.40s\n",
+				      menuitem_eventtype_to_eventtypename(event), item->id);
 		}
 
 		// MENUEVENT_ENTER, MENUEVENT_LEAVE, and other events without specific values
 	} else {
-		sock_printf(c->sock, "menuevent %s %.40s\n",
-			    menuitem_eventtype_to_eventtypename(event), item->id);
+		client_printf(c, "menuevent %s %.40s\n",
+			      menuitem_eventtype_to_eventtypename(event), item->id);
 	}
 
 	return 0;
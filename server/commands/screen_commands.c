@@ -46,6 +46,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "shared/arena.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
 
@@ -53,6 +54,7 @@
 #include "render.h"
 #include "screen.h"
 #include "screen_commands.h"
+#include "screenlist.h"
 
 // Handle screen_add command for creating new screens
 int screen_add_func(Client *c, int argc, char **argv)
@@ -63,31 +65,26 @@ int screen_add_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 2) {
-		sock_send_error(c->sock, "Usage: screen_add <screenid>\n");
-		return 0;
-	}
-
 	debug(RPT_DEBUG, "screen_add: Adding screen %s", argv[1]);
 
 	s = client_find_screen(c, argv[1]);
 	if (s != NULL) {
-		sock_send_error(c->sock, "Screen already exists\n");
+		client_send_error(c, "Screen already exists\n");
 		return 0;
 	}
 
 	s = screen_create(argv[1], c);
 	if (s == NULL) {
-		sock_send_error(c->sock, "failed to create screen\n");
+		client_send_error(c, "failed to create screen\n");
 		return 0;
 	}
 
 	err = client_add_screen(c, s);
 
 	if (err == 0) {
-		sock_send_string(c->sock, "success\n");
+		client_send_success(c);
 	} else {
-		sock_send_error(c->sock, "failed to add screen\n");
+		client_send_error(c, "failed to add screen\n");
 	}
 	report(RPT_INFO, "Client on socket %d added added screen \"%s\"", c->sock, s->id);
 
@@ -103,26 +100,21 @@ int screen_del_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 2) {
-		sock_send_error(c->sock, "Usage: screen_del <screenid>\n");
-		return 0;
-	}
-
 	debug(RPT_DEBUG, "screen_del: Deleting screen %s", argv[1]);
 
 	s = client_find_screen(c, argv[1]);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
 	err = client_remove_screen(c, s);
 	if (err == 0) {
-		sock_send_string(c->sock, "success\n");
+		client_send_success(c);
 	} else if (err < 0) {
-		sock_send_error(c->sock, "failed to remove screen\n");
+		client_send_error(c, "failed to remove screen\n");
 	} else {
-		sock_send_error(c->sock, "Unknown screen id\n");
+		client_send_error(c, "Unknown screen id\n");
 	}
 
 	report(RPT_INFO, "Client on socket %d removed screen \"%s\"", c->sock, s->id);
@@ -142,17 +134,8 @@ int screen_set_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc == 1) {
-		sock_send_error(c->sock, "Usage: screen_set <id> [-name <name>]"
-					 " [-wid <width>] [-hgt <height>] [-priority <prio>]"
-					 " [-duration <int>] [-timeout <int>]"
-					 " [-heartbeat <type>] [-backlight <type>]"
-					 " [-cursor <type>]"
-					 " [-cursor_x <xpos>] [-cursor_y <ypos>]\n");
-		return 0;
-
-	} else if (argc == 2) {
-		sock_send_error(c->sock, "What do you want to set?\n");
+	if (argc == 2) {
+		client_send_error(c, "What do you want to set?\n");
 		return 0;
 	}
 
@@ -160,10 +143,12 @@ int screen_set_func(Client *c, int argc, char **argv)
 
 	s = client_find_screen(c, id);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
+	screen_touch(s);
+
 	// Process all property configuration parameters
 	for (i = 2; i < argc; i++) {
 		char *p = argv[i];
@@ -178,12 +163,16 @@ int screen_set_func(Client *c, int argc, char **argv)
 				i++;
 				debug(RPT_DEBUG, "screen_set: name=\"%s\"", argv[i]);
 
-				if (s->name != NULL)
-					free(s->name);
-				s->name = strdup(argv[i]);
-				sock_send_string(c->sock, "success\n");
+				char *name = arena_strset(s->arena, s->name, argv[i]);
+
+				if (name == NULL) {
+					client_send_error(c, "memory allocation failed\n");
+				} else {
+					s->name = name;
+					client_send_success(c);
+				}
 			} else {
-				sock_send_error(c->sock, "-name requires a parameter\n");
+				client_send_error(c, "-name requires a parameter\n");
 			}
 		}
 
@@ -208,15 +197,15 @@ int screen_set_func(Client *c, int argc, char **argv)
 					number = screen_pri_name_to_pri(argv[i]);
 				}
 				if (number >= 0) {
-					s->priority = number;
-					sock_send_string(c->sock, "success\n");
+					screenlist_set_priority(s, number);
+					client_send_success(c);
 
 				} else {
-					sock_send_error(c->sock, "invalid argument at -priority\n");
+					client_send_error(c, "invalid argument at -priority\n");
 				}
 
 			} else {
-				sock_send_error(c->sock, "-priority requires a parameter\n");
+				client_send_error(c, "-priority requires a parameter\n");
 			}
 		}
 
@@ -229,10 +218,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 				number = atoi(argv[i]);
 				if (number > 0)
 					s->duration = number;
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-duration requires a parameter\n");
+				client_send_error(c, "-duration requires a parameter\n");
 			}
 		}
 
@@ -248,10 +237,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 					s->heartbeat = HEARTBEAT_OFF;
 				else if (0 == strcmp(argv[i], "open"))
 					s->heartbeat = HEARTBEAT_OPEN;
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-heartbeat requires a parameter\n");
+				client_send_error(c, "-heartbeat requires a parameter\n");
 			}
 		}
 
@@ -264,10 +253,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 				number = atoi(argv[i]);
 				if (number > 0)
 					s->width = number;
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-wid requires a parameter\n");
+				client_send_error(c, "-wid requires a parameter\n");
 			}
 
 		}
@@ -281,10 +270,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 				number = atoi(argv[i]);
 				if (number > 0)
 					s->height = number;
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-hgt requires a parameter\n");
+				client_send_error(c, "-hgt requires a parameter\n");
 			}
 		}
 
@@ -299,10 +288,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 					s->timeout = number;
 					report(RPT_NOTICE, "Timeout set.");
 				}
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-timeout requires a parameter\n");
+				client_send_error(c, "-timeout requires a parameter\n");
 			}
 		}
 
@@ -331,12 +320,12 @@ int screen_set_func(Client *c, int argc, char **argv)
 				else if (strcmp("open", argv[i]) == 0)
 					s->backlight = BACKLIGHT_OPEN;
 				else
-					sock_send_error(c->sock, "unknown backlight mode\n");
+					client_send_error(c, "unknown backlight mode\n");
 
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-backlight requires a parameter\n");
+				client_send_error(c, "-backlight requires a parameter\n");
 			}
 		}
 
@@ -354,10 +343,10 @@ int screen_set_func(Client *c, int argc, char **argv)
 					s->cursor = CURSOR_UNDER;
 				if (0 == strcmp(argv[i], "block"))
 					s->cursor = CURSOR_BLOCK;
-				sock_send_string(c->sock, "success\n");
+				client_send_success(c);
 
 			} else {
-				sock_send_error(c->sock, "-cursor requires a parameter\n");
+				client_send_error(c, "-cursor requires a parameter\n");
 			}
 		}
 
@@ -370,15 +359,14 @@ int screen_set_func(Client *c, int argc, char **argv)
 				number = atoi(argv[i]);
 				if (number > 0 && number <= s->width) {
 					s->cursor_x = number;
-					sock_send_string(c->sock, "success\n");
+					client_send_success(c);
 
 				} else {
-					sock_send_error(c->sock,
-							"Cursor position outside screen\n");
+					client_send_error(c, "Cursor position outside screen\n");
 				}
 
 			} else {
-				sock_send_error(c->sock, "-cursor_x requires a parameter\n");
+				client_send_error(c, "-cursor_x requires a parameter\n");
 			}
 		}
 
@@ -391,20 +379,19 @@ int screen_set_func(Client *c, int argc, char **argv)
 				number = atoi(argv[i]);
 				if (number > 0 && number <= s->height) {
 					s->cursor_y = number;
-					sock_send_string(c->sock, "success\n");
+					client_send_success(c);
 
 				} else {
-					sock_send_error(c->sock,
-							"Cursor position outside screen\n");
+					client_send_error(c, "Cursor position outside screen\n");
 				}
 
 			} else {
-				sock_send_error(c->sock, "-cursor_y requires a parameter\n");
+				client_send_error(c, "-cursor_y requires a parameter\n");
 			}
 		}
 		// Report unrecognized parameter
 		else
-			sock_send_error(c->sock, "invalid parameter\n");
+			client_send_error(c, "invalid parameter\n");
 	}
 
 	return 0;
@@ -416,30 +403,25 @@ int key_add_func(Client *c, int argc, char **argv)
 	Screen *s;
 	int len;
 
-	if (argc < 3) {
-		sock_send_error(c->sock, "Usage: key_add screen_id {<key>}+\n");
-		return 0;
-	}
-
 	s = client_find_screen(c, argv[1]);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
 	// Calculate total length of key arguments to copy
 	len = argv[argc - 1] - argv[2] + strlen(argv[argc - 1]) + 1;
 
-	char *new_keys = realloc(s->keys, len + s->keys_size);
+	char *new_keys = arena_realloc(s->arena, s->keys, len + s->keys_size);
 	if (new_keys == NULL) {
-		sock_send_error(c->sock, "memory allocation failed\n");
+		client_send_error(c, "memory allocation failed\n");
 		return -1;
 	}
 	s->keys = new_keys;
 	memcpy(&s->keys[s->keys_size], argv[2], len);
 	s->keys_size += len;
 
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	return 0;
 }
@@ -451,14 +433,9 @@ int key_del_func(Client *c, int argc, char **argv)
 	int i, len;
 	char *key, *p;
 
-	if (argc < 3) {
-		sock_send_error(c->sock, "Usage: key_del screen_id {<key>}+\n");
-		return 0;
-	}
-
 	s = client_find_screen(c, argv[1]);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
@@ -471,9 +448,9 @@ int key_del_func(Client *c, int argc, char **argv)
 			memmove(p, p + len, s->keys_size - (p - s->keys));
 			s->keys_size -= len;
 
-			sock_send_string(c->sock, "success\n");
+			client_send_success(c);
 		} else
-			sock_send_error(c->sock, "Key not requested\n");
+			client_send_error(c, "Key not requested\n");
 	}
 
 	return 0;
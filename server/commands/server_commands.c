@@ -9,6 +9,7 @@
  * \features
  * - Hardware output port control for Matrix Orbital and compatible displays
  * - No-operation commands for connectivity testing and keep-alive functionality
+ * - Per-client queue, scheduling wait, suppressed replies, arena usage and Unix peer (client_stats)
  * - Server information and capability reporting (planned for info_func)
  * - Connection testing and protocol responsiveness verification
  * - Hardware output state management (on/off/numeric values)
@@ -38,12 +39,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "shared/arena.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
 
 #include "client.h"
+#include "clients.h"
 #include "render.h"
 #include "server_commands.h"
 
@@ -61,11 +65,6 @@ int output_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 2) {
-		sock_send_error(c->sock, "Usage: output {on|off|<num>}\n");
-		return 0;
-	}
-
 	if (0 == strcmp(argv[1], "on"))
 		output_state = ALL_OUTPUTS_ON;
 	else if (0 == strcmp(argv[1], "off"))
@@ -82,17 +81,17 @@ int output_func(Client *c, int argc, char **argv)
 			// Thread-safe error message generation
 			char err_buf[256];
 			strerror_r(errno, err_buf, sizeof(err_buf));
-			sock_printf_error(c->sock, "number argument: %s\n", err_buf);
+			client_printf_error(c, "number argument: %s\n", err_buf);
 			return 0;
 		} else if ((*argv[1] != '\0') && (*endptr == '\0')) {
 			output_state = out;
 		} else {
-			sock_send_error(c->sock, "invalid parameter...\n");
+			client_send_error(c, "invalid parameter...\n");
 			return 0;
 		}
 	}
 
-	sock_send_string(c->sock, "success\n");
+	client_send_success(c);
 
 	// Outputs are applied later in draw_screen()
 	report(RPT_NOTICE, "output states changed");
@@ -105,6 +104,50 @@ int noop_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	sock_send_string(c->sock, "noop complete\n");
+	client_send_string(c, "noop complete\n");
+	return 0;
+}
+
+// Handle client_stats command: one line of queue and scheduling figures per client
+int client_stats_func(Client *c, int argc, char **argv)
+{
+	struct timespec now;
+	Client *other;
+
+	if (c->state != ACTIVE)
+		return 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	for (other = clients_getfirst(); other != NULL; other = clients_getnext(other)) {
+		long wait = other->wait_usec;
+		arena_usage usage;
+		char peer[96] = "";
+
+		// A queued client's current wait is more telling than its last one
+		if (other->runnable)
+			wait = (now.tv_sec - other->queued_at.tv_sec) * 1000000L +
+			       (now.tv_nsec - other->queued_at.tv_nsec) / 1000;
+
+		arena_get_usage(other->arena, &usage);
+
+		// Peer credentials are only known for Unix domain clients
+		if (other->peer_uid != (uid_t)-1)
+			snprintf(peer, sizeof(peer), " pid %ld uid %lu gid %lu",
+				 (long)other->peer_pid, (unsigned long)other->peer_uid,
+				 (unsigned long)other->peer_gid);
+
+		client_printf(c,
+			      "client %d name {%s} queue %zu outq %zu wait %ld max_wait %ld "
+			      "deferred %lu commands %lu replies_suppressed %lu arena_used %zu "
+			      "arena_size %zu%s\n",
+			      other->sock, (other->name != NULL) ? other->name : "",
+			      other->inbuf_len - other->inbuf_pos, other->outq_len, wait,
+			      other->wait_max_usec, other->deferred, other->commands,
+			      other->replies_suppressed, usage.used, usage.reserved, peer);
+	}
+
+	client_send_string(c, "client_stats complete\n");
+
 	return 0;
 }
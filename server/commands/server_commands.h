@@ -10,6 +10,7 @@
  * - **output_func()**: Hardware output port control for compatible displays
  * - **noop_func()**: No-operation commands for connectivity testing
  * - **info_func()**: Server information and capability reporting
+ * - **client_stats_func()**: Per-client queue, scheduling and memory statistics
  * - Server status and capability reporting functionality
  * - Hardware output port management and control
  * - Connection testing and keep-alive functionality
@@ -85,4 +86,27 @@ int noop_func(Client *c, int argc, char **argv);
  */
 int info_func(Client *c, int argc, char **argv);
 
+/**
+ * \brief Handle client_stats command to report per-client load.
+ * \param c Client connection context
+ * \param argc Number of command arguments
+ * \param argv Array of command argument strings
+ * \retval 0 Success
+ * \retval 1 Client not active
+ *
+ * \details Sends one line per connected client:
+ * "client <sock> name {<name>} queue <bytes> outq <bytes> wait <us>
+ * max_wait <us> deferred <turns> commands <count> replies_suppressed <count>
+ * arena_used <bytes> arena_size <bytes>", followed by "client_stats complete".
+ * Lines of Unix domain clients end with " pid <pid> uid <uid> gid <gid>" of
+ * the peer process.
+ * queue is unparsed input, outq unsent output, wait the time the client's last
+ * (or current) turn waited in the command scheduler's run queue. A client that
+ * keeps a large queue and a high deferred count is sending faster than its
+ * fair share. replies_suppressed counts the replies its ack mode dropped.
+ * arena_used counts the live screens, widgets and strings of the
+ * client, arena_size the memory reserved for them.
+ */
+int client_stats_func(Client *c, int argc, char **argv);
+
 #endif
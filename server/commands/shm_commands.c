@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/commands/shm_commands.c
+ * \brief Shared-memory value channel command handlers for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Region attach using the descriptor received with the command
+ * - Widget to slot binding with range checks against the attached region
+ *
+ * \usage
+ * - Functions are called by the command parser when clients send commands
+ *
+ * \details
+ * The commands in this file only set up the channel; the values themselves
+ * never pass through the protocol. See server/shmvalues.c for the reading
+ * side.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shared/report.h"
+
+#include "../client.h"
+#include "../screen.h"
+#include "../shmvalues.h"
+#include "../widget.h"
+#include "shm_commands.h"
+
+// Handle shm_attach command: map the memfd received with the command
+int shm_attach_func(Client *c, int argc, char **argv)
+{
+	int fd;
+
+	if (c->state != ACTIVE)
+		return 1;
+
+	if (c->shm_fd < 0) {
+		client_send_error(c, "No descriptor received, shm_attach needs the Unix socket\n");
+		return 0;
+	}
+
+	fd = c->shm_fd;
+	c->shm_fd = -1;
+
+	if (shm_values_attach(c, fd) < 0) {
+		client_send_error(c, "Invalid value region\n");
+		return 0;
+	}
+
+	client_send_success(c);
+
+	return 0;
+}
+
+// Handle shm_bind command: take a widget's value from a region slot
+int shm_bind_func(Client *c, int argc, char **argv)
+{
+	Screen *s;
+	Widget *w;
+	long slot;
+	char *end;
+
+	if (c->state != ACTIVE)
+		return 1;
+
+	s = client_find_screen(c, argv[1]);
+	if (s == NULL) {
+		client_send_error(c, "Unknown screen id\n");
+		return 0;
+	}
+
+	w = screen_find_widget(s, argv[2]);
+	if (w == NULL) {
+		client_send_error(c, "Unknown widget id\n");
+		return 0;
+	}
+
+	if (strcmp(argv[3], "none") == 0) {
+		w->shm_slot = -1;
+		client_send_success(c);
+		return 0;
+	}
+
+	if (c->shm_base == NULL) {
+		client_send_error(c, "No value region attached\n");
+		return 0;
+	}
+
+	slot = strtol(argv[3], &end, 10);
+	if (!isdigit((unsigned char)argv[3][0]) || (*end != '\0') || (slot >= c->shm_slots)) {
+		client_printf_error(c, "Slot must be 0-%u or none\n", c->shm_slots - 1);
+		return 0;
+	}
+
+	w->shm_slot = (int)slot;
+	w->shm_seq = 0;
+
+	client_send_success(c);
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/commands/shm_commands.h
+ * \brief Shared-memory value channel command declarations for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - **shm_attach_func()**: Map a memfd passed over the Unix socket
+ * - **shm_bind_func()**: Bind a widget to a value slot of that region
+ *
+ * \usage
+ * - Functions are called by the command parser for client requests
+ * - Only Unix domain clients can pass the descriptor shm_attach needs
+ *
+ * \details
+ * Setup commands for the shared-memory widget value channel. Once a widget
+ * is bound, its value is taken from the client's region every time the
+ * screen is rendered and widget_set is no longer needed for it. The region
+ * layout is described in shared/shmvalues.h.
+ */
+
+#ifndef COMMANDS_SHM_H
+#define COMMANDS_SHM_H
+
+#include "client.h"
+
+/**
+ * \brief Handle shm_attach command to map the client's value region
+ * \param c Client connection context
+ * \param argc Number of command arguments
+ * \param argv Array of command argument strings
+ * \retval 0 Success
+ * \retval 1 Client has not sent hello yet
+ *
+ * \details Usage: shm_attach
+ *
+ * Uses the memfd the client attached (SCM_RIGHTS) to the bytes of this
+ * command. A second shm_attach replaces the region; existing bindings then
+ * refer to the new one.
+ */
+int shm_attach_func(Client *c, int argc, char **argv);
+
+/**
+ * \brief Handle shm_bind command to feed a widget from a value slot
+ * \param c Client connection context
+ * \param argc Number of command arguments
+ * \param argv Array of command argument strings
+ * \retval 0 Success
+ * \retval 1 Client has not sent hello yet
+ *
+ * \details Usage: shm_bind <screenid> <widgetid> {<slot>|none}
+ *
+ * The slot must exist in the attached region. "none" removes the binding;
+ * the widget keeps the value it shows and can be set with widget_set again.
+ */
+int shm_bind_func(Client *c, int argc, char **argv);
+
+#endif
@@ -21,6 +21,7 @@
  * - String widgets with dynamic text content and positioning
  * - Error handling and detailed parameter validation for all widget types
  * - Memory management for widget text content, labels, and dynamic data
+ * - widget_set only marks the screen changed when a value actually differs
  *
  * \usage
  * - Used by the LCDd server protocol parser for widget command dispatch
@@ -64,6 +65,20 @@
  */
 static int not_direction(char c) { return c != 'h' && c != 'v'; }
 
+/**
+ * \brief Store a numeric widget property
+ * \param field Property to set
+ * \param value New value
+ * \param changed Set to 1 if value differs from the current one
+ */
+static void set_property(int *field, int value, int *changed)
+{
+	if (*field != value) {
+		*field = value;
+		*changed = 1;
+	}
+}
+
 // Add a widget to a screen
 int widget_add_func(Client *c, int argc, char **argv)
 {
@@ -77,24 +92,24 @@ int widget_add_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if ((argc < 4) || (argc > 6)) {
-		sock_send_error(
-		    c->sock, "Usage: widget_add <screenid> <widgetid> <widgettype> [-in <id>]\\n");
-		return 0;
-	}
-
 	sid = argv[1];
 	wid = argv[2];
 
 	s = client_find_screen(c, sid);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
 	wtype = widget_typename_to_type(argv[3]);
 	if (wtype == WID_NONE) {
-		sock_send_error(c->sock, "Invalid widget type\\n");
+		client_send_error(c, "Invalid widget type\n");
+		return 0;
+	}
+
+	// Ids are unique per screen including all of its frames
+	if (screen_find_widget(s, wid) != NULL) {
+		client_send_error(c, "Widget already exists\n");
 		return 0;
 	}
 
@@ -110,14 +125,14 @@ int widget_add_func(Client *c, int argc, char **argv)
 			Widget *frame;
 
 			if (argc < 6) {
-				sock_send_error(c->sock, "Specify a frame to place widget in\\n");
+				client_send_error(c, "Specify a frame to place widget in\n");
 				return 0;
 			}
 
 			// Replace target screen with frame's internal screen
 			frame = screen_find_widget(s, argv[5]);
 			if (frame == NULL) {
-				sock_send_error(c->sock, "Error finding frame\\n");
+				client_send_error(c, "Error finding frame\n");
 				return 0;
 			}
 			s = frame->frame_screen;
@@ -126,15 +141,17 @@ int widget_add_func(Client *c, int argc, char **argv)
 
 	w = widget_create(wid, wtype, s);
 	if (w == NULL) {
-		sock_send_error(c->sock, "Error adding widget\\n");
+		client_send_error(c, "Error adding widget\n");
 		return 0;
 	}
 
 	err = screen_add_widget(s, w);
-	if (err == 0)
-		sock_send_string(c->sock, "success\\n");
-	else
-		sock_send_error(c->sock, "Error adding widget\\n");
+	if (err == 0) {
+		client_send_success(c);
+	} else {
+		widget_destroy(w);
+		client_send_error(c, "Error adding widget\n");
+	}
 
 	return 0;
 }
@@ -151,11 +168,6 @@ int widget_del_func(Client *c, int argc, char **argv)
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc != 3) {
-		sock_send_error(c->sock, "Usage: widget_del <screenid> <widgetid>\\n");
-		return 0;
-	}
-
 	sid = argv[1];
 	wid = argv[2];
 
@@ -163,21 +175,22 @@ int widget_del_func(Client *c, int argc, char **argv)
 
 	s = client_find_screen(c, sid);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
 	w = screen_find_widget(s, wid);
 	if (w == NULL) {
-		sock_send_error(c->sock, "Unknown widget id\\n");
+		client_send_error(c, "Unknown widget id\n");
 		return 0;
 	}
 
-	err = screen_remove_widget(s, w);
+	// Widgets inside frames live in the frame's sub-screen
+	err = screen_remove_widget(w->screen, w);
 	if (err == 0)
-		sock_send_string(c->sock, "success\\n");
+		client_send_success(c);
 	else
-		sock_send_error(c->sock, "Error removing widget\\n");
+		client_send_error(c, "Error removing widget\n");
 
 	return 0;
 }
@@ -190,20 +203,15 @@ int widget_set_func(Client *c, int argc, char **argv)
 	char *sid;
 	Screen *s;
 	Widget *w;
+	int changed = 0;
 
 	if (c->state != ACTIVE)
 		return 1;
 
-	if (argc < 4) {
-		sock_send_error(
-		    c->sock, "Usage: widget_set <screenid> <widgetid> <widget-SPECIFIC-data>\\n");
-		return 0;
-	}
-
 	sid = argv[1];
 	s = client_find_screen(c, sid);
 	if (s == NULL) {
-		sock_send_error(c->sock, "Unknown screen id\\n");
+		client_send_error(c, "Unknown screen id\n");
 		return 0;
 	}
 
@@ -212,7 +220,7 @@ int widget_set_func(Client *c, int argc, char **argv)
 
 	// Debug output for troubleshooting widget lookup failures
 	if (w == NULL) {
-		sock_send_error(c->sock, "Unknown widget id\\n");
+		client_send_error(c, "Unknown widget id\n");
 		{
 			int j;
 
@@ -231,20 +239,19 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// String widgets: x, y coordinates and text content
 	case WID_STRING:
 		if (argc != i + 3) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
 		if ((!isdigit((unsigned int)argv[i][0])) ||
 		    (!isdigit((unsigned int)argv[i + 1][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
-		w->x = atoi(argv[i]);
-		w->y = atoi(argv[i + 1]);
-		free(w->text);
-		w->text = strdup(argv[i + 2]);
+		set_property(&w->x, atoi(argv[i]), &changed);
+		set_property(&w->y, atoi(argv[i + 1]), &changed);
+		changed |= (widget_set_string(w, &w->text, argv[i + 2]) > 0);
 		debug(RPT_DEBUG, "Widget %s set to %s", wid, w->text);
 
 		break;
@@ -253,80 +260,78 @@ int widget_set_func(Client *c, int argc, char **argv)
 	case WID_HBAR:
 	case WID_VBAR:
 		if (argc != i + 3) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
 		if ((!isdigit((unsigned int)argv[i][0])) ||
 		    (!isdigit((unsigned int)argv[i + 1][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
-		w->x = atoi(argv[i]);
-		w->y = atoi(argv[i + 1]);
-		w->length = atoi(argv[i + 2]);
+		set_property(&w->x, atoi(argv[i]), &changed);
+		set_property(&w->y, atoi(argv[i + 1]), &changed);
+		set_property(&w->length, atoi(argv[i + 2]), &changed);
 
 		debug(RPT_DEBUG, "Widget %s set to %i", wid, w->length);
 
 		break;
 
 	// Progress bar widgets: x, y, width, promille and optional labels
-	case WID_PBAR:
+	case WID_PBAR: {
+		char *begin, *end;
+
 		if (argc < i + 4 || argc > i + 6) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
 		if ((!isdigit((unsigned int)argv[i][0])) ||
 		    (!isdigit((unsigned int)argv[i + 1][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
-		free(w->begin_label);
-		free(w->end_label);
-		w->begin_label = NULL;
-		w->end_label = NULL;
-
-		w->x = atoi(argv[i]);
-		w->y = atoi(argv[i + 1]);
-		w->width = atoi(argv[i + 2]);
-		w->promille = atoi(argv[i + 3]);
+		set_property(&w->x, atoi(argv[i]), &changed);
+		set_property(&w->y, atoi(argv[i + 1]), &changed);
+		set_property(&w->width, atoi(argv[i + 2]), &changed);
+		set_property(&w->promille, atoi(argv[i + 3]), &changed);
 
-		if (argc >= i + 5)
-			w->begin_label = strdup(argv[i + 4]);
-		if (argc >= i + 6)
-			w->end_label = strdup(argv[i + 5]);
+		begin = (argc >= i + 5) ? argv[i + 4] : NULL;
+		end = (argc >= i + 6) ? argv[i + 5] : NULL;
+		changed |= (widget_set_string(w, &w->begin_label, begin) > 0);
+		changed |= (widget_set_string(w, &w->end_label, end) > 0);
 
 		debug(RPT_DEBUG, "Widget %s set to %i", wid, w->promille);
 
 		break;
+	}
 
 	// Icon widgets: x, y coordinates and icon name
 	case WID_ICON: {
 		int icon;
 
 		if (argc != i + 3) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
 		if ((!isdigit((unsigned int)argv[i][0])) ||
 		    (!isdigit((unsigned int)argv[i + 1][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
 		icon = widget_iconname_to_icon(argv[i + 2]);
 		if (icon == -1) {
-			sock_send_error(c->sock, "Invalid icon name\\n");
+			client_send_error(c, "Invalid icon name\n");
 			return 0;
 		}
 
-		w->x = atoi(argv[i]);
-		w->y = atoi(argv[i + 1]);
-		w->length = icon;
+		set_property(&w->x, atoi(argv[i]), &changed);
+		set_property(&w->y, atoi(argv[i + 1]), &changed);
+		set_property(&w->length, icon, &changed);
 
 		break;
 	}
@@ -334,13 +339,12 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// Title widgets: only text content, position is automatic
 	case WID_TITLE:
 		if (argc != i + 1) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
-		free(w->text);
-		w->text = strdup(argv[i]);
-		w->width = display_props->width;
+		changed |= (widget_set_string(w, &w->text, argv[i]) > 0);
+		set_property(&w->width, display_props->width, &changed);
 		debug(RPT_DEBUG, "Widget %s set to %s", wid, w->text);
 
 		break;
@@ -348,7 +352,7 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// Scroller widgets: bounds, direction, speed and text content
 	case WID_SCROLLER:
 		if (argc != i + 7) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
@@ -356,24 +360,23 @@ int widget_set_func(Client *c, int argc, char **argv)
 		    (!isdigit((unsigned int)argv[i + 1][0])) ||
 		    (!isdigit((unsigned int)argv[i + 2][0])) ||
 		    (!isdigit((unsigned int)argv[i + 3][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
 		// Direction must be 'm' (marquee), 'v' (vertical) or 'h' (horizontal)
 		if (not_direction(argv[i + 4][0]) && argv[i + 4][0] != 'm') {
-			sock_send_error(c->sock, "Invalid direction\\n");
+			client_send_error(c, "Invalid direction\n");
 			return 0;
 		}
 
-		w->left = atoi(argv[i]);
-		w->top = atoi(argv[i + 1]);
-		w->right = atoi(argv[i + 2]);
-		w->bottom = atoi(argv[i + 3]);
-		w->length = (unsigned char)argv[i + 4][0];
-		w->speed = atoi(argv[i + 5]);
-		free(w->text);
-		w->text = strdup(argv[i + 6]);
+		set_property(&w->left, atoi(argv[i]), &changed);
+		set_property(&w->top, atoi(argv[i + 1]), &changed);
+		set_property(&w->right, atoi(argv[i + 2]), &changed);
+		set_property(&w->bottom, atoi(argv[i + 3]), &changed);
+		set_property(&w->length, (unsigned char)argv[i + 4][0], &changed);
+		set_property(&w->speed, atoi(argv[i + 5]), &changed);
+		changed |= (widget_set_string(w, &w->text, argv[i + 6]) > 0);
 
 		debug(RPT_DEBUG, "Widget %s set to %s", wid, w->text);
 
@@ -382,7 +385,7 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// Frame widgets: bounds, dimensions, direction and speed
 	case WID_FRAME:
 		if (argc != i + 8) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
@@ -392,24 +395,24 @@ int widget_set_func(Client *c, int argc, char **argv)
 		    (!isdigit((unsigned int)argv[i + 3][0])) ||
 		    (!isdigit((unsigned int)argv[i + 4][0])) ||
 		    (!isdigit((unsigned int)argv[i + 5][0]))) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
 		// Direction must be 'v' (vertical) or 'h' (horizontal)
 		if (not_direction(argv[i + 6][0])) {
-			sock_send_error(c->sock, "Invalid direction\\n");
+			client_send_error(c, "Invalid direction\n");
 			return 0;
 		}
 
-		w->left = atoi(argv[i]);
-		w->top = atoi(argv[i + 1]);
-		w->right = atoi(argv[i + 2]);
-		w->bottom = atoi(argv[i + 3]);
-		w->width = atoi(argv[i + 4]);
-		w->height = atoi(argv[i + 5]);
-		w->length = (unsigned char)argv[i + 6][0];
-		w->speed = atoi(argv[i + 7]);
+		set_property(&w->left, atoi(argv[i]), &changed);
+		set_property(&w->top, atoi(argv[i + 1]), &changed);
+		set_property(&w->right, atoi(argv[i + 2]), &changed);
+		set_property(&w->bottom, atoi(argv[i + 3]), &changed);
+		set_property(&w->width, atoi(argv[i + 4]), &changed);
+		set_property(&w->height, atoi(argv[i + 5]), &changed);
+		set_property(&w->length, (unsigned char)argv[i + 6][0], &changed);
+		set_property(&w->speed, atoi(argv[i + 7]), &changed);
 
 		debug(RPT_DEBUG, "Widget %s set to (%i,%i)-(%i,%i) %ix%i", wid, w->left, w->top,
 		      w->right, w->bottom, w->width, w->height);
@@ -419,22 +422,22 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// Numeric widgets: x coordinate and number value
 	case WID_NUM:
 		if (argc != i + 2) {
-			sock_send_error(c->sock, "Wrong number of arguments\\n");
+			client_send_error(c, "Wrong number of arguments\n");
 			return 0;
 		}
 
 		if (!isdigit((unsigned int)argv[i][0])) {
-			sock_send_error(c->sock, "Invalid coordinates\\n");
+			client_send_error(c, "Invalid coordinates\n");
 			return 0;
 		}
 
 		if (!isdigit((unsigned int)argv[i + 1][0])) {
-			sock_send_error(c->sock, "Invalid number\\n");
+			client_send_error(c, "Invalid number\n");
 			return 0;
 		}
 
-		w->x = atoi(argv[i]);
-		w->y = atoi(argv[i + 1]);
+		set_property(&w->x, atoi(argv[i]), &changed);
+		set_property(&w->y, atoi(argv[i + 1]), &changed);
 
 		debug(RPT_DEBUG, "Widget %s set to %i", wid, w->y);
 
@@ -443,11 +446,13 @@ int widget_set_func(Client *c, int argc, char **argv)
 	// Reject invalid or uninitialized widget types
 	case WID_NONE:
 	default:
-		sock_send_error(c->sock, "Widget has no type\\n");
+		client_send_error(c, "Widget has no type\n");
 		return 0;
 	}
 
-	sock_send_string(c->sock, "success\\n");
+	if (changed)
+		screen_touch(s);
+	client_send_success(c);
 
 	return 0;
 }
@@ -19,6 +19,7 @@
  * - Automatic fallback to alternative functions when driver lacks implementation
  * - Debug logging for all driver operations and state changes
  * - Memory management for driver resources and cleanup
+ * - Recording of frame output for the render thread, driver lock for other calls
  * - Global driver state management with output_driver identification
  *
  * \usage
@@ -40,6 +41,7 @@
 #endif
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -60,6 +62,7 @@
 
 #include "driver.h"
 #include "drivers.h"
+#include "renderthread.h"
 #include "widget.h"
 
 // Global driver management state: primary output driver, list of all loaded drivers, and shared
@@ -68,6 +71,9 @@ Driver *output_driver = NULL;
 LinkedList *loaded_drivers = NULL;
 DisplayProps *display_props = NULL;
 
+/** \brief Serializes driver calls of the main loop and the render thread */
+static pthread_mutex_t drivers_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /** \brief Iterator macro for looping through all loaded drivers
  * \param drv Driver pointer variable to use in loop
  *
@@ -160,15 +166,25 @@ const char *drivers_get_info(void)
 {
 	Driver *drv;
 
+	const char *info = "";
+
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	// Taken when the render thread started, it may be busy with a USB write
+	if (renderthread_recording())
+		return renderthread_get_info();
+
+	drivers_lock();
 	ForAllDrivers(drv)
 	{
 		if (drv->get_info) {
-			return drv->get_info(drv);
+			info = drv->get_info(drv);
+			break;
 		}
 	}
-	return "";
+	drivers_unlock();
+
+	return info;
 }
 
 // Clear screen on all loaded drivers
@@ -178,6 +194,11 @@ void drivers_clear(void)
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_CLEAR, 0, 0, 0, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->clear)
@@ -192,6 +213,12 @@ void drivers_flush(void)
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	// The render thread sends the frame
+	if (renderthread_recording()) {
+		renderthread_publish();
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->flush)
@@ -206,6 +233,11 @@ void drivers_string(int x, int y, const char *string)
 
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, string=\"%.40s\")", __FUNCTION__, x, y, string);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_STRING, x, y, 0, 0, 0, string, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->string)
@@ -220,6 +252,11 @@ void drivers_chr(int x, int y, char c)
 
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, c='%c')", __FUNCTION__, x, y, c);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_CHR, x, y, (unsigned char)c, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->chr)
@@ -235,6 +272,11 @@ void drivers_vbar(int x, int y, int len, int promille, int pattern)
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, len=%d, promille=%d, pattern=%d)", __FUNCTION__, x, y, len,
 	      promille, pattern);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_VBAR, x, y, len, promille, pattern, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->vbar)
@@ -252,6 +294,11 @@ void drivers_hbar(int x, int y, int len, int promille, int pattern)
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, len=%d, promille=%d, pattern=%d)", __FUNCTION__, x, y, len,
 	      promille, pattern);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_HBAR, x, y, len, promille, pattern, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->hbar)
@@ -266,6 +313,11 @@ void drivers_pbar(int x, int y, int width, int promille, char *begin_label, char
 {
 	Driver *drv;
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_PBAR, x, y, width, promille, 0, begin_label, end_label);
+		return;
+	}
+
 	ForAllDrivers(drv) driver_pbar(drv, x, y, width, promille, begin_label, end_label);
 }
 
@@ -276,6 +328,11 @@ void drivers_num(int x, int num)
 
 	debug(RPT_DEBUG, "%s(x=%d, num=%d)", __FUNCTION__, x, num);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_NUM, x, 0, num, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->num)
@@ -292,6 +349,11 @@ void drivers_heartbeat(int state)
 
 	debug(RPT_DEBUG, "%s(state=%d)", __FUNCTION__, state);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_HEARTBEAT, 0, 0, state, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->heartbeat)
@@ -309,6 +371,11 @@ void drivers_icon(int x, int y, int icon)
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, icon=ICON_%s)", __FUNCTION__, x, y,
 	      widget_icon_to_iconname(icon));
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_ICON, x, y, icon, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->icon) {
@@ -328,6 +395,11 @@ void drivers_cursor(int x, int y, int state)
 
 	debug(RPT_DEBUG, "%s(x=%d, y=%d, state=%d)", __FUNCTION__, x, y, state);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_CURSOR, x, y, state, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->cursor)
@@ -344,6 +416,11 @@ void drivers_backlight(int state)
 
 	debug(RPT_DEBUG, "%s(state=%d)", __FUNCTION__, state);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_BACKLIGHT, 0, 0, state, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->backlight)
@@ -359,6 +436,11 @@ int drivers_set_macro_leds(int m1, int m2, int m3, int mr)
 
 	debug(RPT_DEBUG, "%s(m1=%d, m2=%d, m3=%d, mr=%d)", __FUNCTION__, m1, m2, m3, mr);
 
+	// Queued for the render thread, it may be busy with a USB write
+	if (renderthread_recording())
+		return renderthread_set_macro_leds(m1, m2, m3, mr);
+
+	drivers_lock();
 	ForAllDrivers(drv)
 	{
 		if (drv->set_macro_leds) {
@@ -368,6 +450,7 @@ int drivers_set_macro_leds(int m1, int m2, int m3, int mr)
 			}
 		}
 	}
+	drivers_unlock();
 
 	return result;
 }
@@ -379,6 +462,11 @@ void drivers_output(int state)
 
 	debug(RPT_DEBUG, "%s(state=%d)", __FUNCTION__, state);
 
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_OUTPUT, 0, 0, state, 0, 0, NULL, NULL);
+		return;
+	}
+
 	ForAllDrivers(drv)
 	{
 		if (drv->output)
@@ -394,6 +482,10 @@ const char *drivers_get_key(void)
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	// The render thread polls the drivers and queues the keys
+	if (renderthread_recording())
+		return renderthread_get_key();
+
 	ForAllDrivers(drv)
 	{
 		if (drv->get_key) {
@@ -408,6 +500,44 @@ const char *drivers_get_key(void)
 	return NULL;
 }
 
+// Check whether any loaded driver provides key input
+int drivers_have_input(void)
+{
+	Driver *drv;
+	int have_input = 0;
+
+	drivers_lock();
+	ForAllDrivers(drv)
+	{
+		if (drv->get_key) {
+			have_input = 1;
+			break;
+		}
+	}
+	drivers_unlock();
+
+	return have_input;
+}
+
+// Check whether any loaded driver has macro LEDs
+int drivers_have_macro_leds(void)
+{
+	Driver *drv;
+	int have_leds = 0;
+
+	drivers_lock();
+	ForAllDrivers(drv)
+	{
+		if (drv->set_macro_leds) {
+			have_leds = 1;
+			break;
+		}
+	}
+	drivers_unlock();
+
+	return have_leds;
+}
+
 // Set custom character definition on all drivers
 void drivers_set_char(char ch, unsigned char *dat)
 {
@@ -415,11 +545,13 @@ void drivers_set_char(char ch, unsigned char *dat)
 
 	debug(RPT_DEBUG, "%s(ch='%c', dat=%p)", __FUNCTION__, ch, dat);
 
+	drivers_lock();
 	ForAllDrivers(drv)
 	{
 		if (drv->set_char)
 			drv->set_char(drv, ch, dat);
 	}
+	drivers_unlock();
 }
 
 // Get contrast from output driver
@@ -427,18 +559,23 @@ int drivers_get_contrast(void)
 {
 	Driver *drv;
 
+	int contrast = -1;
+
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	drivers_lock();
 	ForAllDrivers(drv)
 	{
 		if (drv->get_contrast) {
-			int contrast = drv->get_contrast(drv);
+			contrast = drv->get_contrast(drv);
 			debug(RPT_DEBUG, "%s: Driver [%.40s] returned contrast %d", __FUNCTION__,
 			      drv->name, contrast);
-			return contrast;
+			break;
 		}
 	}
-	return -1;
+	drivers_unlock();
+
+	return contrast;
 }
 
 // Set contrast on all drivers
@@ -448,9 +585,17 @@ void drivers_set_contrast(int contrast)
 
 	debug(RPT_DEBUG, "%s(contrast=%d)", __FUNCTION__, contrast);
 
+	drivers_lock();
 	ForAllDrivers(drv)
 	{
 		if (drv->set_contrast)
 			drv->set_contrast(drv, contrast);
 	}
+	drivers_unlock();
 }
+
+// Take the driver lock
+void drivers_lock(void) { pthread_mutex_lock(&drivers_mutex); }
+
+// Release the driver lock
+void drivers_unlock(void) { pthread_mutex_unlock(&drivers_mutex); }
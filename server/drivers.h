@@ -209,6 +209,37 @@ void drivers_output(int state);
  */
 const char *drivers_get_key(void);
 
+/**
+ * \brief Check whether any loaded driver can generate key input
+ * \retval 1 At least one driver implements get_key()
+ * \retval 0 No input driver loaded
+ *
+ * \details Driver input is polled, so the main loop only needs a periodic
+ * input wakeup when this returns 1.
+ */
+int drivers_have_input(void);
+
+/**
+ * \brief Check whether any loaded driver can set macro LEDs
+ * \retval 1 At least one driver implements set_macro_leds()
+ * \retval 0 No driver with macro LEDs loaded
+ */
+int drivers_have_macro_leds(void);
+
+/**
+ * \brief Take the driver lock
+ *
+ * \details Serializes driver calls of the main loop with the render thread.
+ * drivers_* functions that are not recorded into frames take it themselves;
+ * code calling a driver function directly must hold it. Not recursive.
+ */
+void drivers_lock(void);
+
+/**
+ * \brief Release the driver lock
+ */
+void drivers_unlock(void);
+
 /**
  * \brief Global output driver pointer
  * \details Points to the currently active output driver
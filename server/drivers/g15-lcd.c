@@ -0,0 +1,579 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/drivers/g15-lcd.c
+ * \brief G15 LCD frames in report layout and conversion of libg15render canvases
+ * \author Anthony J. Mirabella
+ * \author n0vedad
+ * \date 2006-2026
+ *
+ * \features
+ * - Rectangle fill and bitmap blit on frames in report layout
+ * - Glyph atlas entries loaded from a canvas and drawn as column masks
+ * - Import of libg15render canvas rows for the compatibility path
+ * - Bitwise reference conversion, one output bit at a time
+ * - SWAR kernel transposing 8x8 bit blocks in a 64-bit word
+ * - SSE2 and AVX2 kernels gathering a pixel column of 16 or 32 blocks per movemask
+ * - Runtime selection of the fastest kernel the CPU supports
+ *
+ * \usage
+ * - Linked into the g15 driver, see g15-lcd.h
+ *
+ * \details Every output byte is one column of an 8x8 bit block: bit k of
+ * output byte 8 * j + b is bit 7 - b of canvas byte j in row k of the strip.
+ * The kernels therefore transpose whole blocks instead of collecting single
+ * bits. The x86 kernels are compiled with target attributes, so the driver
+ * runs on any CPU of its architecture and only calls them after checking
+ * the CPU.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "shared/defines.h"
+
+#include "g15-lcd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define G15_LCD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * \brief Bitwise reference kernel
+ * \param lcd_data Destination for G15_LCD_DATA_LEN bytes of report pixel data
+ * \param data Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ *
+ * \details The former g15_pixmap_to_lcd() loop, kept as the reference the
+ * block kernels are tested against.
+ */
+static void g15_lcd_bitwise(unsigned char *lcd_data, const unsigned char *data)
+{
+	/**
+	 * \note For a set of bytes (A, B, C, etc.) the bits representing pixels will appear
+	 * on the LCD like this:
+	 *
+	 * A0 B0 C0
+	 * A1 B1 C1
+	 * A2 B2 C2
+	 * A3 B3 C3 ... and across for G15_LCD_STRIP_LEN bytes
+	 * A4 B4 C4
+	 * A5 B5 C5
+	 * A6 B6 C6
+	 * A7 B7 C7
+	 *
+	 * A0
+	 * A1  <- second 8-pixel-high row starts straight after the last byte on
+	 * A2     the previous row
+	 * A3
+	 * A4
+	 * A5
+	 * A6
+	 * A7
+	 * A8
+	 *
+	 * A0
+	 * ...
+	 * A0
+	 * ...
+	 * A0
+	 * ...
+	 * A0
+	 * A1 <- only the first three bits are shown on the bottom row (the last three
+	 * A2    pixels of the 43-pixel high display.)
+	 */
+
+	const unsigned int stride = G15_LCD_STRIDE;
+	unsigned int row, col;
+
+	// Process 6 rows of 8 pixels each (43 pixel height requires 6 bytes per column)
+	for (row = 0; row < G15_LCD_STRIPS; row++) {
+		for (col = 0; col < G15_LCD_STRIP_LEN; col++) {
+			unsigned int bit = col % 8;
+
+			// Extract 8 vertical pixels and pack into single byte
+			*lcd_data++ = (((data[stride * 0] << bit) & 0x80) >> 7) |
+				      (((data[stride * 1] << bit) & 0x80) >> 6) |
+				      (((data[stride * 2] << bit) & 0x80) >> 5) |
+				      (((data[stride * 3] << bit) & 0x80) >> 4) |
+				      (((data[stride * 4] << bit) & 0x80) >> 3) |
+				      (((data[stride * 5] << bit) & 0x80) >> 2) |
+				      (((data[stride * 6] << bit) & 0x80) >> 1) |
+				      (((data[stride * 7] << bit) & 0x80) >> 0);
+
+			// Advance to next byte in source data after processing 8 columns
+			if (bit == 7)
+				data++;
+		}
+		// Skip 7 rows in source (we already processed row 0 above)
+		data += 7 * stride;
+	}
+}
+
+/**
+ * \brief Transpose one 8x8 bit block in a 64-bit word
+ * \param rows First canvas byte of the block, the others follow at G15_LCD_STRIDE
+ * \param out Destination for the 8 report bytes of the block
+ *
+ * \details Row k goes into byte 7 - k. Flipping the word about its
+ * anti-diagonal then leaves report byte b in byte b, so no byte swap is
+ * needed and the result is stored least significant byte first.
+ */
+static inline void g15_lcd_swar_block(const unsigned char *rows, unsigned char *out)
+{
+	uint64_t x = 0, t;
+
+	for (int k = 0; k < 8; k++)
+		x |= (uint64_t)rows[k * G15_LCD_STRIDE] << (8 * (7 - k));
+
+	t = x ^ (x << 36);
+	x ^= 0xf0f0f0f00f0f0f0fULL & (t ^ (x >> 36));
+	t = 0xcccc0000cccc0000ULL & (x ^ (x << 18));
+	x ^= t ^ (t >> 18);
+	t = 0xaa00aa00aa00aa00ULL & (x ^ (x << 9));
+	x ^= t ^ (t >> 9);
+
+	for (int b = 0; b < 8; b++)
+		out[b] = (unsigned char)(x >> (8 * b));
+}
+
+/**
+ * \brief Portable SWAR kernel
+ * \param lcd_data Destination for G15_LCD_DATA_LEN bytes of report pixel data
+ * \param data Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ */
+static void g15_lcd_swar(unsigned char *lcd_data, const unsigned char *data)
+{
+	for (int strip = 0; strip < G15_LCD_STRIPS; strip++) {
+		const unsigned char *rows = data + strip * 8 * G15_LCD_STRIDE;
+		unsigned char *out = lcd_data + strip * G15_LCD_STRIP_LEN;
+
+		for (int j = 0; j < G15_LCD_STRIDE; j++)
+			g15_lcd_swar_block(rows + j, out + 8 * j);
+	}
+}
+
+#ifdef G15_LCD_X86
+
+/**
+ * \brief Gather the blocks of 16 canvas bytes per row into block order
+ * \param r Rows 0 to 7 of the strip, bytes 0 to 15
+ * \param c Result, c[i] holds blocks 2i and 2i+1 with row k in byte k of each half
+ *
+ * \details Three rounds of interleaving: bytes of row pairs, then 16-bit
+ * pairs of row quads, then 32-bit quads of both row halves.
+ */
+__attribute__((target("sse2"))) static inline void g15_lcd_sse2_gather(const __m128i r[8],
+									 __m128i c[8])
+{
+	__m128i a[8], b[8];
+
+	for (int i = 0; i < 4; i++) {
+		a[i] = _mm_unpacklo_epi8(r[2 * i], r[2 * i + 1]);
+		a[i + 4] = _mm_unpackhi_epi8(r[2 * i], r[2 * i + 1]);
+	}
+	for (int i = 0; i < 2; i++) {
+		b[2 * i] = _mm_unpacklo_epi16(a[4 * i], a[4 * i + 1]);
+		b[2 * i + 1] = _mm_unpackhi_epi16(a[4 * i], a[4 * i + 1]);
+		b[2 * i + 4] = _mm_unpacklo_epi16(a[4 * i + 2], a[4 * i + 3]);
+		b[2 * i + 5] = _mm_unpackhi_epi16(a[4 * i + 2], a[4 * i + 3]);
+	}
+	for (int i = 0; i < 4; i++) {
+		c[2 * i] = _mm_unpacklo_epi32(b[i], b[i + 4]);
+		c[2 * i + 1] = _mm_unpackhi_epi32(b[i], b[i + 4]);
+	}
+}
+
+/**
+ * \brief Turn the movemasks of two blocks into their 16 report bytes
+ * \param m Movemask of pixel column 0 to 7, low byte first block, high byte second block
+ * \return Report bytes of both blocks
+ */
+__attribute__((target("sse2"))) static inline __m128i g15_lcd_sse2_pack(const short m[8])
+{
+	__m128i v = _mm_set_epi16(m[7], m[6], m[5], m[4], m[3], m[2], m[1], m[0]);
+
+	return _mm_packus_epi16(_mm_and_si128(v, _mm_set1_epi16(0xff)), _mm_srli_epi16(v, 8));
+}
+
+/**
+ * \brief SSE2 kernel
+ * \param lcd_data Destination for G15_LCD_DATA_LEN bytes of report pixel data
+ * \param data Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ *
+ * \details Bytes 0 to 15 of each row are gathered so that one movemask
+ * collects a pixel column of two blocks; doubling every byte moves the next
+ * column into the sign bits. Bytes 16 to 19 go through the SWAR block.
+ */
+__attribute__((target("sse2"))) static void g15_lcd_sse2(unsigned char *lcd_data,
+							  const unsigned char *data)
+{
+	for (int strip = 0; strip < G15_LCD_STRIPS; strip++) {
+		const unsigned char *rows = data + strip * 8 * G15_LCD_STRIDE;
+		unsigned char *out = lcd_data + strip * G15_LCD_STRIP_LEN;
+		__m128i r[8], c[8];
+
+		for (int k = 0; k < 8; k++)
+			r[k] = _mm_loadu_si128((const __m128i *)(rows + k * G15_LCD_STRIDE));
+		g15_lcd_sse2_gather(r, c);
+
+		for (int i = 0; i < 8; i++) {
+			__m128i v = c[i];
+			short m[8];
+
+			for (int b = 0; b < 8; b++) {
+				m[b] = (short)_mm_movemask_epi8(v);
+				v = _mm_add_epi8(v, v);
+			}
+			_mm_storeu_si128((__m128i *)(out + 16 * i), g15_lcd_sse2_pack(m));
+		}
+
+		for (int j = 16; j < G15_LCD_STRIDE; j++)
+			g15_lcd_swar_block(rows + j, out + 8 * j);
+	}
+}
+
+/**
+ * \brief AVX2 kernel
+ * \param lcd_data Destination for G15_LCD_DATA_LEN bytes of report pixel data
+ * \param data Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ *
+ * \details The SSE2 scheme with two strips side by side, one per 128-bit
+ * lane, since the interleaving instructions work within lanes.
+ */
+__attribute__((target("avx2"))) static void g15_lcd_avx2(unsigned char *lcd_data,
+							  const unsigned char *data)
+{
+	for (int strip = 0; strip < G15_LCD_STRIPS; strip += 2) {
+		const unsigned char *rows = data + strip * 8 * G15_LCD_STRIDE;
+		unsigned char *out = lcd_data + strip * G15_LCD_STRIP_LEN;
+		__m256i r[8], a[8], b[8], c[8];
+
+		for (int k = 0; k < 8; k++) {
+			const unsigned char *lo = rows + k * G15_LCD_STRIDE;
+			const unsigned char *hi = lo + 8 * G15_LCD_STRIDE;
+
+			r[k] = _mm256_inserti128_si256(
+			    _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)lo)),
+			    _mm_loadu_si128((const __m128i *)hi), 1);
+		}
+
+		for (int i = 0; i < 4; i++) {
+			a[i] = _mm256_unpacklo_epi8(r[2 * i], r[2 * i + 1]);
+			a[i + 4] = _mm256_unpackhi_epi8(r[2 * i], r[2 * i + 1]);
+		}
+		for (int i = 0; i < 2; i++) {
+			b[2 * i] = _mm256_unpacklo_epi16(a[4 * i], a[4 * i + 1]);
+			b[2 * i + 1] = _mm256_unpackhi_epi16(a[4 * i], a[4 * i + 1]);
+			b[2 * i + 4] = _mm256_unpacklo_epi16(a[4 * i + 2], a[4 * i + 3]);
+			b[2 * i + 5] = _mm256_unpackhi_epi16(a[4 * i + 2], a[4 * i + 3]);
+		}
+		for (int i = 0; i < 4; i++) {
+			c[2 * i] = _mm256_unpacklo_epi32(b[i], b[i + 4]);
+			c[2 * i + 1] = _mm256_unpackhi_epi32(b[i], b[i + 4]);
+		}
+
+		for (int i = 0; i < 8; i++) {
+			__m256i v = c[i];
+			short lo[8], hi[8];
+
+			for (int bit = 0; bit < 8; bit++) {
+				unsigned int m = (unsigned int)_mm256_movemask_epi8(v);
+
+				lo[bit] = (short)m;
+				hi[bit] = (short)(m >> 16);
+				v = _mm256_add_epi8(v, v);
+			}
+			_mm_storeu_si128((__m128i *)(out + 16 * i), g15_lcd_sse2_pack(lo));
+			_mm_storeu_si128((__m128i *)(out + G15_LCD_STRIP_LEN + 16 * i),
+					 g15_lcd_sse2_pack(hi));
+		}
+
+		for (int j = 16; j < G15_LCD_STRIDE; j++) {
+			g15_lcd_swar_block(rows + j, out + 8 * j);
+			g15_lcd_swar_block(rows + 8 * G15_LCD_STRIDE + j,
+					   out + G15_LCD_STRIP_LEN + 8 * j);
+		}
+	}
+}
+
+// Check whether the CPU supports SSE2
+static int g15_lcd_have_sse2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+}
+
+// Check whether the CPU supports AVX2
+static int g15_lcd_have_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+const G15LcdKernel g15_lcd_kernels[] = {
+#ifdef G15_LCD_X86
+    {"avx2", g15_lcd_avx2, g15_lcd_have_avx2},
+    {"sse2", g15_lcd_sse2, g15_lcd_have_sse2},
+#endif
+    {"swar", g15_lcd_swar, NULL},
+    {"bitwise", g15_lcd_bitwise, NULL},
+    {NULL, NULL, NULL},
+};
+
+/** \brief Kernel used by g15_pixmap_to_lcd(), picked on first use */
+static const G15LcdKernel *g15_lcd_kernel = NULL;
+
+/**
+ * \brief Pick the first kernel the CPU supports
+ * \return Kernel
+ */
+static const G15LcdKernel *g15_lcd_select(void)
+{
+	const G15LcdKernel *k;
+
+	if (g15_lcd_kernel != NULL)
+		return g15_lcd_kernel;
+
+	for (k = g15_lcd_kernels; k->name != NULL; k++) {
+		if ((k->supported == NULL) || k->supported())
+			break;
+	}
+	g15_lcd_kernel = k;
+
+	return k;
+}
+
+// Convert libg15render canvas format to raw data for the USB output endpoint
+void g15_pixmap_to_lcd(unsigned char *lcd_buffer, const unsigned char *data)
+{
+	// Set output report ID and initialize buffer header
+	lcd_buffer[0] = G15_LCD_REPORT_ID;
+	memset(lcd_buffer + 1, 0, G15_LCD_REPORT_OFFSET - 1);
+
+	g15_lcd_select()->convert(lcd_buffer + G15_LCD_REPORT_OFFSET, data);
+}
+
+// Return the name of the kernel g15_pixmap_to_lcd() uses
+const char *g15_lcd_kernel_name(void) { return g15_lcd_select()->name; }
+
+/**
+ * \brief Bits of a strip that lie within a range of rows
+ * \param strip Strip index
+ * \param y1 First row, at most y2
+ * \param y2 Last row
+ * \return Mask with bit k set for row 8 * strip + k
+ */
+static unsigned char g15_lcd_strip_mask(int strip, int y1, int y2)
+{
+	int top = max(y1 - 8 * strip, 0);
+	int bottom = min(y2 - 8 * strip, 7);
+
+	return (unsigned char)((0xff << top) & (0xff >> (7 - bottom)));
+}
+
+/**
+ * \brief Record a write to a range of strips
+ * \param f Frame
+ * \param first First strip written
+ * \param last Last strip written, at least first
+ */
+static inline void g15_lcd_touch(G15LcdFrame *f, int first, int last)
+{
+	f->dirty |= (unsigned char)((2u << last) - (1u << first));
+	f->generation++;
+}
+
+// Set up the report header and clear a frame
+void g15_lcd_frame_init(G15LcdFrame *f)
+{
+	memset(f->report, 0, sizeof(f->report));
+	f->report[0] = G15_LCD_REPORT_ID;
+	f->generation = 0;
+	f->dirty = G15_LCD_ALL_STRIPS;
+}
+
+// Forget which strips were written
+void g15_lcd_frame_clean(G15LcdFrame *f) { f->dirty = 0; }
+
+// Set every pixel of a frame
+void g15_lcd_clear(G15LcdFrame *f, int color)
+{
+	memset(G15_LCD_FRAME_DATA(f), color ? 0xff : 0x00, G15_LCD_DATA_LEN);
+	g15_lcd_touch(f, 0, G15_LCD_STRIPS - 1);
+}
+
+// Set every pixel of a rectangle
+void g15_lcd_fill(G15LcdFrame *f, int x1, int y1, int x2, int y2, int color)
+{
+	unsigned char *data = G15_LCD_FRAME_DATA(f);
+	int xa = max(min(x1, x2), 0);
+	int xb = min(max(x1, x2), G15_LCD_COLUMNS - 1);
+	int ya = max(min(y1, y2), 0);
+	int yb = min(max(y1, y2), G15_LCD_ROWS - 1);
+
+	if ((xa > xb) || (ya > yb))
+		return;
+
+	g15_lcd_touch(f, ya / 8, yb / 8);
+	for (int strip = ya / 8; strip <= yb / 8; strip++) {
+		unsigned char *out = data + strip * G15_LCD_STRIP_LEN;
+		unsigned char mask = g15_lcd_strip_mask(strip, ya, yb);
+
+		if (mask == 0xff) {
+			memset(out + xa, color ? 0xff : 0x00, xb - xa + 1);
+		} else if (color) {
+			for (int x = xa; x <= xb; x++)
+				out[x] |= mask;
+		} else {
+			for (int x = xa; x <= xb; x++)
+				out[x] &= (unsigned char)~mask;
+		}
+	}
+}
+
+// Draw a 1 bpp bitmap
+void g15_lcd_blit(G15LcdFrame *f, int x, int y, int width, int height, const unsigned char *bits,
+		  int stride, int color, int paint_bg)
+{
+	unsigned char *data = G15_LCD_FRAME_DATA(f);
+	int first = max(-x, 0);
+	int last = min(width, G15_LCD_COLUMNS - x) - 1;
+	int top = max(-y, 0);
+	int bottom = min(height, G15_LCD_ROWS - y) - 1;
+
+	if ((first > last) || (top > bottom))
+		return;
+
+	g15_lcd_touch(f, (y + top) / 8, (y + bottom) / 8);
+	for (int r = top; r <= bottom; r++) {
+		const unsigned char *row = bits + r * stride;
+		unsigned char *out = data + ((y + r) / 8) * G15_LCD_STRIP_LEN;
+		unsigned char bit = (unsigned char)(1 << ((y + r) % 8));
+
+		for (int c = first; c <= last; c++) {
+			int ink = (row[c / 8] >> (7 - c % 8)) & 1;
+
+			if (!ink && !paint_bg)
+				continue;
+			if (ink ? color : !color)
+				out[x + c] |= bit;
+			else
+				out[x + c] &= (unsigned char)~bit;
+		}
+	}
+}
+
+// Overwrite full-height columns with bitmap data in report layout
+void g15_lcd_put_columns(G15LcdFrame *f, int x, int width, const unsigned char *columns,
+			 int stride)
+{
+	unsigned char *data = G15_LCD_FRAME_DATA(f);
+	unsigned char keep = (unsigned char)~g15_lcd_strip_mask(G15_LCD_STRIPS - 1, 0,
+								 G15_LCD_ROWS - 1);
+	int first = max(-x, 0);
+	int last = min(width, G15_LCD_COLUMNS - x);
+
+	if (first >= last)
+		return;
+
+	g15_lcd_touch(f, 0, G15_LCD_STRIPS - 1);
+	for (int strip = 0; strip < G15_LCD_STRIPS - 1; strip++)
+		memcpy(data + strip * G15_LCD_STRIP_LEN + x + first,
+		       columns + strip * stride + first, last - first);
+
+	// The last strip also holds the padding rows below the LCD
+	unsigned char *out = data + (G15_LCD_STRIPS - 1) * G15_LCD_STRIP_LEN;
+	const unsigned char *in = columns + (G15_LCD_STRIPS - 1) * stride;
+
+	for (int c = first; c < last; c++)
+		out[x + c] = (out[x + c] & keep) | (in[c] & (unsigned char)~keep);
+}
+
+// Load a glyph into the atlas
+int g15_lcd_glyph_load(G15LcdGlyph *g, const unsigned char *pixmap)
+{
+	memset(g, 0, sizeof(*g));
+
+	for (int y = 0; y < G15_LCD_ROWS; y++) {
+		for (int x = 0; x < G15_LCD_COLUMNS; x++) {
+			int c = x - G15_LCD_GLYPH_ORIGIN_X;
+			int r = y - G15_LCD_GLYPH_ORIGIN_Y;
+
+			if (!(pixmap[y * G15_LCD_STRIDE + x / 8] & (0x80 >> (x % 8))))
+				continue;
+			if ((c < 0) || (c >= G15_LCD_GLYPH_COLUMNS) || (r < 0) ||
+			    (r >= G15_LCD_GLYPH_ROWS))
+				return -1;
+
+			g->ink[c] |= (uint32_t)1 << r;
+			g->width = (unsigned char)max(g->width, c + 1);
+		}
+	}
+	g->valid = 1;
+
+	return 0;
+}
+
+// Draw a glyph from the atlas
+void g15_lcd_glyph_draw(G15LcdFrame *f, const G15LcdGlyph *g, int x, int y, int color)
+{
+	int first = max(-x, 0);
+	int last = min(g->width, G15_LCD_COLUMNS - x) - 1;
+
+	// Rows above the frame are shifted out, rows below it are masked off
+	int strip = (y < 0) ? 0 : y / 8;
+	int shift = (y < 0) ? 0 : y % 8;
+	int drop = (y < 0) ? min(-y, G15_LCD_GLYPH_ROWS) : 0;
+	int rows = G15_LCD_ROWS - 8 * strip;
+	uint32_t clip = (rows >= 32) ? 0xffffffffu : (((uint32_t)1 << rows) - 1);
+	unsigned char *base = G15_LCD_FRAME_DATA(f) + strip * G15_LCD_STRIP_LEN;
+
+	if ((first > last) || (strip >= G15_LCD_STRIPS))
+		return;
+
+	// A column of up to 24 rows shifted by up to 7 spans at most 4 strips
+	g15_lcd_touch(f, strip, min(strip + 3, G15_LCD_STRIPS - 1));
+	for (int c = first; c <= last; c++) {
+		uint32_t column = ((g->ink[c] >> drop) << shift) & clip;
+		unsigned char *out = base + x + c;
+
+		for (; column != 0; out += G15_LCD_STRIP_LEN, column >>= 8) {
+			if (color)
+				*out |= (unsigned char)column;
+			else
+				*out &= (unsigned char)~column;
+		}
+	}
+}
+
+// Copy the ink of libg15render canvas rows into a frame
+void g15_lcd_import(G15LcdFrame *f, const unsigned char *pixmap, int y1, int y2, int color)
+{
+	unsigned char ink[G15_LCD_DATA_LEN];
+	unsigned char *data = G15_LCD_FRAME_DATA(f);
+
+	y1 = max(y1, 0);
+	y2 = min(y2, G15_LCD_ROWS - 1);
+	if (y1 > y2)
+		return;
+
+	// A whole canvas goes through the kernel faster than the rows bit by bit
+	g15_lcd_select()->convert(ink, pixmap);
+	g15_lcd_touch(f, y1 / 8, y2 / 8);
+
+	for (int strip = y1 / 8; strip <= y2 / 8; strip++) {
+		unsigned char mask = g15_lcd_strip_mask(strip, y1, y2);
+		unsigned char *out = data + strip * G15_LCD_STRIP_LEN;
+		const unsigned char *in = ink + strip * G15_LCD_STRIP_LEN;
+
+		for (int x = 0; x < G15_LCD_STRIP_LEN; x++) {
+			if (color)
+				out[x] |= in[x] & mask;
+			else
+				out[x] &= (unsigned char)~(in[x] & mask);
+		}
+	}
+}
@@ -0,0 +1,249 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/drivers/g15-lcd.h
+ * \brief G15 LCD frames in report layout and conversion of libg15render canvases
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Frame stored as the output report itself, ready to be sent as is
+ * - Rectangle fill and bitmap blit writing the 8-pixel strips directly
+ * - Full-height bitmaps stored in report layout copied column byte by column byte
+ * - Glyph atlas: glyphs rasterized once, drawn as masked column bytes
+ * - Import of ink drawn by libg15render for operations not done natively
+ * - Turns the row-major canvas into the column-major 8-pixel strips of the LCD
+ * - Conversion kernels working on 8x8 bit blocks: AVX2, SSE2 and portable SWAR
+ * - Fastest kernel supported by the CPU picked once at runtime
+ * - Write generation and per-strip dirty mask kept by every drawing call
+ * - Bitwise reference kernel every other kernel must match
+ *
+ * \usage
+ * - Set up a G15LcdFrame with g15_lcd_frame_init() and draw with g15_lcd_*()
+ * - Load each glyph once with g15_lcd_glyph_load(), draw it with g15_lcd_glyph_draw()
+ * - Send G15LcdFrame.report, G15_LCD_REPORT_LEN bytes, to the LCD
+ * - Call g15_pixmap_to_lcd() to convert a whole canvas instead
+ * - Tests and benchmarks may call the kernels in g15_lcd_kernels directly
+ *
+ * \details Independent of libg15 and libg15render so it can be tested without
+ * them. The canvas is 160 pixels wide with one bit per pixel, leftmost pixel
+ * in the most significant bit. The LCD wants one byte per column and 8-pixel
+ * strip with the top pixel in the least significant bit.
+ */
+
+#ifndef G15_LCD_H_
+#define G15_LCD_H_
+
+#include <stdint.h>
+
+/** \name G15 LCD Report Layout
+ * Sizes of the canvas read and the output report written
+ */
+///@{
+#define G15_LCD_COLUMNS 160	    ///< Pixel columns of the LCD
+#define G15_LCD_ROWS 43		    ///< Pixel rows of the LCD
+#define G15_LCD_STRIDE 20	    ///< Canvas bytes per pixel row
+#define G15_LCD_STRIPS 6	    ///< 8-pixel strips covering the 43 pixel rows
+#define G15_LCD_STRIP_LEN 160	    ///< Report bytes per strip, one per pixel column
+#define G15_LCD_WHITE 0		    ///< Pixel off, as G15_COLOR_WHITE of libg15render
+#define G15_LCD_BLACK 1		    ///< Pixel on, as G15_COLOR_BLACK of libg15render
+#define G15_LCD_REPORT_OFFSET 32    ///< Report header length before the pixel data
+#define G15_LCD_REPORT_ID 0x03	    ///< Output report ID of the LCD
+
+/** \brief Canvas bytes read, the 43 display rows padded to 48 */
+#define G15_LCD_PIXMAP_LEN (G15_LCD_STRIPS * 8 * G15_LCD_STRIDE)
+
+/** \brief Report pixel data bytes */
+#define G15_LCD_DATA_LEN (G15_LCD_STRIPS * G15_LCD_STRIP_LEN)
+
+/** \brief Complete output report length */
+#define G15_LCD_REPORT_LEN (G15_LCD_REPORT_OFFSET + G15_LCD_DATA_LEN)
+
+/** \brief Dirty mask with every strip set */
+#define G15_LCD_ALL_STRIPS ((1 << G15_LCD_STRIPS) - 1)
+///@}
+
+/**
+ * \brief Frame in the layout of the LCD output report
+ *
+ * \details Pixel (x, y) is bit y % 8 of report byte G15_LCD_REPORT_OFFSET +
+ * (y / 8) * G15_LCD_STRIP_LEN + x. Every drawing call that writes pixels bumps
+ * the generation and marks the strips it wrote as dirty, so a flush can tell
+ * without looking at the pixels whether and where the frame may have changed.
+ */
+typedef struct {
+	unsigned char report[G15_LCD_REPORT_LEN]; ///< Report ID, header and pixel data
+	unsigned int generation;		  ///< Count of drawing calls that wrote pixels
+	unsigned char dirty;			  ///< Bit s: strip s written since the last clean
+} G15LcdFrame;
+
+/** \brief Pixel data of a frame */
+#define G15_LCD_FRAME_DATA(f) ((f)->report + G15_LCD_REPORT_OFFSET)
+
+/** \name G15 Glyph Atlas
+ * Size of a cached glyph and where it is drawn when loading it
+ */
+///@{
+#define G15_LCD_GLYPH_COLUMNS 16 ///< Widest glyph the atlas holds
+#define G15_LCD_GLYPH_ROWS 24	 ///< Tallest glyph the atlas holds
+#define G15_LCD_GLYPH_ORIGIN_X 8 ///< Canvas column a glyph is drawn at for loading
+#define G15_LCD_GLYPH_ORIGIN_Y 8 ///< Canvas row a glyph is drawn at for loading
+///@}
+
+/**
+ * \brief Glyph rasterized into column masks
+ */
+typedef struct {
+	uint32_t ink[G15_LCD_GLYPH_COLUMNS]; ///< Bit r of column c is pixel (c, r) from the origin
+	unsigned char width;		     ///< Columns up to the last one with ink
+	unsigned char valid;		     ///< Glyph fits the atlas and was loaded
+} G15LcdGlyph;
+
+/**
+ * \brief Conversion kernel
+ * \param lcd_data Destination for G15_LCD_DATA_LEN bytes of report pixel data
+ * \param pixmap Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ */
+typedef void (*G15LcdKernelFunc)(unsigned char *lcd_data, const unsigned char *pixmap);
+
+/**
+ * \brief Conversion kernel and the CPU check it needs
+ */
+typedef struct {
+	const char *name;	  ///< Kernel name for logs and benchmarks
+	G15LcdKernelFunc convert; ///< Kernel
+	int (*supported)(void);	  ///< CPU check, NULL if the kernel runs everywhere
+} G15LcdKernel;
+
+/**
+ * \brief Kernels built into this binary, fastest first
+ *
+ * \details Terminated by an entry with a NULL name. The last real entry is the
+ * bitwise reference kernel.
+ */
+extern const G15LcdKernel g15_lcd_kernels[];
+
+/**
+ * \brief Set up the report header and clear a frame
+ * \param f Frame
+ *
+ * \details The new frame has every strip dirty, it was never sent.
+ */
+void g15_lcd_frame_init(G15LcdFrame *f);
+
+/**
+ * \brief Mark every strip of a frame as clean
+ * \param f Frame
+ *
+ * \details Called once the frame was sent. The generation keeps counting.
+ */
+void g15_lcd_frame_clean(G15LcdFrame *f);
+
+/**
+ * \brief Set every pixel of a frame
+ * \param f Frame
+ * \param color G15_LCD_WHITE or G15_LCD_BLACK
+ */
+void g15_lcd_clear(G15LcdFrame *f, int color);
+
+/**
+ * \brief Set every pixel of a rectangle
+ * \param f Frame
+ * \param x1 First column
+ * \param y1 First row
+ * \param x2 Last column, may be left of x1
+ * \param y2 Last row, may be above y1
+ * \param color G15_LCD_WHITE or G15_LCD_BLACK
+ *
+ * \details Covers the same pixels as a filled one pixel thick
+ * g15r_pixelBox(). Pixels outside the LCD are skipped.
+ */
+void g15_lcd_fill(G15LcdFrame *f, int x1, int y1, int x2, int y2, int color);
+
+/**
+ * \brief Draw a 1 bpp bitmap
+ * \param f Frame
+ * \param x Column of the left edge, may be negative
+ * \param y Row of the top edge, may be negative
+ * \param width Bitmap width in pixels
+ * \param height Bitmap height in pixels
+ * \param bits Bitmap rows, leftmost pixel in the most significant bit
+ * \param stride Bytes per bitmap row
+ * \param color Color of set bitmap pixels
+ * \param paint_bg Paint clear bitmap pixels in the other color, else leave them
+ *
+ * \details Color and paint_bg work as in g15r_renderG15Glyph(). Pixels
+ * outside the LCD are skipped.
+ */
+void g15_lcd_blit(G15LcdFrame *f, int x, int y, int width, int height, const unsigned char *bits,
+		  int stride, int color, int paint_bg);
+
+/**
+ * \brief Overwrite full-height columns with bitmap data in report layout
+ * \param f Frame
+ * \param x Column of the left edge, may be negative
+ * \param width Columns to draw
+ * \param columns G15_LCD_STRIPS strips of column bytes, laid out as the frame
+ * \param stride Bytes per strip of columns
+ *
+ * \details Same pixels as g15_lcd_blit() of a width x G15_LCD_ROWS bitmap at
+ * row 0 with paint_bg set, one byte copied per column and strip. Columns
+ * outside the LCD are skipped, the rows below the LCD are left unchanged.
+ */
+void g15_lcd_put_columns(G15LcdFrame *f, int x, int width, const unsigned char *columns,
+			 int stride);
+
+/**
+ * \brief Load a glyph into the atlas
+ * \param g Atlas entry
+ * \param pixmap White libg15render canvas with only the glyph drawn on it,
+ * its top left corner at G15_LCD_GLYPH_ORIGIN_X, G15_LCD_GLYPH_ORIGIN_Y
+ * \retval 0 Glyph loaded
+ * \retval -1 Ink outside the atlas box, the entry is left invalid
+ */
+int g15_lcd_glyph_load(G15LcdGlyph *g, const unsigned char *pixmap);
+
+/**
+ * \brief Draw a glyph from the atlas
+ * \param f Frame
+ * \param g Valid atlas entry
+ * \param x Column of the glyph origin, may be negative
+ * \param y Row of the glyph origin, may be negative
+ * \param color Color of the ink, other pixels are left unchanged
+ *
+ * \details Draws the same pixels as g15r_renderG15Glyph() without paint_bg
+ * at the same position, one masked byte per column and strip.
+ */
+void g15_lcd_glyph_draw(G15LcdFrame *f, const G15LcdGlyph *g, int x, int y, int color);
+
+/**
+ * \brief Copy the ink of libg15render canvas rows into a frame
+ * \param f Frame
+ * \param pixmap libg15render canvas, G15_LCD_PIXMAP_LEN bytes are read
+ * \param y1 First row
+ * \param y2 Last row
+ * \param color Color the set canvas pixels get in the frame
+ *
+ * \details Compatibility path for drawing that is left to libg15render: draw
+ * on a white canvas, import the rows it touched, clear them again. Clear
+ * canvas pixels leave the frame unchanged.
+ */
+void g15_lcd_import(G15LcdFrame *f, const unsigned char *pixmap, int y1, int y2, int color);
+
+/**
+ * \brief Convert libg15render canvas format to raw data for the USB output endpoint
+ * \param lcd_buffer Destination for a complete output report of G15_LCD_REPORT_LEN bytes
+ * \param data Canvas, G15_LCD_PIXMAP_LEN bytes are read
+ *
+ * \details Writes the report ID, clears the rest of the header and converts
+ * the canvas with the kernel picked on the first call.
+ */
+void g15_pixmap_to_lcd(unsigned char *lcd_buffer, const unsigned char *data);
+
+/**
+ * \brief Name of the kernel g15_pixmap_to_lcd() uses
+ * \return Kernel name
+ */
+const char *g15_lcd_kernel_name(void);
+
+#endif
@@ -14,12 +14,14 @@
  * - USB HID communication via hidraw interface for reliable device access
  * - RGB backlight control for G510/G510s keyboards with zone support
  * - Macro LED control for G510/G510s keyboards (M1, M2, M3, MR LEDs)
- * - Big number display rendering with 32x32 pixel bitmaps
+ * - Big number display copying 24x43 pixel bitmaps stored in report layout
  * - Icon and graphics rendering with predefined icon library
  * - Horizontal and vertical progress bar rendering
- * - Key input handling and event processing
- * - Double buffering with canvas and backingstore for smooth updates
- * - libg15render integration for advanced display operations
+ * - No key input of its own, the G-keys are read by the linux_input driver
+ * - Frame kept in LCD report layout, sent without conversion when it changed
+ * - Change detection from the frame generation and the strips drawn since the last flush
+ * - Glyph atlas rasterized from the libg15render font at init
+ * - libg15render drawing imported into the frame for glyphs the atlas cannot hold
  * - Font rendering support with TTF_SUPPORT workaround
  * - Device detection and capability auto-configuration
  * - Memory management for display buffers and device state
@@ -66,6 +68,7 @@
 #define TTF_SUPPORT
 #include <libg15render.h>
 
+#include "g15-lcd.h"
 #include "g15.h"
 #include "lcd.h"
 
@@ -83,7 +86,7 @@ MODULE_EXPORT char *symbol_prefix = "g15_";    ///< Function symbol prefix for t
 ///@}
 
 void g15_close(Driver *drvthis);
-static void g15_pixmap_to_lcd(unsigned char *lcd_buffer, unsigned char const *data);
+static void g15_load_glyphs(Driver *drvthis);
 
 /** \brief Supported Logitech G-Series keyboard USB device IDs
  *
@@ -190,7 +193,8 @@ MODULE_EXPORT int g15_init(Driver *drvthis)
 	}
 
 	g15r_initCanvas(&p->canvas);
-	g15r_initCanvas(&p->backingstore);
+	g15_lcd_frame_init(&p->frame);
+	g15_load_glyphs(drvthis);
 
 	if (p->has_rgb_backlight && p->backlight_state == BACKLIGHT_ON) {
 		g15_set_rgb_backlight(drvthis, p->rgb_red, p->rgb_green, p->rgb_blue);
@@ -202,14 +206,14 @@ MODULE_EXPORT int g15_init(Driver *drvthis)
 
 	// CRITICAL: Send blank frame to force-clear hardware logo after USB reset
 	// The G510 shows a boot logo that can sometime persists until we send data
-	// Explicitly clear canvas and send it to overwrite the logo
-	g15r_clearScreen(&p->canvas, G15_COLOR_WHITE);
-	unsigned char lcd_buf[G15_LCD_OFFSET + 6 * G15_LCD_WIDTH];
-	memset(lcd_buf + 1, 0, G15_LCD_OFFSET - 1);
-	g15_pixmap_to_lcd(lcd_buf, p->canvas.buffer);
-	lib_hidraw_send_output_report(p->hidraw_handle, lcd_buf, sizeof(lcd_buf));
-	memcpy(p->backingstore.buffer, p->canvas.buffer, G15_BUFFER_LEN * sizeof(unsigned char));
+	// Explicitly clear the frame and send it to overwrite the logo
+	g15_lcd_clear(&p->frame, G15_LCD_WHITE);
+	lib_hidraw_send_output_report(p->hidraw_handle, p->frame.report, G15_LCD_REPORT_LEN);
+	memcpy(p->sent, G15_LCD_FRAME_DATA(&p->frame), G15_LCD_DATA_LEN);
+	g15_lcd_frame_clean(&p->frame);
+	p->flushed_generation = p->frame.generation;
 	report(RPT_INFO, "%s: Sent blank frame to force-clear hardware logo", drvthis->name);
+	report(RPT_INFO, "%s: Using %s canvas conversion", drvthis->name, g15_lcd_kernel_name());
 
 	return 0;
 }
@@ -245,121 +249,62 @@ MODULE_EXPORT void g15_clear(Driver *drvthis)
 {
 	PrivateData *p = drvthis->private_data;
 
-	report(RPT_DEBUG, "%s: Clearing ONLY canvas buffer (backingstore kept for diff)",
-	       drvthis->name);
-	g15r_clearScreen(&p->canvas, 0);
-	// NEVER clear backingstore - it must keep the last sent frame for memcmp optimization
-}
-
-/**
- * \brief Convert libg15render canvas format to raw data for the USB output endpoint
- * \param lcd_buffer Destination buffer for LCD data (must be sized for G15_LCD_OFFSET + 6 *
- * G15_LCD_WIDTH bytes)
- * \param data Source pixel data from libg15render canvas buffer
- *
- * \details Transforms the horizontal pixel layout used by libg15render into the
- * vertical column-oriented format required by the G15 LCD hardware. The G15 LCD
- * uses a column-major layout where each byte represents 8 vertical pixels.
- */
-static void g15_pixmap_to_lcd(unsigned char *lcd_buffer, unsigned char const *data)
-{
-	/**
-	 * \note For a set of bytes (A, B, C, etc.) the bits representing pixels will appear
-	 * on the LCD like this:
-	 *
-	 * A0 B0 C0
-	 * A1 B1 C1
-	 * A2 B2 C2
-	 * A3 B3 C3 ... and across for G15_LCD_WIDTH bytes
-	 * A4 B4 C4
-	 * A5 B5 C5
-	 * A6 B6 C6
-	 * A7 B7 C7
-	 *
-	 * A0
-	 * A1  <- second 8-pixel-high row starts straight after the last byte on
-	 * A2     the previous row
-	 * A3
-	 * A4
-	 * A5
-	 * A6
-	 * A7
-	 * A8
-	 *
-	 * A0
-	 * ...
-	 * A0
-	 * ...
-	 * A0
-	 * ...
-	 * A0
-	 * A1 <- only the first three bits are shown on the bottom row (the last three
-	 * A2    pixels of the 43-pixel high display.)
-	 */
-
-	const unsigned int stride = G15_LCD_WIDTH / 8;
-	unsigned int row, col;
-
-	// Set output report ID and initialize buffer header
-	lcd_buffer[0] = 0x03;
-	memset(lcd_buffer + 1, 0, G15_LCD_OFFSET - 1);
-	lcd_buffer += G15_LCD_OFFSET;
-
-	// Process 6 rows of 8 pixels each (43 pixel height requires 6 bytes per column)
-	for (row = 0; row < 6; row++) {
-		for (col = 0; col < G15_LCD_WIDTH; col++) {
-			unsigned int bit = col % 8;
-
-			// Extract 8 vertical pixels and pack into single byte
-			*lcd_buffer++ = (((data[stride * 0] << bit) & 0x80) >> 7) |
-					(((data[stride * 1] << bit) & 0x80) >> 6) |
-					(((data[stride * 2] << bit) & 0x80) >> 5) |
-					(((data[stride * 3] << bit) & 0x80) >> 4) |
-					(((data[stride * 4] << bit) & 0x80) >> 3) |
-					(((data[stride * 5] << bit) & 0x80) >> 2) |
-					(((data[stride * 6] << bit) & 0x80) >> 1) |
-					(((data[stride * 7] << bit) & 0x80) >> 0);
-
-			// Advance to next byte in source data after processing 8 columns
-			if (bit == 7)
-				data++;
-		}
-		// Skip 7 rows in source (we already processed row 0 above)
-		data += 7 * stride;
-	}
+	report(RPT_DEBUG, "%s: Clearing ONLY frame (last sent frame kept for diff)", drvthis->name);
+	g15_lcd_clear(&p->frame, G15_LCD_WHITE);
+	// NEVER clear the sent copy - it must keep the last sent frame for memcmp optimization
 }
 
 // Flush the frame buffer to the LCD display
 MODULE_EXPORT void g15_flush(Driver *drvthis)
 {
 	PrivateData *p = drvthis->private_data;
-	unsigned char lcd_buf[G15_LCD_OFFSET + 6 * G15_LCD_WIDTH];
+	unsigned char *data = G15_LCD_FRAME_DATA(&p->frame);
 	static int flush_count = 0;
+	unsigned char differ = 0;
 
 	flush_count++;
 
-	// Calculate checksums for debugging
-	unsigned int canvas_sum = 0;
-	unsigned int backing_sum = 0;
-	for (int i = 0; i < G15_BUFFER_LEN; i++) {
-		canvas_sum += p->canvas.buffer[i];
-		backing_sum += p->backingstore.buffer[i];
+	// Checksums only feed the debug log
+	if (report_enabled(RPT_DEBUG)) {
+		unsigned int frame_sum = 0;
+		unsigned int sent_sum = 0;
+
+		for (int i = 0; i < G15_LCD_DATA_LEN; i++) {
+			frame_sum += data[i];
+			sent_sum += p->sent[i];
+		}
+		report(RPT_DEBUG, "%s: flush #%d - frame_checksum=%u, sent_checksum=%u",
+		       drvthis->name, flush_count, frame_sum, sent_sum);
+	}
+
+	if (p->frame.generation == p->flushed_generation) {
+		report(RPT_DEBUG, "%s: Nothing drawn - SKIPPING update to hardware",
+		       drvthis->name);
+		return;
 	}
+	p->flushed_generation = p->frame.generation;
 
-	report(RPT_DEBUG, "%s: flush #%d - canvas_checksum=%u, backing_checksum=%u", drvthis->name,
-	       flush_count, canvas_sum, backing_sum);
+	// Only strips written since the last flush can differ from the sent frame
+	for (int strip = 0; strip < G15_LCD_STRIPS; strip++) {
+		int offset = strip * G15_LCD_STRIP_LEN;
 
-	if (memcmp(p->backingstore.buffer, p->canvas.buffer,
-		   G15_BUFFER_LEN * sizeof(unsigned char)) == 0) {
+		if (!(p->frame.dirty & (1 << strip)) ||
+		    (memcmp(p->sent + offset, data + offset, G15_LCD_STRIP_LEN) == 0))
+			continue;
+		memcpy(p->sent + offset, data + offset, G15_LCD_STRIP_LEN);
+		differ |= (unsigned char)(1 << strip);
+	}
+	g15_lcd_frame_clean(&p->frame);
+
+	if (differ == 0) {
 		report(RPT_DEBUG, "%s: Buffers identical - SKIPPING update to hardware",
 		       drvthis->name);
 		return;
 	}
 
-	report(RPT_DEBUG, "%s: Buffers differ - SENDING update to hardware", drvthis->name);
-	memcpy(p->backingstore.buffer, p->canvas.buffer, G15_BUFFER_LEN * sizeof(unsigned char));
-	g15_pixmap_to_lcd(lcd_buf, p->canvas.buffer);
-	lib_hidraw_send_output_report(p->hidraw_handle, lcd_buf, sizeof(lcd_buf));
+	report(RPT_DEBUG, "%s: Strips 0x%02x differ - SENDING update to hardware", drvthis->name,
+	       differ);
+	lib_hidraw_send_output_report(p->hidraw_handle, p->frame.report, G15_LCD_REPORT_LEN);
 	report(RPT_DEBUG, "%s: Hardware update completed", drvthis->name);
 }
 
@@ -396,20 +341,67 @@ int g15_convert_coords(int x, int y, int *px, int *py)
 	return 1;
 }
 
-// Place a single character on the LCD at specified position
-MODULE_EXPORT void g15_chr(Driver *drvthis, int x, int y, char c)
+/**
+ * \brief Rasterize every glyph of the font into the glyph atlas
+ * \param drvthis Driver instance
+ *
+ * \details Each glyph is rendered alone on the white scratch canvas with
+ * libg15render and read back, so the atlas matches what libg15render draws.
+ */
+static void g15_load_glyphs(Driver *drvthis)
 {
 	PrivateData *p = drvthis->private_data;
-	int px, py;
+	int loaded = 0;
+
+	for (int c = 0; c < 256; c++) {
+		g15r_renderG15Glyph(&p->canvas, p->font, (unsigned char)c, G15_LCD_GLYPH_ORIGIN_X,
+				    G15_LCD_GLYPH_ORIGIN_Y, G15_COLOR_BLACK, 0);
+		if (g15_lcd_glyph_load(&p->glyphs[c], p->canvas.buffer) == 0)
+			loaded++;
+		g15r_clearScreen(&p->canvas, G15_COLOR_WHITE);
+	}
+
+	report(RPT_INFO, "%s: %d of 256 glyphs cached", drvthis->name, loaded);
+}
+
+/**
+ * \brief Draw a character cell into the frame
+ * \param p Driver private data
+ * \param x Character column position (1-based)
+ * \param y Character row position (1-based)
+ * \param c Character or icon glyph
+ * \param reverse Draw white on black instead of black on white
+ *
+ * \details The glyph is drawn one pixel up and left of the cell. Glyphs too
+ * large for the atlas are rendered by libg15render on the scratch canvas and
+ * imported; the rows they may touch are cleared on the canvas afterwards.
+ */
+static void g15_draw_chr(PrivateData *p, int x, int y, unsigned char c, int reverse)
+{
+	int paper = reverse ? G15_LCD_BLACK : G15_LCD_WHITE;
+	int px, py, top;
 
 	if (!g15_convert_coords(x, y, &px, &py)) {
 		return;
 	}
 
-	g15r_pixelReverseFill(&p->canvas, px, py, px + G15_CELL_WIDTH - 1, py + G15_CELL_HEIGHT - 1,
-			      G15_PIXEL_FILL, G15_COLOR_WHITE);
+	g15_lcd_fill(&p->frame, px, py, px + G15_CELL_WIDTH - 1, py + G15_CELL_HEIGHT - 1, paper);
+
+	if (p->glyphs[c].valid) {
+		g15_lcd_glyph_draw(&p->frame, &p->glyphs[c], px - 1, py - 1, !paper);
+		return;
+	}
 
 	g15r_renderG15Glyph(&p->canvas, p->font, c, px - 1, py - 1, G15_COLOR_BLACK, 0);
+	top = max(py - 1, 0);
+	g15_lcd_import(&p->frame, p->canvas.buffer, top, G15_LCD_ROWS - 1, !paper);
+	memset(p->canvas.buffer + top * G15_LCD_STRIDE, 0, (G15_LCD_ROWS - top) * G15_LCD_STRIDE);
+}
+
+// Place a single character on the LCD at specified position
+MODULE_EXPORT void g15_chr(Driver *drvthis, int x, int y, char c)
+{
+	g15_draw_chr(drvthis->private_data, x, y, (unsigned char)c, 0);
 }
 
 // Print a string on the LCD display at specified position
@@ -417,7 +409,7 @@ MODULE_EXPORT void g15_string(Driver *drvthis, int x, int y, const char string[]
 {
 	int i;
 
-	report(RPT_DEBUG, "%s: Rendering string at (%d,%d): '%s'", drvthis->name, x, y, string);
+	debug(RPT_DEBUG, "%s: Rendering string at (%d,%d): '%s'", drvthis->name, x, y, string);
 
 	// Render each character sequentially
 	for (i = 0; string[i] != '\0'; i++) {
@@ -443,14 +435,12 @@ MODULE_EXPORT int g15_icon(Driver *drvthis, int x, int y, int icon)
 		px2 = px1 + G15_CELL_WIDTH - 2;
 		py2 = py1 + G15_CELL_HEIGHT - 2;
 
-		g15r_pixelBox(&p->canvas, px1, py1, px2, py2, G15_COLOR_BLACK, 1, G15_PIXEL_FILL);
+		g15_lcd_fill(&p->frame, px1, py1, px2, py2, G15_LCD_BLACK);
 		return 0;
 
-	// Open heart icon - requires reverse mode
+	// Open heart icon - drawn reversed
 	case ICON_HEART_OPEN:
-		p->canvas.mode_reverse = 1;
-		g15_chr(drvthis, x, y, G15_ICON_HEART_OPEN);
-		p->canvas.mode_reverse = 0;
+		g15_draw_chr(p, x, y, G15_ICON_HEART_OPEN, 1);
 		return 0;
 
 	// Filled heart icon
@@ -562,7 +552,7 @@ MODULE_EXPORT void g15_hbar(Driver *drvthis, int x, int y, int len, int promille
 	px2 = px1 + total_pixels;
 	py2 = py1 + G15_CELL_HEIGHT - 2;
 
-	g15r_pixelBox(&p->canvas, px1, py1, px2, py2, G15_COLOR_BLACK, 1, G15_PIXEL_FILL);
+	g15_lcd_fill(&p->frame, px1, py1, px2, py2, G15_LCD_BLACK);
 }
 
 // Draw a vertical bar growing upward
@@ -580,12 +570,9 @@ MODULE_EXPORT void g15_vbar(Driver *drvthis, int x, int y, int len, int promille
 	py2 = py1 + total_pixels - 1;
 	px2 = px1 + G15_CELL_WIDTH - 2;
 
-	g15r_pixelBox(&p->canvas, px1, py1, px2, py2, G15_COLOR_BLACK, 1, G15_PIXEL_FILL);
+	g15_lcd_fill(&p->frame, px1, py1, px2, py2, G15_LCD_BLACK);
 }
 
-// Get key input from the G15 keyboard
-MODULE_EXPORT const char *g15_get_key(Driver *drvthis) { return NULL; }
-
 // Control the LCD backlight
 MODULE_EXPORT void g15_backlight(Driver *drvthis, int on)
 {
@@ -830,28 +817,8 @@ MODULE_EXPORT void g15_num(Driver *drvthis, int x, int num)
 		return;
 	}
 
-	// Determine bitmap dimensions based on character type
-	int width = 0;
-	int height = 43;
-
-	if ((num >= 0) && (num <= 9)) {
-		width = 24;
-	} else {
-		width = 9;
-	}
-
-	int i = 0;
-
-	// Render bitmap pixel by pixel
-	for (i = 0; i < (width * height); ++i) {
+	int width = (num <= 9) ? G15_BIGNUM_WIDTH : G15_BIGNUM_COLON_WIDTH;
 
-		// Convert bitmap data to color (1=white, 0=black)
-		int color = (g15_bignum_data[num][i] ? G15_COLOR_WHITE : G15_COLOR_BLACK);
-
-		// Calculate pixel position from linear index
-		int px = ox + i % width;
-		int py = i / width;
-
-		g15r_setPixel(&p->canvas, px, py, color);
-	}
+	// The bitmaps cover the full LCD height, in report layout
+	g15_lcd_put_columns(&p->frame, ox, width, g15_bignum_data[num][0], G15_BIGNUM_WIDTH);
 }
@@ -16,12 +16,12 @@
  * - Macro LED control for G510 keyboards (M1, M2, M3, MR)
  * - Big number display support with 32x32 pixel bitmaps
  * - Icon rendering capabilities with predefined icon set
- * - Double buffering with canvas and backing store
+ * - Frame kept in LCD report layout, sent as is when it changed
  * - Font rendering support through libg15render
  * - Core driver functions: init, close, width, height, clear, flush
  * - Graphics functions: string, chr, icon, hbar, vbar, num
  * - Display control: backlight, RGB backlight, macro LEDs
- * - Key input handling and event processing
+ * - No get_key(), so the G15 alone does not make the server poll for keys
  *
  * \usage
  * - Include this header in LCDd server for G15/G510 driver support
@@ -41,6 +41,7 @@
 #ifndef G15_H_
 #define G15_H_
 
+#include "g15-lcd.h"
 #include "hidraw_lib.h"
 #include "lcd.h"
 #include <libg15render.h>
@@ -55,11 +56,20 @@ typedef struct g15_private_data {
 	// HID raw handle for USB communication
 	struct lib_hidraw_handle *hidraw_handle;
 
-	// Primary LCD canvas buffer
+	// Frame drawn into, in LCD report layout
+	G15LcdFrame frame;
+
+	// Pixel data of the frame last sent to the LCD
+	unsigned char sent[G15_LCD_DATA_LEN];
+
+	// Frame generation at the last flush
+	unsigned int flushed_generation;
+
+	// White scratch canvas for drawing left to libg15render
 	g15canvas canvas;
 
-	// Backing store for double buffering
-	g15canvas backingstore;
+	// Glyphs of the font, rasterized at init
+	G15LcdGlyph glyphs[256];
 
 	// Font handle for text rendering
 	g15font *font;
@@ -135,7 +145,8 @@ typedef struct g15_private_data {
  * Constants for big number rendering
  */
 ///@{
-#define G15_BIGNUM_LEN 1032 ///< Big number bitmap length in bytes
+#define G15_BIGNUM_WIDTH 24	 ///< Big number digit width, bytes per bitmap strip
+#define G15_BIGNUM_COLON_WIDTH 9 ///< Big number colon width
 ///@}
 
 /** \name G510 RGB Backlight Control
@@ -169,7 +180,8 @@ typedef struct g15_private_data {
  * External data declarations for G15 driver
  */
 ///@{
-extern short g15_bignum_data[11][G15_BIGNUM_LEN]; ///< Big number bitmap data (digits 0-9 and colon)
+/** \brief Big number bitmaps (digits 0-9 and colon) in report layout, see g15-num.c */
+extern const unsigned char g15_bignum_data[11][G15_LCD_STRIPS][G15_BIGNUM_WIDTH];
 ///@}
 
 /**
@@ -233,7 +245,7 @@ MODULE_EXPORT int g15_cellheight(Driver *drvthis);
  * \brief Clear the LCD screen
  * \param drvthis Pointer to driver structure
  *
- * \details Clears both the main canvas and backing store buffers.
+ * \details Clears the frame. The last sent frame is kept for change detection.
  */
 MODULE_EXPORT void g15_clear(Driver *drvthis);
 
@@ -241,8 +253,10 @@ MODULE_EXPORT void g15_clear(Driver *drvthis);
  * \brief Flush the frame buffer to the LCD display
  * \param drvthis Pointer to driver structure
  *
- * \details Converts the canvas buffer to LCD format and sends it
- * to the device via USB. Updates the display with current content.
+ * \details Sends the frame to the device via USB if it differs from the
+ * last sent frame. The frame already is in report layout, so it is sent as is.
+ * Nothing is compared if the frame generation did not move since the last
+ * flush, else only the strips drawn since then.
  */
 MODULE_EXPORT void g15_flush(Driver *drvthis);
 
@@ -312,16 +326,6 @@ MODULE_EXPORT void g15_hbar(Driver *drvthis, int x, int y, int len, int promille
  */
 MODULE_EXPORT void g15_vbar(Driver *drvthis, int x, int y, int len, int promille, int options);
 
-/**
- * \brief Get key input from the G15 keyboard
- * \param drvthis Pointer to driver structure
- * \return Key string or NULL if no key pressed
- *
- * \details Returns key input from the G15 keyboard. Currently not
- * implemented for direct hidraw access.
- */
-MODULE_EXPORT const char *g15_get_key(Driver *drvthis);
-
 /**
  * \brief Control the LCD backlight
  * \param drvthis Pointer to driver structure
@@ -0,0 +1,313 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/event.c
+ * \brief Event loop (epoll reactor) implementation for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - epoll instance shared by listening socket, client sockets and helpers
+ * - One-shot absolute deadline timer based on timerfd (CLOCK_MONOTONIC)
+ * - signalfd based signal delivery without async-signal-safety constraints
+ * - Descriptor table indexed by fd for O(1) lookup on dispatch
+ * - Generation tagging so stale events of a recycled fd are dropped
+ *
+ * \usage
+ * - Used by sock.c to watch the listening and client sockets
+ * - Used by main.c to sleep until the next frame or input poll is due
+ *
+ * \details Every registration gets a generation number that is stored next
+ * to the fd in the epoll user data. A handler may remove (and even close and
+ * reuse) any descriptor while a batch of events is dispatched; events that
+ * still refer to the old registration fail the generation check and are
+ * silently skipped.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "shared/report.h"
+
+#include "event.h"
+
+/** \brief Maximum number of events fetched by a single epoll_wait() */
+#define EVENT_BATCH 64
+
+/**
+ * \brief Registered file descriptor
+ * \details Handler and user data of one watched descriptor.
+ */
+typedef struct EventSource {
+	EventHandler handler; ///< Callback for ready events
+	void *data;	      ///< Opaque user data for the callback
+	uint32_t gen;	      ///< Registration generation (see file details)
+} EventSource;
+
+/** \name Reactor State
+ * epoll instance, helper descriptors and the fd-indexed source table
+ */
+///@{
+static int epoll_fd = -1;			     ///< epoll instance
+static int timer_fd = -1;			     ///< Deadline timer
+static int signal_fd = -1;			     ///< Signal delivery descriptor
+static EventSignalHandler signal_handler = NULL;     ///< Callback for signal_fd
+static EventSource *sources = NULL;		     ///< Source table indexed by fd
+static int sources_size = 0;			     ///< Allocated entries in sources
+static uint32_t next_gen = 1;			     ///< Next registration generation
+///@}
+
+/**
+ * \brief Pack fd and generation into epoll user data
+ * \param fd File descriptor
+ * \param gen Registration generation
+ * \return 64-bit epoll user data
+ */
+static inline uint64_t event_pack(int fd, uint32_t gen) { return ((uint64_t)gen << 32) | fd; }
+
+/**
+ * \brief Grow the source table so that fd is a valid index
+ * \param fd File descriptor that must fit
+ * \retval 0 Success
+ * \retval -1 Allocation failed
+ */
+static int event_reserve(int fd)
+{
+	EventSource *tmp;
+	int new_size;
+
+	if (fd < sources_size)
+		return 0;
+
+	new_size = (sources_size > 0) ? sources_size : 64;
+	while (new_size <= fd)
+		new_size *= 2;
+
+	tmp = realloc(sources, new_size * sizeof(EventSource));
+	if (tmp == NULL)
+		return -1;
+
+	memset(tmp + sources_size, 0, (new_size - sources_size) * sizeof(EventSource));
+	sources = tmp;
+	sources_size = new_size;
+
+	return 0;
+}
+
+// Create epoll instance and deadline timer
+int event_init(void)
+{
+	debug(RPT_DEBUG, "%s()", __FUNCTION__);
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		report(RPT_ERR, "%s: epoll_create1 failed - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (timer_fd < 0) {
+		report(RPT_ERR, "%s: timerfd_create failed - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	// Helper descriptors are tagged with generation 0 and handled inline
+	struct epoll_event ev = {.events = EPOLLIN, .data.u64 = event_pack(timer_fd, 0)};
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) < 0) {
+		report(RPT_ERR, "%s: cannot watch timerfd - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+// Close all reactor descriptors and free the source table
+void event_shutdown(void)
+{
+	debug(RPT_DEBUG, "%s()", __FUNCTION__);
+
+	if (signal_fd >= 0)
+		close(signal_fd);
+	if (timer_fd >= 0)
+		close(timer_fd);
+	if (epoll_fd >= 0)
+		close(epoll_fd);
+
+	signal_fd = timer_fd = epoll_fd = -1;
+
+	free(sources);
+	sources = NULL;
+	sources_size = 0;
+}
+
+// Register a descriptor with callback and user data
+int event_add(int fd, uint32_t events, EventHandler handler, void *data)
+{
+	struct epoll_event ev;
+
+	if ((fd < 0) || (handler == NULL))
+		return -1;
+
+	if (event_reserve(fd) < 0) {
+		report(RPT_ERR, "%s: error allocating event source", __FUNCTION__);
+		return -1;
+	}
+
+	sources[fd].handler = handler;
+	sources[fd].data = data;
+	sources[fd].gen = next_gen++;
+	if (next_gen == 0)
+		next_gen = 1;
+
+	ev.events = events;
+	ev.data.u64 = event_pack(fd, sources[fd].gen);
+
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		report(RPT_ERR, "%s: cannot watch fd %d - %s", __FUNCTION__, fd, strerror(errno));
+		sources[fd].handler = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+// Change the event mask of a registered descriptor
+int event_modify(int fd, uint32_t events)
+{
+	struct epoll_event ev;
+
+	if ((fd < 0) || (fd >= sources_size) || (sources[fd].handler == NULL))
+		return -1;
+
+	ev.events = events;
+	ev.data.u64 = event_pack(fd, sources[fd].gen);
+
+	return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+// Unregister a descriptor (does not close it)
+int event_remove(int fd)
+{
+	if ((fd < 0) || (fd >= sources_size) || (sources[fd].handler == NULL))
+		return -1;
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+
+	sources[fd].handler = NULL;
+	sources[fd].data = NULL;
+	sources[fd].gen = 0;
+
+	return 0;
+}
+
+// Block the given signals and receive them through a signalfd
+int event_watch_signals(const sigset_t *mask, EventSignalHandler handler)
+{
+	if (sigprocmask(SIG_BLOCK, mask, NULL) < 0) {
+		report(RPT_ERR, "%s: sigprocmask failed - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	// Passing the existing fd updates its mask instead of creating a new one
+	int fd = signalfd(signal_fd, mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+	if (fd < 0) {
+		report(RPT_ERR, "%s: signalfd failed - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	if (signal_fd < 0) {
+		struct epoll_event ev = {.events = EPOLLIN, .data.u64 = event_pack(fd, 0)};
+
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+			report(RPT_ERR, "%s: cannot watch signalfd - %s", __FUNCTION__,
+			       strerror(errno));
+			close(fd);
+			return -1;
+		}
+		signal_fd = fd;
+	}
+
+	signal_handler = handler;
+
+	return 0;
+}
+
+// Arm (or disarm) the one-shot absolute deadline
+void event_set_deadline(const struct timespec *deadline)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+
+	if (deadline != NULL) {
+		its.it_value = *deadline;
+
+		// A zero it_value would disarm the timer instead of firing immediately
+		if ((its.it_value.tv_sec == 0) && (its.it_value.tv_nsec == 0))
+			its.it_value.tv_nsec = 1;
+	}
+
+	if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+		report(RPT_ERR, "%s: timerfd_settime failed - %s", __FUNCTION__, strerror(errno));
+}
+
+// Wait for ready descriptors, the deadline or a signal and dispatch them
+int event_dispatch(void)
+{
+	struct epoll_event events[EVENT_BATCH];
+	int n, i;
+
+	n = epoll_wait(epoll_fd, events, EVENT_BATCH, -1);
+	if (n < 0) {
+		if (errno == EINTR)
+			return 0;
+		report(RPT_ERR, "%s: epoll_wait failed - %s", __FUNCTION__, strerror(errno));
+		return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		int fd = (int)(events[i].data.u64 & 0xffffffff);
+		uint32_t gen = (uint32_t)(events[i].data.u64 >> 32);
+
+		if (gen == 0) {
+			// Reactor-owned helper descriptors
+			if (fd == timer_fd) {
+				uint64_t expirations;
+
+				if (read(timer_fd, &expirations, sizeof(expirations)) < 0 &&
+				    errno != EAGAIN)
+					report(RPT_ERR, "%s: timerfd read failed", __FUNCTION__);
+
+			} else if (fd == signal_fd) {
+				struct signalfd_siginfo si;
+
+				while (read(signal_fd, &si, sizeof(si)) == sizeof(si)) {
+					if (signal_handler != NULL)
+						signal_handler(si.ssi_signo);
+				}
+			}
+			continue;
+		}
+
+		// Skip events whose registration was removed earlier in this batch
+		if ((fd >= sources_size) || (sources[fd].handler == NULL) ||
+		    (sources[fd].gen != gen))
+			continue;
+
+		sources[fd].handler(fd, events[i].events, sources[fd].data);
+	}
+
+	return n;
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/event.h
+ * \brief Event loop (epoll reactor) interface for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Single epoll instance for all server file descriptors
+ * - Per-descriptor callback registration with opaque user data
+ * - Absolute CLOCK_MONOTONIC deadline via a timerfd
+ * - Synchronous signal delivery via a signalfd
+ * - Blocking dispatch that sleeps until I/O, a deadline or a signal is due
+ *
+ * \usage
+ * - Call event_init() once before sockets are created
+ * - Register sockets with event_add() and unregister with event_remove()
+ * - Route signals through event_watch_signals() instead of async handlers
+ * - Arm the next wakeup with event_set_deadline() before event_dispatch()
+ *
+ * \details The reactor replaces the former select()/usleep() polling in the
+ * main loop. An idle server blocks in epoll_wait() until a client sends data,
+ * the next frame deadline expires or a watched signal arrives.
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <signal.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <time.h>
+
+/**
+ * \brief Callback type for file descriptor events
+ * \param fd File descriptor that became ready
+ * \param events Ready event mask (EPOLLIN, EPOLLOUT, EPOLLHUP, ...)
+ * \param data Opaque pointer given at registration time
+ */
+typedef void (*EventHandler)(int fd, uint32_t events, void *data);
+
+/**
+ * \brief Callback type for signals delivered through the signalfd
+ * \param signum Number of the signal that was received
+ */
+typedef void (*EventSignalHandler)(int signum);
+
+/**
+ * \brief Initialize the event loop
+ * \retval 0 Success
+ * \retval <0 epoll or timerfd creation failed
+ *
+ * \details Creates the epoll instance and the deadline timerfd.
+ */
+int event_init(void);
+
+/**
+ * \brief Shut down the event loop
+ *
+ * \details Closes the epoll instance, the timerfd and the signalfd and
+ * releases all remaining registrations.
+ */
+void event_shutdown(void);
+
+/**
+ * \brief Register a file descriptor with the reactor
+ * \param fd File descriptor to watch
+ * \param events epoll event mask to wait for
+ * \param handler Callback invoked when the descriptor is ready
+ * \param data Opaque pointer passed to the callback
+ * \retval 0 Success
+ * \retval <0 Registration failed
+ */
+int event_add(int fd, uint32_t events, EventHandler handler, void *data);
+
+/**
+ * \brief Change the event mask of a registered file descriptor
+ * \param fd Registered file descriptor
+ * \param events New epoll event mask
+ * \retval 0 Success
+ * \retval <0 Descriptor not registered or epoll_ctl() failed
+ */
+int event_modify(int fd, uint32_t events);
+
+/**
+ * \brief Unregister a file descriptor from the reactor
+ * \param fd File descriptor to remove
+ * \retval 0 Success
+ * \retval <0 Descriptor was not registered
+ *
+ * \details Safe to call from inside a handler, also for descriptors that
+ * are still pending in the current dispatch round. The descriptor itself
+ * is not closed.
+ */
+int event_remove(int fd);
+
+/**
+ * \brief Deliver signals synchronously through the reactor
+ * \param mask Signals to watch (they get blocked for the process)
+ * \param handler Callback invoked for each received signal
+ * \retval 0 Success
+ * \retval <0 signalfd creation failed
+ */
+int event_watch_signals(const sigset_t *mask, EventSignalHandler handler);
+
+/**
+ * \brief Set the next wakeup deadline
+ * \param deadline Absolute CLOCK_MONOTONIC time, or NULL to disarm
+ *
+ * \details The deadline is one-shot. A deadline in the past makes the next
+ * event_dispatch() return immediately.
+ */
+void event_set_deadline(const struct timespec *deadline);
+
+/**
+ * \brief Wait for events and run their handlers
+ * \retval >=0 Number of events dispatched (deadline expiry included)
+ * \retval <0 epoll_wait() failed
+ *
+ * \details Blocks until at least one registered descriptor is ready, the
+ * deadline expires or a watched signal arrives. EINTR is reported as zero
+ * dispatched events.
+ */
+int event_dispatch(void);
+
+#endif
@@ -20,7 +20,7 @@
  * - Priority system implementation (screen keys > reserved keys > server keys)
  * - Automatic cleanup of key reservations on client disconnect
  * - Debug logging for all key operations and reservation state changes
- * - Thread-safe linked list operations for key reservation management
+ * - Hash table of reserved keys, dispatch cost independent of the number of reservations
  * - Memory management for key reservation structures and navigation key strings
  *
  * \usage
@@ -36,6 +36,11 @@
  *
  * \details Implementation of keypad and other input handling from users with
  * comprehensive key reservation system and intelligent routing for multi-client support.
+ *
+ * Reservations are grouped per key in a KeyEntry, found through a hash table
+ * keyed by the interned key name. Each reservation is also linked into the
+ * list of its client, so a disconnect releases its keys without scanning
+ * those of other clients.
  */
 
 #include <stdio.h>
@@ -44,8 +49,10 @@
 
 #include "shared/LL.h"
 #include "shared/configfile.h"
+#include "shared/intern.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
+#include "shared/strhash.h"
 
 /** \brief Include only type definitions from headers
  *
@@ -63,34 +70,78 @@
 #include "render.h"
 #include "screenlist.h"
 
+/**
+ * \brief All reservations of one key
+ */
+typedef struct KeyEntry {
+	const char *key; ///< Interned key name, also the key in keytable
+	ilist holders;	 ///< Reservations of the key, a single one if exclusive
+	ilist_link link; ///< Position in the list of all entries
+} KeyEntry;
+
 /** \name Global Input State
- * Key event queue and configurable key bindings for server actions
+ * Key reservations and configurable key bindings for server actions
  */
 ///@{
-LinkedList *keylist;	 ///< Queue of pending key events from input drivers
-char *toggle_rotate_key; ///< Key name to toggle automatic screen rotation
-char *prev_screen_key;	 ///< Key name to switch to previous screen
-char *next_screen_key;	 ///< Key name to switch to next screen
-char *scroll_up_key;	 ///< Key name to scroll menu/widget up
-char *scroll_down_key;	 ///< Key name to scroll menu/widget down
+static strhash *keytable;	      ///< KeyEntry of every reserved key
+static ilist keyentries;	      ///< All KeyEntry structures, for shutdown
+static ilist server_keys;	      ///< Reservations made by the server itself
+static const char *toggle_rotate_key; ///< Key name to toggle automatic screen rotation
+static const char *prev_screen_key;   ///< Key name to switch to previous screen
+static const char *next_screen_key;   ///< Key name to switch to next screen
+static const char *scroll_up_key;     ///< Key name to scroll menu/widget up
+static const char *scroll_down_key;   ///< Key name to scroll menu/widget down
 ///@}
 
 // Internal function for processing system-level key events
 void input_internal_key(const char *key);
 
+/**
+ * \brief Get the list of reservations made by a client
+ * \param client Client, NULL for the server
+ * \return The client's reservation list
+ */
+static ilist *input_client_keys(Client *client)
+{
+	return (client != NULL) ? &client->keys : &server_keys;
+}
+
+/**
+ * \brief Remove and free a reservation, and its key's entry with the last one
+ * \param entry Entry of the reserved key
+ * \param kr Reservation to drop
+ */
+static void input_drop_reservation(KeyEntry *entry, KeyReservation *kr)
+{
+	ilist_remove(&entry->holders, &kr->link);
+	ilist_remove(input_client_keys(kr->client), &kr->client_link);
+	free(kr);
+
+	if (entry->holders.count == 0) {
+		strhash_remove(keytable, entry->key);
+		ilist_remove(&keyentries, &entry->link);
+		intern_release(entry->key);
+		free(entry);
+	}
+}
+
 // Initialize the input handling system
 int input_init(void)
 {
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	keylist = LL_new();
+	keytable = strhash_create();
+	if (keytable == NULL)
+		return -1;
+	ilist_init(&keyentries);
+	ilist_init(&server_keys);
 
-	// Load server navigation keys from config with defaults
-	toggle_rotate_key = strdup(config_get_string("server", "ToggleRotateKey", 0, "Enter"));
-	prev_screen_key = strdup(config_get_string("server", "PrevScreenKey", 0, "Left"));
-	next_screen_key = strdup(config_get_string("server", "NextScreenKey", 0, "Right"));
-	scroll_up_key = strdup(config_get_string("server", "ScrollUpKey", 0, "Up"));
-	scroll_down_key = strdup(config_get_string("server", "ScrollDownKey", 0, "Down"));
+	// Load server navigation keys from config with defaults, interned for pointer compares
+	toggle_rotate_key = intern(config_get_string("server", "ToggleRotateKey", 0, "Enter"));
+	prev_screen_key = intern(config_get_string("server", "PrevScreenKey", 0, "Left"));
+	next_screen_key = intern(config_get_string("server", "NextScreenKey", 0, "Right"));
+	scroll_up_key = intern(config_get_string("server", "ScrollUpKey", 0, "Up"));
+	scroll_down_key = intern(config_get_string("server", "ScrollDownKey", 0, "Down"));
 
 	return 0;
 }
@@ -98,16 +149,23 @@ int input_init(void)
 // Shutdown the input handling system
 void input_shutdown()
 {
-	if (!keylist) {
-		return;
-	}
+	ilist_link *link;
+
+	// Dropping the last holder frees the entry, so look it up again each time
+	while ((link = ilist_first(&keyentries)) != NULL) {
+		KeyEntry *entry = ilist_entry(link, KeyEntry, link);
 
-	free(keylist);
-	free(toggle_rotate_key);
-	free(prev_screen_key);
-	free(next_screen_key);
-	free(scroll_up_key);
-	free(scroll_down_key);
+		input_drop_reservation(entry, ilist_entry(ilist_first(&entry->holders),
+							  KeyReservation, link));
+	}
+	strhash_destroy(keytable);
+	keytable = NULL;
+
+	intern_release(toggle_rotate_key);
+	intern_release(prev_screen_key);
+	intern_release(next_screen_key);
+	intern_release(scroll_up_key);
+	intern_release(scroll_down_key);
 }
 
 // Handle all available input events
@@ -131,7 +189,7 @@ void handle_input(void)
 
 		// Priority 1: Screen-specific keys from screen_add_key()
 		if (current_screen && screen_find_key(current_screen, key)) {
-			sock_printf(current_client->sock, "key %s %s\n", key, current_screen->id);
+			client_printf(current_client, "key %s %s\n", key, current_screen->id);
 			continue;
 		}
 
@@ -139,7 +197,7 @@ void handle_input(void)
 		kr = input_find_key(key, current_client);
 		if (kr && kr->client) {
 			debug(RPT_DEBUG, "%s: reserved key: \"%.40s\"", __FUNCTION__, key);
-			sock_printf(kr->client->sock, "key %s\n", key);
+			client_printf(kr->client, "key %s\n", key);
 		} else {
 			// Priority 3: Server internal navigation keys
 			debug(RPT_DEBUG, "%s: left over key: \"%.40s\"", __FUNCTION__, key);
@@ -163,7 +221,13 @@ void input_internal_key(const char *key)
 
 		// Server navigation keys
 	} else {
-		if (strcmp(key, toggle_rotate_key) == 0) {
+		// The navigation keys are interned, any other key has no atom of its own
+		const char *atom = intern_find(key);
+
+		if (atom == NULL) {
+			return;
+
+		} else if (atom == toggle_rotate_key) {
 			autorotate = !autorotate;
 			if (autorotate) {
 				server_msg("Rotate", 4);
@@ -171,15 +235,15 @@ void input_internal_key(const char *key)
 				server_msg("Hold", 4);
 			}
 
-		} else if (strcmp(key, prev_screen_key) == 0) {
+		} else if (atom == prev_screen_key) {
 			screenlist_goto_prev();
 			server_msg("Prev", 4);
 
-		} else if (strcmp(key, next_screen_key) == 0) {
+		} else if (atom == next_screen_key) {
 			screenlist_goto_next();
 			server_msg("Next", 4);
 
-		} else if (strcmp(key, scroll_up_key) == 0 || strcmp(key, scroll_down_key) == 0) {
+		} else if ((atom == scroll_up_key) || (atom == scroll_down_key)) {
 			/**
 			 * \todo Implement scroll up/scroll down functionality for server navigation
 			 *
@@ -208,25 +272,45 @@ void input_internal_key(const char *key)
 int input_reserve_key(const char *key, bool exclusive, Client *client)
 {
 	KeyReservation *kr;
+	KeyEntry *entry;
 
 	debug(RPT_DEBUG, "%s(key=\"%.40s\", exclusive=%d, client=[%d])", __FUNCTION__, key,
 	      exclusive, (client ? client->sock : -1));
 
 	// Check for conflicting reservations (either side exclusive = conflict)
-	for (kr = LL_GetFirst(keylist); kr != NULL; kr = LL_GetNext(keylist)) {
-		if (strcmp(kr->key, key) == 0) {
-			if (kr->exclusive || exclusive) {
-				return -1;
-			}
-		}
+	entry = strhash_get(keytable, key);
+	if (entry != NULL) {
+		kr = ilist_entry(ilist_first(&entry->holders), KeyReservation, link);
+		if (kr->exclusive || exclusive)
+			return -1;
 	}
 
-	// Create new reservation
+	// Create new reservation, and the key's entry if it is the first one
 	kr = malloc(sizeof(KeyReservation));
-	kr->key = strdup(key);
+	if (kr == NULL)
+		return -1;
+
+	if (entry == NULL) {
+		entry = malloc(sizeof(KeyEntry));
+		if (entry != NULL)
+			entry->key = intern(key);
+		if ((entry == NULL) || (entry->key == NULL) ||
+		    (strhash_insert(keytable, entry->key, entry) != 0)) {
+			if (entry != NULL)
+				intern_release(entry->key);
+			free(entry);
+			free(kr);
+			return -1;
+		}
+		ilist_init(&entry->holders);
+		ilist_push(&keyentries, &entry->link);
+	}
+
+	kr->key = entry->key;
 	kr->exclusive = exclusive;
 	kr->client = client;
-	LL_Push(keylist, kr);
+	ilist_push(&entry->holders, &kr->link);
+	ilist_push(input_client_keys(client), &kr->client_link);
 
 	report(RPT_INFO, "Key \"%.40s\" is now reserved %s by client [%d]", key,
 	       (exclusive ? "exclusively" : "shared"), (client ? client->sock : -1));
@@ -237,20 +321,22 @@ int input_reserve_key(const char *key, bool exclusive, Client *client)
 // Release a key reservation
 void input_release_key(const char *key, Client *client)
 {
+	KeyEntry *entry = strhash_get(keytable, key);
 	KeyReservation *kr;
 
 	debug(RPT_DEBUG, "%s(key=\"%.40s\", client=[%d])", __FUNCTION__, key,
 	      (client ? client->sock : -1));
 
-	for (kr = LL_GetFirst(keylist); kr != NULL; kr = LL_GetNext(keylist)) {
-		if ((kr->client == client) && (strcmp(kr->key, key) == 0)) {
+	if (entry == NULL)
+		return;
+
+	ilist_foreach(kr, &entry->holders, link) {
+		if (kr->client == client) {
 			report(RPT_INFO,
 			       "Key \"%.40s\" reserved %s by client [%d] and is now released", key,
 			       (kr->exclusive ? "exclusively" : "shared"),
 			       (client ? client->sock : -1));
-			free(kr->key);
-			free(kr);
-			LL_DeleteNode(keylist, NEXT);
+			input_drop_reservation(entry, kr);
 			return;
 		}
 	}
@@ -259,20 +345,15 @@ void input_release_key(const char *key, Client *client)
 // Release all key reservations for a client
 void input_release_client_keys(Client *client)
 {
-	KeyReservation *kr;
+	KeyReservation *kr, *next;
 
 	debug(RPT_DEBUG, "%s(client=[%d])", __FUNCTION__, (client ? client->sock : -1));
 
-	for (kr = LL_GetFirst(keylist); kr != NULL; kr = LL_GetNext(keylist)) {
-		if (kr->client == client) {
-			report(RPT_INFO,
-			       "Key \"%.40s\" reserved %s by client [%d] and is now released",
-			       kr->key, (kr->exclusive ? "exclusively" : "shared"),
-			       (client ? client->sock : -1));
-			free(kr->key);
-			free(kr);
-			LL_DeleteNode(keylist, PREV);
-		}
+	ilist_foreach_safe(kr, next, input_client_keys(client), client_link) {
+		report(RPT_INFO, "Key \"%.40s\" reserved %s by client [%d] and is now released",
+		       kr->key, (kr->exclusive ? "exclusively" : "shared"),
+		       (client ? client->sock : -1));
+		input_drop_reservation(strhash_get(keytable, kr->key), kr);
 	}
 }
 
@@ -280,16 +361,17 @@ void input_release_client_keys(Client *client)
 KeyReservation *input_find_key(const char *key, Client *client)
 {
 	KeyReservation *kr;
+	KeyEntry *entry;
 
-	debug(RPT_DEBUG, "%s(key=\"%.40s\", client=[%d])", __FUNCTION__, key,
-	      (client ? client->sock : -1));
+	// No debug() here: it formats a message per key press when DEBUG is defined
+	entry = strhash_get(keytable, key);
+	if (entry == NULL)
+		return NULL;
 
 	// Grant access if exclusive or client matches
-	for (kr = LL_GetFirst(keylist); kr != NULL; kr = LL_GetNext(keylist)) {
-		if (strcmp(kr->key, key) == 0) {
-			if (kr->exclusive || client == kr->client) {
-				return kr;
-			}
+	ilist_foreach(kr, &entry->holders, link) {
+		if (kr->exclusive || client == kr->client) {
+			return kr;
 		}
 	}
 	return NULL;
@@ -49,15 +49,18 @@
 #endif
 
 #include "shared/defines.h"
+#include "shared/ilist.h"
 
 /**
  * \brief Key reservation structure
  * \details Contains key name, exclusivity flag, and owning client
  */
 typedef struct KeyReservation {
-	char *key;	/**< Key name string */
-	bool exclusive; /**< True if key is exclusively reserved */
-	Client *client; /**< Owning client (NULL for server keys) */
+	const char *key;	/**< Key name string, interned */
+	bool exclusive;		/**< True if key is exclusively reserved */
+	Client *client;		/**< Owning client (NULL for server keys) */
+	ilist_link link;	/**< Position among the reservations of the key */
+	ilist_link client_link; /**< Position among the reservations of the client */
 } KeyReservation;
 
 /**
@@ -21,7 +21,8 @@
  * - Privilege dropping for security
  * - Driver initialization and management
  * - Network socket initialization
- * - Screen rendering and client polling
+ * - Event loop driven client I/O, frame deadlines and signal delivery
+ * - Optional render thread sending frames to the drivers off the main loop
  * - Server screen rotation and timing control
  *
  * \usage
@@ -61,6 +62,7 @@
 #include <math.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include <popt.h>
 
@@ -88,11 +90,13 @@
 
 #include "clients.h"
 #include "drivers.h"
+#include "event.h"
 #include "input.h"
 #include "main.h"
 #include "menuscreens.h"
 #include "parse.h"
 #include "render.h"
+#include "renderthread.h"
 #include "screen.h"
 #include "screenlist.h"
 #include "serverscreens.h"
@@ -288,12 +292,16 @@ int main(int argc, char **argv)
 		report(RPT_INFO, "Server running in foreground");
 	}
 
+	CHAIN(e, event_init());
+	CHAIN_END(e, "Critical error while initializing event loop, abort.");
+
 	install_signal_handlers(!foreground_mode);
 
 	CHAIN(e, sock_init(bind_addr, bind_port));
 	CHAIN(e, screenlist_init());
 	CHAIN(e, init_drivers());
 	CHAIN(e, clients_init());
+	CHAIN(e, parse_init());
 	CHAIN(e, input_init());
 	CHAIN(e, menuscreens_init());
 	CHAIN(e, server_screen_init());
@@ -304,6 +312,10 @@ int main(int argc, char **argv)
 	}
 
 	drop_privs(user);
+
+	CHAIN(e, renderthread_init());
+	CHAIN_END(e, "Critical error while starting the render thread, abort.");
+
 	do_mainloop();
 
 	return 0;
@@ -658,7 +670,8 @@ static void set_default_settings(void)
  * \param allow_reload Enable SIGHUP reload handler (1=yes, 0=no)
  *
  * \details Sets handlers for SIGINT/SIGTERM (exit), SIGPIPE (ignore),
- * and optionally SIGHUP (reload).
+ * and SIGHUP (exit). With reload enabled SIGHUP is instead delivered
+ * synchronously through the event loop's signalfd.
  */
 static void install_signal_handlers(int allow_reload)
 {
@@ -681,7 +694,14 @@ static void install_signal_handlers(int allow_reload)
 	sigaction(SIGTERM, &sa, NULL);
 
 	if (allow_reload) {
-		sa.sa_handler = catch_reload_signal;
+		sigset_t mask;
+
+		sigemptyset(&mask);
+		sigaddset(&mask, SIGHUP);
+		if (event_watch_signals(&mask, catch_reload_signal) == 0)
+			return;
+
+		report(RPT_WARNING, "Cannot watch SIGHUP, reload disabled");
 	}
 	sigaction(SIGHUP, &sa, NULL);
 }
@@ -836,6 +856,7 @@ static void do_reload(void)
 {
 	int e = 0;
 
+	renderthread_shutdown();
 	drivers_unload_all();
 	config_clear();
 	clear_settings();
@@ -854,51 +875,102 @@ static void do_reload(void)
 		  0));
 
 	CHAIN(e, init_drivers());
+	CHAIN(e, renderthread_init());
 	CHAIN_END(e, "Critical error while reloading, abort.");
+
+	// The new drivers start with an empty display
+	render_invalidate();
+}
+
+/**
+ * \brief Add microseconds to a timespec
+ * \param ts Time to advance
+ * \param usec Microseconds to add (may be negative)
+ */
+static void timespec_add_usec(struct timespec *ts, long usec)
+{
+	ts->tv_sec += usec / 1000000;
+	ts->tv_nsec += (usec % 1000000) * 1000;
+
+	if (ts->tv_nsec >= 1000000000) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000;
+	} else if (ts->tv_nsec < 0) {
+		ts->tv_sec--;
+		ts->tv_nsec += 1000000000;
+	}
+}
+
+/**
+ * \brief Compute a - b in microseconds
+ * \param a First time
+ * \param b Second time
+ * \return Difference in microseconds
+ */
+static long timespec_diff_usec(const struct timespec *a, const struct timespec *b)
+{
+	return (a->tv_sec - b->tv_sec) * 1000000L + (a->tv_nsec - b->tv_nsec) / 1000;
+}
+
+/**
+ * \brief Tell when the next frame changes the display
+ * \return Timer value of that frame, at least timer + 1
+ *
+ * \details Called before the main loop sleeps. Anything a client or key
+ * changes in the meantime wakes the loop and is seen on the next call.
+ */
+static long next_change(void)
+{
+	Screen *s = screenlist_current();
+
+	// The server screen is refreshed every frame, a held batch is released by frame count
+	if ((s == server_screen) || ((s != NULL) && client_batch_holds_render(s->client, timer)))
+		return timer + 1;
+
+	return min(render_next_change(s, timer), screenlist_next_change(timer));
 }
 
-// Main loop: process clients/input at PROCESS_FREQ Hz, render at frame_interval
+// Main loop: dispatch client I/O as it arrives, poll input at PROCESS_FREQ Hz and render at
+// frame_interval, sleeping in the event loop until the next deadline
 static void do_mainloop(void)
 {
 	Screen *s;
-	struct timeval t;
-	struct timeval last_t;
-	int sleeptime;
-	long int process_lag = 0;
-	long int render_lag = 0;
-	long int t_diff;
+	struct timespec now;
+	struct timespec next_frame;
+	struct timespec next_input;
+	struct timespec wake;
+	const struct timespec *deadline;
+	long frames;
+	int poll_input;
+	int backlog = 0;
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	gettimeofday(&t, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	next_frame = now;
+	next_input = now;
 
-	// Main event loop: calculate time delta, process clients/input when due, render screens
-	// when due, sleep remainder
+	// Input drivers cannot be watched by fd, so they are polled only if present
+	poll_input = drivers_have_input();
+
+	// Main event loop: handle due input and frames, arm the nearest deadline, sleep in the
+	// reactor until a socket, the deadline or a signal wakes us, then parse new commands
 	while (1) {
-		last_t = t;
-		gettimeofday(&t, NULL);
-		t_diff = t.tv_sec - last_t.tv_sec;
-		if (((t_diff + 1) > ((double)LONG_MAX / 1e6)) || (t_diff < 0)) {
-			t_diff = 0;
-			process_lag = 1;
-			render_lag = frame_interval;
-		} else {
-			t_diff *= 1e6;
-			t_diff += t.tv_usec - last_t.tv_usec;
-		}
-		process_lag += t_diff;
-		if (process_lag > 0) {
-			sock_poll_clients();
-			parse_all_client_messages();
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		if (poll_input && timespec_diff_usec(&now, &next_input) >= 0) {
 			handle_input();
 
-			process_lag = 0 - (1e6 / PROCESS_FREQ);
+			next_input = now;
+			timespec_add_usec(&next_input, 1000000L / PROCESS_FREQ);
 		}
 
-		render_lag += t_diff;
-		if (render_lag > 0) {
-			timer++;
-			screenlist_process();
+		if (timespec_diff_usec(&now, &next_frame) >= 0) {
+			// Frames slept through count as well, the timer follows the clock
+			frames = 1 + timespec_diff_usec(&now, &next_frame) / frame_interval;
+			timespec_add_usec(&next_frame, (frames - 1) * frame_interval);
+			timer += frames;
+			screenlist_process(frames);
 			s = screenlist_current();
 
 			/**
@@ -920,22 +992,38 @@ static void do_mainloop(void)
 			if (s == server_screen) {
 				update_server_screen();
 			}
-			render_screen(s, timer);
 
-			if (render_lag > frame_interval * MAX_RENDER_LAG_FRAMES) {
-				render_lag = frame_interval * MAX_RENDER_LAG_FRAMES;
-			}
-			render_lag -= frame_interval;
-		}
+			renderthread_begin_frame(&next_frame);
+
+			// Keep showing the last frame while the screen's client is inside a batch
+			if ((s == NULL) || !client_batch_holds_render(s->client, timer))
+				render_screen(s, timer);
 
-		sleeptime = min(0 - process_lag, 0 - render_lag);
-		if (sleeptime > 0) {
-			usleep(sleeptime);
+			timespec_add_usec(&next_frame, frame_interval);
 		}
 
+		// Sleep through the frames that would not change the display
+		wake = next_frame;
+		timespec_add_usec(&wake, min(next_change() - timer - 1, (long)MAX_IDLE_FRAMES - 1) *
+						 frame_interval);
+		deadline = &wake;
+		if (poll_input && timespec_diff_usec(&next_input, &wake) < 0)
+			deadline = &next_input;
+
+		// Commands left over from the last round must not wait for new input
+		if (backlog)
+			deadline = &now;
+
+		event_set_deadline(deadline);
+		event_dispatch();
+
+		// Stop parsing in time for the next frame
+		backlog = parse_all_client_messages(&next_frame);
+
 		if (got_reload_signal) {
 			got_reload_signal = 0;
 			do_reload();
+			poll_input = drivers_have_input();
 		}
 	}
 
@@ -1011,14 +1099,17 @@ static void exit_program(int val)
 		report_dest = DEFAULT_REPORTDEST;
 	set_reporting("LCDd", report_level, report_dest);
 
+	renderthread_shutdown();
 	goodbye_screen();
 	drivers_unload_all();
 
 	clients_shutdown();
+	parse_shutdown();
 	menuscreens_shutdown();
 	screenlist_shutdown();
 	input_shutdown();
 	sock_shutdown();
+	event_shutdown();
 
 	report(RPT_INFO, "Exiting.");
 	_exit(EXIT_SUCCESS);
@@ -1029,7 +1120,7 @@ static void exit_program(int val)
  * \param val Signal number (unused)
  *
  * \details Sets reload_flag which triggers config reload in main loop.
- * Async-signal-safe.
+ * Called from the event loop via signalfd, not in signal context.
  */
 static void catch_reload_signal(int val)
 {
@@ -24,7 +24,7 @@
  * \usage
  * - Include for access to global server state and configuration variables
  * - Reference for configuration variable names in command-line processing
- * - Use timing constants (PROCESS_FREQ, MAX_RENDER_LAG_FRAMES) for main loop
+ * - Use timing constants (PROCESS_FREQ, MAX_IDLE_FRAMES) for main loop
  * - Access default values for fallback configuration
  * - Reference driver arrays for multi-driver support
  * - Use UNSET_INT and UNSET_STR for configuration initialization
@@ -57,15 +57,17 @@ extern char *build_date;       /**< Build date information */
 #define PROCESS_FREQ 32
 
 /**
- * \brief Maximum allowed render lag in frame intervals
- * \details When rendering falls behind by more than this many frames,
- * slowdown occurs rather than trying to catch up
+ * \brief Longest sleep of an idle main loop in frame intervals
+ * \details The main loop sleeps through frames that would not change the
+ * display; frames missed while asleep or stalled are not drawn, the timer
+ * skips them.
  */
-#define MAX_RENDER_LAG_FRAMES 16
+#define MAX_IDLE_FRAMES 512
 
 /**
  * \brief Global timer counter
- * \details Incremented at render frequency, used for timing and animations.
+ * \details Counts frame intervals, including those the main loop slept
+ * through, used for timing and animations.
  * 32 bits at 8Hz will overflow in 2^29 = 5e8 seconds = 17 years.
  */
 extern long timer;
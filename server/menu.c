@@ -58,6 +58,7 @@
 #include "screen.h"
 #include "widget.h"
 
+#include "shared/intern.h"
 #include "shared/report.h"
 
 /** \brief User-configurable main menu (defined in menuscreens.c) */
@@ -96,8 +97,9 @@ static void *menu_get_subitem(Menu *menu, int index)
  * \param item_id char *item_id
  * \return Return value
  */
-static int menu_get_index_of(Menu *menu, char *item_id)
+static int menu_get_index_of(Menu *menu, const char *item_id)
 {
+	const char *atom = intern_find(item_id);
 	MenuItem *item;
 	int i = 0;
 
@@ -107,7 +109,7 @@ static int menu_get_index_of(Menu *menu, char *item_id)
 	for (item = LL_GetFirst(menu->data.menu.contents); item != NULL;
 	     item = LL_GetNext(menu->data.menu.contents)) {
 		if (!item->is_hidden) {
-			if (strcmp(item_id, item->id) == 0)
+			if (item->id == atom)
 				return i;
 			++i;
 		}
@@ -219,7 +221,7 @@ char *fill_labeled_value(char *string, int len, const char *text, const char *va
 }
 
 // Create new menu with specified properties
-Menu *menu_create(char *id, MenuEventFunc(*event_func), char *text, Client *client)
+Menu *menu_create(const char *id, MenuEventFunc(*event_func), const char *text, Client *client)
 {
 	Menu *new_menu;
 
@@ -314,25 +316,26 @@ MenuItem *menu_get_current_item(Menu *menu)
 					   : NULL);
 }
 
-// Find menu item by ID within menu
-MenuItem *menu_find_item(Menu *menu, char *id, bool recursive)
+/**
+ * \brief Find a menu item by interned id
+ * \param menu Menu to search
+ * \param atom Interned id
+ * \param recursive Also search submenus
+ * \retval NULL No such item
+ * \retval !NULL The menu itself or the matching item
+ */
+static MenuItem *menu_find_atom(Menu *menu, const char *atom, bool recursive)
 {
 	MenuItem *item;
 
-	debug(RPT_DEBUG, "%s(menu=[%s], id=\"%s\", recursive=%d)", __FUNCTION__,
-	      ((menu != NULL) ? menu->id : "(null)"), id, recursive);
-
-	if ((menu == NULL) || (id == NULL))
-		return NULL;
-	if (strcmp(menu->id, id) == 0)
+	if (menu->id == atom)
 		return menu;
 
 	for (item = menu_getfirst_item(menu); item != NULL; item = menu_getnext_item(menu)) {
-		if (strcmp(item->id, id) == 0) {
+		if (item->id == atom)
 			return item;
-		}
 		if (recursive && (item->type == MENUITEM_MENU)) {
-			MenuItem *res = menu_find_item(item, id, recursive);
+			MenuItem *res = menu_find_atom(item, atom, recursive);
 
 			if (res != NULL)
 				return res;
@@ -342,6 +345,25 @@ MenuItem *menu_find_item(Menu *menu, char *id, bool recursive)
 	return NULL;
 }
 
+// Find menu item by ID within menu
+MenuItem *menu_find_item(Menu *menu, const char *id, bool recursive)
+{
+	const char *atom;
+
+	debug(RPT_DEBUG, "%s(menu=[%s], id=\"%s\", recursive=%d)", __FUNCTION__,
+	      ((menu != NULL) ? menu->id : "(null)"), id, recursive);
+
+	if ((menu == NULL) || (id == NULL))
+		return NULL;
+
+	// An id no menu item uses is not interned, so the tree need not be walked
+	atom = intern_find(id);
+	if (atom == NULL)
+		return NULL;
+
+	return menu_find_atom(menu, atom, recursive);
+}
+
 // Set association data for menu
 void menu_set_association(Menu *menu, void *assoc)
 {
@@ -950,7 +972,7 @@ MenuResult menu_process_input(Menu *menu, MenuToken token, const char *key, unsi
 }
 
 // Position current item pointer on entry with given ID
-void menu_select_subitem(Menu *menu, char *item_id)
+void menu_select_subitem(Menu *menu, const char *item_id)
 {
 	int position;
 
@@ -71,7 +71,7 @@ typedef MenuItem Menu;
  * \retval Menu* Pointer to created menu
  * \retval NULL Creation failed
  */
-Menu *menu_create(char *id, MenuEventFunc(*event_func), char *text, Client *client);
+Menu *menu_create(const char *id, MenuEventFunc(*event_func), const char *text, Client *client);
 
 /**
  * \brief Deletes menu from memory
@@ -146,7 +146,7 @@ MenuItem *menu_get_current_item(Menu *menu);
  * \retval MenuItem* Found menu item
  * \retval NULL Item not found
  */
-MenuItem *menu_find_item(Menu *menu, char *id, bool recursive);
+MenuItem *menu_find_item(Menu *menu, const char *id, bool recursive);
 
 /**
  * \brief Sets the association member of a Menu
@@ -224,5 +224,5 @@ MenuResult menu_process_input(Menu *menu, MenuToken token, const char *key, unsi
  * \param menu Menu to modify
  * \param item_id Item identifier to select
  */
-void menu_select_subitem(Menu *menu, char *item_id);
+void menu_select_subitem(Menu *menu, const char *item_id);
 #endif
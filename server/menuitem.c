@@ -37,6 +37,7 @@
 #include <string.h>
 
 #include "shared/defines.h"
+#include "shared/intern.h"
 #include "shared/report.h"
 
 #include "drivers.h"
@@ -265,8 +266,8 @@ MenuResult (*process_input_table[NUM_ITEMTYPES])(MenuItem *item, MenuToken token
     menuitem_process_input_ip};
 
 // Create a generic menu item of specified type
-MenuItem *menuitem_create(MenuItemType type, char *id, MenuEventFunc(*event_func), char *text,
-			  Client *client)
+MenuItem *menuitem_create(MenuItemType type, const char *id, MenuEventFunc(*event_func),
+			  const char *text, Client *client)
 {
 	MenuItem *new_item;
 
@@ -285,7 +286,7 @@ MenuItem *menuitem_create(MenuItemType type, char *id, MenuEventFunc(*event_func
 	}
 
 	new_item->type = type;
-	new_item->id = strdup(id);
+	new_item->id = intern(id);
 	if (!new_item->id) {
 		report(RPT_ERR, "%s: Could not allocate memory", __FUNCTION__);
 		free(new_item);
@@ -299,7 +300,7 @@ MenuItem *menuitem_create(MenuItemType type, char *id, MenuEventFunc(*event_func
 	new_item->text = strdup(text);
 	if (!new_item->text) {
 		report(RPT_ERR, "%s: Could not allocate memory", __FUNCTION__);
-		free(new_item->id);
+		intern_release(new_item->id);
 		free(new_item);
 		return NULL;
 	}
@@ -593,7 +594,7 @@ void menuitem_destroy(MenuItem *item)
 			destructor(item);
 
 		free(item->text);
-		free(item->id);
+		intern_release(item->id);
 		free(item);
 	}
 }
@@ -1012,6 +1013,7 @@ void menuitem_update_screen(MenuItem *item, Screen *s)
 		return;
 
 	s->cursor = CURSOR_OFF;
+	screen_touch(s);
 	update_screen = update_screen_table[item->type];
 
 	if (update_screen) {
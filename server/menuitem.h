@@ -137,7 +137,7 @@ typedef enum MenuEventType {
  */
 typedef struct MenuItem {
 	MenuItemType type;	 // Type as defined above
-	char *id;		 // Internal name for client supplied menus
+	const char *id;		 // Internal name for client supplied menus, interned
 	char *successor_id;	 /// next menuitem after hitting "Enter" on this one.
 	char *predecessor_id;	 // next menuitem after hitting "Escape" on this one.
 	struct MenuItem *parent; // Parent of this menuitem
@@ -260,8 +260,8 @@ MenuItem *menuitem_search(char *menu_id, Client *client);
  * \retval NULL Creation failed
  * \warning Use type-specific creation functions instead of calling this directly
  */
-MenuItem *menuitem_create(MenuItemType type, char *id, MenuEventFunc(*event_func), char *text,
-			  Client *client);
+MenuItem *menuitem_create(MenuItemType type, const char *id, MenuEventFunc(*event_func),
+			  const char *text, Client *client);
 
 /**
  * \details For all constructor functions below the following parameter meanings apply:
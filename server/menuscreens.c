@@ -268,13 +268,13 @@ void menuscreen_switch_item(MenuItem *new_menuitem)
 	if (!old_menuitem && !new_menuitem) {
 
 	} else if (old_menuitem && !new_menuitem) {
-		menuscreen->priority = PRI_HIDDEN;
+		screenlist_set_priority(menuscreen, PRI_HIDDEN);
 
 	} else if (!old_menuitem && new_menuitem) {
 		menuitem_reset(active_menuitem);
 		menuitem_rebuild_screen(active_menuitem, menuscreen);
 
-		menuscreen->priority = PRI_INPUT;
+		screenlist_set_priority(menuscreen, PRI_INPUT);
 	} else {
 		if (old_menuitem->parent != new_menuitem) {
 			menuitem_reset(new_menuitem);
@@ -762,7 +762,9 @@ MenuEventFunc(contrast_handler)
 		Driver *driver = item->parent->data.menu.association;
 
 		if (driver != NULL) {
+			drivers_lock();
 			driver->set_contrast(driver, item->data.slider.value);
+			drivers_unlock();
 			report(RPT_INFO, "Menu: set contrast of [%.40s] to %d", driver->name,
 			       item->data.slider.value);
 		}
@@ -782,6 +784,7 @@ MenuEventFunc(brightness_handler)
 		Driver *driver = item->parent->data.menu.association;
 
 		if (driver != NULL) {
+			drivers_lock();
 			if (strcmp(item->id, "onbrightness") == 0) {
 				driver->set_brightness(driver, BACKLIGHT_ON,
 						       item->data.slider.value);
@@ -789,6 +792,7 @@ MenuEventFunc(brightness_handler)
 				driver->set_brightness(driver, BACKLIGHT_OFF,
 						       item->data.slider.value);
 			}
+			drivers_unlock();
 		}
 	}
 
@@ -9,11 +9,12 @@
  * \date 1999-2008
  *
  * \features
- * - Client message tokenization and parsing
+ * - In-place client message tokenization without copying or allocation
  * - Command argument extraction and validation
  * - Protocol command dispatching
  * - Quote handling for string arguments
  * - Multi-client message processing
+ * - Deficit round-robin scheduling with command and time budgets
  *
  * \usage
  * - State machine based parser for robust tokenization
@@ -25,7 +26,15 @@
  * \details Handles input commands from clients by splitting strings into tokens
  * and passing arguments to the appropriate handler. The parser works much like
  * a command line interface where only the first token is used to determine
- * what function to call.
+ * what function to call. Tokens are unescaped and NUL-terminated in place, so
+ * the argv handed to command handlers points straight into the client's
+ * receive buffer.
+ *
+ * Clients with buffered input wait in a run queue and are served in turns
+ * (deficit round-robin with one command as the unit of cost). A turn ends
+ * when the client used its quantum, ran out of complete lines or the
+ * per-call budget is exhausted; in the latter case the client stays at the
+ * head of the queue and keeps its remaining deficit for the next call.
  */
 
 #include "parse.h"
@@ -36,7 +45,9 @@
 #include <string.h>
 
 #include "commands/command_list.h"
-#include "shared/LL.h"
+#include "shared/ilist.h"
+#include "shared/configfile.h"
+#include "shared/defines.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
 
@@ -48,6 +59,24 @@
  */
 #define MAX_ARGUMENTS 40
 
+/** \brief Default maximum number of commands run per main loop iteration */
+#define DEFAULT_COMMAND_BUDGET 1024
+/** \brief Default number of commands a client may run per turn */
+#define DEFAULT_COMMAND_QUANTUM 32
+/** \brief Default time budget per main loop iteration in microseconds */
+#define DEFAULT_COMMAND_TIME_BUDGET 20000
+
+/** \name Command Scheduler State
+ * Run queue and budgets, see [server] in LCDd.conf
+ */
+///@{
+static ilist runqueue;					     ///< Clients with buffered input
+static int runqueue_open = 0;				     ///< Run queue initialized
+static int command_budget = DEFAULT_COMMAND_BUDGET;	     ///< CommandBudget setting
+static int command_quantum = DEFAULT_COMMAND_QUANTUM;	     ///< CommandQuantum setting
+static long command_time_budget = DEFAULT_COMMAND_TIME_BUDGET; ///< CommandTimeBudget setting
+///@}
+
 /**
  * \brief Check if character is whitespace
  * \param x Character to test
@@ -90,13 +119,16 @@ static inline int is_closing_quote(char x, char q)
 
 /**
  * \brief Parse a single client message and dispatch command
- * \param str Message string to parse
+ * \param str Message string to parse (modified in place)
  * \param c Client that sent the message
  *
  * \details Parses client protocol messages, tokenizes arguments, and dispatches
  * to appropriate command handlers. Supports quoted strings and escape sequences.
+ * Every input character yields at most one output character, so the arguments
+ * are compacted into str itself behind the read position, separated by single
+ * NUL bytes just like a separately built argument buffer.
  */
-static void parse_message(const char *str, Client *c)
+static void parse_message(char *str, Client *c)
 {
 	typedef enum { ST_INITIAL, ST_WHITESPACE, ST_ARGUMENT, ST_FINAL } State;
 	State state = ST_INITIAL;
@@ -104,16 +136,15 @@ static void parse_message(const char *str, Client *c)
 	int error = 0;
 	char quote = '\0';
 	int pos = 0;
-	char arg_space[strlen(str) + 1];
 	int argc = 0;
 	char *argv[MAX_ARGUMENTS];
 	int argpos = 0;
-	CommandFunc function = NULL;
+	const client_function *cmd = NULL;
 
 	debug(RPT_DEBUG, "%s(str=\"%.120s\", client=[%d])", __FUNCTION__, str, c->sock);
 
-	// Initialize argv[0] to point to start of argument buffer
-	argv[0] = arg_space;
+	// Arguments are written back into the message; writes never overtake reads
+	argv[0] = str;
 
 	// State machine loop processes each character until final state or error
 	while ((state != ST_FINAL) && !error) {
@@ -255,52 +286,168 @@ static void parse_message(const char *str, Client *c)
 
 	// Send parse error to client and abort processing
 	if (error) {
-		sock_send_error(c->sock, "Could not parse command\n");
+		client_send_error(c, "Could not parse command\n");
 		return;
 	}
 
 	// Look up command handler function by first argument
-	function = get_command_function(argv[0]);
+	cmd = get_command(argv[0]);
+
+	if (cmd != NULL) {
+		// Reject wrong argument counts centrally so handlers need not check
+		if (!command_args_valid(cmd, argc)) {
+			client_send_error(c, cmd->usage);
+			return;
+		}
 
-	if (function != NULL) {
 		// Execute command handler and report any errors
-		error = function(c, argc, argv);
+		error = cmd->function(c, argc, argv);
 		if (error) {
-			sock_printf_error(c->sock, "Function returned error \"%.40s\"\n", argv[0]);
+			client_printf_error(c, "Function returned error \"%.40s\"\n", argv[0]);
 			report(RPT_WARNING,
 			       "Command function returned an error after command from client on "
 			       "socket %d: %.40s",
-			       c->sock, str);
+			       c->sock, argv[0]);
 		}
 	} else {
 		// Unknown command - send error response
-		sock_printf_error(c->sock, "Invalid command \"%.40s\"\n", argv[0]);
+		client_printf_error(c, "Invalid command \"%.40s\"\n", argv[0]);
 		report(RPT_WARNING, "Invalid command from client on socket %d: %.40s", c->sock,
-		       str);
+		       argv[0]);
 	}
 }
 
-// Parse and process all pending client messages
-void parse_all_client_messages(void)
+// Read scheduler budgets and create the run queue
+int parse_init(void)
+{
+	ilist_init(&runqueue);
+	runqueue_open = 1;
+
+	command_budget = config_get_int("server", "CommandBudget", 0, DEFAULT_COMMAND_BUDGET);
+	command_budget = max(command_budget, 1);
+	command_quantum = config_get_int("server", "CommandQuantum", 0, DEFAULT_COMMAND_QUANTUM);
+	command_quantum = max(command_quantum, 1);
+	command_time_budget =
+	    config_get_int("server", "CommandTimeBudget", 0, DEFAULT_COMMAND_TIME_BUDGET);
+	command_time_budget = max(command_time_budget, 1000);
+
+	report(RPT_INFO, "%s: %d commands per iteration, %d per turn, %ld us", __FUNCTION__,
+	       command_budget, command_quantum, command_time_budget);
+
+	return 0;
+}
+
+// Release the run queue
+void parse_shutdown(void)
+{
+	Client *c, *next;
+
+	ilist_foreach_safe(c, next, &runqueue, runq_link) {
+		parse_forget_client(c);
+	}
+	runqueue_open = 0;
+}
+
+// Append a client with new input to the run queue
+void parse_schedule_client(Client *c)
+{
+	if (c->runnable || c->throttled || (c->state == GONE) || !runqueue_open)
+		return;
+
+	c->runnable = 1;
+	clock_gettime(CLOCK_MONOTONIC, &c->queued_at);
+	ilist_push(&runqueue, &c->runq_link);
+}
+
+// Drop a client from the run queue
+void parse_forget_client(Client *c)
+{
+	if (!c->runnable)
+		return;
+
+	ilist_remove(&runqueue, &c->runq_link);
+	c->runnable = 0;
+}
+
+/**
+ * \brief Microseconds from a to b
+ * \param a Start time
+ * \param b End time
+ * \return b - a in microseconds
+ */
+static long elapsed_usec(const struct timespec *a, const struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) * 1000000L + (b->tv_nsec - a->tv_nsec) / 1000;
+}
+
+// Run client commands in deficit round-robin turns until the queue or a budget runs out
+int parse_all_client_messages(const struct timespec *until)
 {
-	Client *c;
+	struct timespec now, stop;
+	int budget = command_budget;
+	ilist_link *link;
+	Client *c, *next;
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	// Iterate through all connected clients
-	for (c = clients_getfirst(); c != NULL; c = clients_getnext()) {
-		char *str;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	stop = now;
+	stop.tv_nsec += command_time_budget * 1000;
+	stop.tv_sec += stop.tv_nsec / 1000000000;
+	stop.tv_nsec %= 1000000000;
+	if ((until != NULL) && (elapsed_usec(until, &stop) > 0))
+		stop = *until;
+
+	// One turn per pass; the first turn runs even if the frame is already due
+	while ((link = ilist_first(&runqueue)) != NULL) {
+		char *str = NULL;
+		long wait;
+
+		c = ilist_entry(link, Client, runq_link);
+
+		// A client whose previous turn was cut short continues with its old deficit
+		if (c->deficit <= 0) {
+			c->deficit = command_quantum;
+			wait = elapsed_usec(&c->queued_at, &now);
+			c->wait_usec = wait;
+			c->wait_max_usec = max(c->wait_max_usec, wait);
+		}
 
-		// Process all queued messages for this client and stop processing if client
-		// disconnected
-		for (str = client_get_message(c); str != NULL; str = client_get_message(c)) {
+		while ((c->deficit > 0) && (budget > 0) && (c->state != GONE) && !c->throttled &&
+		       (str = client_get_message(c)) != NULL) {
 			parse_message(str, c);
-			free(str);
+			c->deficit--;
+			c->commands++;
+			budget--;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
 
-			if (c->state == GONE) {
+		if ((c->state == GONE) || c->throttled || (str == NULL && c->deficit > 0)) {
+			// Out of complete lines (or unable to continue): leave the queue
+			ilist_remove(&runqueue, &c->runq_link);
+			c->runnable = 0;
+			c->deficit = 0;
+			if (c->state == GONE)
 				sock_destroy_client_socket(c);
-				break;
-			}
+		} else if (c->deficit <= 0) {
+			// Quantum used up with input left: back of the queue
+			ilist_remove(&runqueue, &c->runq_link);
+			ilist_push(&runqueue, &c->runq_link);
+			c->queued_at = now;
+			c->deferred++;
 		}
+
+		if ((budget <= 0) || (elapsed_usec(&now, &stop) <= 0))
+			break;
 	}
+
+	// Clients may also be marked GONE outside the parser, e.g. on a failed write
+	for (c = clients_getfirst(); c != NULL; c = next) {
+		next = clients_getnext(c);
+		if (c->state == GONE)
+			sock_destroy_client_socket(c);
+	}
+
+	return (ilist_first(&runqueue) != NULL);
 }
@@ -12,6 +12,7 @@
  * - Protocol command interpretation
  * - Message queue management
  * - Client communication handling
+ * - Fair command scheduling across clients within a budget
  *
  * \usage
  * - Called from main server loop to process pending client messages
@@ -26,14 +27,57 @@
 #ifndef PARSE_H
 #define PARSE_H
 
+#include <time.h>
+
+/** \brief Include only type definitions from client.h */
+#define INC_TYPES_ONLY 1
+#include "client.h"
+#undef INC_TYPES_ONLY
+
+/**
+ * \brief Initialize the command scheduler
+ * \retval 0 Success
+ * \retval <0 Allocation failed
+ *
+ * \details Reads CommandBudget, CommandQuantum and CommandTimeBudget from
+ * the [server] section of the configuration.
+ */
+int parse_init(void);
+
+/**
+ * \brief Release the command scheduler
+ */
+void parse_shutdown(void);
+
+/**
+ * \brief Queue a client whose receive buffer got new data
+ * \param c Client to schedule
+ *
+ * \details Called by the socket layer after a read and when a throttled
+ * client resumes. A client that is already queued keeps its place.
+ */
+void parse_schedule_client(Client *c);
+
+/**
+ * \brief Remove a client from the run queue
+ * \param c Client that is about to be destroyed
+ */
+void parse_forget_client(Client *c);
+
 /**
- * \brief Parses and processes all pending client messages
+ * \brief Parses and processes pending client messages within a budget
+ * \param until Absolute CLOCK_MONOTONIC time to stop at, usually the next frame
+ * \retval 0 All complete messages were processed
+ * \retval 1 Messages are left over for the next call
  *
- * \details Processes all queued messages from connected clients,
- * parsing protocol commands and dispatching them to appropriate
- * handlers. This function is typically called from the main
- * server event loop.
+ * \details Clients take turns in deficit round-robin order: each turn a
+ * client may run up to CommandQuantum commands, and clients with input left
+ * go to the back of the run queue. The call stops once CommandBudget commands
+ * ran, CommandTimeBudget microseconds passed or until is reached, whichever
+ * comes first, so a chatty client can neither starve others nor delay the
+ * next frame. At least one turn runs per call, so input always makes
+ * progress. Clients marked GONE are destroyed.
  */
-void parse_all_client_messages(void);
+int parse_all_client_messages(const struct timespec *until);
 
 #endif
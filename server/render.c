@@ -16,6 +16,7 @@
  * - Display hardware abstraction
  * - Heartbeat and cursor management
  * - Server message display
+ * - Skipping of frames whose content and animations have not changed
  *
  * \usage
  * - Supports various widget types (strings, bars, icons, etc.)
@@ -26,7 +27,14 @@
  * \details This file contains code that actually generates the full screen data to
  * send to the LCD. render_screen() takes a screen definition and calls
  * render_frame() which in turn builds the screen according to the definition.
- * It may recursively call itself (for nested frames). THIS FILE IS MESSY!
+ * It may recursively call itself (for nested frames).
+ *
+ * A frame is only drawn when the screen differs from the last one drawn, its
+ * version was bumped by screen_touch(), the backlight, heartbeat or output
+ * state changed, or an animation is due. Scrolling widgets, blinking
+ * backlights, the heartbeat and server messages report the timer value at
+ * which their output changes next while they are drawn, so a static screen
+ * costs no work per tick. THIS FILE IS MESSY!
  * Anyone care to rewrite it nicely? Please?? Multiple screen sizes? Multiple
  * simultaneous screens? Horrors of horrors... next thing you know it'll be
  * making coffee... Better believe it'll take a while to do...
@@ -62,6 +70,7 @@
 #include "config.h"
 #endif
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -75,6 +84,7 @@
 #include "render.h"
 #include "screen.h"
 #include "screenlist.h"
+#include "shmvalues.h"
 #include "widget.h"
 
 /** \brief Buffer size for string formatting operations */
@@ -94,6 +104,57 @@ char *server_msg_text;			      ///< Server message text to display
 int server_msg_expire = 0;		      ///< Frame count when server message expires
 ///@}
 
+/** \name Last Rendered Frame
+ * What the displays currently show, used to skip unchanged frames
+ */
+///@{
+static const Screen *rendered_screen = NULL; ///< Screen drawn last
+static unsigned long rendered_version = 0;   ///< Its version at that time
+static int rendered_backlight = -1;	     ///< Effective backlight state drawn
+static int rendered_heartbeat = -1;	     ///< Effective heartbeat state drawn
+static int rendered_output = -1;	     ///< Output state sent to drivers
+static long render_next_due = 0;	     ///< Timer value of the next animation step
+///@}
+
+/**
+ * \brief Note when a time-driven widget changes next
+ * \param timer Current timer value
+ * \param speed Ticks per step if positive, steps per tick if negative, 0 for static
+ *
+ * \details Called while a frame is drawn; the earliest reported step
+ * decides when the screen has to be drawn again.
+ */
+static void render_due(long timer, int speed)
+{
+	long due;
+
+	if (speed == 0)
+		return;
+
+	due = (speed > 0) ? (timer / speed + 1) * speed : timer + 1;
+	if (due < render_next_due)
+		render_next_due = due;
+}
+
+/**
+ * \brief Pull shared-memory values into bound widgets
+ * \param list Widget list to scan, frames are scanned recursively
+ *
+ * \details Runs before the skip check so that a changed slot touches the
+ * screen and gets drawn in the same frame.
+ */
+static void render_poll_values(ilist *list)
+{
+	Widget *w;
+
+	ilist_foreach(w, list, link) {
+		if (w->shm_slot >= 0)
+			shm_values_apply(w);
+		if ((w->type == WID_FRAME) && (w->frame_screen != NULL))
+			render_poll_values(&w->frame_screen->widgets);
+	}
+}
+
 /**
  * \brief Renders frame containers with nested widgets
  * \param list Widget list to render
@@ -109,7 +170,7 @@ int server_msg_expire = 0;		      ///< Frame count when server message expires
  *
  * \details Supports recursion and scrolling for nested frame widgets.
  */
-static void render_frame(LinkedList *list, int left, int top, int right, int bottom, int fwid,
+static void render_frame(ilist *list, int left, int top, int right, int bottom, int fwid,
 			 int fhgt, char fscroll, int fspeed, long timer);
 
 /**
@@ -156,64 +217,110 @@ static void render_pbar(Widget *w, int left, int top, int right, int bottom);
 static void render_title(Widget *w, int left, int top, int right, int bottom, long timer);
 static void render_num(Widget *w, int left, int top, int right, int bottom);
 
+/**
+ * \brief Effective backlight state of a screen
+ * \param s Screen
+ * \return Backlight state, by priority server > client > screen > fallback
+ */
+static int render_backlight_state(const Screen *s)
+{
+	if (backlight != BACKLIGHT_OPEN)
+		return backlight;
+	if ((s->client != NULL) && (s->client->backlight != BACKLIGHT_OPEN))
+		return s->client->backlight;
+	if (s->backlight != BACKLIGHT_OPEN)
+		return s->backlight;
+	return backlight_fallback;
+}
+
+/**
+ * \brief Effective heartbeat state of a screen
+ * \param s Screen
+ * \return Heartbeat state, by priority server > client > screen > fallback
+ */
+static int render_heartbeat_state(const Screen *s)
+{
+	if (heartbeat != HEARTBEAT_OPEN)
+		return heartbeat;
+	if ((s->client != NULL) && (s->client->heartbeat != HEARTBEAT_OPEN))
+		return s->client->heartbeat;
+	if (s->heartbeat != HEARTBEAT_OPEN)
+		return s->heartbeat;
+	return heartbeat_fallback;
+}
+
+/**
+ * \brief Check whether the displays already show a screen as it is now
+ * \param s Screen
+ * \param backlight_state Effective backlight state of s
+ * \param heartbeat_state Effective heartbeat state of s
+ * \retval 1 s is the screen drawn last and nothing it depends on changed
+ * \retval 0 s has to be drawn
+ */
+static int render_is_current(const Screen *s, int backlight_state, int heartbeat_state)
+{
+	return (s == rendered_screen) && (s->version == rendered_version) &&
+	       (backlight_state == rendered_backlight) && (heartbeat_state == rendered_heartbeat) &&
+	       (output_state == rendered_output);
+}
+
 // Render complete screen with backlight, heartbeat, and display effects
 int render_screen(Screen *s, long timer)
 {
-	int tmp_state = 0;
+	int backlight_state;
+	int heartbeat_state;
+
+	if (s == NULL)
+		return -1;
+
+	backlight_state = render_backlight_state(s);
+	heartbeat_state = render_heartbeat_state(s);
+
+	if ((s->client != NULL) && (s->client->shm_base != NULL))
+		render_poll_values(&s->widgets);
+
+	// Nothing to do if the displays already show this frame
+	if (render_is_current(s, backlight_state, heartbeat_state) && (timer < render_next_due))
+		return 0;
 
 	debug(RPT_DEBUG, "%s(screen=[%.40s], timer=%ld)  ==== START RENDERING ====", __FUNCTION__,
 	      s->id, timer);
 
-	if (s == NULL)
-		return -1;
+	render_next_due = LONG_MAX;
 
 	drivers_clear();
 
-	// Determine backlight priority: server > client > screen > fallback
-	if (backlight != BACKLIGHT_OPEN) {
-		tmp_state = backlight;
-	} else if ((s->client != NULL) && (s->client->backlight != BACKLIGHT_OPEN)) {
-		tmp_state = s->client->backlight;
-	} else if (s->backlight != BACKLIGHT_OPEN) {
-		tmp_state = s->backlight;
-	} else {
-		tmp_state = backlight_fallback;
-	}
-
 	// Apply backlight effect based on mode
-	if (tmp_state & BACKLIGHT_FLASH) {
-		drivers_backlight(((tmp_state & BACKLIGHT_ON) ^ ((timer & 7) == 7))
+	if (backlight_state & BACKLIGHT_FLASH) {
+		drivers_backlight(((backlight_state & BACKLIGHT_ON) ^ ((timer & 7) == 7))
 				      ? BACKLIGHT_ON
 				      : BACKLIGHT_OFF);
-	} else if (tmp_state & BACKLIGHT_BLINK) {
-		drivers_backlight(((tmp_state & BACKLIGHT_ON) ^ ((timer & 14) == 14))
+		render_due(timer, -1);
+	} else if (backlight_state & BACKLIGHT_BLINK) {
+		drivers_backlight(((backlight_state & BACKLIGHT_ON) ^ ((timer & 14) == 14))
 				      ? BACKLIGHT_ON
 				      : BACKLIGHT_OFF);
+		render_due(timer, -1);
 	} else {
-		drivers_backlight(tmp_state & BACKLIGHT_ON);
+		drivers_backlight(backlight_state & BACKLIGHT_ON);
 	}
 
 	drivers_output(output_state);
 
-	render_frame(s->widgetlist, 0, 0, display_props->width, display_props->height, s->width,
+	render_frame(&s->widgets, 0, 0, display_props->width, display_props->height, s->width,
 		     s->height, 'v', max(s->duration / s->height, 1), timer);
 
+	// Drivers may blink the cursor themselves
 	drivers_cursor(s->cursor_x, s->cursor_y, s->cursor);
+	if (s->cursor != CURSOR_OFF)
+		render_due(timer, -1);
 
-	// Determine heartbeat priority: server > client > screen > fallback
-	if (heartbeat != HEARTBEAT_OPEN) {
-		tmp_state = heartbeat;
-	} else if ((s->client != NULL) && (s->client->heartbeat != HEARTBEAT_OPEN)) {
-		tmp_state = s->client->heartbeat;
-	} else if (s->heartbeat != HEARTBEAT_OPEN) {
-		tmp_state = s->heartbeat;
-	} else {
-		tmp_state = heartbeat_fallback;
-	}
-
-	drivers_heartbeat(tmp_state);
+	// The heart is animated from the global timer
+	drivers_heartbeat(heartbeat_state);
+	if (heartbeat_state == HEARTBEAT_ON)
+		render_due(timer, -1);
 
-	// Display server message if not expired
+	// Display server message if not expired; the frame after the last one clears it
 	if (server_msg_expire > 0) {
 		drivers_string(display_props->width - strlen(server_msg_text) + 1,
 			       display_props->height, server_msg_text);
@@ -221,20 +328,42 @@ int render_screen(Screen *s, long timer)
 		if (server_msg_expire == 0) {
 			free(server_msg_text);
 		}
+		render_due(timer, -1);
 	}
 
 	drivers_flush();
 
+	rendered_screen = s;
+	rendered_version = s->version;
+	rendered_backlight = backlight_state;
+	rendered_heartbeat = heartbeat_state;
+	rendered_output = output_state;
+
 	debug(RPT_DEBUG, "==== END RENDERING ====");
 
 	return 0;
 }
 
+// Force the next render_screen() call to draw
+void render_invalidate(void) { render_next_due = 0; }
+
+// Timer value at which render_screen() has to draw s next
+long render_next_change(const Screen *s, long timer)
+{
+	// Shared-memory values change without a command, they are polled per frame
+	if ((s == NULL) || ((s->client != NULL) && (s->client->shm_base != NULL)) ||
+	    !render_is_current(s, render_backlight_state(s), render_heartbeat_state(s)))
+		return timer + 1;
+
+	return max(render_next_due, timer + 1);
+}
+
 // Render frame container with nested widgets (supports recursion and scrolling)
-static void render_frame(LinkedList *list, int left, int top, int right, int bottom, int fwid,
+static void render_frame(ilist *list, int left, int top, int right, int bottom, int fwid,
 			 int fhgt, char fscroll, int fspeed, long timer)
 {
 	int fy = 0;
+	Widget *w;
 
 	debug(RPT_DEBUG,
 	      "%s(list=%p, left=%d, top=%d, "
@@ -252,6 +381,7 @@ static void render_frame(LinkedList *list, int left, int top, int right, int bot
 
 			fy = (fspeed > 0) ? (timer / fspeed) % fy_max : (-fspeed * timer) % fy_max;
 			fy = max(fy, 0);
+			render_due(timer, fspeed);
 
 			debug(RPT_DEBUG, "%s: fy=%d", __FUNCTION__, fy);
 		}
@@ -276,15 +406,8 @@ static void render_frame(LinkedList *list, int left, int top, int right, int bot
 		 */
 	}
 
-	LL_Rewind(list);
-
 	// Iterate through all widgets and render each by type
-	do {
-		Widget *w = (Widget *)LL_Get(list);
-
-		if (w == NULL)
-			return;
-
+	ilist_foreach(w, list, link) {
 		switch (w->type) {
 
 		// Text string widget
@@ -365,7 +488,7 @@ static void render_frame(LinkedList *list, int left, int top, int right, int bot
 			int new_bottom = min(top + w->bottom, bottom);
 
 			if ((new_left < right) && (new_top < bottom)) {
-				render_frame(w->frame_screen->widgetlist, new_left, new_top,
+				render_frame(&w->frame_screen->widgets, new_left, new_top,
 					     new_right, new_bottom, w->width, w->height, w->length,
 					     w->speed, timer);
 			}
@@ -383,8 +506,7 @@ static void render_frame(LinkedList *list, int left, int top, int right, int bot
 		default:
 			break;
 		}
-
-	} while (LL_Next(list) == 0);
+	}
 }
 
 // Render text string widget at specified position
@@ -606,6 +728,8 @@ static void render_title(Widget *w, int left, int top, int right, int bottom, lo
 		int reverse;
 		int x;
 
+		render_due(timer, -1);
+
 		if ((delay != 0) && (delay < length / (length - width)))
 			offset /= delay;
 
@@ -671,6 +795,7 @@ static void render_scroller(Widget *w, int left, int top, int right, int bottom,
 
 		gap = screen_width / 2;
 		length += gap;
+		render_due(timer, w->speed);
 
 		if (w->speed > 0) {
 			necessaryTimeUnits = length * w->speed;
@@ -712,6 +837,8 @@ static void render_scroller(Widget *w, int left, int top, int right, int bottom,
 		} else {
 			int effLength = length - screen_width;
 
+			render_due(timer, w->speed);
+
 			if (w->speed > 0) {
 				necessaryTimeUnits = effLength * w->speed;
 				if (((timer / necessaryTimeUnits) % 2) == 0) {
@@ -803,6 +930,8 @@ static void render_scroller(Widget *w, int left, int top, int right, int bottom,
 				    length, screen_width, lines_required, available_lines,
 				    effLines);
 
+				render_due(timer, w->speed);
+
 				if (w->speed > 0) {
 					necessaryTimeUnits = effLines * w->speed;
 					if (((timer / necessaryTimeUnits) % 2) == 0) {
@@ -892,6 +1021,7 @@ int server_msg(const char *text, int expire)
 	strncat(server_msg_text, text, msg_size - strlen(server_msg_text) - 1);
 
 	server_msg_expire = expire;
+	render_invalidate();
 
 	return 0;
 }
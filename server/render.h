@@ -88,10 +88,32 @@ extern int output_state; ///< Current output state
  * \retval <0 Rendering failed
  *
  * \details Converts the logical screen representation to physical
- * display output, handling widgets, text positioning, and effects.
+ * display output, handling widgets, text positioning, and effects. Returns
+ * without touching the drivers if s is the screen drawn last, its version
+ * is unchanged and none of its animations has reached its next step.
  */
 int render_screen(Screen *s, long timer);
 
+/**
+ * \brief Make the next render_screen() call draw unconditionally
+ *
+ * \details Needed when the displays lost their content behind the
+ * renderer's back, e.g. after the drivers were reloaded.
+ */
+void render_invalidate(void);
+
+/**
+ * \brief Tell when a screen has to be drawn next
+ * \param s Screen the next frame will show, may be NULL
+ * \param timer Timer value of the last frame
+ * \return Timer value of the next frame that changes the display, at least timer + 1
+ *
+ * \details Assumes nothing changes the screen in the meantime. The main loop
+ * sleeps until then while no client sends anything, so an idle display
+ * does not wake the server every frame.
+ */
+long render_next_change(const Screen *s, long timer);
+
 /**
  * \brief Displays a short server message
  * \param text Message text (must be shorter than 16 characters)
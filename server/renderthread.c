@@ -0,0 +1,592 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/renderthread.c
+ * \brief Optional render thread owning the drivers
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Frames recorded as driver calls with their strings copied into the frame
+ * - Three frame buffers: recorded, published and being sent
+ * - Publishing swaps two pointers, the main loop never waits for a USB write
+ * - Frames sent by the render thread as soon as they are published
+ * - Key polling on the render thread, keys handed over through a small queue
+ * - Macro LED changes queued to the render thread, driver info cached at start
+ * - Frame timing statistics reported on shutdown
+ *
+ * \usage
+ * - Enabled with RenderThread=yes in the [Server] section of LCDd.conf
+ * - See renderthread.h for the calls made by main.c and drivers.c
+ *
+ * \details render_screen() draws every frame from scratch, starting with
+ * drivers_clear(), so a recorded frame is a complete snapshot of the
+ * display that does not refer to any screen or widget. The main loop owns
+ * the frame being recorded, the render thread the frame being sent; the
+ * published frame in between is only touched under the lock. A frame
+ * published while the previous one waits to be sent replaces it.
+ *
+ * The main loop renders when a frame is due and publishes it at once, so
+ * the frame leaves without waiting for the write of the previous one. The
+ * deadline is kept to report how late frames were sent.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shared/configfile.h"
+#include "shared/defines.h"
+#include "shared/report.h"
+
+#include "drivers.h"
+#include "main.h"
+#include "renderthread.h"
+
+/** \brief Number of keys the queue holds */
+#define KEY_QUEUE_SIZE 16
+
+/** \brief Longest key name kept in the queue, including the NUL */
+#define KEY_NAME_SIZE 32
+
+/** \brief Text offset of an absent string argument */
+#define NO_TEXT -1
+
+/**
+ * \brief One recorded driver call
+ */
+typedef struct DrawOp {
+	DrawOpType type; ///< Driver call
+	int x;		 ///< Column
+	int y;		 ///< Row
+	int arg[3];	 ///< Integer arguments
+	int text[2];	 ///< Offsets of the string arguments in the frame text, or NO_TEXT
+} DrawOp;
+
+/**
+ * \brief One recorded frame
+ */
+typedef struct Frame {
+	DrawOp *ops;	     ///< Recorded driver calls
+	int count;	     ///< Used entries in ops
+	int size;	     ///< Allocated entries in ops
+	char *text;	     ///< String arguments, NUL-terminated one after the other
+	size_t text_len;     ///< Used bytes in text
+	size_t text_size;    ///< Allocated bytes in text
+	int broken;	     ///< Recording ran out of memory
+	struct timespec due; ///< Deadline of the frame, zero if it has none
+} Frame;
+
+/** \name Frame Buffers
+ * back is recorded by the main loop, front sent by the render thread;
+ * ready and ready_fresh are protected by lock
+ */
+///@{
+static Frame frames[3];	      ///< Storage of the three frames
+static Frame *back = NULL;    ///< Frame being recorded
+static Frame *ready = NULL;   ///< Last published frame
+static Frame *front = NULL;   ///< Frame being sent
+static int ready_fresh = 0;   ///< ready has not been sent yet
+///@}
+
+/** \name Thread State
+ */
+///@{
+static pthread_t thread;				 ///< The render thread
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER; ///< Protects ready and the key queue
+static pthread_cond_t wakeup;				 ///< Signalled on publish and stop
+static int stopping = 0;				 ///< Render thread must exit
+static bool running = false;				 ///< Render thread was started
+static _Thread_local bool recording = false;		 ///< Calling thread records
+static long poll_interval = 0;				 ///< Key poll period, 0 without input
+static char *info = NULL;				 ///< drivers_get_info() at start
+static bool have_macro_leds = false;			 ///< A driver has macro LEDs
+///@}
+
+/** \name Macro LEDs
+ * Last state set by a client, protected by lock
+ */
+///@{
+static int leds[4];	     ///< M1, M2, M3 and MR
+static int leds_fresh = 0; ///< leds have not been sent yet
+///@}
+
+/** \name Key Queue
+ * Keys polled by the render thread, protected by lock
+ */
+///@{
+static char keys[KEY_QUEUE_SIZE][KEY_NAME_SIZE]; ///< Queued key names
+static int key_head = 0;			 ///< Oldest queued key
+static int key_count = 0;			 ///< Number of queued keys
+static char key_taken[KEY_NAME_SIZE];		 ///< Key returned to handle_input()
+///@}
+
+/** \name Statistics
+ * Reported by renderthread_shutdown() once the render thread has exited
+ */
+///@{
+static unsigned long frames_sent = 0;	  ///< Frames sent to the drivers
+static unsigned long frames_replaced = 0; ///< Frames replaced before they were sent (under lock)
+static long max_late = 0;		  ///< Largest delay past the deadline in us
+///@}
+
+/**
+ * \brief Microseconds from a to b
+ * \param a Start time
+ * \param b End time
+ * \return b - a in microseconds
+ */
+static long elapsed_usec(const struct timespec *a, const struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) * 1000000L + (b->tv_nsec - a->tv_nsec) / 1000;
+}
+
+/**
+ * \brief Add microseconds to a time
+ * \param ts Time to advance
+ * \param usec Microseconds to add (non-negative)
+ */
+static void add_usec(struct timespec *ts, long usec)
+{
+	ts->tv_sec += usec / 1000000;
+	ts->tv_nsec += (usec % 1000000) * 1000;
+	if (ts->tv_nsec >= 1000000000) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000;
+	}
+}
+
+// Empty a frame, keeping its buffers
+static void frame_reset(Frame *f)
+{
+	f->count = 0;
+	f->text_len = 0;
+	f->broken = 0;
+	f->due.tv_sec = 0;
+	f->due.tv_nsec = 0;
+}
+
+// Release the buffers of a frame
+static void frame_free(Frame *f)
+{
+	free(f->ops);
+	free(f->text);
+	memset(f, 0, sizeof(Frame));
+}
+
+/**
+ * \brief Copy a string argument into a frame
+ * \param f Frame being recorded
+ * \param s String or NULL
+ * \return Offset of the copy in f->text, or NO_TEXT
+ */
+static int frame_add_text(Frame *f, const char *s)
+{
+	size_t len;
+	int offset;
+
+	if ((s == NULL) || f->broken)
+		return NO_TEXT;
+
+	len = strlen(s) + 1;
+	if (f->text_len + len > f->text_size) {
+		size_t size = max(max(f->text_size * 2, f->text_len + len), 256);
+		char *text = realloc(f->text, size);
+
+		if (text == NULL) {
+			f->broken = 1;
+			return NO_TEXT;
+		}
+		f->text = text;
+		f->text_size = size;
+	}
+
+	offset = f->text_len;
+	memcpy(f->text + offset, s, len);
+	f->text_len += len;
+
+	return offset;
+}
+
+/**
+ * \brief Replay a frame on the drivers and flush them
+ * \param f Frame to send
+ */
+static void frame_send(const Frame *f)
+{
+	for (int i = 0; i < f->count; i++) {
+		const DrawOp *op = &f->ops[i];
+		char *s1 = (op->text[0] != NO_TEXT) ? f->text + op->text[0] : NULL;
+		char *s2 = (op->text[1] != NO_TEXT) ? f->text + op->text[1] : NULL;
+
+		switch (op->type) {
+		case DRAW_CLEAR:
+			drivers_clear();
+			break;
+		case DRAW_STRING:
+			drivers_string(op->x, op->y, s1);
+			break;
+		case DRAW_CHR:
+			drivers_chr(op->x, op->y, (char)op->arg[0]);
+			break;
+		case DRAW_VBAR:
+			drivers_vbar(op->x, op->y, op->arg[0], op->arg[1], op->arg[2]);
+			break;
+		case DRAW_HBAR:
+			drivers_hbar(op->x, op->y, op->arg[0], op->arg[1], op->arg[2]);
+			break;
+		case DRAW_PBAR:
+			drivers_pbar(op->x, op->y, op->arg[0], op->arg[1], s1, s2);
+			break;
+		case DRAW_NUM:
+			drivers_num(op->x, op->arg[0]);
+			break;
+		case DRAW_HEARTBEAT:
+			drivers_heartbeat(op->arg[0]);
+			break;
+		case DRAW_ICON:
+			drivers_icon(op->x, op->y, op->arg[0]);
+			break;
+		case DRAW_CURSOR:
+			drivers_cursor(op->x, op->y, op->arg[0]);
+			break;
+		case DRAW_BACKLIGHT:
+			drivers_backlight(op->arg[0]);
+			break;
+		case DRAW_OUTPUT:
+			drivers_output(op->arg[0]);
+			break;
+		}
+	}
+
+	drivers_flush();
+}
+
+/**
+ * \brief Take the published frame and send it
+ *
+ * \details Called by the render thread with lock held; the lock is dropped
+ * while the drivers are busy.
+ */
+static void renderthread_send(void)
+{
+	Frame *f = front;
+	struct timespec now;
+
+	front = ready;
+	ready = f;
+	ready_fresh = 0;
+	pthread_mutex_unlock(&lock);
+
+	if (front->due.tv_sec != 0) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		max_late = max(max_late, elapsed_usec(&front->due, &now));
+	}
+
+	drivers_lock();
+	frame_send(front);
+	drivers_unlock();
+	frames_sent++;
+
+	pthread_mutex_lock(&lock);
+}
+
+/**
+ * \brief Send the last macro LED state to the drivers
+ *
+ * \details Called by the render thread with lock held; the lock is dropped
+ * while the drivers are busy.
+ */
+static void renderthread_send_leds(void)
+{
+	int m[4];
+
+	memcpy(m, leds, sizeof(m));
+	leds_fresh = 0;
+	pthread_mutex_unlock(&lock);
+
+	drivers_set_macro_leds(m[0], m[1], m[2], m[3]);
+
+	pthread_mutex_lock(&lock);
+}
+
+/**
+ * \brief Move pressed keys from the drivers to the queue
+ *
+ * \details Called by the render thread with lock held; the lock is dropped
+ * while the drivers are polled.
+ */
+static void renderthread_poll_keys(void)
+{
+	const char *key;
+
+	pthread_mutex_unlock(&lock);
+	drivers_lock();
+
+	while ((key = drivers_get_key()) != NULL) {
+		pthread_mutex_lock(&lock);
+		if (key_count < KEY_QUEUE_SIZE) {
+			char *slot = keys[(key_head + key_count) % KEY_QUEUE_SIZE];
+
+			strncpy(slot, key, KEY_NAME_SIZE - 1);
+			slot[KEY_NAME_SIZE - 1] = '\0';
+			key_count++;
+		} else {
+			report(RPT_WARNING, "%s: key queue full, dropped key %.40s", __FUNCTION__,
+			       key);
+		}
+		pthread_mutex_unlock(&lock);
+	}
+
+	drivers_unlock();
+	pthread_mutex_lock(&lock);
+}
+
+/**
+ * \brief Render thread: send published frames when due and poll the keys
+ * \param arg Unused
+ * \return NULL
+ */
+static void *renderthread_main(void *arg)
+{
+	struct timespec now, next_poll;
+
+	(void)arg;
+
+	clock_gettime(CLOCK_MONOTONIC, &next_poll);
+
+	pthread_mutex_lock(&lock);
+	while (!stopping) {
+		if (leds_fresh) {
+			renderthread_send_leds();
+			continue;
+		}
+
+		if (ready_fresh) {
+			renderthread_send();
+			continue;
+		}
+
+		if (poll_interval > 0) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			if (elapsed_usec(&next_poll, &now) >= 0) {
+				renderthread_poll_keys();
+				next_poll = now;
+				add_usec(&next_poll, poll_interval);
+				continue;
+			}
+			pthread_cond_timedwait(&wakeup, &lock, &next_poll);
+		} else {
+			pthread_cond_wait(&wakeup, &lock);
+		}
+	}
+
+	// The last frame, e.g. the goodbye screen, must not get lost
+	if (leds_fresh)
+		renderthread_send_leds();
+	if (ready_fresh)
+		renderthread_send();
+	pthread_mutex_unlock(&lock);
+
+	return NULL;
+}
+
+// Start the render thread if RenderThread is enabled
+int renderthread_init(void)
+{
+	if (!config_get_bool("Server", "RenderThread", 0, 0))
+		return 0;
+
+	return renderthread_start();
+}
+
+// Start the render thread, the calling thread records from now on
+int renderthread_start(void)
+{
+	pthread_condattr_t attr;
+	sigset_t all, old;
+	int err;
+
+	if (running)
+		return 0;
+
+	for (int i = 0; i < 3; i++)
+		frame_reset(&frames[i]);
+	back = &frames[0];
+	ready = &frames[1];
+	front = &frames[2];
+	ready_fresh = 0;
+	stopping = 0;
+	key_head = key_count = 0;
+	frames_sent = frames_replaced = 0;
+	max_late = 0;
+	poll_interval = drivers_have_input() ? 1000000L / PROCESS_FREQ : 0;
+	have_macro_leds = drivers_have_macro_leds();
+	leds_fresh = 0;
+	info = strdup(drivers_get_info());
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&wakeup, &attr);
+	pthread_condattr_destroy(&attr);
+
+	// Signals stay with the main loop's signalfd
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	err = pthread_create(&thread, NULL, renderthread_main, NULL);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+	if (err != 0) {
+		report(RPT_ERR, "%s: cannot create render thread: %s", __FUNCTION__, strerror(err));
+		pthread_cond_destroy(&wakeup);
+		free(info);
+		info = NULL;
+		return -1;
+	}
+
+	running = true;
+	recording = true;
+	report(RPT_INFO, "%s: render thread started", __FUNCTION__);
+
+	return 0;
+}
+
+// Send the last frame, stop the render thread and draw directly again
+void renderthread_shutdown(void)
+{
+	if (!running)
+		return;
+
+	pthread_mutex_lock(&lock);
+	stopping = 1;
+	pthread_cond_signal(&wakeup);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(thread, NULL);
+	pthread_cond_destroy(&wakeup);
+	running = false;
+	recording = false;
+
+	for (int i = 0; i < 3; i++)
+		frame_free(&frames[i]);
+	free(info);
+	info = NULL;
+
+	report(RPT_INFO, "%s: %lu frames sent, %lu replaced before sending, up to %ld us late",
+	       __FUNCTION__, frames_sent, frames_replaced, max_late);
+}
+
+// Check whether the calling thread records frames
+bool renderthread_recording(void) { return recording; }
+
+// Start a new frame due at the given time
+void renderthread_begin_frame(const struct timespec *due)
+{
+	if (!recording)
+		return;
+
+	frame_reset(back);
+	back->due = *due;
+}
+
+// Append a driver call to the frame being recorded
+void renderthread_record(DrawOpType type, int x, int y, int a, int b, int c, const char *s1,
+			 const char *s2)
+{
+	DrawOp *op;
+
+	if (back->broken)
+		return;
+
+	if (back->count == back->size) {
+		int size = (back->size > 0) ? back->size * 2 : 64;
+		DrawOp *ops = realloc(back->ops, size * sizeof(DrawOp));
+
+		if (ops == NULL) {
+			back->broken = 1;
+			return;
+		}
+		back->ops = ops;
+		back->size = size;
+	}
+
+	op = &back->ops[back->count];
+	op->type = type;
+	op->x = x;
+	op->y = y;
+	op->arg[0] = a;
+	op->arg[1] = b;
+	op->arg[2] = c;
+	op->text[0] = frame_add_text(back, s1);
+	op->text[1] = frame_add_text(back, s2);
+
+	if (!back->broken)
+		back->count++;
+}
+
+// Hand the recorded frame to the render thread
+void renderthread_publish(void)
+{
+	Frame *f;
+
+	if (back->broken) {
+		report(RPT_WARNING, "%s: out of memory, frame dropped", __FUNCTION__);
+		frame_reset(back);
+		return;
+	}
+
+	pthread_mutex_lock(&lock);
+	if (ready_fresh)
+		frames_replaced++;
+	f = ready;
+	ready = back;
+	back = f;
+	ready_fresh = 1;
+	pthread_cond_signal(&wakeup);
+	pthread_mutex_unlock(&lock);
+
+	frame_reset(back);
+}
+
+// Queue a macro LED change for the render thread
+int renderthread_set_macro_leds(int m1, int m2, int m3, int mr)
+{
+	if (!have_macro_leds)
+		return -1;
+
+	pthread_mutex_lock(&lock);
+	leds[0] = m1;
+	leds[1] = m2;
+	leds[2] = m3;
+	leds[3] = mr;
+	leds_fresh = 1;
+	pthread_cond_signal(&wakeup);
+	pthread_mutex_unlock(&lock);
+
+	return 0;
+}
+
+// Return the driver info taken when the render thread started
+const char *renderthread_get_info(void) { return (info != NULL) ? info : ""; }
+
+// Take the oldest key from the queue
+const char *renderthread_get_key(void)
+{
+	const char *key = NULL;
+
+	pthread_mutex_lock(&lock);
+	if (key_count > 0) {
+		memcpy(key_taken, keys[key_head], KEY_NAME_SIZE);
+		key_head = (key_head + 1) % KEY_QUEUE_SIZE;
+		key_count--;
+		key = key_taken;
+	}
+	pthread_mutex_unlock(&lock);
+
+	return key;
+}
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/renderthread.h
+ * \brief Optional render thread owning the drivers
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Frames drawn by the main loop are recorded as lists of driver calls
+ * - Finished frames are published to a render thread that replays them
+ * - Frames sent without the main loop waiting for the display write
+ * - Key input polled by the render thread and queued for handle_input()
+ *
+ * \usage
+ * - Call renderthread_init() after the drivers are loaded; it starts the
+ *   thread if RenderThread is enabled in the [Server] section
+ * - Call renderthread_begin_frame() with the frame deadline before rendering
+ * - drivers.c records into the current frame while renderthread_recording()
+ *   is true and publishes it on drivers_flush()
+ * - Call renderthread_shutdown() before unloading or reloading the drivers
+ *
+ * \details Only the thread that started the render thread records. The
+ * render thread calls the same drivers_* functions to replay a frame and
+ * then reaches the drivers. Macro LED changes are queued to the render
+ * thread and the driver info is taken once at start, as clients expect
+ * both to answer without waiting for a frame to be written. Contrast and
+ * brightness go straight to the drivers from the main loop under
+ * drivers_lock().
+ */
+
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <stdbool.h>
+#include <time.h>
+
+/**
+ * \brief Driver calls that can be recorded into a frame
+ */
+typedef enum {
+	DRAW_CLEAR,	///< drivers_clear()
+	DRAW_STRING,	///< drivers_string(x, y, s1)
+	DRAW_CHR,	///< drivers_chr(x, y, a)
+	DRAW_VBAR,	///< drivers_vbar(x, y, a, b, c)
+	DRAW_HBAR,	///< drivers_hbar(x, y, a, b, c)
+	DRAW_PBAR,	///< drivers_pbar(x, y, a, b, s1, s2)
+	DRAW_NUM,	///< drivers_num(x, a)
+	DRAW_HEARTBEAT, ///< drivers_heartbeat(a)
+	DRAW_ICON,	///< drivers_icon(x, y, a)
+	DRAW_CURSOR,	///< drivers_cursor(x, y, a)
+	DRAW_BACKLIGHT, ///< drivers_backlight(a)
+	DRAW_OUTPUT,	///< drivers_output(a)
+} DrawOpType;
+
+/**
+ * \brief Start the render thread if the configuration asks for it
+ * \retval 0 Success, also when the thread is disabled
+ * \retval <0 Thread could not be started
+ */
+int renderthread_init(void);
+
+/**
+ * \brief Start the render thread
+ * \retval 0 Success
+ * \retval <0 Thread creation failed
+ *
+ * \details The calling thread records frames from now on. Published frames
+ * are sent as soon as the render thread is done with the previous one.
+ */
+int renderthread_start(void);
+
+/**
+ * \brief Send the last published frame and stop the render thread
+ *
+ * \details Afterwards drivers_* calls reach the drivers directly again.
+ * Does nothing if the thread is not running.
+ */
+void renderthread_shutdown(void);
+
+/**
+ * \brief Check whether the calling thread records frames
+ * \retval true drivers_* calls are recorded
+ * \retval false drivers_* calls go to the drivers
+ */
+bool renderthread_recording(void);
+
+/**
+ * \brief Start a new frame
+ * \param due Deadline of the frame (CLOCK_MONOTONIC)
+ *
+ * \details Discards anything recorded since the last published frame. Does
+ * nothing if the calling thread does not record.
+ */
+void renderthread_begin_frame(const struct timespec *due);
+
+/**
+ * \brief Append a driver call to the current frame
+ * \param type Driver call
+ * \param x Column
+ * \param y Row
+ * \param a First integer argument
+ * \param b Second integer argument
+ * \param c Third integer argument
+ * \param s1 First string argument or NULL
+ * \param s2 Second string argument or NULL
+ *
+ * \details Strings are copied. See DrawOpType for the meaning of the
+ * arguments per call.
+ */
+void renderthread_record(DrawOpType type, int x, int y, int a, int b, int c, const char *s1,
+			 const char *s2);
+
+/**
+ * \brief Publish the current frame to the render thread
+ *
+ * \details Replaces a published frame the render thread has not sent yet.
+ */
+void renderthread_publish(void);
+
+/**
+ * \brief Queue a macro LED change for the render thread
+ * \param m1 M1 LED state
+ * \param m2 M2 LED state
+ * \param m3 M3 LED state
+ * \param mr MR LED state
+ * \retval 0 Queued
+ * \retval -1 No driver has macro LEDs
+ *
+ * \details Only the last state queued before the render thread gets to it
+ * is sent. Errors of the driver are reported, not returned.
+ */
+int renderthread_set_macro_leds(int m1, int m2, int m3, int mr);
+
+/**
+ * \brief Return the driver info taken when the render thread started
+ * \return Info string, empty if the drivers have none
+ */
+const char *renderthread_get_info(void);
+
+/**
+ * \brief Take the next key polled by the render thread
+ * \retval NULL No key pressed
+ * \retval !NULL Key name, valid until the next call
+ */
+const char *renderthread_get_key(void);
+
+#endif
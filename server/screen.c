@@ -16,6 +16,8 @@
  * - Key reservation and lookup
  * - Client association and ownership
  * - Menu system integration
+ * - Content versions for skipping unchanged frames
+ * - Hashed widget id lookup covering nested frames
  *
  * \usage
  * - Screen lifecycle management functions
@@ -37,7 +39,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "shared/arena.h"
+#include "shared/intern.h"
 #include "shared/report.h"
+#include "shared/strhash.h"
 
 #include "clients.h"
 #include "drivers.h"
@@ -53,6 +58,9 @@
 ///@{
 int default_duration = 0; ///< Default screen display duration (0 = infinite)
 int default_timeout = -1; ///< Default screen timeout (-1 = never timeout)
+
+/** \brief Last version handed out by screen_touch(), shared by all screens */
+static unsigned long screen_generation = 0;
 ///@}
 
 /** \brief Priority level name strings
@@ -67,6 +75,7 @@ char *pri_names[] = {
 // Create new screen with default properties and menu integration
 Screen *screen_create(char *id, Client *client)
 {
+	arena *a = (client != NULL) ? client->arena : NULL;
 	Screen *s;
 
 	debug(RPT_DEBUG, "%s(id=\"%.40s\", client=[%d])", __FUNCTION__, id,
@@ -77,16 +86,17 @@ Screen *screen_create(char *id, Client *client)
 		return NULL;
 	}
 
-	s = calloc(sizeof(Screen), 1);
+	s = arena_zalloc(a, sizeof(Screen));
 	if (s == NULL) {
 		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
 		return NULL;
 	}
+	s->arena = a;
 
-	s->id = strdup(id);
+	s->id = intern(id);
 	if (s->id == NULL) {
 		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
-		free(s);
+		arena_free(a, s);
 		return NULL;
 	}
 
@@ -101,14 +111,9 @@ Screen *screen_create(char *id, Client *client)
 	s->cursor = CURSOR_OFF;
 	s->cursor_x = 1;
 	s->cursor_y = 1;
+	screen_touch(s);
 
-	s->widgetlist = LL_new();
-	if (s->widgetlist == NULL) {
-		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
-		free(s->id);
-		free(s);
-		return NULL;
-	}
+	ilist_init(&s->widgets);
 
 	menuscreen_add_screen(s);
 
@@ -118,36 +123,114 @@ Screen *screen_create(char *id, Client *client)
 // Destroy screen and free all associated resources
 void screen_destroy(Screen *s)
 {
-	Widget *w;
+	Widget *w, *next;
 
 	debug(RPT_DEBUG, "%s(s=[%.40s])", __FUNCTION__, s->id);
 
 	menuscreen_remove_screen(s);
 	screenlist_remove(s);
 
-	for (w = LL_GetFirst(s->widgetlist); w; w = LL_GetNext(s->widgetlist)) {
+	ilist_foreach_safe(w, next, &s->widgets, link) {
 		widget_destroy(w);
 	}
-	LL_Destroy(s->widgetlist);
+	strhash_destroy(s->widgetindex);
 
-	if (s->id != NULL)
-		free(s->id);
+	intern_release(s->id);
+	arena_free(s->arena, s->name);
+	arena_free(s->arena, s->keys);
+	arena_free(s->arena, s);
+}
 
-	if (s->name != NULL)
-		free(s->name);
+// Unregister a screen and its frames, leaving the memory to the client's arena
+void screen_discard(Screen *s)
+{
+	Widget *w;
+
+	debug(RPT_DEBUG, "%s(s=[%.40s])", __FUNCTION__, s->id);
+
+	menuscreen_remove_screen(s);
+	screenlist_remove(s);
+
+	ilist_foreach(w, &s->widgets, link) {
+		intern_release(w->id);
+		if ((w->type == WID_FRAME) && (w->frame_screen != NULL))
+			screen_discard(w->frame_screen);
+	}
+	strhash_destroy(s->widgetindex);
+	s->widgetindex = NULL;
+	intern_release(s->id);
+}
+
+/**
+ * \brief Add a widget and, for frames, everything inside it to an id index
+ * \param index Index of the top-level screen
+ * \param w Widget to add
+ * \retval 0 Success
+ * \retval <0 The id of w is already taken or memory ran out
+ */
+static int screen_index_add(strhash *index, Widget *w)
+{
+	Widget *sub;
+
+	if (strhash_insert(index, w->id, w) != 0)
+		return -1;
+
+	if ((w->type == WID_FRAME) && (w->frame_screen != NULL)) {
+		ilist_foreach(sub, &w->frame_screen->widgets, link) {
+			if (screen_index_add(index, sub) < 0)
+				report(RPT_WARNING, "%s: duplicate widget id %.40s in frame %.40s",
+				       __FUNCTION__, sub->id, w->id);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * \brief Remove a widget and, for frames, everything inside it from an id index
+ * \param index Index of the top-level screen
+ * \param w Widget to remove
+ */
+static void screen_index_remove(strhash *index, Widget *w)
+{
+	Widget *sub;
 
-	if (s->keys != NULL)
-		free(s->keys);
+	if (strhash_get(index, w->id) == w)
+		strhash_remove(index, w->id);
 
-	free(s);
+	if ((w->type == WID_FRAME) && (w->frame_screen != NULL)) {
+		ilist_foreach(sub, &w->frame_screen->widgets, link) {
+			screen_index_remove(index, sub);
+		}
+	}
 }
 
-// Add widget to screen's widget list
+// Add widget to screen's widget list and the top-level screen's id index
 int screen_add_widget(Screen *s, Widget *w)
 {
+	Screen *top = s;
+
 	debug(RPT_DEBUG, "%s(s=[%.40s], widget=[%.40s])", __FUNCTION__, s->id, w->id);
 
-	LL_Push(s->widgetlist, (void *)w);
+	while (top->parent != NULL)
+		top = top->parent;
+
+	if (top->widgetindex == NULL) {
+		top->widgetindex = strhash_create();
+		if (top->widgetindex == NULL) {
+			report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
+			return -1;
+		}
+	}
+
+	if (screen_index_add(top->widgetindex, w) < 0) {
+		report(RPT_WARNING, "%s: widget id %.40s already used on screen %.40s",
+		       __FUNCTION__, w->id, top->id);
+		return -1;
+	}
+
+	ilist_push(&s->widgets, &w->link);
+	screen_touch(s);
 
 	return 0;
 }
@@ -155,16 +238,39 @@ int screen_add_widget(Screen *s, Widget *w)
 // Remove widget from screen's widget list (does not destroy widget)
 int screen_remove_widget(Screen *s, Widget *w)
 {
+	Screen *top = s;
+
 	debug(RPT_DEBUG, "%s(s=[%.40s], widget=[%.40s])", __FUNCTION__, s->id, w->id);
 
-	LL_Remove(s->widgetlist, (void *)w, NEXT);
+	while (top->parent != NULL)
+		top = top->parent;
+
+	if (!ilist_linked(&w->link))
+		return -1;
+
+	ilist_remove(&s->widgets, &w->link);
+
+	if (top->widgetindex != NULL)
+		screen_index_remove(top->widgetindex, w);
+	screen_touch(s);
 
 	return 0;
 }
 
-// Find widget by ID (searches recursively in frame widgets)
+// Give the top-level screen a new content version
+void screen_touch(Screen *s)
+{
+	while (s->parent != NULL)
+		s = s->parent;
+
+	s->version = ++screen_generation;
+}
+
+// Find widget by ID in the screen and its frames using the top-level index
 Widget *screen_find_widget(Screen *s, char *id)
 {
+	Screen *top;
+	Screen *owner;
 	Widget *w;
 
 	if (!s)
@@ -174,20 +280,26 @@ Widget *screen_find_widget(Screen *s, char *id)
 
 	debug(RPT_DEBUG, "%s(s=[%.40s], id=\"%.40s\")", __FUNCTION__, s->id, id);
 
-	// Widget search loop with recursive frame traversal for nested container support
-	for (w = LL_GetFirst(s->widgetlist); w != NULL; w = LL_GetNext(s->widgetlist)) {
-		if (0 == strcmp(w->id, id)) {
-			debug(RPT_DEBUG, "%s: Found %s", __FUNCTION__, id);
-			return w;
-		}
-		if (w->type == WID_FRAME) {
-			w = widget_search_subs(w, id);
-			if (w != NULL)
-				return w;
-		}
+	for (top = s; top->parent != NULL; top = top->parent)
+		;
+
+	if (top->widgetindex == NULL)
+		return NULL;
+
+	w = strhash_get(top->widgetindex, id);
+
+	// A frame's sub-screen only sees the widgets inside that frame
+	for (owner = (w != NULL) ? w->screen : NULL; (owner != NULL) && (owner != s);
+	     owner = owner->parent)
+		;
+
+	if (owner == NULL) {
+		debug(RPT_DEBUG, "%s: Not found", __FUNCTION__);
+		return NULL;
 	}
-	debug(RPT_DEBUG, "%s: Not found", __FUNCTION__);
-	return NULL;
+
+	debug(RPT_DEBUG, "%s: Found %s", __FUNCTION__, id);
+	return w;
 }
 
 // Test if key is reserved by screen
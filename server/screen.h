@@ -42,11 +42,14 @@
 #ifndef SCREEN_H_TYPES
 #define SCREEN_H_TYPES
 
-// Include linked list implementation
+// Include linked list implementations
 #include "shared/LL.h"
+#include "shared/ilist.h"
 
 // Forward declaration of Client to avoid circular dependency
 struct Client;
+struct strhash;
+struct arena;
 
 /**
  * \brief Screen priority levels
@@ -68,7 +71,7 @@ typedef enum {
  * Contains all properties and widgets associated with the screen.
  */
 typedef struct Screen {
-	char *id;		// Unique screen identifier
+	const char *id;		// Unique screen identifier, interned
 	char *name;		// Human-readable screen name
 	int width, height;	// Screen dimensions
 	int duration;		// Display duration in deciseconds
@@ -81,8 +84,13 @@ typedef struct Screen {
 	short int cursor_y;	// Cursor Y position
 	char *keys;		// Reserved key list
 	int keys_size;		// Size of keys buffer
-	LinkedList *widgetlist; // List of widgets on this screen
-	struct Client *client;	// Client that owns this screen
+	ilist widgets;		     // Widgets on this screen, linked through Widget.link
+	struct strhash *widgetindex; // Widget ids of this screen and its frames, top level only
+	struct Client *client;	     // Client that owns this screen
+	struct arena *arena;	     // Allocator of the screen and its widgets, NULL for the heap
+	struct Screen *parent;	     // Screen holding the frame widget, NULL at top level
+	unsigned long version;	     // Content version, see screen_touch()
+	ilist_link link;	     // Position in the global screen list, unlinked if not listed
 } Screen;
 
 /** \brief Default screen duration in deciseconds
@@ -136,6 +144,7 @@ typedef struct Client Client;
  * \retval NULL Creation failed
  *
  * \details Creates and initializes a new screen with default properties.
+ * The screen and its widgets are allocated from the client's arena.
  */
 Screen *screen_create(char *id, Client *client);
 
@@ -148,6 +157,17 @@ Screen *screen_create(char *id, Client *client);
  */
 void screen_destroy(Screen *s);
 
+/**
+ * \brief Unregisters a screen of a disconnecting client
+ * \param s Screen to discard, also handles the frames inside it
+ *
+ * \details Removes the screen from the screen list and the menu, frees its
+ * id index and drops the interned ids of the screen and its widgets, but
+ * leaves their memory alone: it is released together with the client's
+ * arena.
+ */
+void screen_discard(Screen *s);
+
 /**
  * \brief Add a widget to a screen
  * \param s Target screen
@@ -155,7 +175,9 @@ void screen_destroy(Screen *s);
  * \retval 0 Success
  * \retval <0 Addition failed
  *
- * \details Adds a widget to the screen's widget list.
+ * \details Adds a widget to the screen's widget list and its id to the
+ * index of the top-level screen, which also covers all frames. Fails if
+ * the id is already used anywhere on the top-level screen.
  */
 int screen_add_widget(Screen *s, Widget *w);
 
@@ -166,11 +188,24 @@ int screen_add_widget(Screen *s, Widget *w);
  * \retval 0 Success
  * \retval <0 Removal failed
  *
- * \details Removes a widget from the screen's widget list.
- * Does not destroy the widget itself.
+ * \details Removes a widget from the screen's widget list and the id
+ * index; for a frame, the ids of the widgets inside it are dropped from the
+ * index as well. Does not destroy the widget itself.
  */
 int screen_remove_widget(Screen *s, Widget *w);
 
+/**
+ * \brief Mark a screen's content as changed
+ * \param s Screen whose widgets or properties were modified
+ *
+ * \details Gives the top-level screen a new version from a server-wide
+ * counter; frame sub-screens pass the change on to the screen holding the
+ * frame. render_screen() skips screens whose version has not changed since
+ * they were last drawn, so every change to displayed content must be
+ * followed by a call to this function.
+ */
+void screen_touch(Screen *s);
+
 /**
  * \brief Get first widget from screen
  * \param s Screen to query
@@ -181,21 +216,26 @@ int screen_remove_widget(Screen *s, Widget *w);
  */
 static inline Widget *screen_getfirst_widget(Screen *s)
 {
-	return (Widget *)((s != NULL) ? LL_GetFirst(s->widgetlist) : NULL);
+	ilist_link *link = (s != NULL) ? ilist_first(&s->widgets) : NULL;
+
+	return (link != NULL) ? ilist_entry(link, Widget, link) : NULL;
 }
 
 /**
- * \brief Get next widget from screen
+ * \brief Get the widget following another on its screen
  * \param s Screen to query
+ * \param w Current widget, on s
  * \retval Widget* Next widget
  * \retval NULL No more widgets or invalid screen
  *
- * \details Returns the next widget in the screen's widget list.
- * Must be called after screen_getfirst_widget().
+ * \details The position is held by the caller, so loops over the same
+ * screen may nest.
  */
-static inline Widget *screen_getnext_widget(Screen *s)
+static inline Widget *screen_getnext_widget(Screen *s, Widget *w)
 {
-	return (Widget *)((s != NULL) ? LL_GetNext(s->widgetlist) : NULL);
+	ilist_link *link = (s != NULL) ? ilist_next(&s->widgets, &w->link) : NULL;
+
+	return (link != NULL) ? ilist_entry(link, Widget, link) : NULL;
 }
 
 /**
@@ -205,7 +245,9 @@ static inline Widget *screen_getnext_widget(Screen *s)
  * \retval Widget* Found widget
  * \retval NULL Widget not found
  *
- * \details Searches the screen's widget list for a widget with the given ID.
+ * \details Looks the id up in the top-level screen's hash index, so the
+ * cost does not grow with the number of widgets. Called on a frame's
+ * sub-screen, only widgets inside that frame are found.
  */
 Widget *screen_find_widget(Screen *s, char *id);
 
@@ -21,20 +21,23 @@
  * - Screen addition and removal operations
  * - Automatic screen processing and rotation
  * - Manual screen navigation functions
- * - Priority-based screen sorting
+ * - Priority order kept up to date on add, remove and priority change
  *
  * \details All actions that can be performed on the list of screens.
  * This file also manages the rotation of screens and priority-based
- * scheduling of screen display. Uses linked list for screen storage,
- * sorts screens by priority before processing, handles client notification
+ * scheduling of screen display. Uses linked list for screen storage kept in
+ * priority order, each screen at the end of its priority tier, so that
+ * processing a frame does not need to sort. Handles client notification
  * on screen switches, manages screen timeouts and expiration, and supports
  * manual navigation (next/previous).
  */
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "shared/LL.h"
+#include "shared/defines.h"
+#include "shared/ilist.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
 
@@ -43,28 +46,74 @@
 #include "screen.h"
 #include "screenlist.h"
 
-int compare_priority(void *one, void *two);
-
 /** \name Global Screen Rotation State
  * Screen list, current screen tracking, and autorotate configuration
  */
 ///@{
 int autorotate = UNSET_INT;		///< Auto-rotation enabled flag (see render.h)
-LinkedList *screenlist = NULL;		///< Priority-sorted list of all screens
+static ilist screenlist;		///< Priority-ordered list of all screens
+static int screenlist_ready = 0;	///< screenlist initialized
 Screen *current_screen = NULL;		///< Currently displayed screen
 long int current_screen_start_time = 0; ///< Frame counter when current screen started
 ///@}
 
+/**
+ * \brief Convert a screen list link to its screen
+ * \param link Link in the screen list, or NULL
+ * \return Screen containing link, NULL if link is NULL
+ */
+static inline Screen *screenlist_entry(ilist_link *link)
+{
+	return (link != NULL) ? ilist_entry(link, Screen, link) : NULL;
+}
+
+/**
+ * \brief Find the screen screenlist_goto_next() switches to
+ * \return Next screen in the priority-sorted list, wrapping around to the
+ * first at the end of the current screen's priority tier
+ *
+ * \details current_screen must be set.
+ */
+static Screen *screenlist_next_screen(void)
+{
+	Screen *s = NULL;
+
+	if (ilist_linked(&current_screen->link))
+		s = screenlist_entry(ilist_next(&screenlist, &current_screen->link));
+
+	if (!s || s->priority < current_screen->priority)
+		s = screenlist_entry(ilist_first(&screenlist));
+
+	return s;
+}
+
+/**
+ * \brief Insert a screen behind all screens of the same or higher priority
+ * \param s Unlisted screen
+ */
+static void screenlist_enqueue(Screen *s)
+{
+	ilist_link *pos = &screenlist.head;
+	Screen *t;
+
+	ilist_foreach(t, &screenlist, link) {
+		if (t->priority < s->priority) {
+			pos = &t->link;
+			break;
+		}
+	}
+
+	ilist_insert_before(&screenlist, pos, &s->link);
+}
+
 // Initialize screenlist and prepare screen management
 int screenlist_init(void)
 {
 	report(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	screenlist = LL_new();
-	if (!screenlist) {
-		report(RPT_ERR, "%s: Error allocating", __FUNCTION__);
-		return -1;
-	}
+	ilist_init(&screenlist);
+	screenlist_ready = 1;
+
 	return 0;
 }
 
@@ -73,10 +122,14 @@ int screenlist_shutdown(void)
 {
 	report(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	if (!screenlist) {
+	if (!screenlist_ready) {
 		return -1;
 	}
-	LL_Destroy(screenlist);
+
+	// The screens belong to their clients, only the links are dropped
+	while (ilist_first(&screenlist) != NULL)
+		ilist_remove(&screenlist, ilist_first(&screenlist));
+	screenlist_ready = 0;
 
 	return 0;
 }
@@ -84,10 +137,11 @@ int screenlist_shutdown(void)
 // Add screen to global screenlist
 int screenlist_add(Screen *s)
 {
-	if (!screenlist)
+	if (!screenlist_ready || ilist_linked(&s->link))
 		return -1;
 
-	return LL_Push(screenlist, s);
+	screenlist_enqueue(s);
+	return 0;
 }
 
 // Remove screen from global screenlist (switches away if current)
@@ -95,34 +149,49 @@ int screenlist_remove(Screen *s)
 {
 	debug(RPT_DEBUG, "%s(s=[%.40s])", __FUNCTION__, s->id);
 
-	if (!screenlist)
+	if (!screenlist_ready || !ilist_linked(&s->link))
 		return -1;
 
 	if (s == current_screen) {
 		screenlist_goto_next();
 		if (s == current_screen) {
-			void *res = LL_Remove(screenlist, s, NEXT);
+			ilist_remove(&screenlist, &s->link);
 			screenlist_goto_next();
-			return (res == NULL) ? -1 : 0;
+			return 0;
 		}
 	}
 
-	return (LL_Remove(screenlist, s, NEXT) == NULL) ? -1 : 0;
+	ilist_remove(&screenlist, &s->link);
+	return 0;
+}
+
+// Change a screen's priority and move it to the end of its new tier
+void screenlist_set_priority(Screen *s, Priority priority)
+{
+	if (s->priority == priority)
+		return;
+
+	s->priority = priority;
+
+	// Screens not yet added only take the new value
+	if (screenlist_ready && ilist_linked(&s->link)) {
+		ilist_remove(&screenlist, &s->link);
+		screenlist_enqueue(s);
+	}
 }
 
 // Process screenlist and handle screen switching logic
-void screenlist_process(void)
+void screenlist_process(long frames)
 {
 	Screen *s;
 	Screen *f;
 
 	report(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	if (!screenlist)
+	if (!screenlist_ready)
 		return;
 
-	LL_Sort(screenlist, compare_priority);
-	f = LL_GetFirst(screenlist);
+	f = screenlist_entry(ilist_first(&screenlist));
 	s = screenlist_current();
 
 	// Screen scheduling logic: initialize if no current screen, handle timeout expiration,
@@ -139,7 +208,7 @@ void screenlist_process(void)
 
 	} else {
 		if (s->timeout != -1) {
-			--(s->timeout);
+			s->timeout -= (int)min(frames, (long)s->timeout);
 			report(RPT_DEBUG, "Active screen [%.40s] has timeout->%d", s->id,
 			       s->timeout);
 
@@ -163,6 +232,30 @@ void screenlist_process(void)
 	}
 }
 
+// Timer value at which screenlist_process() switches screens on its own
+long screenlist_next_change(long timer)
+{
+	Screen *f = screenlist_entry(ilist_first(&screenlist));
+	Screen *s = current_screen;
+	long due = LONG_MAX;
+
+	if (!screenlist_ready || (f == NULL))
+		return LONG_MAX;
+
+	if ((s == NULL) || (f->priority > s->priority))
+		return timer + 1;
+
+	if (s->timeout != -1)
+		due = timer + max(s->timeout, 1);
+
+	// Rotating to the same screen changes nothing
+	if (autorotate && s->priority > PRI_BACKGROUND && s->priority <= PRI_FOREGROUND &&
+	    screenlist_next_screen() != s)
+		due = min(due, max(current_screen_start_time + s->duration, timer + 1));
+
+	return due;
+}
+
 // Switch to another screen with client notification
 void screenlist_switch(Screen *s)
 {
@@ -185,7 +278,7 @@ void screenlist_switch(Screen *s)
 
 		if (c) {
 			snprintf(str, sizeof(str), "ignore %s\n", current_screen->id);
-			sock_send_string(c->sock, str);
+			client_send_string(c, str);
 		}
 	}
 
@@ -195,7 +288,7 @@ void screenlist_switch(Screen *s)
 		snprintf(str, sizeof(str), "listen %s\n", s->id);
 		report(RPT_INFO, "%s: Sending 'listen %s' to client [%d] on socket %d",
 		       __FUNCTION__, s->id, c->sock, c->sock);
-		sock_send_string(c->sock, str);
+		client_send_string(c, str);
 		report(RPT_DEBUG, "%s: 'listen %s' message sent successfully", __FUNCTION__, s->id);
 	} else {
 		report(RPT_DEBUG, "%s: No client for screen [%.40s] - listen message NOT sent",
@@ -213,32 +306,19 @@ Screen *screenlist_current(void) { return current_screen; }
 // Move to next screen in rotation order
 int screenlist_goto_next(void)
 {
-	Screen *s;
-
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	// Navigate to next screen in priority-sorted list with wraparound, respecting priority
-	// boundaries to stay within same priority tier
 	if (!current_screen)
 		return -1;
 
-	for (s = LL_GetFirst(screenlist); s && s != current_screen; s = LL_GetNext(screenlist))
-		;
-
-	s = LL_GetNext(screenlist);
-
-	if (!s || s->priority < current_screen->priority) {
-		s = LL_GetFirst(screenlist);
-	}
-
-	screenlist_switch(s);
+	screenlist_switch(screenlist_next_screen());
 	return 0;
 }
 
 // Move to previous screen in rotation order
 int screenlist_goto_prev(void)
 {
-	Screen *s;
+	Screen *s = NULL;
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
@@ -247,17 +327,16 @@ int screenlist_goto_prev(void)
 	if (!current_screen)
 		return -1;
 
-	for (s = LL_GetFirst(screenlist); s && s != current_screen; s = LL_GetNext(screenlist))
-		;
-
-	s = LL_GetPrev(screenlist);
+	if (ilist_linked(&current_screen->link))
+		s = screenlist_entry(ilist_prev(&screenlist, &current_screen->link));
 
 	if (!s) {
-		Screen *f = LL_GetFirst(screenlist);
+		Screen *f = screenlist_entry(ilist_first(&screenlist));
 		Screen *n;
 
 		s = f;
-		while ((n = LL_GetNext(screenlist)) && n->priority == f->priority) {
+		while ((s != NULL) && (n = screenlist_entry(ilist_next(&screenlist, &s->link))) &&
+		       n->priority == f->priority) {
 			s = n;
 		}
 	}
@@ -265,28 +344,3 @@ int screenlist_goto_prev(void)
 	screenlist_switch(s);
 	return 0;
 }
-
-/**
- * \brief Compare priority
- * \param one void *one
- * \param two void *two
- * \return Return value
- */
-int compare_priority(void *one, void *two)
-{
-	Screen *a, *b;
-
-	debug(RPT_DEBUG, "compare_priority: %8x %8x", one, two);
-
-	if (!one)
-		return 0;
-	if (!two)
-		return 0;
-
-	a = (Screen *)one;
-	b = (Screen *)two;
-
-	debug(RPT_DEBUG, "compare_priority: done?");
-
-	return (b->priority - a->priority);
-}
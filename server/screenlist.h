@@ -74,8 +74,9 @@ int screenlist_shutdown(void);
  * \retval 0 Success
  * \retval <0 Addition failed
  *
- * \details Adds the screen to the global screen list
- * and makes it available for rotation and display.
+ * \details Adds the screen to the global screen list behind all screens
+ * of the same or higher priority and makes it available for rotation and
+ * display.
  */
 int screenlist_add(Screen *s);
 
@@ -90,14 +91,39 @@ int screenlist_add(Screen *s);
  */
 int screenlist_remove(Screen *s);
 
+/**
+ * \brief Changes the priority of a screen
+ * \param s Screen to change
+ * \param priority New priority
+ * \details The list is kept in priority order instead of being sorted
+ * every frame, so priorities of listed screens must only be changed
+ * through this function. A screen whose priority changes moves to the end
+ * of its new priority tier; setting the current priority again keeps its
+ * place in the rotation.
+ */
+void screenlist_set_priority(Screen *s, Priority priority);
+
 /**
  * \brief Processes the screenlist
+ * \param frames Frames elapsed since the last call, at least 1
  *
  * \details Processes the screenlist and decides if we need to switch
  * to another screen based on priorities, timeouts, and rotation settings.
- * This function is typically called from the main server loop.
+ * This function is typically called from the main server loop. Screen
+ * timeouts count down by frames, as the main loop may sleep through some.
+ */
+void screenlist_process(long frames);
+
+/**
+ * \brief Tell when the screenlist switches screens on its own
+ * \param timer Timer value of the last frame
+ * \retval LONG_MAX No screens, or none that times out or rotates
+ * \retval >timer Timer value at which screenlist_process() may switch
+ *
+ * \details Covers screen timeouts, autorotation and a higher priority
+ * screen waiting to be selected.
  */
-void screenlist_process(void);
+long screenlist_next_change(long timer);
 
 /**
  * \brief Switches to another screen
@@ -150,6 +150,8 @@ int server_screen_shutdown(void)
 int update_server_screen(void)
 {
 	static int hello_done = 0;
+	static int shown_clients = -1;
+	static int shown_screens = -1;
 	Client *c;
 	Widget *w;
 	int num_clients = 0;
@@ -192,7 +194,7 @@ int update_server_screen(void)
 
 	// Count total screens across all clients and update server screen widgets with
 	// client/screen statistics, adapting layout to display dimensions
-	for (c = clients_getfirst(); c != NULL; c = clients_getnext()) {
+	for (c = clients_getfirst(); c != NULL; c = clients_getnext(c)) {
 		num_screens += client_screen_count(c);
 	}
 
@@ -220,6 +222,13 @@ int update_server_screen(void)
 		}
 	}
 
+	// The server screen is polled every frame, only redraw it when the numbers change
+	if ((num_clients != shown_clients) || (num_screens != shown_screens)) {
+		shown_clients = num_clients;
+		shown_screens = num_screens;
+		screen_touch(server_screen);
+	}
+
 	return 0;
 }
 
@@ -284,7 +293,8 @@ static int reset_server_screen(int rotate, int heartbeat, int title)
 
 	server_screen->heartbeat =
 	    (heartbeat && (rotate != SERVERSCREEN_BLANK)) ? HEARTBEAT_OPEN : HEARTBEAT_OFF;
-	server_screen->priority = (rotate == SERVERSCREEN_ON) ? PRI_INFO : PRI_BACKGROUND;
+	screenlist_set_priority(server_screen,
+				(rotate == SERVERSCREEN_ON) ? PRI_INFO : PRI_BACKGROUND);
 
 	// Reset all server screen widgets: clear text, set positions, and configure first line as
 	// title widget if enabled
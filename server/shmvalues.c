@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/shmvalues.c
+ * \brief Shared-memory widget value channel for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Read-only MAP_SHARED mapping of client memfds
+ * - F_SEAL_SHRINK requirement so a client cannot fault the server
+ * - Lock-free sequence counter reads of single slots
+ * - Widget updates only when a slot's sequence has changed
+ * - Screens are marked changed only when a widget value really differs
+ *
+ * \usage
+ * - Called from the shm_attach command and from render_screen()
+ *
+ * \details The slot count is copied out of the header at attach time; the
+ * client may scribble over the header afterwards without affecting bounds
+ * checks. Slot contents are copied to the stack before they are checked, so
+ * a writer racing with the server can at worst cause an update to be
+ * skipped until the next frame.
+ */
+
+#define _GNU_SOURCE
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shared/defines.h"
+#include "shared/report.h"
+
+#include "screen.h"
+#include "shmvalues.h"
+
+/** \brief Attempts to read a slot that a writer is updating concurrently */
+#define SHM_READ_RETRIES 4
+
+// Map and validate a client's value region
+int shm_values_attach(Client *c, int fd)
+{
+	ShmValuesHeader header;
+	struct stat st;
+	size_t size;
+	int seals;
+	void *base;
+
+	seals = fcntl(fd, F_GET_SEALS);
+	if ((seals < 0) || !(seals & F_SEAL_SHRINK)) {
+		report(RPT_WARNING, "Client [%d]: value region is not sealed", c->sock);
+		close(fd);
+		return -1;
+	}
+
+	if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(ShmValuesHeader))) {
+		report(RPT_WARNING, "Client [%d]: value region too small", c->sock);
+		close(fd);
+		return -1;
+	}
+	size = st.st_size;
+
+	if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+	    (header.magic != SHM_VALUES_MAGIC) || (header.version != SHM_VALUES_VERSION) ||
+	    (header.slot_size != sizeof(ShmValueSlot)) || (header.nslots == 0) ||
+	    (header.nslots > SHM_VALUES_MAX_SLOTS) ||
+	    (sizeof(ShmValuesHeader) + header.nslots * sizeof(ShmValueSlot) > size)) {
+		report(RPT_WARNING, "Client [%d]: invalid value region header", c->sock);
+		close(fd);
+		return -1;
+	}
+
+	base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		report(RPT_WARNING, "Client [%d]: cannot map value region - %s", c->sock,
+		       strerror(errno));
+		return -1;
+	}
+
+	shm_values_detach(c);
+	c->shm_base = base;
+	c->shm_size = size;
+	c->shm_slots = header.nslots;
+
+	report(RPT_INFO, "Client [%d]: attached value region with %u slots", c->sock,
+	       c->shm_slots);
+
+	return 0;
+}
+
+// Unmap a client's value region
+void shm_values_detach(Client *c)
+{
+	if (c->shm_base == NULL)
+		return;
+
+	munmap(c->shm_base, c->shm_size);
+	c->shm_base = NULL;
+	c->shm_size = 0;
+	c->shm_slots = 0;
+}
+
+/**
+ * \brief Take a consistent copy of a slot
+ * \param src Slot in the shared region
+ * \param dst Private copy
+ * \retval 0 dst holds a complete update
+ * \retval -1 Slot never written or the writer did not finish in time
+ */
+static int shm_values_read_slot(const ShmValueSlot *src, ShmValueSlot *dst)
+{
+	for (int i = 0; i < SHM_READ_RETRIES; i++) {
+		uint32_t seq = __atomic_load_n(&src->seq, __ATOMIC_ACQUIRE);
+
+		if (seq == 0)
+			return -1;
+		if (seq & 1)
+			continue;
+
+		memcpy(dst, src, sizeof(*dst));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) == seq) {
+			dst->seq = seq;
+			dst->text[SHM_VALUE_TEXT_SIZE - 1] = '\0';
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+// Copy the bound slot value into a widget
+void shm_values_apply(Widget *w)
+{
+	Client *c = w->screen->client;
+	const ShmValueSlot *slots;
+	ShmValueSlot slot;
+
+	if ((c == NULL) || (c->shm_base == NULL) || ((unsigned int)w->shm_slot >= c->shm_slots))
+		return;
+
+	slots = (const ShmValueSlot *)((const char *)c->shm_base + sizeof(ShmValuesHeader));
+
+	// Cheap check first: most slots are not rewritten every frame
+	if (__atomic_load_n(&slots[w->shm_slot].seq, __ATOMIC_RELAXED) == w->shm_seq)
+		return;
+
+	if (shm_values_read_slot(&slots[w->shm_slot], &slot) < 0)
+		return;
+
+	w->shm_seq = slot.seq;
+
+	switch (w->type) {
+	case WID_STRING:
+	case WID_TITLE:
+	case WID_SCROLLER:
+		if (widget_set_string(w, &w->text, slot.text) > 0)
+			screen_touch(w->screen);
+		break;
+
+	case WID_HBAR:
+	case WID_VBAR:
+		if (w->length != slot.value) {
+			w->length = slot.value;
+			screen_touch(w->screen);
+		}
+		break;
+
+	case WID_PBAR:
+		if (w->promille != min(max(slot.value, 0), 1000)) {
+			w->promille = min(max(slot.value, 0), 1000);
+			screen_touch(w->screen);
+		}
+		break;
+
+	case WID_NUM:
+		if ((slot.value >= 0) && (slot.value <= 10) && (w->y != slot.value)) {
+			w->y = slot.value;
+			screen_touch(w->screen);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file server/shmvalues.h
+ * \brief Shared-memory widget value channel interface for LCDd server
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Maps a client supplied memfd read-only into the server
+ * - Validates size, seals and header before the region is used
+ * - Copies bound slot values into widgets while a frame is rendered
+ *
+ * \usage
+ * - shm_attach_func() hands the descriptor received over the Unix socket
+ *   to shm_values_attach()
+ * - render_screen() calls shm_values_apply() for every bound widget
+ * - client_destroy() releases the mapping with shm_values_detach()
+ *
+ * \details Clients that update values every frame write them into the
+ * shared region instead of sending widget_set, so an update costs no system
+ * call on either side. The layout is defined in shared/shmvalues.h.
+ */
+
+#ifndef SHMVALUES_SERVER_H
+#define SHMVALUES_SERVER_H
+
+#include "shared/shmvalues.h"
+
+#include "client.h"
+#include "widget.h"
+
+/**
+ * \brief Map a client's value region
+ * \param c Client that sent the descriptor
+ * \param fd memfd received from the client, consumed in any case
+ * \retval 0 Success, a previous region of the client is replaced
+ * \retval -1 The descriptor is not a valid value region
+ *
+ * \details The memfd must be sealed with F_SEAL_SHRINK so that the client
+ * cannot truncate it under the server's mapping, and must be large enough
+ * for the slot count in its header.
+ */
+int shm_values_attach(Client *c, int fd);
+
+/**
+ * \brief Unmap a client's value region
+ * \param c Client whose region is released
+ *
+ * \details Widgets stay bound to their slots but keep their last values.
+ */
+void shm_values_detach(Client *c);
+
+/**
+ * \brief Copy the bound slot value into a widget
+ * \param w Widget with shm_slot >= 0
+ *
+ * \details Does nothing if the slot was not written since the last call,
+ * is being written right now or lies outside the client's region. The
+ * widget's screen is touched when the widget's value changes.
+ */
+void shm_values_apply(Widget *w);
+
+#endif
@@ -12,18 +12,22 @@
  *
  * \features
  * - TCP socket creation and binding
+ * - Optional Unix domain listener (filesystem path or abstract namespace)
+ * - SO_PEERCRED identification of local clients
  * - Client connection acceptance and management
- * - Non-blocking socket I/O with select()
- * - Message buffering with ring buffer
+ * - Non-blocking socket I/O driven by the epoll event loop
+ * - Reading into per-client receive buffers
+ * - Non-blocking writes with per-client output queues flushed by writev()
+ * - Output high-water mark that throttles or disconnects slow readers
  * - Socket-to-client mapping management
  * - IPv4 and IPv6 address validation
  * - Socket resource pooling for efficiency
  *
  * \usage
  * - Server socket initialization and configuration
- * - Client connection polling and management
+ * - Client connection and data events via event loop callbacks
  * - Socket resource allocation and cleanup
- * - Message reading and buffering operations
+ * - Message reading into client receive buffers
  * - IP address validation utilities
  *
  * \details This file contains all the sockets code used by the server. This contains
@@ -31,11 +35,16 @@
  * as code to deal with sending messages to clients, maintaining connections,
  * accepting new connections, closing dead connections (or connections
  * associated with dying/exiting clients), etc. Uses pre-allocated socket mapping
- * pool to avoid heap operations, maintains active socket list for select() polling,
- * ring buffer for incoming message assembly, non-blocking I/O prevents server blocking
- * on slow clients, and automatic client cleanup on socket errors.
+ * pool to avoid heap operations, registers every socket with the event loop so
+ * data is read as soon as it arrives, reads straight into each client's growable
+ * receive buffer so partial lines carry over between reads, non-blocking I/O
+ * prevents server blocking on slow clients, and automatic client cleanup on socket
+ * errors.
  */
 
+/** \brief Enable struct ucred for SO_PEERCRED */
+#define _GNU_SOURCE
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -49,29 +58,49 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include "shared/configfile.h"
 #include "shared/defines.h"
+#include "shared/ilist.h"
 #include "shared/report.h"
-#include "shared/sring.h"
 
 #include "clients.h"
+#include "event.h"
+#include "parse.h"
 #include "sock.h"
 
+/** \brief Default output queue length at which a client counts as slow */
+#define DEFAULT_OUTPUT_HIGH_WATER 262144
+/** \brief A throttled client is dropped when its queue exceeds this many high-water marks */
+#define OUTPUT_HARD_LIMIT_FACTOR 4
+/** \brief Maximum number of queue blocks passed to one writev() */
+#define SOCK_IOV_MAX 64
+
 /** \name Global Socket Management State
- * File descriptor sets, listening socket, and connection tracking
+ * Listening socket and connection tracking
  */
 ///@{
-static fd_set active_fd_set;			///< Set of all active file descriptors for select()
-static fd_set read_fd_set;			///< Working set for select() read operations
 static int listening_fd;			///< Listening socket file descriptor
-static LinkedList *openSocketList = NULL;	///< List of active ClientSocketMap objects
-static LinkedList *freeClientSocketList = NULL; ///< List of unused ClientSocketMap objects
-static sring_buffer *messageRing;		///< Ring buffer for queued outgoing messages
+static int unix_fd = -1;			///< Unix domain listening socket, -1 if disabled
+static char unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)]; ///< Path to unlink at exit
+static ilist openSocketList;			///< List of active ClientSocketMap objects
+static ilist freeClientSocketList;		///< List of unused ClientSocketMap objects
+///@}
+
+/** \name Output Flow Control
+ * Limits for clients that do not read their replies, see [server] in LCDd.conf
+ */
+///@{
+static size_t output_high_water = DEFAULT_OUTPUT_HIGH_WATER; ///< OutputHighWater setting
+static int output_throttle = 1; ///< OutputOverflow: throttle (1) or disconnect (0)
 ///@}
 
 /**
@@ -79,8 +108,9 @@ static sring_buffer *messageRing;		///< Ring buffer for queued outgoing messages
  * \details Associates socket file descriptors with client objects for connection management
  */
 typedef struct _ClientSocketMap {
-	int socket;	///< Socket file descriptor
-	Client *client; ///< Associated client object
+	int socket;	 ///< Socket file descriptor
+	Client *client;	 ///< Associated client object
+	ilist_link link; ///< Position in the open or the free list
 } ClientSocketMap;
 
 /** \brief Pre-allocated pool of socket mapping structures
@@ -90,23 +120,47 @@ typedef struct _ClientSocketMap {
  */
 ClientSocketMap *freeClientSocketPool;
 
-/** \brief Maximum message length for socket transmission
- *
- * \details Length of longest single transmission allowed. Messages exceeding
- * this size are truncated or split.
- */
-#define MAXMSG 8192
-
 // Internal socket I/O and cleanup function declarations
+static void sock_accept_handler(int fd, uint32_t events, void *data);
+static void sock_client_handler(int fd, uint32_t events, void *data);
 static int sock_read_from_client(ClientSocketMap *clientSocketMap);
-static void sock_destroy_socket(void);
+static int sock_recv_client(Client *c, char *buf, size_t len);
+static int sock_flush_client(Client *c);
+static void sock_update_client_events(Client *c);
+static void sock_destroy_socket(ClientSocketMap *entry);
+
+/**
+ * \brief Take an unused entry from the socket map pool
+ * \retval NULL Pool exhausted
+ * \retval !NULL Entry, not on any list
+ */
+static ClientSocketMap *sock_take_free(void)
+{
+	ilist_link *link = ilist_first(&freeClientSocketList);
+
+	if (link == NULL)
+		return NULL;
+
+	ilist_remove(&freeClientSocketList, link);
+	return ilist_entry(link, ClientSocketMap, link);
+}
 
 // Initialize socket system and prepare listening socket with resource pools
 int sock_init(char *bind_addr, int bind_port)
 {
+	ClientSocketMap *entry;
 	int i;
 
 	debug(RPT_DEBUG, "%s(bind_addr=\"%s\", port=%d)", __FUNCTION__, bind_addr, bind_port);
+
+	// Flow control for clients that do not read what the server sends
+	i = config_get_int("server", "OutputHighWater", 0, DEFAULT_OUTPUT_HIGH_WATER);
+	output_high_water = (i < CLIENT_OUTBLOCK_SIZE) ? CLIENT_OUTBLOCK_SIZE : i;
+	output_throttle = (strcasecmp(config_get_string("server", "OutputOverflow", 0, "throttle"),
+				      "disconnect") != 0);
+	report(RPT_INFO, "%s: output high-water mark %zu bytes, overflow policy %s", __FUNCTION__,
+	       output_high_water, output_throttle ? "throttle" : "disconnect");
+
 	listening_fd = sock_create_inet_socket(bind_addr, bind_port);
 
 	// Socket initialization with resource pools: allocate client socket pool, create socket
@@ -123,37 +177,37 @@ int sock_init(char *bind_addr, int bind_port)
 		return -1;
 	}
 
-	freeClientSocketList = LL_new();
-
-	if (freeClientSocketList == NULL) {
-		report(RPT_ERR, "%s: error allocating free socket list.", __FUNCTION__);
-		return -1;
-	}
+	ilist_init(&freeClientSocketList);
 
 	for (i = 0; i < FD_SETSIZE; ++i) {
-		LL_AddNode(freeClientSocketList, (void *)&freeClientSocketPool[i]);
+		ilist_push(&freeClientSocketList, &freeClientSocketPool[i].link);
 	}
 
-	openSocketList = LL_new();
+	ilist_init(&openSocketList);
 
-	if (openSocketList == NULL) {
-		report(RPT_ERR, "%s: error allocating open socket list.", __FUNCTION__);
-		return -1;
+	entry = sock_take_free();
+	entry->socket = listening_fd;
+	entry->client = NULL;
+	ilist_push(&openSocketList, &entry->link);
 
-	} else {
-		ClientSocketMap *entry;
+	if (event_add(listening_fd, EPOLLIN, sock_accept_handler, NULL) < 0) {
+		report(RPT_ERR, "%s: error watching listening socket", __FUNCTION__);
+		return -1;
+	}
 
-		entry = (ClientSocketMap *)LL_Pop(freeClientSocketList);
+	// Local clients may skip the TCP stack through an additional Unix domain listener
+	const char *path = config_get_string("server", "UnixSocket", 0, "");
 
-		entry->socket = listening_fd;
-		entry->client = NULL;
+	if (path[0] != '\0') {
+		unix_fd = sock_create_unix_socket(path);
 
-		LL_AddNode(openSocketList, (void *)entry);
-	}
+		if (unix_fd < 0)
+			return -1;
 
-	if ((messageRing = sring_create(MAXMSG)) == NULL) {
-		report(RPT_ERR, "%s: error allocating receive buffer.", __FUNCTION__);
-		return -1;
+		if (event_add(unix_fd, EPOLLIN, sock_accept_handler, NULL) < 0) {
+			report(RPT_ERR, "%s: error watching unix socket", __FUNCTION__);
+			return -1;
+		}
 	}
 
 	return 0;
@@ -166,10 +220,22 @@ int sock_shutdown(void)
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
+	event_remove(listening_fd);
 	close(listening_fd);
-	LL_Destroy(freeClientSocketList);
+
+	if (unix_fd >= 0) {
+		event_remove(unix_fd);
+		close(unix_fd);
+		unix_fd = -1;
+
+		// May fail after dropping privileges; the next start replaces a stale file
+		if ((unix_path[0] != '\0') && (unlink(unix_path) < 0))
+			report(RPT_INFO, "%s: cannot remove %s - %s", __FUNCTION__, unix_path,
+			       sock_geterror());
+	}
+	ilist_init(&openSocketList);
+	ilist_init(&freeClientSocketList);
 	free(freeClientSocketPool);
-	sring_destroy(messageRing);
 
 	return retVal;
 }
@@ -185,7 +251,7 @@ int sock_create_inet_socket(char *addr, unsigned int port)
 	sock = socket(PF_INET, SOCK_STREAM, 0);
 
 	// TCP socket setup sequence: validate socket creation, enable address reuse, configure bind
-	// address/port, start listening, and initialize fd_set for select()
+	// address/port and start listening
 	if (sock < 0) {
 		report(RPT_ERR, "%s: cannot create socket - %s", __FUNCTION__, sock_geterror());
 		return -1;
@@ -218,170 +284,357 @@ int sock_create_inet_socket(char *addr, unsigned int port)
 
 	report(RPT_NOTICE, "Listening for queries on %s:%d", addr, port);
 
-	FD_ZERO(&active_fd_set);
-	FD_SET(sock, &active_fd_set);
+	return sock;
+}
+
+// Create Unix domain socket on a path or abstract name and start listening
+int sock_create_unix_socket(const char *path)
+{
+	struct sockaddr_un name;
+	struct stat st;
+	socklen_t len;
+	int sock;
+
+	debug(RPT_DEBUG, "%s(path=\"%s\")", __FUNCTION__, path);
+
+	if (strlen(path) >= sizeof(name.sun_path)) {
+		report(RPT_ERR, "%s: socket path too long: %s", __FUNCTION__, path);
+		return -1;
+	}
+
+	memset(&name, 0, sizeof(name));
+	name.sun_family = AF_UNIX;
+
+	// "@name" selects the abstract namespace: no file, gone with the last descriptor
+	if (path[0] == '@') {
+		memcpy(name.sun_path + 1, path + 1, strlen(path) - 1);
+		len = offsetof(struct sockaddr_un, sun_path) + strlen(path);
+	} else {
+		strcpy(name.sun_path, path);
+		len = sizeof(name);
+
+		// Remove a socket left behind by a previous instance
+		if ((lstat(path, &st) == 0) && S_ISSOCK(st.st_mode))
+			unlink(path);
+	}
+
+	sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (sock < 0) {
+		report(RPT_ERR, "%s: cannot create socket - %s", __FUNCTION__, sock_geterror());
+		return -1;
+	}
+
+	if (bind(sock, (struct sockaddr *)&name, len) < 0) {
+		report(RPT_ERR, "%s: cannot bind to %s - %s", __FUNCTION__, path, sock_geterror());
+		close(sock);
+		return -1;
+	}
+
+	if (path[0] != '@') {
+		strcpy(unix_path, path);
+
+		// Same audience as the loopback TCP port: every local user
+		chmod(path, 0666);
+	}
+
+	if (listen(sock, SOMAXCONN) < 0) {
+		report(RPT_ERR, "%s: error in attempting to listen on %s - %s", __FUNCTION__, path,
+		       sock_geterror());
+		close(sock);
+		return -1;
+	}
+
+	report(RPT_NOTICE, "Listening for queries on unix:%s", path);
 
 	return sock;
 }
 
-// Poll all sockets for new connections and incoming data using select()
-int sock_poll_clients(void)
+/**
+ * \brief Accept a pending connection on the listening socket
+ * \param fd Listening socket file descriptor
+ * \param events Ready event mask (unused)
+ * \param data Unused
+ *
+ * \details Event loop callback. Creates the client, takes a socket map entry
+ * from the pool and registers the new socket with the event loop.
+ */
+static void sock_accept_handler(int fd, uint32_t events, void *data)
 {
-	struct timeval t;
-	ClientSocketMap *clientSocket;
+	Client *c;
+	ClientSocketMap *newClientSocket;
+	int new_sock;
+	struct sockaddr_storage clientname;
+	socklen_t size = sizeof(clientname);
+	struct ucred cred = {.pid = 0, .uid = (uid_t)-1, .gid = (gid_t)-1};
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	t.tv_sec = 0;
-	t.tv_usec = 0;
-	read_fd_set = active_fd_set;
+	new_sock = accept(fd, (struct sockaddr *)&clientname, &size);
 
-	if (select(FD_SETSIZE, &read_fd_set, NULL, NULL, &t) < 0) {
-		report(RPT_ERR, "%s: Select error - %s", __FUNCTION__, sock_geterror());
-		return -1;
+	if (new_sock < 0) {
+		report(RPT_ERR, "%s: Accept error - %s", __FUNCTION__, sock_geterror());
+		return;
+	}
+
+	if (clientname.ss_family == AF_UNIX) {
+		socklen_t credlen = sizeof(cred);
+
+		// Local peers are identified by process and user instead of an address
+		if (getsockopt(new_sock, SOL_SOCKET, SO_PEERCRED, &cred, &credlen) < 0)
+			report(RPT_WARNING, "%s: SO_PEERCRED failed - %s", __FUNCTION__,
+			       sock_geterror());
+
+		report(RPT_NOTICE, "Connect from pid %d (uid %d, gid %d) on socket %i",
+		       (int)cred.pid, (int)cred.uid, (int)cred.gid, new_sock);
+	} else {
+		struct sockaddr_in *sin = (struct sockaddr_in *)&clientname;
+
+		// Thread-safe IP address conversion
+		char client_addr[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, &(sin->sin_addr), client_addr, INET_ADDRSTRLEN);
+		report(RPT_NOTICE, "Connect from host %s:%hu on socket %i", client_addr,
+		       ntohs(sin->sin_port), new_sock);
+	}
+
+	fcntl(new_sock, F_SETFL, O_NONBLOCK);
+
+	newClientSocket = sock_take_free();
+
+	if (newClientSocket == NULL) {
+		report(RPT_ERR, "%s: Error - free client socket list exhausted - %d clients.",
+		       __FUNCTION__, FD_SETSIZE);
+		close(new_sock);
+		return;
+	}
+
+	if ((c = client_create(new_sock)) == NULL) {
+		report(RPT_ERR, "%s: Error creating client on socket %i - %s", __FUNCTION__,
+		       new_sock, sock_geterror());
+		ilist_push(&freeClientSocketList, &newClientSocket->link);
+		close(new_sock);
+		return;
+	}
+
+	c->peer_pid = cred.pid;
+	c->peer_uid = cred.uid;
+	c->peer_gid = cred.gid;
+
+	newClientSocket->socket = new_sock;
+	newClientSocket->client = c;
+	ilist_push(&openSocketList, &newClientSocket->link);
+
+	if (clients_add_client(c) == NULL) {
+		report(RPT_ERR, "%s: Could not add client on socket %i", __FUNCTION__, new_sock);
+		sock_destroy_socket(newClientSocket);
+		return;
 	}
 
-	LL_Rewind(openSocketList);
-
-	// Process all ready sockets: accept new connections on listening socket, read data from
-	// client sockets, cleanup on errors
-	for (clientSocket = (ClientSocketMap *)LL_Get(openSocketList); clientSocket != NULL;
-	     clientSocket = LL_GetNext(openSocketList)) {
-
-		if (FD_ISSET(clientSocket->socket, &read_fd_set)) {
-			if (clientSocket->socket == listening_fd) {
-				Client *c;
-				int new_sock;
-				struct sockaddr_in clientname;
-				socklen_t size = sizeof(clientname);
-
-				new_sock =
-				    accept(listening_fd, (struct sockaddr *)&clientname, &size);
-
-				if (new_sock < 0) {
-					report(RPT_ERR, "%s: Accept error - %s", __FUNCTION__,
-					       sock_geterror());
-					return -1;
-				}
-
-				// Thread-safe IP address conversion
-				char client_addr[INET_ADDRSTRLEN];
-				inet_ntop(AF_INET, &(clientname.sin_addr), client_addr,
-					  INET_ADDRSTRLEN);
-				report(RPT_NOTICE, "Connect from host %s:%hu on socket %i",
-				       client_addr, ntohs(clientname.sin_port), new_sock);
-				FD_SET(new_sock, &active_fd_set);
-
-				fcntl(new_sock, F_SETFL, O_NONBLOCK);
-
-				// Clear the message ring buffer for new client connection
-				report(RPT_NOTICE,
-				       "Clearing message ring buffer (before: r=%d, w=%d)",
-				       messageRing->r, messageRing->w);
-				sring_clear(messageRing);
-				report(RPT_NOTICE,
-				       "Message ring buffer cleared (after: r=%d, w=%d)",
-				       messageRing->r, messageRing->w);
-
-				if ((c = client_create(new_sock)) == NULL) {
-					report(RPT_ERR,
-					       "%s: Error creating client on socket %i - %s",
-					       __FUNCTION__, clientSocket->socket, sock_geterror());
-					return -1;
-
-				} else {
-					ClientSocketMap *newClientSocket;
-					newClientSocket =
-					    (ClientSocketMap *)LL_Pop(freeClientSocketList);
-
-					if (newClientSocket != NULL) {
-						newClientSocket->socket = new_sock;
-						newClientSocket->client = c;
-						LL_InsertNode(openSocketList,
-							      (void *)newClientSocket);
-
-						LL_Next(openSocketList);
-
-					} else {
-						report(RPT_ERR,
-						       "%s: Error - free client socket list "
-						       "exhausted - %d clients.",
-						       __FUNCTION__, FD_SETSIZE);
-						return -1;
-					}
-				}
-
-				if (clients_add_client(c) == NULL) {
-					report(RPT_ERR, "%s: Could not add client on socket %i",
-					       __FUNCTION__, clientSocket->socket);
-					return -1;
-				}
-
-			} else {
-				int err = 0;
-
-				debug(RPT_DEBUG, "%s: reading...", __FUNCTION__);
-				err = sock_read_from_client(clientSocket);
-				debug(RPT_DEBUG, "%s: ...done", __FUNCTION__);
-				if (err < 0)
-					sock_destroy_socket();
+	if (event_add(new_sock, EPOLLIN | EPOLLRDHUP, sock_client_handler, newClientSocket) < 0) {
+		report(RPT_ERR, "%s: Could not watch client on socket %i", __FUNCTION__, new_sock);
+		sock_destroy_socket(newClientSocket);
+	}
+}
+
+/**
+ * \brief Handle readiness of a client socket
+ * \param fd Client socket file descriptor
+ * \param events Ready event mask
+ * \param data ClientSocketMap entry of the client
+ *
+ * \details Event loop callback. Flushes queued output when the socket is
+ * writable, reads all pending data into the client's receive buffer and
+ * destroys the connection on EOF or error.
+ */
+static void sock_client_handler(int fd, uint32_t events, void *data)
+{
+	ClientSocketMap *clientSocket = (ClientSocketMap *)data;
+	int err = 0;
+
+	debug(RPT_DEBUG, "%s(fd=%d, events=0x%x)", __FUNCTION__, fd, events);
+
+	if ((events & EPOLLOUT) && (clientSocket->client != NULL))
+		err = sock_flush_client(clientSocket->client);
+
+	if ((err == 0) && (events & ~EPOLLOUT)) {
+		debug(RPT_DEBUG, "%s: reading...", __FUNCTION__);
+		err = sock_read_from_client(clientSocket);
+		debug(RPT_DEBUG, "%s: ...done", __FUNCTION__);
+	}
+
+	if (err < 0)
+		sock_destroy_socket(clientSocket);
+}
+
+/**
+ * \brief Set the epoll mask of a client socket from its queue and throttle state
+ * \param c Client whose registration is updated
+ *
+ * \details Reading (and half-close detection, which would fire on every
+ * dispatch while nothing is read) stops while the client is throttled.
+ * EPOLLOUT is only requested while output is queued, otherwise it would fire
+ * continuously.
+ */
+static void sock_update_client_events(Client *c)
+{
+	uint32_t events = 0;
+
+	if (!c->throttled)
+		events |= EPOLLIN | EPOLLRDHUP;
+	if (c->outq_len > 0)
+		events |= EPOLLOUT;
+
+	event_modify(c->sock, events);
+}
+
+/**
+ * \brief Write as much queued output as the socket accepts
+ * \param c Client whose queue is flushed
+ * \retval 0 Queue empty or socket full
+ * \retval -1 Write error, the connection is dead
+ *
+ * \details Passes up to SOCK_IOV_MAX queue blocks to a single writev().
+ * A throttled client is resumed once its queue drained to half the
+ * high-water mark.
+ */
+static int sock_flush_client(Client *c)
+{
+	struct iovec iov[SOCK_IOV_MAX];
+
+	while (c->outq_len > 0) {
+		int cnt = client_outq_iov(c, iov, SOCK_IOV_MAX);
+		ssize_t n = writev(c->sock, iov, cnt);
+
+		if (n < 0) {
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+				break;
+			if (errno == EINTR)
+				continue;
+			report(RPT_WARNING, "%s: write to socket %d failed - %s", __FUNCTION__,
+			       c->sock, strerror(errno));
+			return -1;
+		}
+
+		client_outq_consume(c, n);
+	}
+
+	if (c->throttled && (c->outq_len <= output_high_water / 2)) {
+		report(RPT_INFO, "Client on socket %d caught up, resuming", c->sock);
+		c->throttled = 0;
+		// Lines buffered while throttled are parsed without waiting for new input
+		parse_schedule_client(c);
+	}
+
+	sock_update_client_events(c);
+
+	return 0;
+}
+
+// Send data to a client without blocking, queueing what the socket does not take
+int sock_send_client(Client *c, const void *data, size_t len)
+{
+	int was_empty = (c->outq_len == 0);
+
+	if (c->state == GONE)
+		return -1;
+
+	// Fast path: nothing queued, so the data may go out directly and in order
+	if (was_empty) {
+		ssize_t n = send(c->sock, data, len, MSG_NOSIGNAL);
+
+		if (n < 0) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+				report(RPT_WARNING, "%s: write to socket %d failed - %s",
+				       __FUNCTION__, c->sock, strerror(errno));
+				c->state = GONE;
+				return -1;
 			}
+			n = 0;
+		}
+
+		if ((size_t)n == len)
+			return 0;
+
+		data = (const char *)data + n;
+		len -= n;
+	}
+
+	if (client_outq_append(c, data, len) < 0) {
+		c->state = GONE;
+		return -1;
+	}
+
+	if (c->outq_len > output_high_water) {
+		size_t hard_limit = output_high_water * OUTPUT_HARD_LIMIT_FACTOR;
+
+		if (!output_throttle || (c->outq_len > hard_limit)) {
+			report(RPT_WARNING,
+			       "Client on socket %d does not read its output (%zu bytes queued), "
+			       "disconnecting",
+			       c->sock, c->outq_len);
+			c->state = GONE;
+			return -1;
+		}
+
+		if (!c->throttled) {
+			report(RPT_INFO, "Client on socket %d is slow, pausing its input", c->sock);
+			c->throttled = 1;
+			sock_update_client_events(c);
+			return 0;
 		}
 	}
 
+	if (was_empty)
+		sock_update_client_events(c);
+
 	return 0;
 }
 
 /**
- * \brief Sock read from client
+ * \brief Read all pending data of a client into its receive buffer
  * \param clientSocketMap ClientSocketMap *clientSocketMap
- * \return Return value
+ * \retval 0 Socket drained or receive buffer full of unparsed lines
+ * \retval -1 Connection closed, read error or line longer than CLIENT_INBUF_MAX
+ *
+ * \details Complete lines are taken from the buffer by the parser later on,
+ * an incomplete trailing line stays in place until the rest arrives.
  */
 static int sock_read_from_client(ClientSocketMap *clientSocketMap)
 {
-	char buffer[MAXMSG];
+	Client *c = clientSocketMap->client;
 	int nbytes;
 
 	debug(RPT_DEBUG, "%s()", __FUNCTION__);
 
-	errno = 0;
-	nbytes = sock_recv(clientSocketMap->socket, buffer, MAXMSG);
+	if (c == NULL) {
+		report(RPT_DEBUG, "%s: Can't find client %d", __FUNCTION__,
+		       clientSocketMap->socket);
+		return -1;
+	}
 
-	// Read loop: buffer incoming data to ring, extract complete newline-delimited messages,
-	// dispatch to client, and handle buffer overflow with EAGAIN retry
-	while (nbytes > 0) {
-		int fr;
-		char *str;
+	// Read loop: append to the client's buffer until the socket would block. Stop early when
+	// the buffer is full of unparsed lines; the level-triggered event fires again later.
+	while (1) {
+		size_t avail;
+		char *space = client_recv_space(c, &avail);
 
-		debug(RPT_DEBUG, "%s: received %4d bytes", __FUNCTION__, nbytes);
+		if (space == NULL) {
+			report(RPT_WARNING, "%s: line from socket %d exceeds %d bytes",
+			       __FUNCTION__, clientSocketMap->socket, CLIENT_INBUF_MAX);
+			return -1;
+		}
 
-		sring_write(messageRing, buffer, nbytes);
+		if (avail == 0)
+			return 0;
 
-		do {
-			str = sring_read_string(messageRing);
-			if (clientSocketMap->client) {
-				client_add_message(clientSocketMap->client, str);
-			} else {
-				report(RPT_DEBUG, "%s: Can't find client %d", __FUNCTION__,
-				       clientSocketMap->socket);
-			}
-		} while (str != NULL);
-
-		fr = sring_getMaxWrite(messageRing);
-		if (fr <= 0) {
-			report(RPT_WARNING, "%s: Message buffer full or invalid (fr=%d)",
-			       __FUNCTION__, fr);
-			// Buffer is full, stop reading from socket but don't disconnect
-			nbytes = 0;
-		} else {
-			nbytes =
-			    sock_recv(clientSocketMap->socket, buffer, min(MAXMSG, (size_t)fr));
-		}
-	}
+		errno = 0;
+		nbytes = sock_recv_client(c, space, avail);
 
-	if (sring_getMaxRead(messageRing) > 0) {
-		report(RPT_WARNING, "%s: left over bytes in message buffer", __FUNCTION__);
-		sring_clear(messageRing);
+		if (nbytes <= 0)
+			break;
+
+		debug(RPT_DEBUG, "%s: received %4d bytes", __FUNCTION__, nbytes);
+		client_recv_commit(c, nbytes);
+		parse_schedule_client(c);
 	}
 
 	if (nbytes < 0 && errno == EAGAIN) {
@@ -392,14 +645,53 @@ static int sock_read_from_client(ClientSocketMap *clientSocketMap)
 }
 
 /**
- * \brief Byclient
- * \param csm void *csm
- * \param client void *client
- * \return Return value
+ * \brief Receive bytes and passed descriptors from a client
+ * \param c Client to read from
+ * \param buf Destination buffer
+ * \param len Size of buf
+ * \retval >0 Number of bytes received
+ * \retval 0 Connection closed
+ * \retval -1 Read error, errno is EAGAIN if the socket is drained
+ *
+ * \details Unix domain clients may attach a memfd to the bytes carrying
+ * shm_attach. The descriptor is kept in the client until that command runs;
+ * a later descriptor replaces an unused earlier one. TCP sockets never carry
+ * ancillary data, so the same call serves both.
  */
-int byClient(void *csm, void *client)
+static int sock_recv_client(Client *c, char *buf, size_t len)
 {
-	return (((ClientSocketMap *)csm)->client == (Client *)client) ? 0 : -1;
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct iovec iov = {.iov_base = buf, .iov_len = len};
+	struct msghdr msg = {
+	    .msg_iov = &iov,
+	    .msg_iovlen = 1,
+	    .msg_control = control.buf,
+	    .msg_controllen = sizeof(control.buf),
+	};
+	struct cmsghdr *cmsg;
+	ssize_t nbytes;
+
+	nbytes = recvmsg(c->sock, &msg, MSG_CMSG_CLOEXEC);
+	if (nbytes < 0)
+		return -1;
+
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS) &&
+		    (cmsg->cmsg_len == CMSG_LEN(sizeof(int)))) {
+			if (c->shm_fd >= 0)
+				close(c->shm_fd);
+			memcpy(&c->shm_fd, CMSG_DATA(cmsg), sizeof(int));
+		}
+	}
+
+	// More descriptors than fit into control were closed by the kernel
+	if (msg.msg_flags & MSG_CTRUNC)
+		report(RPT_WARNING, "Client [%d] passed more than one descriptor", c->sock);
+
+	return (int)nbytes;
 }
 
 // Find and destroy socket for given client
@@ -407,12 +699,11 @@ int sock_destroy_client_socket(Client *client)
 {
 	ClientSocketMap *entry;
 
-	LL_Rewind(openSocketList);
-	entry = LL_Find(openSocketList, byClient, client);
-
-	if (entry != NULL) {
-		sock_destroy_socket();
-		return 0;
+	ilist_foreach(entry, &openSocketList, link) {
+		if (entry->client == client) {
+			sock_destroy_socket(entry);
+			return 0;
+		}
 	}
 
 	return -1;
@@ -420,32 +711,31 @@ int sock_destroy_client_socket(Client *client)
 
 /**
  * \brief Close socket and clean up client resources
+ * \param entry Socket map entry of the connection
  *
- * \details Destroys client, removes from client list, closes socket,
- * and frees socket map entry.
+ * \details Unregisters the socket from the event loop, removes the client from
+ * the client list, destroys it, closes the socket and returns the socket map
+ * entry to the pool.
  */
-static void sock_destroy_socket(void)
+static void sock_destroy_socket(ClientSocketMap *entry)
 {
-	ClientSocketMap *entry = LL_Get(openSocketList);
-
-	if (entry != NULL) {
-		if (entry->client != NULL) {
-			report(RPT_NOTICE, "Client on socket %i disconnected", entry->socket);
-			client_destroy(entry->client);
-			clients_remove_client(entry->client, PREV);
-			entry->client = NULL;
-
-		} else {
-			report(RPT_ERR, "%s: Can't find client of socket %i", __FUNCTION__,
-			       entry->socket);
-		}
+	event_remove(entry->socket);
+
+	if (entry->client != NULL) {
+		report(RPT_NOTICE, "Client on socket %i disconnected", entry->socket);
+		parse_forget_client(entry->client);
+		clients_remove_client(entry->client);
+		// client_destroy() closes the socket
+		client_destroy(entry->client);
+		entry->client = NULL;
 
-		FD_CLR(entry->socket, &active_fd_set);
+	} else {
+		report(RPT_ERR, "%s: Can't find client of socket %i", __FUNCTION__, entry->socket);
 		close(entry->socket);
-
-		entry = (ClientSocketMap *)LL_DeleteNode(openSocketList, PREV);
-		LL_Push(freeClientSocketList, (void *)entry);
 	}
+
+	ilist_remove(&openSocketList, &entry->link);
+	ilist_push(&freeClientSocketList, &entry->link);
 }
 
 // Validate IPv4 address string format using inet_pton()
@@ -10,16 +10,17 @@
  * \date 1999-2008
  *
  * \features
- * - TCP socket creation and management
+ * - TCP and Unix domain socket creation and management
  * - Client connection handling
  * - IP address validation (IPv4 and IPv6)
- * - Socket polling and event handling
+ * - Event loop driven connection and data handling
+ * - Non-blocking client output with bounded queues
  * - Client socket cleanup and destruction
  * - Network communication abstraction
  *
  * \usage
  * - Socket system initialization and configuration
- * - Client connection management and polling
+ * - Client connection management via event loop callbacks
  * - IP address validation for access control
  * - Socket resource cleanup and shutdown
  * - Function prototypes for socket operations
@@ -28,7 +29,7 @@
  * network communication functionality for the LCDproc server including
  * client connection management, socket creation, and IP address validation.
  * Handles TCP socket creation and management, client connection handling,
- * IP address validation for both IPv4 and IPv6, socket polling and event
+ * IP address validation for both IPv4 and IPv6, event loop driven socket
  * handling, and client socket cleanup and destruction.
  */
 
@@ -53,7 +54,9 @@
  * \retval 0 Success
  * \retval <0 Initialization failed
  *
- * \details Sets up the server socket and prepares for client connections.
+ * \details Sets up the server socket and, if UnixSocket is configured, a
+ * Unix domain socket, and registers them with the event loop. event_init()
+ * must have been called before.
  */
 int sock_init(char *bind_addr, int bind_port);
 
@@ -78,14 +81,16 @@ int sock_shutdown(void);
 int sock_create_inet_socket(char *bind_addr, unsigned int port);
 
 /**
- * \brief Polls for client activity
- * \retval 0 Success
- * \retval <0 Polling failed
+ * \brief Creates a Unix domain socket
+ * \param path Filesystem path, or "@name" for the Linux abstract namespace
+ * \retval >=0 Socket file descriptor
+ * \retval <0 Socket creation failed
  *
- * \details Checks for new client connections and incoming data
- * from existing clients. Handles socket events and timeouts.
+ * \details Creates a listening AF_UNIX stream socket. A stale socket file
+ * at path is replaced and the new one is made accessible to all local users,
+ * like the loopback TCP port. The file is removed again by sock_shutdown().
  */
-int sock_poll_clients(void);
+int sock_create_unix_socket(const char *path);
 
 /**
  * \brief Destroys a client socket
@@ -97,6 +102,22 @@ int sock_poll_clients(void);
  */
 int sock_destroy_client_socket(Client *client);
 
+/**
+ * \brief Send data to a client without blocking
+ * \param c Client to send to
+ * \param data Bytes to send
+ * \param len Number of bytes
+ * \retval 0 Data sent or queued
+ * \retval -1 Client is gone, the write failed or the client is too slow
+ *
+ * \details Output the socket does not accept immediately is kept in the
+ * client's output queue and flushed with writev() when the socket becomes
+ * writable. Once more than OutputHighWater bytes are queued, the client is
+ * either throttled (its input is no longer read) or marked GONE, depending
+ * on OutputOverflow. GONE clients are destroyed by the parser.
+ */
+int sock_send_client(Client *c, const void *data, size_t len);
+
 /**
  * \brief Verifies IPv4 address format
  * \param addr IPv4 address string to verify
@@ -15,13 +15,12 @@
  * - Widget type name conversion
  * - Icon name/number conversion
  * - Frame widget screen management
- * - Subwidget search functionality
+ * - Short widget strings stored inline, unchanged values never rewritten
  *
  * \usage
  * - Widget object creation and management
  * - Type name and icon conversion utilities
  * - Frame widget with associated screen handling
- * - Widget lookup and search operations
  * - Memory management for widget structures
  *
  * \details This file houses code that handles the creation and destruction of widget
@@ -37,6 +36,8 @@
 #include <string.h>
 #include <strings.h>
 
+#include "shared/arena.h"
+#include "shared/intern.h"
 #include "shared/report.h"
 #include "shared/sockets.h"
 
@@ -113,6 +114,34 @@ struct icontable icontable[] = {{ICON_BLOCK_FILLED, "BLOCK_FILLED"},
 				{ICON_REC, "REC"},
 				{0, NULL}};
 
+/**
+ * \brief Get the inline buffer belonging to one of a widget's string fields
+ * \param w Widget owning the field
+ * \param field &w->text, &w->begin_label or &w->end_label
+ * \return Inline buffer of WIDGET_INLINE_SIZE bytes
+ */
+static char *widget_inline_buf(Widget *w, char **field)
+{
+	if (field == &w->begin_label)
+		return w->begin_buf;
+	if (field == &w->end_label)
+		return w->end_buf;
+
+	return w->text_buf;
+}
+
+/**
+ * \brief Free a widget string unless it lives in the widget
+ * \param a Arena of the widget's screen
+ * \param str String to release (can be NULL)
+ * \param buf Inline buffer of the field str was stored in
+ */
+static void widget_release_string(arena *a, char *str, const char *buf)
+{
+	if (str != buf)
+		arena_free(a, str);
+}
+
 // Create and initialize new widget with default properties
 Widget *widget_create(char *id, WidgetType type, Screen *screen)
 {
@@ -120,9 +149,15 @@ Widget *widget_create(char *id, WidgetType type, Screen *screen)
 
 	debug(RPT_DEBUG, "%s(id=\"%s\", type=%d, screen=[%s])", __FUNCTION__, id, type, screen->id);
 
-	w = calloc(1, sizeof(Widget));
+	w = arena_zalloc(screen->arena, sizeof(Widget));
+	if (w == NULL)
+		return NULL;
 
-	w->id = strdup(id);
+	w->id = intern(id);
+	if (w->id == NULL) {
+		arena_free(screen->arena, w);
+		return NULL;
+	}
 	w->type = type;
 	w->screen = screen;
 
@@ -132,6 +167,7 @@ Widget *widget_create(char *id, WidgetType type, Screen *screen)
 	w->top = 1;
 	w->length = 1;
 	w->speed = 1;
+	w->shm_slot = -1;
 
 	if (type == WID_FRAME) {
 		size_t frame_name_size = sizeof("frame_") + strlen(id);
@@ -143,6 +179,8 @@ Widget *widget_create(char *id, WidgetType type, Screen *screen)
 		strncat(frame_name, id, frame_name_size - strlen(frame_name) - 1);
 
 		w->frame_screen = screen_create(frame_name, screen->client);
+		if (w->frame_screen != NULL)
+			w->frame_screen->parent = screen;
 	}
 
 	return w;
@@ -156,13 +194,52 @@ void widget_destroy(Widget *w)
 	if (!w)
 		return;
 
-	free(w->id);
-	free(w->text);
+	arena *a = w->screen->arena;
+
+	intern_release(w->id);
+	widget_release_string(a, w->text, w->text_buf);
+	widget_release_string(a, w->begin_label, w->begin_buf);
+	widget_release_string(a, w->end_label, w->end_buf);
 
 	if (w->type == WID_FRAME)
 		screen_destroy(w->frame_screen);
 
-	free(w);
+	arena_free(a, w);
+}
+
+// Replace a widget string, inline when short, skipping writes of the same value
+int widget_set_string(Widget *w, char **field, const char *value)
+{
+	arena *a = w->screen->arena;
+	char *buf = widget_inline_buf(w, field);
+	size_t len;
+	char *str;
+
+	if (value == NULL) {
+		if (*field == NULL)
+			return 0;
+		widget_release_string(a, *field, buf);
+		*field = NULL;
+		return 1;
+	}
+
+	if ((*field != NULL) && (strcmp(*field, value) == 0))
+		return 0;
+
+	len = strlen(value) + 1;
+	if (len <= WIDGET_INLINE_SIZE) {
+		widget_release_string(a, *field, buf);
+		memcpy(buf, value, len);
+		*field = buf;
+		return 1;
+	}
+
+	str = arena_strset(a, (*field == buf) ? NULL : *field, value);
+	if (str == NULL)
+		return -1;
+
+	*field = str;
+	return 1;
 }
 
 // Convert widget typename string to WidgetType enum value
@@ -182,16 +259,6 @@ WidgetType widget_typename_to_type(char *typename)
 // Convert WidgetType enum value to typename string
 char *widget_type_to_typename(WidgetType t) { return typenames[t]; }
 
-// Search for widget by ID within frame widget's subwidgets
-Widget *widget_search_subs(Widget *w, char *id)
-{
-	if (w->type == WID_FRAME) {
-		return screen_find_widget(w->frame_screen, id);
-	} else {
-		return NULL;
-	}
-}
-
 // Convert icon number to icon name string
 char *widget_icon_to_iconname(int icon)
 {
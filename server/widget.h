@@ -15,14 +15,12 @@
  * - Progress bars and scrollers
  * - Icon display support
  * - Frame widgets for containers
- * - Widget search and lookup
  *
  * \usage
  * - Widget structure definitions and enumerations
  * - Function prototypes for widget operations
  * - Widget type conversion utilities
  * - Icon name and number mapping
- * - Subwidget search functionality
  *
  * \details Public interface to the widget methods. Provides functionality
  * for creating, managing, and manipulating widget objects that are used
@@ -30,8 +28,8 @@
  * horizontal and vertical bars for progress, icons for graphical elements,
  * scrolling text widgets, title widgets for screen headers, and frame widgets
  * for grouping. Allows creating widgets with specific types and properties,
- * positioning widgets on screen coordinates, updating widget content dynamically,
- * and searching for widgets by ID within screens.
+ * positioning widgets on screen coordinates and updating widget content
+ * dynamically.
  */
 
 #ifndef WIDGET_H
@@ -65,13 +63,21 @@ typedef enum WidgetType {
 	WID_NUM	      ///< Total number of widget types
 } WidgetType;
 
+/**
+ * \brief Bytes of each widget string stored inside the widget, terminator included
+ *
+ * \details Percentages, clock strings and bar labels fit, longer values are
+ * allocated from the arena of the widget's screen.
+ */
+#define WIDGET_INLINE_SIZE 24
+
 /**
  * \brief Widget structure
  * \details Core widget data structure containing all properties
  * and data needed to display widgets on LCD screens
  */
 typedef struct Widget {
-	char *id;		      // The widget's unique identifier name
+	const char *id;		      // The widget's unique identifier name, interned
 	WidgetType type;	      // The widget's type (string, bar, icon, etc.)
 	Screen *screen;		      // What screen is this widget in?
 	int x, y;		      // Position coordinates on screen
@@ -84,6 +90,13 @@ typedef struct Widget {
 	char *begin_label;	      // Label in front of progress bars; or NULL
 	char *end_label;	      // Label at end of progress bars; or NULL
 	struct Screen *frame_screen;  // Frame widgets get an associated screen
+	int shm_slot;		      // Bound shared-memory value slot, -1 if none
+	unsigned int shm_seq;	      // Slot sequence last copied into the widget
+	ilist_link link;	      // Position in its screen's widget list
+
+	char text_buf[WIDGET_INLINE_SIZE];  // Inline storage for a short text
+	char begin_buf[WIDGET_INLINE_SIZE]; // Inline storage for a short begin_label
+	char end_buf[WIDGET_INLINE_SIZE];   // Inline storage for a short end_label
 
 } Widget;
 
@@ -115,6 +128,22 @@ Widget *widget_create(char *id, WidgetType type, Screen *screen);
  */
 void widget_destroy(Widget *w);
 
+/**
+ * \brief Replaces one of a widget's strings
+ * \param w Widget owning the string
+ * \param field &w->text, &w->begin_label or &w->end_label
+ * \param value New value, NULL clears the string
+ * \retval 1 The string changed
+ * \retval 0 The string already held value, nothing was written
+ * \retval -1 Memory allocation failure, the string is unchanged
+ *
+ * \details Values shorter than WIDGET_INLINE_SIZE are stored in the widget
+ * itself. Longer ones use the arena of the widget's screen, overwriting the
+ * current block when it is large enough. Callers use the return value to
+ * decide whether the screen needs a screen_touch().
+ */
+int widget_set_string(Widget *w, char **field, const char *value);
+
 /**
  * \brief Converts a widget typename string to a widget type
  * \param typename String name of widget type
@@ -137,18 +166,6 @@ WidgetType widget_typename_to_type(char *typename);
  */
 char *widget_type_to_typename(WidgetType t);
 
-/**
- * \brief Searches for subwidgets within a widget
- * \param w Parent widget to search in
- * \param id Widget ID to search for
- * \retval Widget* Found widget
- * \retval NULL Widget not found
- *
- * \details Recursively searches for a widget with the given ID
- * within the subwidgets of the specified parent widget.
- */
-Widget *widget_search_subs(Widget *w, char *id);
-
 /**
  * \brief Converts icon number to icon name
  * \param icon Icon number
@@ -11,8 +11,10 @@
  * - Data manipulation: get, put, find
  * - Stack operations: push, pop, top
  * - Queue operations: enqueue, dequeue, shift, unshift
- * - Advanced operations: sort, priority enqueue, node swapping
+ * - Advanced operations: stable merge sort, top-k selection, priority enqueue,
+ *   node swapping
  * - Utility functions: length calculation, indexed access
+ * - Nodes come from per-list slabs and are recycled instead of freed
  *
  * \usage
  * - Create a list with LL_new()
@@ -60,6 +62,71 @@
 #undef DEBUG
 #endif
 
+/** \brief Number of pending runs in LL_Sort(), enough for 2^32 nodes */
+#define LL_SORT_BINS 32
+
+/** \brief Node count of a list's first slab */
+#define LL_SLAB_MIN 4
+/** \brief Upper bound for the node count of one slab */
+#define LL_SLAB_MAX 256
+
+/**
+ * \brief Block of nodes allocated at once
+ * \details Each slab doubles the list's capacity up to LL_SLAB_MAX nodes.
+ */
+typedef struct LL_slab {
+	struct LL_slab *next; ///< Next slab of the same list
+	LL_node nodes[];      ///< Nodes carved from this slab
+} LL_slab;
+
+/**
+ * \brief Take a node from the list's spare chain, allocating a slab if empty
+ * \param list List the node is for
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Unlinked node
+ */
+static LL_node *LL_AllocNode(LinkedList *list)
+{
+	LL_node *node;
+
+	if (list->spare == NULL) {
+		int count = list->capacity;
+		LL_slab *slab;
+
+		if (count < LL_SLAB_MIN)
+			count = LL_SLAB_MIN;
+		if (count > LL_SLAB_MAX)
+			count = LL_SLAB_MAX;
+
+		slab = malloc(sizeof(LL_slab) + count * sizeof(LL_node));
+		if (slab == NULL)
+			return NULL;
+
+		slab->next = list->slabs;
+		list->slabs = slab;
+		list->capacity += count;
+
+		for (int i = 0; i < count; i++) {
+			slab->nodes[i].next = list->spare;
+			list->spare = &slab->nodes[i];
+		}
+	}
+
+	node = list->spare;
+	list->spare = node->next;
+
+	return node;
+}
+
+// Return an unlinked node to the list's spare chain
+static void LL_FreeNode(LinkedList *list, LL_node *node)
+{
+	node->prev = NULL;
+	node->data = NULL;
+	node->next = list->spare;
+	list->spare = node;
+}
+
 // Create new doubly linked list with sentinel nodes
 LinkedList *LL_new(void)
 {
@@ -80,33 +147,25 @@ LinkedList *LL_new(void)
 
 	list->current = &list->head;
 
+	list->spare = NULL;
+	list->slabs = NULL;
+	list->capacity = 0;
+
 	return list;
 }
 
 // Destroy the entire list and free all memory
 int LL_Destroy(LinkedList *list)
 {
-	LL_node *prev, *next;
-	LL_node *node;
+	LL_slab *slab, *next;
 
 	if (!list)
 		return -1;
 
-	node = &list->head;
-
-	// Traverse and free all nodes except sentinels
-	for (node = node->next; node && node->next; node = next) {
-		next = node->next;
-		prev = node->prev;
-
-		if (next != NULL)
-			next->prev = prev;
-		if (prev != NULL)
-			prev->next = next;
-
-		node->next = NULL;
-		node->prev = NULL;
-		free(node);
+	// Every node lives in a slab, linked or spare
+	for (slab = list->slabs; slab != NULL; slab = next) {
+		next = slab->next;
+		free(slab);
 	}
 
 	free(list);
@@ -308,7 +367,7 @@ int LL_AddNode(LinkedList *list, void *add)
 	if (!list->current)
 		return -1;
 
-	node = malloc(sizeof(LL_node));
+	node = LL_AllocNode(list);
 	if (node == NULL)
 		return -1;
 
@@ -343,7 +402,7 @@ int LL_InsertNode(LinkedList *list, void *add)
 	if (!list->current)
 		return -1;
 
-	node = malloc(sizeof(LL_node));
+	node = LL_AllocNode(list);
 	if (node == NULL)
 		return -1;
 
@@ -376,7 +435,7 @@ void *LL_DeleteNode(LinkedList *list, Direction whereto)
 	if (!list->current)
 		return NULL;
 
-	// Protect sentinel nodes, unlink current node from list, clean up pointers, and free memory
+	// Protect sentinel nodes, unlink current node from list and recycle it
 	if (list->current == &list->head)
 		return NULL;
 	if (list->current == &list->tail)
@@ -392,10 +451,7 @@ void *LL_DeleteNode(LinkedList *list, Direction whereto)
 	if (next)
 		next->prev = prev;
 
-	list->current->prev = NULL;
-	list->current->next = NULL;
-	list->current->data = NULL;
-	free(list->current);
+	LL_FreeNode(list, list->current);
 
 	// Set new current position based on direction
 	switch (whereto) {
@@ -664,13 +720,39 @@ void *LL_GetByIndex(LinkedList *list, int index)
 	return NULL;
 }
 
-// Sort list by its contents using bubble sort algorithm
+/**
+ * \brief Merge two sorted NULL-terminated chains linked through next
+ * \param a Chain of the earlier nodes
+ * \param b Chain of the later nodes
+ * \param compare Comparison function
+ * \return Merged chain, nodes of a first on ties
+ */
+static LL_node *LL_Merge(LL_node *a, LL_node *b, int (*compare)(void *, void *))
+{
+	LL_node merged;
+	LL_node *last = &merged;
+
+	while ((a != NULL) && (b != NULL)) {
+		if (compare(a->data, b->data) > 0) {
+			last->next = b;
+			b = b->next;
+		} else {
+			last->next = a;
+			a = a->next;
+		}
+		last = last->next;
+	}
+	last->next = (a != NULL) ? a : b;
+
+	return merged.next;
+}
+
+// Sort list by its contents using a stable bottom-up merge sort
 int LL_Sort(LinkedList *list, int (*compare)(void *, void *))
 {
-	int i, j;
-	int numnodes;
-	LL_node *best, *last;
-	LL_node *current;
+	LL_node *bins[LL_SORT_BINS] = {NULL};
+	LL_node *node, *next, *run, *prev;
+	int i;
 
 	if (!list)
 		return -1;
@@ -678,41 +760,153 @@ int LL_Sort(LinkedList *list, int (*compare)(void *, void *))
 	if (!compare)
 		return -1;
 
-	numnodes = LL_Length(list);
+	if (list->head.next == &list->tail) {
+		LL_Rewind(list);
+		return 0;
+	}
 
-	if (0 > LL_End(list))
+	// Detach the nodes as a chain; prev pointers are rebuilt at the end
+	list->tail.prev->next = NULL;
+	node = list->head.next;
+
+	// bins[i] holds a sorted run of 2^i nodes; each new node is carried upwards like in a
+	// binary counter, always merging the earlier run first to keep the sort stable
+	while (node != NULL) {
+		next = node->next;
+		node->next = NULL;
+		run = node;
+
+		for (i = 0; (i < LL_SORT_BINS - 1) && (bins[i] != NULL); i++) {
+			run = LL_Merge(bins[i], run, compare);
+			bins[i] = NULL;
+		}
+		bins[i] = (bins[i] != NULL) ? LL_Merge(bins[i], run, compare) : run;
+
+		node = next;
+	}
+
+	// Higher bins hold earlier nodes
+	run = NULL;
+	for (i = 0; i < LL_SORT_BINS; i++) {
+		if (bins[i] != NULL)
+			run = (run != NULL) ? LL_Merge(bins[i], run, compare) : bins[i];
+	}
+
+	prev = &list->head;
+	for (node = run; node != NULL; node = node->next) {
+		prev->next = node;
+		node->prev = prev;
+		prev = node;
+	}
+	prev->next = &list->tail;
+	list->tail.prev = prev;
+
+	LL_Rewind(list);
+
+	return 0;
+}
+
+/**
+ * \brief Candidate of LL_TopK() with its list position for stable ordering
+ */
+typedef struct LL_TopKEntry {
+	void *data; ///< Node data
+	int index;  ///< Position in the list
+} LL_TopKEntry;
+
+/**
+ * \brief Test whether one candidate sorts behind another like in LL_Sort()
+ * \param x First candidate
+ * \param y Second candidate
+ * \param compare Comparison function
+ * \retval 1 x comes after y
+ * \retval 0 x comes before y
+ */
+static int LL_TopKAfter(const LL_TopKEntry *x, const LL_TopKEntry *y,
+			int (*compare)(void *, void *))
+{
+	if (x->index < y->index)
+		return compare(x->data, y->data) > 0;
+
+	return !(compare(y->data, x->data) > 0);
+}
+
+/**
+ * \brief Restore the heap property below a slot of a max-heap
+ * \param heap Heap array, the root sorts last
+ * \param size Number of entries in the heap
+ * \param i Slot whose entry may sort before its children
+ * \param compare Comparison function
+ */
+static void LL_TopKSiftDown(LL_TopKEntry *heap, int size, int i, int (*compare)(void *, void *))
+{
+	for (;;) {
+		int child = 2 * i + 1;
+		LL_TopKEntry tmp;
+
+		if (child >= size)
+			return;
+		if ((child + 1 < size) && LL_TopKAfter(&heap[child + 1], &heap[child], compare))
+			child++;
+		if (!LL_TopKAfter(&heap[child], &heap[i], compare))
+			return;
+
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+
+// Select the k nodes LL_Sort() would put first, without sorting the list
+int LL_TopK(LinkedList *list, int (*compare)(void *, void *), void **out, int k)
+{
+	LL_TopKEntry *heap;
+	LL_node *node;
+	int size = 0;
+	int index = 0;
+
+	if (!list || !compare || !out || (k < 0))
 		return -1;
-	last = LL_GetNode(list);
 
-	if (numnodes < 2)
+	if (k == 0)
 		return 0;
 
-	// Bubble sort: iterate through decreasing ranges
-	for (i = numnodes - 1; i > 0; i--) {
-		LL_Rewind(list);
-		best = last;
+	heap = malloc(k * sizeof(LL_TopKEntry));
+	if (heap == NULL)
+		return -1;
+
+	// Keep the best k in a max-heap whose root is the worst of them
+	for (node = list->head.next; node != &list->tail; node = node->next, index++) {
+		LL_TopKEntry entry = {node->data, index};
+
+		if (size < k) {
+			int i = size++;
 
-		// Find the largest element in current range
-		for (j = 0; j < i; j++) {
-			current = LL_GetNode(list);
-			if (compare(current->data, best->data) > 0) {
-				best = current;
+			heap[i] = entry;
+			while ((i > 0) && LL_TopKAfter(&heap[i], &heap[(i - 1) / 2], compare)) {
+				LL_TopKEntry tmp = heap[i];
+
+				heap[i] = heap[(i - 1) / 2];
+				heap[(i - 1) / 2] = tmp;
+				i = (i - 1) / 2;
 			}
-			LL_Next(list);
+		} else if (LL_TopKAfter(&heap[0], &entry, compare)) {
+			heap[0] = entry;
+			LL_TopKSiftDown(heap, size, 0, compare);
 		}
+	}
 
-		// Swap largest element to end of current range
-		LL_SwapNodes(last, best);
-
-		if (best)
-			last = best->prev;
-		else
-			return -1;
+	// Pop the worst remaining candidate into the last free output slot
+	for (int n = size; n > 0; n--) {
+		out[n - 1] = heap[0].data;
+		heap[0] = heap[n - 1];
+		LL_TopKSiftDown(heap, n - 1, 0, compare);
 	}
 
-	LL_Rewind(list);
+	free(heap);
 
-	return 0;
+	return size;
 }
 
 // Print debug information about the linked list structure
@@ -110,7 +110,7 @@
     LL_Enqueue()   // Standard queue operations
     LL_Dequeue()
 
-  There are also other goodies, like sorting and searching.
+  There are also other goodies, like sorting, top-k selection and searching.
 
   // See LL.c for more detailed descriptions of these functions.
 
@@ -147,11 +147,18 @@ typedef struct LL_node {
  * \brief Structure for a doubly linked list
  * \details Uses sentinel nodes (head/tail anchors) for simplified traversal.
  * The current pointer tracks the active position during iteration.
+ *
+ * Nodes are carved from slabs owned by the list. Removed nodes go onto the
+ * spare chain and are reused by the next insertion; slabs are only freed by
+ * LL_Destroy().
  */
 typedef struct LinkedList {
-	LL_node head;	  ///< List's head anchor (sentinel)
-	LL_node tail;	  ///< List's tail anchor (sentinel)
-	LL_node *current; ///< Pointer to current node during iteration
+	LL_node head;	       ///< List's head anchor (sentinel)
+	LL_node tail;	       ///< List's tail anchor (sentinel)
+	LL_node *current;      ///< Pointer to current node during iteration
+	LL_node *spare;	       ///< Unused nodes, chained through next
+	struct LL_slab *slabs; ///< Node slabs allocated for this list
+	int capacity;	       ///< Number of nodes in all slabs
 } LinkedList;
 
 /**
@@ -521,10 +528,27 @@ void *LL_GetByIndex(LinkedList *list, int index);
  * \retval 0 Success
  *
  * \details The list gets sorted using a comparison function for the data of its nodes.
- * After the sorting, the list's current pointer is set to the first node.
+ * compare(a, b) > 0 means that a belongs behind b. The sort is a stable bottom-up merge
+ * sort: nodes that compare equal keep their order, and sorting takes O(n log n)
+ * comparisons. After the sorting, the list's current pointer is set to the first node.
  */
 int LL_Sort(LinkedList *list, int (*compare)(void *, void *));
 
+/**
+ * \brief Select the first nodes of the sorted order without sorting
+ * \param list List object, left unchanged
+ * \param compare Comparison function as for LL_Sort()
+ * \param out Array receiving at least k data pointers
+ * \param k Number of nodes wanted
+ * \retval -1 Error
+ * \retval >=0 Number of pointers stored, less than k if the list is shorter
+ *
+ * \details Stores the data of the nodes LL_Sort() would put into the first k
+ * places, in that order, ties included. Uses a bounded heap of k entries, so
+ * the cost is O(n log k) comparisons for a list of n nodes.
+ */
+int LL_TopK(LinkedList *list, int (*compare)(void *, void *), void **out, int k);
+
 /**
  * \brief Print debug information about the linked list structure
  * \param list List object to examine
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/arena.c
+ * \brief Region allocator with size-class free lists
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Power-of-two size classes from 16 to 1024 bytes
+ * - Chunks grow from 2 KiB to 16 KiB as the arena fills
+ * - Large blocks on a list of their own, freed individually or with the arena
+ *
+ * \usage
+ * - Used for the screens, widgets and strings of one LCDd client
+ *
+ * \details Small blocks are cut from the current chunk with a bump pointer.
+ * A freed small block goes onto the free list of its class and is handed out
+ * again before the chunk grows, so an owner that keeps replacing values of
+ * similar size stops allocating after warm-up. Chunks are only returned by
+ * arena_destroy().
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+/** \brief Number of small size classes */
+#define ARENA_CLASSES 7
+/** \brief Payload size of the smallest class as a power of two */
+#define ARENA_MIN_SHIFT 4
+/** \brief Largest payload served from chunks */
+#define ARENA_MAX_SMALL (1u << (ARENA_MIN_SHIFT + ARENA_CLASSES - 1))
+/** \brief Class number marking a large block */
+#define ARENA_LARGE ARENA_CLASSES
+/** \brief Size of the first chunk */
+#define ARENA_CHUNK_MIN 2048
+/** \brief Upper bound for the size of later chunks */
+#define ARENA_CHUNK_MAX 16384
+
+/**
+ * \brief Header in front of every block
+ * \details Two words keep the payload aligned like malloc() memory.
+ */
+typedef struct arena_header {
+	size_t cls; ///< Size class, ARENA_LARGE for a large block
+	size_t cap; ///< Usable bytes behind the header
+} arena_header;
+
+/**
+ * \brief Link in front of the header of a large block
+ */
+typedef struct arena_large {
+	struct arena_large *prev; ///< Previous large block, the arena's sentinel at the front
+	struct arena_large *next; ///< Next large block, the arena's sentinel at the back
+} arena_large;
+
+/**
+ * \brief Chunk header, small blocks follow it
+ */
+typedef struct arena_chunk {
+	struct arena_chunk *next; ///< Previously allocated chunk
+	size_t size;		  ///< Bytes behind this header
+} arena_chunk;
+
+/**
+ * \brief Arena state
+ */
+struct arena {
+	void *free[ARENA_CLASSES]; ///< Free blocks per class, chained through their payload
+	arena_chunk *chunks;	   ///< All chunks, newest first
+	char *bump;		   ///< Next unused byte in the newest chunk
+	size_t left;		   ///< Unused bytes in the newest chunk
+	size_t next_chunk;	   ///< Size of the next chunk
+	arena_large large;	   ///< Sentinel of the large block list
+	arena_usage usage;	   ///< Figures for arena_get_usage()
+};
+
+// Smallest class whose payload holds size bytes
+static size_t arena_class(size_t size)
+{
+	size_t cls = 0;
+
+	while (((size_t)1 << (ARENA_MIN_SHIFT + cls)) < size)
+		cls++;
+
+	return cls;
+}
+
+/**
+ * \brief Allocate a block too large for the chunks
+ * \param a Arena
+ * \param size Requested size in bytes
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Payload of the new block
+ */
+static void *arena_alloc_large(arena *a, size_t size)
+{
+	size_t total = sizeof(arena_large) + sizeof(arena_header) + size;
+	arena_large *link = malloc(total);
+	arena_header *hdr;
+
+	if (link == NULL)
+		return NULL;
+
+	link->prev = a->large.prev;
+	link->next = &a->large;
+	a->large.prev->next = link;
+	a->large.prev = link;
+
+	hdr = (arena_header *)(link + 1);
+	hdr->cls = ARENA_LARGE;
+	hdr->cap = size;
+
+	a->usage.reserved += total;
+	a->usage.used += total;
+	a->usage.blocks++;
+
+	return hdr + 1;
+}
+
+/**
+ * \brief Start a new chunk big enough for one block of need bytes
+ * \param a Arena
+ * \param need Header plus payload of the block
+ * \retval 0 Success
+ * \retval -1 Memory allocation failure
+ */
+static int arena_grow(arena *a, size_t need)
+{
+	size_t size = (a->next_chunk > need) ? a->next_chunk : need;
+	arena_chunk *chunk = malloc(sizeof(arena_chunk) + size);
+
+	if (chunk == NULL)
+		return -1;
+
+	chunk->next = a->chunks;
+	chunk->size = size;
+	a->chunks = chunk;
+	a->bump = (char *)(chunk + 1);
+	a->left = size;
+
+	if (a->next_chunk < ARENA_CHUNK_MAX)
+		a->next_chunk *= 2;
+
+	a->usage.reserved += sizeof(arena_chunk) + size;
+	a->usage.chunks++;
+
+	return 0;
+}
+
+// Create an empty arena
+arena *arena_create(void)
+{
+	arena *a = calloc(1, sizeof(arena));
+
+	if (a == NULL)
+		return NULL;
+
+	a->next_chunk = ARENA_CHUNK_MIN;
+	a->large.prev = &a->large;
+	a->large.next = &a->large;
+	a->usage.reserved = sizeof(arena);
+
+	return a;
+}
+
+// Free all chunks and large blocks, then the arena itself
+void arena_destroy(arena *a)
+{
+	arena_chunk *chunk, *next_chunk;
+	arena_large *link, *next_link;
+
+	if (a == NULL)
+		return;
+
+	for (chunk = a->chunks; chunk != NULL; chunk = next_chunk) {
+		next_chunk = chunk->next;
+		free(chunk);
+	}
+
+	for (link = a->large.next; link != &a->large; link = next_link) {
+		next_link = link->next;
+		free(link);
+	}
+
+	free(a);
+}
+
+// Allocate a block from the arena
+void *arena_alloc(arena *a, size_t size)
+{
+	arena_header *hdr;
+	size_t cls, cap;
+
+	if (a == NULL)
+		return malloc(size);
+
+	if (size > ARENA_MAX_SMALL)
+		return arena_alloc_large(a, size);
+
+	cls = arena_class(size);
+	cap = (size_t)1 << (ARENA_MIN_SHIFT + cls);
+
+	if (a->free[cls] != NULL) {
+		void *p = a->free[cls];
+
+		a->free[cls] = *(void **)p;
+		hdr = (arena_header *)p - 1;
+	} else {
+		if ((a->left < sizeof(arena_header) + cap) &&
+		    (arena_grow(a, sizeof(arena_header) + cap) < 0))
+			return NULL;
+
+		hdr = (arena_header *)a->bump;
+		hdr->cls = cls;
+		hdr->cap = cap;
+		a->bump += sizeof(arena_header) + cap;
+		a->left -= sizeof(arena_header) + cap;
+	}
+
+	a->usage.used += sizeof(arena_header) + cap;
+	a->usage.blocks++;
+
+	return hdr + 1;
+}
+
+// Allocate a zeroed block from the arena
+void *arena_zalloc(arena *a, size_t size)
+{
+	void *p;
+
+	if (a == NULL)
+		return calloc(1, size);
+
+	p = arena_alloc(a, size);
+	if (p != NULL)
+		memset(p, 0, size);
+
+	return p;
+}
+
+// Resize a block, in place while it fits its capacity
+void *arena_realloc(arena *a, void *p, size_t size)
+{
+	arena_header *hdr;
+	void *n;
+
+	if (a == NULL)
+		return realloc(p, size);
+
+	if (p == NULL)
+		return arena_alloc(a, size);
+
+	hdr = (arena_header *)p - 1;
+	if (size <= hdr->cap)
+		return p;
+
+	n = arena_alloc(a, size);
+	if (n == NULL)
+		return NULL;
+
+	memcpy(n, p, hdr->cap);
+	arena_free(a, p);
+
+	return n;
+}
+
+// Put a block on its class free list, or release a large block
+void arena_free(arena *a, void *p)
+{
+	arena_header *hdr;
+
+	if (a == NULL) {
+		free(p);
+		return;
+	}
+
+	if (p == NULL)
+		return;
+
+	hdr = (arena_header *)p - 1;
+	a->usage.blocks--;
+
+	if (hdr->cls == ARENA_LARGE) {
+		arena_large *link = (arena_large *)hdr - 1;
+		size_t total = sizeof(arena_large) + sizeof(arena_header) + hdr->cap;
+
+		link->prev->next = link->next;
+		link->next->prev = link->prev;
+		a->usage.reserved -= total;
+		a->usage.used -= total;
+		free(link);
+		return;
+	}
+
+	a->usage.used -= sizeof(arena_header) + hdr->cap;
+	*(void **)p = a->free[hdr->cls];
+	a->free[hdr->cls] = p;
+}
+
+// Copy a string into the arena
+char *arena_strdup(arena *a, const char *s)
+{
+	size_t len = strlen(s) + 1;
+	char *p = arena_alloc(a, len);
+
+	if (p != NULL)
+		memcpy(p, s, len);
+
+	return p;
+}
+
+// Replace a string, overwriting it in place when the new value fits
+char *arena_strset(arena *a, char *old, const char *s)
+{
+	size_t len = strlen(s) + 1;
+	char *p;
+
+	if ((a != NULL) && (old != NULL) && (len <= ((arena_header *)old - 1)->cap)) {
+		memcpy(old, s, len);
+		return old;
+	}
+
+	p = arena_strdup(a, s);
+	if (p != NULL)
+		arena_free(a, old);
+
+	return p;
+}
+
+// Report the current figures of an arena
+void arena_get_usage(const arena *a, arena_usage *usage)
+{
+	if (a == NULL) {
+		memset(usage, 0, sizeof(arena_usage));
+		return;
+	}
+
+	*usage = a->usage;
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/arena.h
+ * \brief Region allocator with size-class free lists
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Blocks carved from large chunks, one arena per owner
+ * - Freed blocks are kept on per-size-class lists and reused
+ * - Resizing a block within its size class happens in place
+ * - Blocks above the largest class get their own allocation, still owned by the arena
+ * - Releasing the arena frees everything at once
+ * - Usage statistics for reporting
+ *
+ * \usage
+ * - arena_create() one arena per owner, arena_destroy() it with the owner
+ * - arena_alloc(), arena_zalloc(), arena_strdup(), arena_realloc() and
+ *   arena_free() work like their libc counterparts
+ * - arena_strset() replaces a string, reusing its block when the new one fits
+ * - A NULL arena makes every call fall through to plain malloc()/free(),
+ *   so code shared between arena and heap owners needs no second path
+ *
+ * \details Each block starts with a small header naming its size class, so
+ * arena_free() needs no size and arena_realloc() knows the capacity. The
+ * header costs 16 bytes per block. Blocks of one arena must not be passed to
+ * another arena or to free().
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/** \brief Opaque arena, see shared/arena.c */
+typedef struct arena arena;
+
+/**
+ * \brief Usage figures of an arena
+ */
+typedef struct arena_usage {
+	size_t reserved; ///< Bytes obtained from malloc() for chunks and large blocks
+	size_t used;	 ///< Bytes in live blocks, headers and class rounding included
+	size_t blocks;	 ///< Number of live blocks
+	size_t chunks;	 ///< Number of chunks
+} arena_usage;
+
+/**
+ * \brief Create an empty arena
+ * \retval NULL Memory allocation failure
+ * \retval !NULL New arena, no chunk is allocated before the first block
+ */
+arena *arena_create(void);
+
+/**
+ * \brief Free an arena and every block allocated from it
+ * \param a Arena to destroy (can be NULL)
+ */
+void arena_destroy(arena *a);
+
+/**
+ * \brief Allocate a block
+ * \param a Arena, NULL for malloc()
+ * \param size Requested size in bytes
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Uninitialized block of at least size bytes
+ */
+void *arena_alloc(arena *a, size_t size);
+
+/**
+ * \brief Allocate a zeroed block
+ * \param a Arena, NULL for calloc()
+ * \param size Requested size in bytes
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Block of size zero bytes
+ */
+void *arena_zalloc(arena *a, size_t size);
+
+/**
+ * \brief Resize a block
+ * \param a Arena p belongs to, NULL for realloc()
+ * \param p Block to resize, NULL allocates
+ * \param size New size in bytes
+ * \retval NULL Memory allocation failure, p is unchanged
+ * \retval !NULL Resized block, equal to p if it stayed in place
+ */
+void *arena_realloc(arena *a, void *p, size_t size);
+
+/**
+ * \brief Return a block to its arena
+ * \param a Arena p belongs to, NULL for free()
+ * \param p Block to free (can be NULL)
+ */
+void arena_free(arena *a, void *p);
+
+/**
+ * \brief Copy a string into a new block
+ * \param a Arena, NULL for strdup()
+ * \param s String to copy
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Copy of s
+ */
+char *arena_strdup(arena *a, const char *s);
+
+/**
+ * \brief Replace a string, reusing its block if the new value fits
+ * \param a Arena old belongs to, NULL for free() and strdup()
+ * \param old Current string (can be NULL)
+ * \param s New value, must not point into old
+ * \retval NULL Memory allocation failure, old is unchanged
+ * \retval !NULL String holding s, equal to old if it was overwritten in place
+ */
+char *arena_strset(arena *a, char *old, const char *s);
+
+/**
+ * \brief Report the usage of an arena
+ * \param a Arena to query (NULL reports zeros)
+ * \param usage Filled with the current figures
+ */
+void arena_get_usage(const arena *a, arena_usage *usage);
+
+#endif
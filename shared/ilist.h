@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/ilist.h
+ * \brief Intrusive doubly linked list with external iterators
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Links live inside the listed objects, adding and removing never allocates
+ * - O(1) removal of an object without searching the list
+ * - No cursor inside the list: any number of loops may walk it at once
+ * - Safe iteration variant that tolerates removing the current object
+ *
+ * \usage
+ * - Embed an ilist_link in the struct to be listed, one per list it can be on
+ * - ilist_init() the list, ilist_push() / ilist_insert_before() / ilist_remove()
+ * - Walk with ilist_foreach() or ilist_foreach_safe(), or step manually with
+ *   ilist_first() and ilist_next(), which return NULL at the end
+ *
+ * \details The list is circular around a sentinel link embedded in the list
+ * head, so insertion and removal need no special cases. Loops yield the
+ * containing objects directly; ilist_entry() converts a link by hand. An
+ * object's link is NULL while it is on no list.
+ *
+ * Unlike LinkedList (shared/LL.h) the iteration state is owned by the caller,
+ * so a function called from inside a loop may walk the same list again.
+ */
+
+#ifndef ILIST_H
+#define ILIST_H
+
+#include <stddef.h>
+
+/**
+ * \brief Link embedded in a listed object
+ */
+typedef struct ilist_link {
+	struct ilist_link *prev; ///< Previous link, the list's sentinel at the front
+	struct ilist_link *next; ///< Next link, the list's sentinel at the back
+} ilist_link;
+
+/**
+ * \brief List head
+ */
+typedef struct ilist {
+	ilist_link head; ///< Sentinel, head.next is the first link
+	int count;	 ///< Number of linked objects
+} ilist;
+
+/**
+ * \brief Get the object containing a link
+ * \param link Pointer to the ilist_link member
+ * \param type Type of the containing struct
+ * \param member Name of the ilist_link member in type
+ */
+#define ilist_entry(link, type, member) ((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ * \brief Iterate over all objects of a list
+ * \param pos Loop variable, pointer to the object type
+ * \param list List to walk
+ * \param member Name of the ilist_link member in *pos
+ *
+ * \details The loop body must not unlink pos, use ilist_foreach_safe() for that.
+ */
+#define ilist_foreach(pos, list, member)                                                           \
+	for (pos = ilist_entry((list)->head.next, __typeof__(*pos), member);                       \
+	     &pos->member != &(list)->head;                                                        \
+	     pos = ilist_entry(pos->member.next, __typeof__(*pos), member))
+
+/**
+ * \brief Iterate over all objects of a list, allowing removal of the current one
+ * \param pos Loop variable, pointer to the object type
+ * \param tmp Second variable of the same type holding the next object
+ * \param list List to walk
+ * \param member Name of the ilist_link member in *pos
+ */
+#define ilist_foreach_safe(pos, tmp, list, member)                                                 \
+	for (pos = ilist_entry((list)->head.next, __typeof__(*pos), member),                       \
+	    tmp = ilist_entry(pos->member.next, __typeof__(*pos), member);                         \
+	     &pos->member != &(list)->head;                                                        \
+	     pos = tmp, tmp = ilist_entry(tmp->member.next, __typeof__(*pos), member))
+
+/**
+ * \brief Initialize an empty list
+ * \param list List to initialize
+ */
+static inline void ilist_init(ilist *list)
+{
+	list->head.prev = &list->head;
+	list->head.next = &list->head;
+	list->count = 0;
+}
+
+/**
+ * \brief Check whether an object is on a list
+ * \param link The object's link
+ * \retval 1 Linked
+ * \retval 0 Not linked
+ *
+ * \details Only valid for links that were zeroed or unlinked by ilist_remove().
+ */
+static inline int ilist_linked(const ilist_link *link) { return link->next != NULL; }
+
+/**
+ * \brief Insert a link in front of another
+ * \param list List containing pos
+ * \param pos Link to insert before, &list->head appends
+ * \param link Unlinked link to insert
+ */
+static inline void ilist_insert_before(ilist *list, ilist_link *pos, ilist_link *link)
+{
+	link->prev = pos->prev;
+	link->next = pos;
+	pos->prev->next = link;
+	pos->prev = link;
+	list->count++;
+}
+
+/**
+ * \brief Append a link to the end of a list
+ * \param list List to append to
+ * \param link Unlinked link to append
+ */
+static inline void ilist_push(ilist *list, ilist_link *link)
+{
+	ilist_insert_before(list, &list->head, link);
+}
+
+/**
+ * \brief Unlink a link from its list
+ * \param list List containing link
+ * \param link Linked link to remove
+ */
+static inline void ilist_remove(ilist *list, ilist_link *link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	link->prev = NULL;
+	link->next = NULL;
+	list->count--;
+}
+
+/**
+ * \brief Get the first link of a list
+ * \param list List to query
+ * \retval NULL List is empty
+ * \retval !NULL First link
+ */
+static inline ilist_link *ilist_first(const ilist *list)
+{
+	return (list->head.next != &list->head) ? list->head.next : NULL;
+}
+
+/**
+ * \brief Get the last link of a list
+ * \param list List to query
+ * \retval NULL List is empty
+ * \retval !NULL Last link
+ */
+static inline ilist_link *ilist_last(const ilist *list)
+{
+	return (list->head.prev != &list->head) ? list->head.prev : NULL;
+}
+
+/**
+ * \brief Get the link following another
+ * \param list List containing link
+ * \param link Current link
+ * \retval NULL link is the last one
+ * \retval !NULL Next link
+ */
+static inline ilist_link *ilist_next(const ilist *list, const ilist_link *link)
+{
+	return (link->next != &list->head) ? link->next : NULL;
+}
+
+/**
+ * \brief Get the link preceding another
+ * \param list List containing link
+ * \param link Current link
+ * \retval NULL link is the first one
+ * \retval !NULL Previous link
+ */
+static inline ilist_link *ilist_prev(const ilist *list, const ilist_link *link)
+{
+	return (link->prev != &list->head) ? link->prev : NULL;
+}
+
+#endif
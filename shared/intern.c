@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/intern.c
+ * \brief Global table of interned identifier strings
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Atoms stored in a strhash keyed by their own text
+ * - Reference count kept in front of the string, no second lookup on release
+ * - Table created on first use
+ *
+ * \usage
+ * - Used for screen, widget, menu item and key reservation ids in LCDd
+ *
+ * \details Each atom is one allocation holding the reference count and the
+ * characters. The hash table borrows the characters as its key and maps
+ * them to the allocation, so intern() and intern_find() cost one probe and
+ * intern_release() none. The table itself is freed with the last atom, which
+ * keeps leak checkers quiet after shutdown.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+#include "strhash.h"
+
+/**
+ * \brief One interned string
+ */
+typedef struct intern_atom {
+	unsigned int refs; ///< Number of holders
+	char str[];	   ///< The characters, NUL-terminated
+} intern_atom;
+
+/** \brief All atoms, keyed by their text */
+static strhash *atoms = NULL;
+
+// Header of the atom whose characters start at str
+static intern_atom *intern_header(const char *str)
+{
+	return (intern_atom *)(str - offsetof(intern_atom, str));
+}
+
+// Get the atom for a string, creating it if needed
+const char *intern(const char *s)
+{
+	intern_atom *atom;
+	size_t len;
+
+	if (atoms == NULL) {
+		atoms = strhash_create();
+		if (atoms == NULL)
+			return NULL;
+	}
+
+	atom = strhash_get(atoms, s);
+	if (atom != NULL) {
+		atom->refs++;
+		return atom->str;
+	}
+
+	len = strlen(s) + 1;
+	atom = malloc(sizeof(intern_atom) + len);
+	if (atom == NULL)
+		return NULL;
+
+	atom->refs = 1;
+	memcpy(atom->str, s, len);
+
+	if (strhash_insert(atoms, atom->str, atom) != 0) {
+		free(atom);
+		return NULL;
+	}
+
+	return atom->str;
+}
+
+// Look up the atom for a string without creating it
+const char *intern_find(const char *s)
+{
+	intern_atom *atom;
+
+	if ((atoms == NULL) || (s == NULL))
+		return NULL;
+
+	atom = strhash_get(atoms, s);
+
+	return (atom != NULL) ? atom->str : NULL;
+}
+
+// Take another reference to an atom
+const char *intern_ref(const char *atom)
+{
+	intern_header(atom)->refs++;
+
+	return atom;
+}
+
+// Drop a reference, freeing the atom with the last one
+void intern_release(const char *atom)
+{
+	intern_atom *a;
+
+	if (atom == NULL)
+		return;
+
+	a = intern_header(atom);
+	if (--a->refs > 0)
+		return;
+
+	strhash_remove(atoms, a->str);
+	free(a);
+
+	if (atoms->count == 0) {
+		strhash_destroy(atoms);
+		atoms = NULL;
+	}
+}
+
+// Number of distinct atoms currently interned
+unsigned int intern_count(void) { return (atoms != NULL) ? atoms->count : 0; }
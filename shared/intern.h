@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/intern.h
+ * \brief Global table of interned identifier strings
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - One shared copy per distinct identifier
+ * - Equal identifiers are equal pointers, compared without strcmp()
+ * - Lookup without interning, an unknown string is rejected by one hash probe
+ * - Reference counted, an identifier is freed with its last user
+ *
+ * \usage
+ * - intern() a string when an object takes it as its id
+ * - intern_release() it when the object goes away
+ * - intern_find() a string received from outside before searching for it,
+ *   then compare the result with stored ids by pointer
+ *
+ * \details Atoms are ordinary NUL-terminated strings and can be printed or
+ * passed to any function reading a string, but must never be modified or
+ * passed to free(). The table is not thread safe; LCDd only touches it from
+ * the main loop.
+ */
+
+#ifndef INTERN_H
+#define INTERN_H
+
+/**
+ * \brief Get the atom for a string, creating it if needed
+ * \param s String to intern
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Atom equal to s, holding one more reference
+ */
+const char *intern(const char *s);
+
+/**
+ * \brief Look up the atom for a string without creating it
+ * \param s String to look up
+ * \retval NULL No object uses s as its id
+ * \retval !NULL Atom equal to s, the reference count is unchanged
+ */
+const char *intern_find(const char *s);
+
+/**
+ * \brief Take another reference to an atom
+ * \param atom Atom returned by intern()
+ * \return atom
+ */
+const char *intern_ref(const char *atom);
+
+/**
+ * \brief Drop a reference to an atom
+ * \param atom Atom returned by intern() or intern_ref() (can be NULL)
+ *
+ * \details The atom is freed when its last reference is dropped.
+ */
+void intern_release(const char *atom);
+
+/**
+ * \brief Number of distinct atoms currently interned
+ * \return Atom count
+ */
+unsigned int intern_count(void);
+
+#endif
@@ -61,10 +61,16 @@ static void store_report_message(int level, const char *message);
 // Flush stored messages to configured destination
 static void flush_messages();
 
+// Check whether messages of a level are reported
+int report_enabled(const int level)
+{
+	return (level <= report_level) || (report_dest == RPT_DEST_STORE);
+}
+
 // Report a message to the selected destination if important enough
 void report(const int level, const char *format, ...)
 {
-	if (level <= report_level || report_dest == RPT_DEST_STORE) {
+	if (report_enabled(level)) {
 		char buf[1024];
 		va_list ap;
 
@@ -91,6 +91,16 @@
  */
 int set_reporting(char *application_name, int new_level, int new_dest);
 
+/**
+ * \brief Check whether messages of a level are reported
+ * \param level Message priority level (RPT_CRIT to RPT_DEBUG)
+ * \retval 1 report() outputs or stores messages of this level
+ * \retval 0 report() drops messages of this level
+ *
+ * \details Lets callers skip work that is only done for a log message.
+ */
+int report_enabled(const int level);
+
 /**
  * \brief Report a message to the selected destination if important enough
  * \param level Message priority level (RPT_CRIT, RPT_ERR, RPT_WARNING, RPT_NOTICE, RPT_INFO,
@@ -114,7 +124,11 @@ void report(const int level, const char *format, ...);
  * \details The code that this function generates will not be in the executable when
  * compiled without debugging. This way memory and CPU cycles are saved.
  */
-static inline void dont_report(const int level, const char *format, ... /*args*/) {}
+static inline void dont_report(const int level, const char *format, ... /*args*/)
+{
+	(void)level;
+	(void)format;
+}
 
 /**
  * \brief Debug output macro that conditionally compiles to report() or dont_report()
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/shmvalues.h
+ * \brief Memory layout of the shared-memory widget value channel
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Fixed-size header identifying the region and its slot count
+ * - 64-byte value slots holding a number and a short text
+ * - Per-slot sequence counter so the server never reads a torn update
+ *
+ * \usage
+ * - Create a memfd, seal it with F_SEAL_SHRINK and size it for the slots
+ * - Fill in the header, then send "shm_attach" over the Unix socket with
+ *   the memfd attached as SCM_RIGHTS ancillary data
+ * - Bind widgets with "shm_bind <screenid> <widgetid> <slot>"
+ * - Update slots in place; LCDd picks the values up when it renders
+ *
+ * \details The region is written by one client process and read by LCDd
+ * only. To update a slot, the writer increments seq (making it odd), issues
+ * a release fence, stores value and text, and increments seq again with
+ * release semantics. LCDd skips slots whose seq is odd or changed while it
+ * was copying them and keeps showing the previous value. A seq of 0 marks a
+ * slot that was never written.
+ *
+ * The meaning of value follows the numeric argument of widget_set for the
+ * bound widget: promille for pbar, length for hbar and vbar, the digit for
+ * num. String, title and scroller widgets show text instead.
+ */
+
+#ifndef SHMVALUES_H
+#define SHMVALUES_H
+
+#include <stdint.h>
+
+/** \brief Header magic, "LCDV" in little endian */
+#define SHM_VALUES_MAGIC 0x5644434c
+/** \brief Layout version described by this header */
+#define SHM_VALUES_VERSION 1
+/** \brief Maximum number of slots LCDd accepts in one region */
+#define SHM_VALUES_MAX_SLOTS 4096
+/** \brief Text capacity of a slot including the terminating NUL */
+#define SHM_VALUE_TEXT_SIZE 56
+
+/**
+ * \brief Region header at offset 0
+ * \details Read by LCDd once at shm_attach time.
+ */
+typedef struct ShmValuesHeader {
+	uint32_t magic;	      ///< SHM_VALUES_MAGIC
+	uint32_t version;     ///< SHM_VALUES_VERSION
+	uint32_t nslots;      ///< Number of slots following the header
+	uint32_t slot_size;   ///< sizeof(ShmValueSlot), guards against layout mismatch
+	uint8_t reserved[48]; ///< Zero, pads the header to one cache line
+} ShmValuesHeader;
+
+/**
+ * \brief One value slot
+ * \details Slots follow the header back to back, one cache line each.
+ */
+typedef struct ShmValueSlot {
+	uint32_t seq;			///< Update sequence, odd while the writer is busy
+	int32_t value;			///< Numeric widget value
+	char text[SHM_VALUE_TEXT_SIZE]; ///< NUL-terminated widget text
+} ShmValueSlot;
+
+#endif
@@ -7,7 +7,7 @@
  * \date Various years
  *
  * \features
- * - TCP socket connection and disconnection
+ * - TCP and Unix domain (unix:/path, unix:@abstract) socket connection and disconnection
  * - Non-blocking socket I/O operations
  * - Printf-style formatted socket output
  * - String and raw data transmission
@@ -85,13 +85,63 @@ static int sock_init_sockaddr(sockaddr_in *name, const char *hostname, unsigned
 	return 0;
 }
 
-// Connect to server on specified host and port
+/**
+ * \brief Connect to a Unix domain socket
+ * \param path Socket path, or "@name" for the abstract namespace
+ * \retval >=0 Connected non-blocking socket
+ * \retval -1 Error
+ */
+static int sock_connect_unix(const char *path)
+{
+	struct sockaddr_un name;
+	socklen_t len;
+	int sock;
+
+	memset(&name, 0, sizeof(name));
+	name.sun_family = AF_UNIX;
+
+	if (strlen(path) >= sizeof(name.sun_path)) {
+		report(RPT_ERR, "sock_connect: socket path too long: %s", path);
+		return -1;
+	}
+
+	// Abstract names start with a NUL byte and are not NUL-terminated
+	if (path[0] == '@') {
+		memcpy(name.sun_path + 1, path + 1, strlen(path) - 1);
+		len = offsetof(struct sockaddr_un, sun_path) + strlen(path);
+	} else {
+		strcpy(name.sun_path, path);
+		len = sizeof(name);
+	}
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		report(RPT_ERR, "sock_connect: Error creating socket");
+		return sock;
+	}
+
+	if (connect(sock, (struct sockaddr *)&name, len) < 0) {
+		report(RPT_ERR, "sock_connect: connect to %s failed", path);
+		close(sock);
+		return -1;
+	}
+
+	// Set non-blocking mode for async I/O
+	fcntl(sock, F_SETFL, O_NONBLOCK);
+
+	return sock;
+}
+
+// Connect to server on specified host and port, or to a "unix:" socket path
 int sock_connect(char *host, unsigned short int port)
 {
 	struct sockaddr_in servername;
 	int sock;
 	int err = 0;
 
+	if (strncmp(host, SOCK_UNIX_PREFIX, strlen(SOCK_UNIX_PREFIX)) == 0)
+		return sock_connect_unix(host + strlen(SOCK_UNIX_PREFIX));
+
 	report(RPT_INFO, "sock_connect: Creating socket");
 	sock = socket(PF_INET, SOCK_STREAM, 0);
 
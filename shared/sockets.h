@@ -7,7 +7,7 @@
  * \date Various years
  *
  * \features
- * - TCP socket connection and disconnection functions
+ * - TCP and Unix domain socket connection and disconnection functions
  * - Non-blocking socket I/O operations
  * - Printf-style formatted socket output
  * - String and raw data transmission
@@ -33,6 +33,9 @@
 
 #include <stddef.h>
 
+/** \brief Server address prefix selecting a Unix domain socket */
+#define SOCK_UNIX_PREFIX "unix:"
+
 /** \brief Default LCDd server port number */
 #ifndef LCDPORT
 #define LCDPORT 13666
@@ -45,14 +48,16 @@
 
 /**
  * \brief Connect to server on host and port
- * \param host Hostname or IP address of the server
- * \param port Port number to connect to
+ * \param host Hostname or IP address of the server, or "unix:<path>"
+ * \param port Port number to connect to (ignored for unix: addresses)
  * \retval >=0 Valid socket file descriptor
  * \retval -1 Error: connection failed
  *
  * \details Creates a TCP socket and establishes a connection to the specified
  * host and port. The socket is set to non-blocking mode after connection.
- * Uses hostname resolution via gethostbyname().
+ * Uses hostname resolution via gethostbyname(). A host of the form
+ * "unix:/path/to/socket" connects to a local Unix domain socket instead;
+ * "unix:@name" uses the Linux abstract namespace.
  */
 int sock_connect(char *host, unsigned short int port);
 
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/strhash.c
+ * \brief Hash table mapping strings to pointers
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Open addressing with linear probing
+ * - Backward shift deletion keeps probe sequences short without tombstones
+ * - Growth by doubling at 75% load
+ *
+ * \usage
+ * - Used for id lookups that used to scan linked lists
+ *
+ * \details Linear probing keeps a lookup within one or two cache lines in
+ * the common case. Removing an entry moves later entries of the same probe
+ * run back into the gap, so the table never degrades with churn.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "strhash.h"
+
+/** \brief Slot count of a new table, must be a power of two */
+#define STRHASH_INITIAL_SLOTS 16
+
+// FNV-1a hash of a NUL-terminated string
+static unsigned int strhash_hash(const char *key)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*key != '\0') {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * \brief Find the slot holding key, or the free slot ending its probe run
+ * \param h Table to search
+ * \param key Key string
+ * \param hash Hash of key
+ * \return Index of the slot
+ */
+static unsigned int strhash_probe(const strhash *h, const char *key, unsigned int hash)
+{
+	unsigned int i = hash & h->mask;
+
+	while (h->slots[i].key != NULL) {
+		if ((h->slots[i].hash == hash) && (strcmp(h->slots[i].key, key) == 0))
+			break;
+		i = (i + 1) & h->mask;
+	}
+
+	return i;
+}
+
+/**
+ * \brief Move all entries into a slot array of twice the size
+ * \param h Table to grow
+ * \retval 0 Success
+ * \retval -1 Memory allocation failure, table unchanged
+ */
+static int strhash_grow(strhash *h)
+{
+	strhash_entry *old = h->slots;
+	unsigned int old_size = h->mask + 1;
+	unsigned int size = old_size * 2;
+
+	h->slots = calloc(size, sizeof(strhash_entry));
+	if (h->slots == NULL) {
+		h->slots = old;
+		return -1;
+	}
+	h->mask = size - 1;
+
+	for (unsigned int i = 0; i < old_size; i++) {
+		if (old[i].key != NULL)
+			h->slots[strhash_probe(h, old[i].key, old[i].hash)] = old[i];
+	}
+
+	free(old);
+	return 0;
+}
+
+// Allocate an empty hash table
+strhash *strhash_create(void)
+{
+	strhash *h = malloc(sizeof(strhash));
+
+	if (h == NULL)
+		return NULL;
+
+	h->slots = calloc(STRHASH_INITIAL_SLOTS, sizeof(strhash_entry));
+	if (h->slots == NULL) {
+		free(h);
+		return NULL;
+	}
+	h->mask = STRHASH_INITIAL_SLOTS - 1;
+	h->count = 0;
+
+	return h;
+}
+
+// Free a hash table, leaving keys and values alone
+void strhash_destroy(strhash *h)
+{
+	if (h == NULL)
+		return;
+
+	free(h->slots);
+	free(h);
+}
+
+// Look up the value stored under key
+void *strhash_get(const strhash *h, const char *key)
+{
+	return h->slots[strhash_probe(h, key, strhash_hash(key))].value;
+}
+
+// Add an entry unless its key is already present
+int strhash_insert(strhash *h, const char *key, void *value)
+{
+	unsigned int hash = strhash_hash(key);
+	unsigned int i;
+
+	if ((h->count + 1) * 4 > (h->mask + 1) * 3) {
+		if (strhash_grow(h) < 0)
+			return -1;
+	}
+
+	i = strhash_probe(h, key, hash);
+	if (h->slots[i].key != NULL)
+		return 1;
+
+	h->slots[i].key = key;
+	h->slots[i].value = value;
+	h->slots[i].hash = hash;
+	h->count++;
+
+	return 0;
+}
+
+// Remove an entry and close the gap in its probe run
+void *strhash_remove(strhash *h, const char *key)
+{
+	unsigned int i = strhash_probe(h, key, strhash_hash(key));
+	unsigned int j = i;
+	void *value = h->slots[i].value;
+
+	if (h->slots[i].key == NULL)
+		return NULL;
+
+	// Pull back every later entry whose home slot is not between the gap and itself
+	for (;;) {
+		unsigned int home;
+
+		j = (j + 1) & h->mask;
+		if (h->slots[j].key == NULL)
+			break;
+
+		home = h->slots[j].hash & h->mask;
+		if (((j - home) & h->mask) >= ((j - i) & h->mask)) {
+			h->slots[i] = h->slots[j];
+			i = j;
+		}
+	}
+
+	h->slots[i].key = NULL;
+	h->slots[i].value = NULL;
+	h->count--;
+
+	return value;
+}
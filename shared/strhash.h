@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file shared/strhash.h
+ * \brief Hash table mapping strings to pointers
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Open addressing with linear probing in one flat array
+ * - FNV-1a hashing, hash values cached per slot to avoid most strcmp() calls
+ * - Table doubles when three quarters full
+ * - Deletion by backward shifting, no tombstones
+ *
+ * \usage
+ * - strhash_create() an empty table, strhash_destroy() it when done
+ * - strhash_insert() and strhash_remove() entries, strhash_get() to look up
+ *
+ * \details Keys are not copied. The caller guarantees that a key string
+ * stays valid and unchanged while it is in the table; usually the key is
+ * owned by the value stored under it, e.g. a widget's id.
+ */
+
+#ifndef STRHASH_H
+#define STRHASH_H
+
+/**
+ * \brief One table slot
+ * \details A slot with key NULL is free.
+ */
+typedef struct strhash_entry {
+	const char *key;   // Borrowed key string
+	void *value;	   // Stored pointer
+	unsigned int hash; // Cached hash of key
+} strhash_entry;
+
+/**
+ * \brief Hash table structure
+ */
+typedef struct strhash {
+	strhash_entry *slots; // Slot array, size is a power of two
+	unsigned int mask;    // Number of slots minus one
+	unsigned int count;   // Number of used slots
+} strhash;
+
+/**
+ * \brief Allocate an empty hash table
+ * \retval NULL Memory allocation failure
+ * \retval !NULL Pointer to the new table
+ */
+strhash *strhash_create(void);
+
+/**
+ * \brief Free a hash table
+ * \param h Table to destroy (can be NULL)
+ *
+ * \details Keys and values are not freed.
+ */
+void strhash_destroy(strhash *h);
+
+/**
+ * \brief Look up a key
+ * \param h Table to search
+ * \param key Key string
+ * \retval NULL Key not in the table
+ * \retval !NULL Value stored under key
+ */
+void *strhash_get(const strhash *h, const char *key);
+
+/**
+ * \brief Add an entry
+ * \param h Table to add to
+ * \param key Key string, must stay valid while the entry exists
+ * \param value Value to store, must not be NULL
+ * \retval 0 Entry added
+ * \retval 1 Key already present, table unchanged
+ * \retval -1 Memory allocation failure
+ */
+int strhash_insert(strhash *h, const char *key, void *value);
+
+/**
+ * \brief Remove an entry
+ * \param h Table to remove from
+ * \param key Key string
+ * \retval NULL Key not in the table
+ * \retval !NULL Value that was stored under key
+ */
+void *strhash_remove(strhash *h, const char *key);
+
+#endif
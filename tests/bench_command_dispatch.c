@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_command_dispatch.c
+ * \brief Microbenchmark for LCDd client command dispatch
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Measures lookup cost per command for the switch-on-length trie
+ * - Compares against the former linear strcmp() table scan
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_command_dispatch [iterations]
+ *
+ * \details The dispatcher in server/commands/command_list.c is compiled into
+ * this program directly; the command handlers are replaced by stubs so no
+ * server state is needed. The command mix is weighted towards widget_set and
+ * screen_set, which dominate real client traffic.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "commands/command_list.c"
+
+/** \brief Default number of lookups per measurement */
+#define DEFAULT_ITERATIONS 20000000L
+
+// Handler stubs: the benchmark only resolves commands, it never calls them
+#define STUB(name)                                                                                 \
+	int name(Client *c, int argc, char **argv)                                                 \
+	{                                                                                          \
+		(void)c;                                                                           \
+		(void)argc;                                                                        \
+		(void)argv;                                                                        \
+		return 0;                                                                          \
+	}
+
+STUB(test_func_func)
+STUB(hello_func)
+STUB(client_set_func)
+STUB(client_add_key_func)
+STUB(client_del_key_func)
+STUB(bye_func)
+STUB(batch_begin_func)
+STUB(batch_end_func)
+STUB(screen_add_func)
+STUB(screen_del_func)
+STUB(screen_set_func)
+STUB(key_add_func)
+STUB(key_del_func)
+STUB(widget_add_func)
+STUB(widget_del_func)
+STUB(widget_set_func)
+STUB(shm_attach_func)
+STUB(shm_bind_func)
+STUB(menu_add_item_func)
+STUB(menu_del_item_func)
+STUB(menu_set_item_func)
+STUB(menu_goto_func)
+STUB(menu_set_main_func)
+STUB(backlight_func)
+STUB(macro_leds_func)
+STUB(output_func)
+STUB(info_func)
+STUB(noop_func)
+STUB(client_stats_func)
+
+/** \brief Keywords in the order of the former linear lookup table, newer ones appended */
+static const char *linear_keywords[] = {
+    "test_func",     "hello",	      "client_set",    "client_add_key", "client_del_key",
+    "bye",	     "screen_add",    "screen_del",    "screen_set",	 "key_add",
+    "key_del",	     "widget_add",    "widget_del",    "widget_set",	 "menu_add_item",
+    "menu_del_item", "menu_set_item", "menu_goto",     "menu_set_main",	 "backlight",
+    "macro_leds",    "output",	      "info",	       "noop",		 "batch_begin",
+    "batch_end",     "shm_attach",    "shm_bind",      "client_stats",  NULL,
+};
+
+/** \brief Typical dashboard traffic: mostly widget updates */
+static const char *workload[] = {
+    "widget_set", "widget_set", "widget_set", "widget_set", "widget_set", "widget_set",
+    "widget_set", "widget_set", "screen_set", "screen_set", "noop",	  "widget_add",
+    "widget_del", "hello",	"client_set", "bogus_cmd",
+};
+
+/**
+ * \brief Former dispatcher: linear strcmp() scan
+ * \param cmd Command keyword
+ * \return Table index or -1
+ */
+static int linear_lookup(const char *cmd)
+{
+	for (int i = 0; linear_keywords[i] != NULL; i++) {
+		if (strcmp(cmd, linear_keywords[i]) == 0)
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	long iterations = (argc > 1) ? atol(argv[1]) : DEFAULT_ITERATIONS;
+	size_t nwork = sizeof(workload) / sizeof(workload[0]);
+	volatile long sink = 0;
+	double t0, t_trie, t_linear;
+
+	t0 = now_ns();
+	for (long i = 0; i < iterations; i++)
+		sink += (get_command(workload[i % nwork]) != NULL);
+	t_trie = now_ns() - t0;
+
+	t0 = now_ns();
+	for (long i = 0; i < iterations; i++)
+		sink += linear_lookup(workload[i % nwork]);
+	t_linear = now_ns() - t0;
+
+	printf("Command dispatch, %ld lookups (widget_set heavy mix)\n", iterations);
+	printf("  switch-on-length trie: %6.2f ns/command\n", t_trie / iterations);
+	printf("  linear strcmp scan:    %6.2f ns/command\n", t_linear / iterations);
+
+	for (int i = 0; linear_keywords[i] != NULL; i++) {
+		// Read through a volatile so the lookup cannot be hoisted out of the loop
+		const char *volatile kw = linear_keywords[i];
+		long n = iterations / 10;
+
+		t0 = now_ns();
+		for (long j = 0; j < n; j++)
+			sink += (get_command(kw) != NULL);
+		t_trie = now_ns() - t0;
+
+		t0 = now_ns();
+		for (long j = 0; j < n; j++)
+			sink += linear_lookup(kw);
+		t_linear = now_ns() - t0;
+
+		printf("  %-15s trie %6.2f ns, linear %6.2f ns\n", linear_keywords[i], t_trie / n,
+		       t_linear / n);
+	}
+
+	return (sink == 0);
+}
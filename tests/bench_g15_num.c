@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_g15_num.c
+ * \brief Microbenchmark for big number drawing in the G15 driver
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies every big number draws the same frame on each path
+ * - Measures nanoseconds per digit for a clock line of digits and colons
+ * - Compares the column copy with g15r_setPixel() per pixel and with packing
+ *   the former one-short-per-pixel table into rows for g15_lcd_blit()
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_g15_num [rounds]
+ *
+ * \details server/drivers/g15-lcd.c and g15-num.c are compiled into this
+ * program directly. libg15render is not needed: g15r_setPixel() is modelled
+ * below, not inlined, as the shared library is called, and the former table
+ * is rebuilt from the packed one. The pixel path is timed without the canvas
+ * conversion it needed at flush.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "g15-lcd.c"
+#include "g15-num.c"
+
+/** \brief Default number of drawn clock lines per path */
+#define DEFAULT_ROUNDS 200000L
+
+/** \brief Width of the big number colon */
+#define COLON_WIDTH 9
+
+/** \brief Former table entry length, one short per pixel */
+#define SHORT_LEN (G15_BIGNUM_WIDTH * G15_LCD_ROWS)
+
+/** \brief Big numbers of a clock line, 12:34:56 */
+static const int clock_line[] = {1, 2, 10, 3, 4, 10, 5, 6};
+
+/** \brief Number of big numbers in the clock line */
+#define CLOCK_LEN ((int)(sizeof(clock_line) / sizeof(clock_line[0])))
+
+/** \brief Former table, 0 for black pixels as g15_bignum_data was */
+static short short_data[11][SHORT_LEN];
+
+/**
+ * \brief g15r_setPixel() of libg15render, without XOR mode
+ * \param canvas Canvas, G15_LCD_PIXMAP_LEN bytes
+ * \param x Column
+ * \param y Row
+ * \param val Pixel value
+ */
+__attribute__((noinline)) static void model_set_pixel(unsigned char *canvas, unsigned int x,
+						      unsigned int y, int val)
+{
+	unsigned int offset = y * G15_LCD_COLUMNS + x;
+
+	if ((x >= G15_LCD_COLUMNS) || (y >= G15_LCD_ROWS))
+		return;
+
+	if (val)
+		canvas[offset / 8] |= (unsigned char)(1 << (7 - offset % 8));
+	else
+		canvas[offset / 8] &= (unsigned char)~(1 << (7 - offset % 8));
+}
+
+/**
+ * \brief Width of a big number
+ * \param num Digit 0-9 or 10 for the colon
+ * \return Columns
+ */
+static int num_width(int num) { return (num <= 9) ? G15_BIGNUM_WIDTH : COLON_WIDTH; }
+
+// Original path: one g15r_setPixel() per pixel of the one-short-per-pixel table
+static void draw_pixels(unsigned char *canvas, int num, int ox)
+{
+	int width = num_width(num);
+
+	for (int i = 0; i < width * G15_LCD_ROWS; ++i)
+		model_set_pixel(canvas, (unsigned int)(ox + i % width), (unsigned int)(i / width),
+				!short_data[num][i]);
+}
+
+// Former frame path: pack the table into rows, then blit them
+static void draw_packed_rows(G15LcdFrame *f, int num, int ox)
+{
+	unsigned char bits[G15_LCD_ROWS][3];
+	int width = num_width(num);
+
+	memset(bits, 0, sizeof(bits));
+	for (int i = 0; i < width * G15_LCD_ROWS; ++i) {
+		int col = i % width;
+
+		if (!short_data[num][i])
+			bits[i / width][col / 8] |= 0x80 >> (col % 8);
+	}
+	g15_lcd_blit(f, ox, 0, width, G15_LCD_ROWS, bits[0], sizeof(bits[0]), G15_LCD_BLACK, 1);
+}
+
+// Packed path: copy the columns in report layout
+static void draw_columns(G15LcdFrame *f, int num, int ox)
+{
+	g15_lcd_put_columns(f, ox, num_width(num), g15_bignum_data[num][0], G15_BIGNUM_WIDTH);
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static unsigned char canvas[G15_LCD_PIXMAP_LEN];
+	static G15LcdFrame f_pixels, f_rows, f_columns;
+	long rounds = (argc > 1) ? atol(argv[1]) : DEFAULT_ROUNDS;
+	volatile unsigned long sink = 0;
+	double t0, t_pixels, t_rows, t_columns;
+	long digits = rounds * CLOCK_LEN;
+	int failures = 0;
+
+	// Rebuild the former table, row by row, 0 for black
+	for (int num = 0; num <= 10; num++) {
+		int width = num_width(num);
+
+		for (int i = 0; i < width * G15_LCD_ROWS; i++) {
+			int x = i % width, y = i / width;
+
+			short_data[num][i] = !((g15_bignum_data[num][y / 8][x] >> (y % 8)) & 1);
+		}
+	}
+
+	g15_lcd_frame_init(&f_rows);
+	g15_lcd_frame_init(&f_columns);
+	for (int num = 0; num <= 10; num++) {
+		int ox = num * 14 - 4;
+
+		draw_pixels(canvas, num, ox);
+		draw_packed_rows(&f_rows, num, ox);
+		draw_columns(&f_columns, num, ox);
+	}
+	g15_pixmap_to_lcd(f_pixels.report, canvas);
+	if ((memcmp(f_pixels.report, f_rows.report, G15_LCD_REPORT_LEN) != 0) ||
+	    (memcmp(f_pixels.report, f_columns.report, G15_LCD_REPORT_LEN) != 0)) {
+		printf("❌ big numbers differ between the drawing paths\n");
+		failures++;
+	}
+
+	t0 = now_ns();
+	for (long i = 0; i < rounds; i++) {
+		for (int d = 0; d < CLOCK_LEN; d++)
+			draw_pixels(canvas, clock_line[d], d * 19);
+		sink += canvas[i % G15_LCD_PIXMAP_LEN];
+	}
+	t_pixels = (now_ns() - t0) / digits;
+
+	t0 = now_ns();
+	for (long i = 0; i < rounds; i++) {
+		for (int d = 0; d < CLOCK_LEN; d++)
+			draw_packed_rows(&f_rows, clock_line[d], d * 19);
+		sink += f_rows.report[G15_LCD_REPORT_OFFSET + i % G15_LCD_DATA_LEN];
+	}
+	t_rows = (now_ns() - t0) / digits;
+
+	t0 = now_ns();
+	for (long i = 0; i < rounds; i++) {
+		for (int d = 0; d < CLOCK_LEN; d++)
+			draw_columns(&f_columns, clock_line[d], d * 19);
+		sink += f_columns.report[G15_LCD_REPORT_OFFSET + i % G15_LCD_DATA_LEN];
+	}
+	t_columns = (now_ns() - t0) / digits;
+
+	printf("Big number drawing, clock line of %d numbers\n", CLOCK_LEN);
+	printf("  %-34s %12s %10s\n", "path", "ns/digit", "speedup");
+	printf("  %-34s %12.1f %9.1fx\n", "g15r_setPixel() per pixel", t_pixels, 1.0);
+	printf("  %-34s %12.1f %9.1fx\n", "short table packed, row blit", t_rows,
+	       t_pixels / t_rows);
+	printf("  %-34s %12.1f %9.1fx\n", "column copy", t_columns, t_pixels / t_columns);
+	printf("  table: %zu bytes, formerly %zu\n", sizeof(g15_bignum_data),
+	       sizeof(short) * 11 * 1032);
+
+	if (failures != 0)
+		return 1;
+	printf("✅ All paths draw identical big numbers\n");
+
+	return (sink == 0);
+}
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_g15_text.c
+ * \brief Microbenchmark for full-screen text redraw in the G15 driver
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies the glyph atlas draws the same frame as libg15render glyphs
+ * - Measures a 20x5 character redraw per path, normal and reversed cells
+ * - Compares the glyph atlas with libg15render drawing on a canvas, converted
+ *   at flush, and with libg15render glyphs imported into the frame
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_g15_text [frames]
+ *
+ * \details server/drivers/g15-lcd.c is compiled into this program directly.
+ * libg15render is not needed: its g15r_setPixel(), g15r_pixelReverseFill()
+ * and g15r_renderG15Glyph() are modelled below, pixel by pixel and not
+ * inlined, as the shared library is called. The font is a random 8x8 font
+ * like the libg15render large font. Cells are placed as g15_chr() does.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "g15-lcd.c"
+
+/** \brief Default number of redrawn screens per path */
+#define DEFAULT_FRAMES 20000L
+
+/** \brief Text columns of the G15 screen */
+#define TEXT_WIDTH 20
+
+/** \brief Text rows of the G15 screen */
+#define TEXT_HEIGHT 5
+
+/**
+ * \brief Canvas as in libg15render
+ */
+typedef struct {
+	unsigned char buffer[1048]; ///< Row-major pixels, as G15_BUFFER_LEN
+	int mode_xor;		    ///< XOR drawing
+	int mode_reverse;	    ///< Inverted drawing
+} ModelCanvas;
+
+/** \brief Glyph rows of the model font, leftmost pixel in the most significant bit */
+static unsigned char font[256][8];
+
+/**
+ * \brief g15r_getPixel() of libg15render
+ * \param c Canvas
+ * \param x Column
+ * \param y Row
+ * \return Pixel value
+ */
+__attribute__((noinline)) static int model_get_pixel(ModelCanvas *c, unsigned int x,
+						     unsigned int y)
+{
+	unsigned int offset = y * G15_LCD_COLUMNS + x;
+
+	if ((x >= G15_LCD_COLUMNS) || (y >= G15_LCD_ROWS))
+		return 0;
+	return (c->buffer[offset / 8] >> (7 - offset % 8)) & 1;
+}
+
+/**
+ * \brief g15r_setPixel() of libg15render
+ * \param c Canvas
+ * \param x Column
+ * \param y Row
+ * \param val Pixel value
+ */
+__attribute__((noinline)) static void model_set_pixel(ModelCanvas *c, unsigned int x,
+						      unsigned int y, int val)
+{
+	unsigned int offset = y * G15_LCD_COLUMNS + x;
+
+	if ((x >= G15_LCD_COLUMNS) || (y >= G15_LCD_ROWS))
+		return;
+	if (c->mode_xor)
+		val ^= model_get_pixel(c, x, y);
+	if (c->mode_reverse)
+		val = !val;
+
+	if (val)
+		c->buffer[offset / 8] |= (unsigned char)(1 << (7 - offset % 8));
+	else
+		c->buffer[offset / 8] &= (unsigned char)~(1 << (7 - offset % 8));
+}
+
+// g15r_pixelReverseFill() of libg15render
+static void model_reverse_fill(ModelCanvas *c, int x1, int y1, int x2, int y2, int fill,
+			       int color)
+{
+	for (int x = x1; x <= x2; ++x) {
+		for (int y = y1; y <= y2; ++y) {
+			if (!fill)
+				color = !model_get_pixel(c, x, y);
+			model_set_pixel(c, x, y, color);
+		}
+	}
+}
+
+// g15r_renderG15Glyph() of libg15render for the model font
+static void model_render_glyph(ModelCanvas *c, unsigned char ch, int x, int y, int color,
+			       int paint_bg)
+{
+	for (int r = 0; r < 8; r++) {
+		for (int col = 0; col < 8; col++) {
+			if ((font[ch][r] >> (7 - col)) & 1)
+				model_set_pixel(c, x + col, y + r, color);
+			else if (paint_bg)
+				model_set_pixel(c, x + col, y + r, !color);
+		}
+	}
+}
+
+/**
+ * \brief Pixel position of a character cell, as g15_convert_coords()
+ * \param x Character column (1-based)
+ * \param y Character row (1-based)
+ * \param px Pixel column
+ * \param py Pixel row
+ */
+static void cell_origin(int x, int y, int *px, int *py)
+{
+	*px = (x - 1) * 8;
+	*py = (y - 1) * 8 + min(y - 1, 3);
+}
+
+// Former path: libg15render draws on the canvas, flush converts it
+static void draw_canvas(ModelCanvas *c, G15LcdFrame *f, const unsigned char *text)
+{
+	for (int i = 0; i < TEXT_WIDTH * TEXT_HEIGHT; i++) {
+		int reverse = (text[i] == 3);
+		int px, py;
+
+		cell_origin(1 + i % TEXT_WIDTH, 1 + i / TEXT_WIDTH, &px, &py);
+		c->mode_reverse = reverse;
+		model_reverse_fill(c, px, py, px + 7, py + 7, 1, 0);
+		model_render_glyph(c, text[i], px - 1, py - 1, 1, 0);
+		c->mode_reverse = 0;
+	}
+	g15_pixmap_to_lcd(f->report, c->buffer);
+}
+
+// Compatibility path: libg15render glyph on a scratch canvas, imported into the frame
+static void draw_import(ModelCanvas *scratch, G15LcdFrame *f, const unsigned char *text)
+{
+	for (int i = 0; i < TEXT_WIDTH * TEXT_HEIGHT; i++) {
+		int paper = (text[i] == 3);
+		int px, py, top;
+
+		cell_origin(1 + i % TEXT_WIDTH, 1 + i / TEXT_WIDTH, &px, &py);
+		g15_lcd_fill(f, px, py, px + 7, py + 7, paper);
+		model_render_glyph(scratch, text[i], px - 1, py - 1, 1, 0);
+		top = max(py - 1, 0);
+		g15_lcd_import(f, scratch->buffer, top, G15_LCD_ROWS - 1, !paper);
+		memset(scratch->buffer + top * G15_LCD_STRIDE, 0,
+		       (G15_LCD_ROWS - top) * G15_LCD_STRIDE);
+	}
+}
+
+// Glyph atlas path
+static void draw_atlas(const G15LcdGlyph *atlas, G15LcdFrame *f, const unsigned char *text)
+{
+	for (int i = 0; i < TEXT_WIDTH * TEXT_HEIGHT; i++) {
+		int paper = (text[i] == 3);
+		int px, py;
+
+		cell_origin(1 + i % TEXT_WIDTH, 1 + i / TEXT_WIDTH, &px, &py);
+		g15_lcd_fill(f, px, py, px + 7, py + 7, paper);
+		g15_lcd_glyph_draw(f, &atlas[text[i]], px - 1, py - 1, !paper);
+	}
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static ModelCanvas canvas, scratch;
+	static G15LcdGlyph atlas[256];
+	static G15LcdFrame f_canvas, f_import, f_atlas;
+	static unsigned char text[2][TEXT_WIDTH * TEXT_HEIGHT];
+	long frames = (argc > 1) ? atol(argv[1]) : DEFAULT_FRAMES;
+	unsigned int state = 0x7e57u;
+	volatile unsigned long sink = 0;
+	double t0, t_canvas, t_import, t_atlas;
+	int failures = 0;
+
+	for (int ch = 0; ch < 256; ch++) {
+		for (int r = 0; r < 8; r++) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			font[ch][r] = (unsigned char)(state >> 24);
+		}
+	}
+
+	// Load the atlas the way g15_load_glyphs() does
+	for (int ch = 0; ch < 256; ch++) {
+		model_render_glyph(&scratch, (unsigned char)ch, G15_LCD_GLYPH_ORIGIN_X,
+				   G15_LCD_GLYPH_ORIGIN_Y, 1, 0);
+		if (g15_lcd_glyph_load(&atlas[ch], scratch.buffer) != 0) {
+			printf("❌ glyph %d does not fit the atlas\n", ch);
+			failures++;
+		}
+		memset(scratch.buffer, 0, sizeof(scratch.buffer));
+	}
+
+	// Two screens of text with some reversed cells (open heart)
+	for (int i = 0; i < TEXT_WIDTH * TEXT_HEIGHT; i++) {
+		text[0][i] = (unsigned char)((i % 11 == 0) ? 3 : 'A' + i % 58);
+		text[1][i] = (unsigned char)((i % 7 == 0) ? 3 : ' ' + i % 95);
+	}
+
+	g15_lcd_frame_init(&f_import);
+	g15_lcd_frame_init(&f_atlas);
+	for (int t = 0; t < 2; t++) {
+		draw_canvas(&canvas, &f_canvas, text[t]);
+		draw_import(&scratch, &f_import, text[t]);
+		draw_atlas(atlas, &f_atlas, text[t]);
+		if ((memcmp(f_canvas.report, f_import.report, G15_LCD_REPORT_LEN) != 0) ||
+		    (memcmp(f_canvas.report, f_atlas.report, G15_LCD_REPORT_LEN) != 0)) {
+			printf("❌ screen %d differs between the drawing paths\n", t);
+			failures++;
+		}
+	}
+
+	t0 = now_ns();
+	for (long i = 0; i < frames; i++) {
+		draw_canvas(&canvas, &f_canvas, text[i & 1]);
+		sink += f_canvas.report[G15_LCD_REPORT_OFFSET + i % G15_LCD_DATA_LEN];
+	}
+	t_canvas = (now_ns() - t0) / frames;
+
+	t0 = now_ns();
+	for (long i = 0; i < frames; i++) {
+		draw_import(&scratch, &f_import, text[i & 1]);
+		sink += f_import.report[G15_LCD_REPORT_OFFSET + i % G15_LCD_DATA_LEN];
+	}
+	t_import = (now_ns() - t0) / frames;
+
+	t0 = now_ns();
+	for (long i = 0; i < frames; i++) {
+		draw_atlas(atlas, &f_atlas, text[i & 1]);
+		sink += f_atlas.report[G15_LCD_REPORT_OFFSET + i % G15_LCD_DATA_LEN];
+	}
+	t_atlas = (now_ns() - t0) / frames;
+
+	printf("Full-screen text redraw, %dx%d cells, report ready to send\n", TEXT_WIDTH,
+	       TEXT_HEIGHT);
+	printf("  %-34s %12s %10s\n", "path", "us/screen", "speedup");
+	printf("  %-34s %12.2f %9.1fx\n", "libg15render canvas + conversion", t_canvas / 1000,
+	       1.0);
+	printf("  %-34s %12.2f %9.1fx\n", "libg15render glyphs imported", t_import / 1000,
+	       t_canvas / t_import);
+	printf("  %-34s %12.2f %9.1fx\n", "glyph atlas", t_atlas / 1000, t_canvas / t_atlas);
+
+	if (failures != 0)
+		return 1;
+	printf("✅ All paths draw identical frames\n");
+
+	return (sink == 0);
+}
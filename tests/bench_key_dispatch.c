@@ -0,0 +1,364 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_key_dispatch.c
+ * \brief Microbenchmark for key reservation lookup and dispatch in LCDd
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies input_find_key() agrees with the former list scan for every key and client
+ * - Verifies exclusive reservations reject other reservations of the key
+ * - Verifies releasing keys, per key and per client, leaves no reservation behind
+ * - Measures lookups and full handle_input() dispatch from 22 to 990 reservations
+ * - Compares against the former strcmp() scan over one list of all reservations
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_key_dispatch [keys]
+ *
+ * \details server/input.c is compiled into this program directly; drivers,
+ * screen list, menu and client output are replaced by stubs. Every client
+ * reserves the 18 G-keys shared and one M-key exclusively, like the macro
+ * client of lcdproc does per mode; the first client also holds the other
+ * M-keys. The current screen belongs to the last client, so shared keys are
+ * found at the end of their holder lists.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "input.c"
+
+/** \brief Default number of dispatched keys per reservation count */
+#define DEFAULT_KEYS 2000000L
+
+/** \brief Largest number of clients in a run */
+#define MAX_CLIENTS 55
+
+// Stubs for the server modules input.c calls into
+int autorotate = 1;
+Screen *menuscreen = NULL;
+
+/** \brief Screen standing in for the current screen */
+static Screen bench_screen;
+
+/** \brief Keys handed out by drivers_get_key(), NULL terminated */
+static const char **pending;
+
+/** \brief Keys delivered to clients by handle_input() */
+static unsigned long delivered;
+
+/** \brief Keys left over for the server by handle_input() */
+static unsigned long leftover;
+
+const char *drivers_get_key(void) { return (*pending != NULL) ? *pending++ : NULL; }
+
+Screen *screenlist_current(void) { return &bench_screen; }
+
+char *screen_find_key(Screen *s, const char *key)
+{
+	(void)s;
+	(void)key;
+	return NULL;
+}
+
+int client_printf(Client *c, const char *format, ...)
+{
+	(void)c;
+	(void)format;
+	delivered++;
+	return 0;
+}
+
+bool is_menu_key(const char *key)
+{
+	(void)key;
+	return false;
+}
+
+void menuscreen_key_handler(const char *key) { (void)key; }
+
+int server_msg(const char *text, int expire)
+{
+	(void)text;
+	(void)expire;
+	leftover++;
+	return 0;
+}
+
+int screenlist_goto_next(void) { return 0; }
+
+int screenlist_goto_prev(void) { return 0; }
+
+/**
+ * \brief Reservation in the former single list
+ */
+typedef struct legacy_reservation {
+	char *key;		  ///< Key name
+	bool exclusive;		  ///< Reserved exclusively
+	Client *client;		  ///< Owning client
+	struct legacy_reservation *next; ///< Next reservation
+} legacy_reservation;
+
+/** \brief Former list of all reservations, in reservation order */
+static legacy_reservation *legacy_list;
+
+/**
+ * \brief Former input_find_key(): scan all reservations with strcmp()
+ * \param key Key name
+ * \param client Client the key is dispatched for
+ * \return Matching reservation or NULL
+ */
+static legacy_reservation *legacy_find(const char *key, Client *client)
+{
+	for (legacy_reservation *kr = legacy_list; kr != NULL; kr = kr->next) {
+		if ((strcmp(kr->key, key) == 0) && (kr->exclusive || (client == kr->client)))
+			return kr;
+	}
+	return NULL;
+}
+
+/**
+ * \brief Reserve a key in both implementations
+ * \param key Key name
+ * \param exclusive Reserve exclusively
+ * \param client Owning client
+ * \retval 0 Reserved
+ * \retval -1 Rejected by input_reserve_key()
+ */
+static int reserve(const char *key, bool exclusive, Client *client)
+{
+	legacy_reservation *kr, **tail;
+
+	if (input_reserve_key(key, exclusive, client) < 0)
+		return -1;
+
+	kr = calloc(1, sizeof(legacy_reservation));
+	kr->key = strdup(key);
+	kr->exclusive = exclusive;
+	kr->client = client;
+	for (tail = &legacy_list; *tail != NULL; tail = &(*tail)->next)
+		;
+	*tail = kr;
+
+	return 0;
+}
+
+// Number of reservations in the former list
+static int legacy_count(void)
+{
+	int n = 0;
+
+	for (legacy_reservation *kr = legacy_list; kr != NULL; kr = kr->next)
+		n++;
+
+	return n;
+}
+
+// Free the former list
+static void legacy_clear(void)
+{
+	while (legacy_list != NULL) {
+		legacy_reservation *next = legacy_list->next;
+
+		free(legacy_list->key);
+		free(legacy_list);
+		legacy_list = next;
+	}
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Let n clients reserve their keys the way the lcdproc macro client does
+static int reserve_all(Client *clients, int n)
+{
+	static const char *modes[] = {"M1", "M2", "M3", "MR"};
+	char key[8];
+	int failures = 0;
+
+	for (int c = 0; c < n; c++) {
+		clients[c].sock = c + 1;
+		ilist_init(&clients[c].keys);
+
+		for (int g = 1; g <= 18; g++) {
+			snprintf(key, sizeof(key), "G%d", g);
+			failures += (reserve(key, false, &clients[c]) != 0);
+		}
+		if (c == 0) {
+			for (int m = 0; m < 4; m++)
+				failures += (reserve(modes[m], true, &clients[c]) != 0);
+		} else if (reserve(modes[c % 4], true, &clients[c]) == 0) {
+			printf("❌ exclusive %s reserved twice\n", modes[c % 4]);
+			failures++;
+		}
+	}
+
+	if (failures != 0)
+		printf("❌ %d reservations failed\n", failures);
+
+	return failures;
+}
+
+// Compare every lookup with the former scan
+static int verify(Client *clients, int n, const char **keys, int nkeys)
+{
+	int failures = 0;
+
+	for (int c = 0; c < n; c++) {
+		for (int k = 0; k < nkeys; k++) {
+			KeyReservation *kr = input_find_key(keys[k], &clients[c]);
+			legacy_reservation *old = legacy_find(keys[k], &clients[c]);
+
+			if ((kr == NULL) != (old == NULL) ||
+			    ((kr != NULL) && ((kr->client != old->client) ||
+					      (strcmp(kr->key, old->key) != 0)))) {
+				printf("❌ %s for client %d differs from the list scan\n", keys[k],
+				       c + 1);
+				failures++;
+			}
+		}
+	}
+
+	if (reserve("G1", true, &clients[0]) == 0) {
+		printf("❌ exclusive reservation of a shared key accepted\n");
+		failures++;
+	}
+
+	return failures;
+}
+
+// Release everything, half per key and half per client, and check nothing is left
+static int release_all(Client *clients, int n)
+{
+	char key[8];
+	int failures = 0;
+
+	for (int c = 0; c < n; c++) {
+		if (c % 2 == 0) {
+			input_release_client_keys(&clients[c]);
+			continue;
+		}
+		for (int g = 1; g <= 18; g++) {
+			snprintf(key, sizeof(key), "G%d", g);
+			input_release_key(key, &clients[c]);
+		}
+	}
+
+	for (int c = 0; c < n; c++) {
+		if (clients[c].keys.count != 0) {
+			printf("❌ client %d keeps %d reservations\n", c + 1, clients[c].keys.count);
+			failures++;
+		}
+	}
+	if ((keytable->count != 0) || (keyentries.count != 0)) {
+		printf("❌ %u keys still in the table\n", keytable->count);
+		failures++;
+	}
+
+	legacy_clear();
+
+	return failures;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static const int client_counts[] = {1, 3, 12, MAX_CLIENTS};
+	static const char *stream[] = {"G1", "G7", "G18", "M1", "G3",   "MR",	"G12", "Left",
+				       "G9", "G2", "G15", "M2", "Down", "G11", "G5",  "Stop"};
+	static Client clients[MAX_CLIENTS];
+	long keys = (argc > 1) ? atol(argv[1]) : DEFAULT_KEYS;
+	int nstream = sizeof(stream) / sizeof(stream[0]);
+	volatile long sink = 0;
+	int failures = 0;
+
+	input_init();
+
+	printf("Key dispatch, 18 shared G-keys per client plus exclusive M-keys\n");
+	printf("  %12s %12s %12s %12s %12s %14s\n", "reservations", "hash hit ns", "scan hit ns",
+	       "hash miss ns", "scan miss ns", "dispatch ns");
+
+	for (size_t k = 0; k < sizeof(client_counts) / sizeof(client_counts[0]); k++) {
+		int n = client_counts[k];
+		Client *current = &clients[n - 1];
+		const char **queue = malloc((keys + 1) * sizeof(char *));
+		double t0, t_hit, t_scan_hit, t_miss, t_scan_miss, t_dispatch;
+
+		failures += reserve_all(clients, n);
+		failures += verify(clients, n, stream, nstream);
+		bench_screen.client = current;
+
+		t0 = now_ns();
+		for (long i = 0; i < keys; i++)
+			sink += (input_find_key(stream[i % 3], current) != NULL);
+		t_hit = (now_ns() - t0) / keys;
+
+		t0 = now_ns();
+		for (long i = 0; i < keys; i++)
+			sink += (legacy_find(stream[i % 3], current) != NULL);
+		t_scan_hit = (now_ns() - t0) / keys;
+
+		t0 = now_ns();
+		for (long i = 0; i < keys; i++)
+			sink += (input_find_key((i & 1) ? "Left" : "Stop", current) != NULL);
+		t_miss = (now_ns() - t0) / keys;
+
+		t0 = now_ns();
+		for (long i = 0; i < keys; i++)
+			sink += (legacy_find((i & 1) ? "Left" : "Stop", current) != NULL);
+		t_scan_miss = (now_ns() - t0) / keys;
+
+		for (long i = 0; i < keys; i++)
+			queue[i] = stream[i % nstream];
+		queue[keys] = NULL;
+		pending = queue;
+		delivered = leftover = 0;
+		t0 = now_ns();
+		handle_input();
+		t_dispatch = (now_ns() - t0) / keys;
+		sink += delivered;
+		free(queue);
+
+		if (delivered + leftover == 0) {
+			printf("❌ no key was dispatched\n");
+			failures++;
+		}
+
+		printf("  %12d %12.2f %12.2f %12.2f %12.2f %14.2f\n", legacy_count(), t_hit,
+		       t_scan_hit, t_miss, t_scan_miss, t_dispatch);
+
+		failures += release_all(clients, n);
+	}
+
+	// Shutdown drops what is still reserved, keys with several holders included
+	for (int c = 0; c < 3; c++)
+		failures += (input_reserve_key("G1", false, &clients[c]) != 0);
+	failures += (input_reserve_key("M1", true, NULL) != 0);
+
+	input_shutdown();
+	if (intern_count() != 0) {
+		printf("❌ %u key names still interned after shutdown\n", intern_count());
+		failures++;
+	}
+
+	if (failures != 0)
+		return 1;
+	printf("✅ Lookups match the list scan, conflicts rejected, all keys released\n");
+
+	return (sink == 0);
+}
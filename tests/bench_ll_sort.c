@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_ll_sort.c
+ * \brief Microbenchmark for sorting and top-k selection in shared/LL
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies LL_Sort() orders the list and keeps equal nodes in order
+ * - Verifies LL_TopK() returns exactly the first k nodes of LL_Sort()
+ * - Measures LL_Sort(), LL_TopK() and the former selection sort
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_ll_sort [rounds]
+ *
+ * \details The workload mimics the lcdproc client's top memory screen:
+ * records sorted by size in descending order with many equal sizes, using
+ * a comparator that only returns 0 or 1 like sort_procs() in
+ * clients/lcdproc/mem.c.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "shared/LL.h"
+
+/** \brief Default number of sorts per list size, divided by the size */
+#define DEFAULT_ROUNDS 2000000L
+
+/** \brief Number of records picked by LL_TopK(), as on a 4-line display */
+#define TOP_K 5
+
+/** \brief Benchmark record */
+typedef struct record {
+	int size; ///< Sort key
+	int seq;  ///< Original list position
+} record;
+
+// Descending by size, returns only 0 or 1 like sort_procs()
+static int by_size(void *a, void *b) { return ((record *)b)->size > ((record *)a)->size; }
+
+/**
+ * \brief Former LL_Sort(): selection sort moving the last element of each range to the end
+ * \param list List to sort
+ * \param compare Comparison function
+ */
+static void legacy_sort(LinkedList *list, int (*compare)(void *, void *))
+{
+	int numnodes = LL_Length(list);
+	LL_node *best, *last, *current;
+
+	if (numnodes < 2)
+		return;
+
+	LL_End(list);
+	last = LL_GetNode(list);
+
+	for (int i = numnodes - 1; i > 0; i--) {
+		LL_Rewind(list);
+		best = last;
+
+		for (int j = 0; j < i; j++) {
+			current = LL_GetNode(list);
+			if (compare(current->data, best->data) > 0)
+				best = current;
+			LL_Next(list);
+		}
+
+		LL_SwapNodes(last, best);
+		last = best->prev;
+	}
+
+	LL_Rewind(list);
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Rebuild list in the original record order
+static void fill_list(LinkedList *list, record *recs, int n)
+{
+	while (LL_Pop(list) != NULL)
+		;
+	for (int i = 0; i < n; i++)
+		LL_Push(list, &recs[i]);
+}
+
+// Check order, stability and top-k agreement for one list size
+static int verify(LinkedList *list, record *recs, int n)
+{
+	void *top[TOP_K];
+	record *prev = NULL;
+	int found, i = 0;
+	int failures = 0;
+
+	fill_list(list, recs, n);
+	found = LL_TopK(list, by_size, top, TOP_K);
+	LL_Sort(list, by_size);
+
+	if (LL_Length(list) != n) {
+		printf("❌ %d nodes lost while sorting\n", n - LL_Length(list));
+		failures++;
+	}
+
+	for (record *r = LL_GetFirst(list); r != NULL; r = LL_GetNext(list), i++) {
+		if ((prev != NULL) && ((prev->size < r->size) ||
+				       ((prev->size == r->size) && (prev->seq > r->seq)))) {
+			printf("❌ node %d out of order (size %d seq %d after size %d seq %d)\n", i,
+			       r->size, r->seq, prev->size, prev->seq);
+			failures++;
+		}
+		if ((i < TOP_K) && ((i >= found) || (top[i] != r))) {
+			printf("❌ top-k entry %d differs from the sorted list\n", i);
+			failures++;
+		}
+		prev = r;
+	}
+
+	if (found != ((n < TOP_K) ? n : TOP_K)) {
+		printf("❌ LL_TopK returned %d entries for %d nodes\n", found, n);
+		failures++;
+	}
+
+	return failures;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static const int sizes[] = {1, 10, 100, 300, 1000, 3000, 10000};
+	long rounds = (argc > 1) ? atol(argv[1]) : DEFAULT_ROUNDS;
+	LinkedList *list = LL_new();
+	volatile long sink = 0;
+	int failures = 0;
+
+	srand(15);
+
+	printf("List sort, descending by size, about one distinct size per four records\n");
+	printf("  %8s %14s %14s %14s\n", "records", "merge sort us", "top-5 us", "former us");
+
+	for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		int n = sizes[k];
+		long reps = rounds / n + 1;
+		long legacy_reps = reps / (1 + n / 100) + 1;
+		record *recs = malloc(n * sizeof(record));
+		void *top[TOP_K];
+		double t_sort = 0, t_top = 0, t_legacy = 0, t0;
+
+		for (int i = 0; i < n; i++) {
+			recs[i].size = rand() % (n / 4 + 1);
+			recs[i].seq = i;
+		}
+
+		failures += verify(list, recs, n);
+
+		for (long r = 0; r < reps; r++) {
+			fill_list(list, recs, n);
+			t0 = now_ns();
+			LL_Sort(list, by_size);
+			t_sort += now_ns() - t0;
+			sink += ((record *)LL_GetFirst(list))->size;
+
+			t0 = now_ns();
+			sink += LL_TopK(list, by_size, top, TOP_K);
+			t_top += now_ns() - t0;
+		}
+
+		for (long r = 0; r < legacy_reps; r++) {
+			fill_list(list, recs, n);
+			t0 = now_ns();
+			legacy_sort(list, by_size);
+			t_legacy += now_ns() - t0;
+			sink += ((record *)LL_GetFirst(list))->size;
+		}
+
+		printf("  %8d %14.2f %14.2f %14.2f\n", n, t_sort / reps / 1000, t_top / reps / 1000,
+		       t_legacy / legacy_reps / 1000);
+		free(recs);
+	}
+
+	fill_list(list, NULL, 0);
+	LL_Destroy(list);
+
+	if (failures != 0)
+		return 1;
+	printf("✅ Sort is ordered and stable, top-k matches the sorted prefix\n");
+
+	return (sink == 0);
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_pixmap_to_lcd.c
+ * \brief Microbenchmark for the G15 canvas to LCD conversion kernels
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies every kernel the CPU supports against the bitwise reference
+ * - Measures nanoseconds and TSC cycles per converted frame for each kernel
+ * - Shows the kernel g15_pixmap_to_lcd() picks on this CPU
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_pixmap_to_lcd [frames]
+ *
+ * \details server/drivers/g15-lcd.c is compiled into this program directly,
+ * libg15 is not needed. Each frame is a random canvas with one byte changed
+ * per iteration, so no conversion can be skipped. Cycles are TSC ticks and
+ * only reported on x86.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "g15-lcd.c"
+
+#ifdef G15_LCD_X86
+#include <x86intrin.h>
+#endif
+
+/** \brief Default number of converted frames per kernel */
+#define DEFAULT_FRAMES 200000L
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * \brief Time stamp counter, 0 where there is none
+ * \return Current TSC value
+ */
+static unsigned long long now_cycles(void)
+{
+#ifdef G15_LCD_X86
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static unsigned char pixmap[G15_LCD_PIXMAP_LEN];
+	static unsigned char expected[G15_LCD_DATA_LEN];
+	static unsigned char lcd_data[G15_LCD_DATA_LEN];
+	long frames = (argc > 1) ? atol(argv[1]) : DEFAULT_FRAMES;
+	const G15LcdKernel *reference = g15_lcd_kernels;
+	unsigned int state = 0x1510u;
+	volatile unsigned long sink = 0;
+	double t_reference = 0;
+	int failures = 0;
+
+	while (reference[1].name != NULL)
+		reference++;
+
+	for (int i = 0; i < G15_LCD_PIXMAP_LEN; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		pixmap[i] = (unsigned char)(state >> 24);
+	}
+
+	printf("Canvas to LCD conversion, %d canvas bytes to %d report bytes per frame\n",
+	       G15_LCD_PIXMAP_LEN, G15_LCD_DATA_LEN);
+	printf("  %8s %14s %16s %10s\n", "kernel", "ns/frame", "cycles/frame", "speedup");
+
+	// Reference last in the table, so time it first for the speedup column
+	for (int pass = 0; pass < 2; pass++) {
+		for (const G15LcdKernel *k = g15_lcd_kernels; k->name != NULL; k++) {
+			double t0, t_frame;
+			unsigned long long c0, c_frame;
+
+			if (((pass == 0) != (k == reference)) ||
+			    ((k->supported != NULL) && !k->supported()))
+				continue;
+
+			reference->convert(expected, pixmap);
+			k->convert(lcd_data, pixmap);
+			if (memcmp(lcd_data, expected, sizeof(expected)) != 0) {
+				printf("❌ %s kernel differs from the bitwise reference\n", k->name);
+				failures++;
+			}
+
+			t0 = now_ns();
+			c0 = now_cycles();
+			for (long i = 0; i < frames; i++) {
+				pixmap[i % G15_LCD_PIXMAP_LEN] ^= (unsigned char)i;
+				k->convert(lcd_data, pixmap);
+				sink += lcd_data[i % G15_LCD_DATA_LEN];
+			}
+			c_frame = (now_cycles() - c0) / frames;
+			t_frame = (now_ns() - t0) / frames;
+			if (k == reference)
+				t_reference = t_frame;
+
+			printf("  %8s %14.1f %16llu %9.1fx\n", k->name, t_frame, c_frame,
+			       t_reference / t_frame);
+		}
+	}
+
+	printf("  g15_pixmap_to_lcd() uses %s\n", g15_lcd_kernel_name());
+
+	if (failures != 0)
+		return 1;
+	printf("✅ All supported kernels match the bitwise reference\n");
+
+	return (sink == 0);
+}
@@ -0,0 +1,468 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_render_jitter.c
+ * \brief Frame jitter and command latency of LCDd with and without render thread
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies frames replayed by the render thread arrive complete and in order
+ * - Simulates the main loop under 50 clients sending command bursts
+ * - Measures the deviation of frame intervals from the frame interval
+ * - Measures how long client commands wait before they are executed
+ * - Compares the single-threaded main loop with the render thread
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_render_jitter [frames]
+ *
+ * \details server/renderthread.c is compiled into this program directly;
+ * the drivers are replaced by a stub display whose flush blocks for 10 to
+ * 20 ms like a full G15 frame written over USB. The main loop is modelled
+ * after do_mainloop(): it sleeps until a client sends or the frame is due,
+ * reads whatever arrived (not interruptible), and runs commands in turns of
+ * 32 per client until the queue is empty or the next frame is due. Commands
+ * burn CPU instead of doing real work. A frame counts as sent when the stub
+ * flush starts.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "renderthread.c"
+
+/** \brief Default number of frames per run */
+#define DEFAULT_FRAMES 60
+
+/** \brief Frame interval of the simulation in microseconds */
+#define BENCH_FRAME_INTERVAL 50000
+
+/** \brief Number of simulated clients */
+#define CLIENTS 50
+
+/** \brief Commands a client runs per turn, as CommandQuantum */
+#define QUANTUM 32
+
+/** \brief CPU time of one command in microseconds */
+#define COMMAND_USEC 8
+
+/** \brief CPU time of reading one client's data in microseconds */
+#define READ_USEC 15
+
+/** \brief Commands in a regular burst */
+#define BURST 8
+
+/** \brief Commands in every 20th burst of a client */
+#define BIG_BURST 160
+
+/** \brief Bursts a client can have queued */
+#define MAX_BURSTS 8
+
+/** \brief Lines of the stub display */
+#define LINES 4
+
+/** \brief Frame number found in the text of the frame being drawn */
+static int drawn_frame;
+
+/** \brief Lines drawn since the last clear */
+static int drawn_lines;
+
+/** \brief Last frame flushed */
+static int flushed_frame;
+
+/** \brief Frames flushed with missing lines or out of order */
+static int broken_frames;
+
+/** \brief Seed of the simulated write times */
+static unsigned int write_seed = 1;
+
+/** \brief Start times of the flushes of the current run */
+static double *flush_at;
+
+/** \brief Number of flushes in the current run */
+static int flushes;
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Burn CPU for usec microseconds
+static void work(long usec)
+{
+	double until = now_ns() + usec * 1e3;
+
+	while (now_ns() < until)
+		;
+}
+
+// Stubs for the drivers renderthread.c calls into
+void drivers_clear(void) { drawn_lines = 0; }
+
+void drivers_string(int x, int y, const char *string)
+{
+	(void)x;
+	(void)y;
+	if (sscanf(string, "frame %d", &drawn_frame) == 1 || strncmp(string, "line", 4) == 0)
+		drawn_lines++;
+}
+
+void drivers_chr(int x, int y, char c)
+{
+	(void)x;
+	(void)y;
+	(void)c;
+}
+
+void drivers_vbar(int x, int y, int len, int promille, int pattern)
+{
+	(void)x;
+	(void)y;
+	(void)len;
+	(void)promille;
+	(void)pattern;
+}
+
+void drivers_hbar(int x, int y, int len, int promille, int pattern)
+{
+	(void)x;
+	(void)y;
+	(void)len;
+	(void)promille;
+	(void)pattern;
+}
+
+void drivers_pbar(int x, int y, int width, int promille, char *begin_label, char *end_label)
+{
+	(void)x;
+	(void)y;
+	(void)width;
+	(void)promille;
+	(void)begin_label;
+	(void)end_label;
+}
+
+void drivers_num(int x, int num)
+{
+	(void)x;
+	(void)num;
+}
+
+void drivers_heartbeat(int state) { (void)state; }
+
+void drivers_icon(int x, int y, int icon)
+{
+	(void)x;
+	(void)y;
+	(void)icon;
+}
+
+void drivers_cursor(int x, int y, int state)
+{
+	(void)x;
+	(void)y;
+	(void)state;
+}
+
+void drivers_backlight(int state) { (void)state; }
+
+void drivers_output(int state) { (void)state; }
+
+// Hand the frame to the stub display, which blocks like a USB write
+void drivers_flush(void)
+{
+	struct timespec write = {0, (10000 + rand_r(&write_seed) % 10000) * 1000L};
+
+	flush_at[flushes++] = now_ns();
+
+	if ((drawn_lines != LINES) || (drawn_frame <= flushed_frame))
+		broken_frames++;
+	flushed_frame = drawn_frame;
+
+	nanosleep(&write, NULL);
+}
+
+const char *drivers_get_key(void) { return NULL; }
+
+int drivers_have_input(void) { return 0; }
+
+int drivers_have_macro_leds(void) { return 0; }
+
+int drivers_set_macro_leds(int m1, int m2, int m3, int mr)
+{
+	(void)m1;
+	(void)m2;
+	(void)m3;
+	(void)mr;
+	return -1;
+}
+
+const char *drivers_get_info(void) { return "stub display"; }
+
+void drivers_lock(void) {}
+
+void drivers_unlock(void) {}
+
+/**
+ * \brief Commands a simulated client has sent but that have not run yet
+ */
+typedef struct {
+	int count[MAX_BURSTS];		   ///< Commands left per queued burst
+	struct timespec sent[MAX_BURSTS]; ///< Arrival time per queued burst
+	int head;			   ///< Oldest queued burst
+	int queued;			   ///< Number of queued bursts
+	struct timespec next_send;	   ///< When the client sends again
+	int bursts;			   ///< Bursts sent so far
+} SimClient;
+
+/** \brief The simulated clients */
+static SimClient clients[CLIENTS];
+
+/** \brief Wait of every executed command in microseconds */
+static long *waits;
+
+/** \brief Number of entries in waits */
+static long nwaits;
+
+/** \brief Capacity of waits */
+static long waits_size;
+
+/**
+ * \brief Draw a frame the way render_screen() does, through drivers.c's recording check
+ * \param n Frame number
+ */
+static void draw_frame(int n)
+{
+	char line[32];
+
+	if (renderthread_recording()) {
+		renderthread_record(DRAW_CLEAR, 0, 0, 0, 0, 0, NULL, NULL);
+		renderthread_record(DRAW_BACKLIGHT, 0, 0, 1, 0, 0, NULL, NULL);
+		snprintf(line, sizeof(line), "frame %d", n);
+		renderthread_record(DRAW_STRING, 1, 1, 0, 0, 0, line, NULL);
+		for (int y = 2; y <= LINES; y++) {
+			snprintf(line, sizeof(line), "line %d of frame %d", y, n);
+			renderthread_record(DRAW_STRING, 1, y, 0, 0, 0, line, NULL);
+		}
+		renderthread_record(DRAW_HBAR, 1, 4, 20, n * 10 % 1000, 0, NULL, NULL);
+		renderthread_record(DRAW_HEARTBEAT, 0, 0, n & 1, 0, 0, NULL, NULL);
+		renderthread_publish();
+		return;
+	}
+
+	drivers_clear();
+	drivers_backlight(1);
+	snprintf(line, sizeof(line), "frame %d", n);
+	drivers_string(1, 1, line);
+	for (int y = 2; y <= LINES; y++) {
+		snprintf(line, sizeof(line), "line %d of frame %d", y, n);
+		drivers_string(1, y, line);
+	}
+	drivers_hbar(1, 4, 20, n * 10 % 1000, 0);
+	drivers_heartbeat(n & 1);
+	drivers_flush();
+}
+
+// Queue the bursts of all clients that have sent by now, return the earliest next send time
+static struct timespec receive(const struct timespec *now)
+{
+	struct timespec next = clients[0].next_send;
+
+	for (int c = 0; c < CLIENTS; c++) {
+		SimClient *sc = &clients[c];
+
+		if (elapsed_usec(&sc->next_send, now) >= 0) {
+			if (sc->queued < MAX_BURSTS) {
+				int slot = (sc->head + sc->queued) % MAX_BURSTS;
+
+				sc->count[slot] = (++sc->bursts % 20 == c % 20) ? BIG_BURST : BURST;
+				sc->sent[slot] = sc->next_send;
+				sc->queued++;
+				work(READ_USEC);
+			}
+			add_usec(&sc->next_send, BENCH_FRAME_INTERVAL / 2 +
+							 rand() % BENCH_FRAME_INTERVAL);
+		}
+		if (elapsed_usec(&sc->next_send, &next) > 0)
+			next = sc->next_send;
+	}
+
+	return next;
+}
+
+// Run commands in turns of QUANTUM per client until none is left or the frame is due
+static void run_commands(const struct timespec *until)
+{
+	struct timespec now;
+	int busy = 1;
+
+	while (busy) {
+		busy = 0;
+		for (int c = 0; c < CLIENTS; c++) {
+			SimClient *sc = &clients[c];
+			int turn = QUANTUM;
+
+			while ((turn > 0) && (sc->queued > 0)) {
+				work(COMMAND_USEC);
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				if (nwaits < waits_size)
+					waits[nwaits++] = elapsed_usec(&sc->sent[sc->head], &now);
+				turn--;
+				if (--sc->count[sc->head] == 0) {
+					sc->head = (sc->head + 1) % MAX_BURSTS;
+					sc->queued--;
+				}
+			}
+			busy |= (sc->queued > 0);
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (elapsed_usec(until, &now) >= 0)
+			return;
+	}
+}
+
+/**
+ * \brief Compare two doubles for qsort()
+ * \param a First value
+ * \param b Second value
+ * \return Sort order
+ */
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * \brief Compare two longs for qsort()
+ * \param a First value
+ * \param b Second value
+ * \return Sort order
+ */
+static int cmp_long(const void *a, const void *b)
+{
+	long x = *(const long *)a, y = *(const long *)b;
+
+	return (x > y) - (x < y);
+}
+
+// Simulate the main loop for a number of frames and print the timing
+static int run(const char *name, int frames, int threaded)
+{
+	struct timespec now, next_frame, next_send, end;
+	double *dev = calloc(frames, sizeof(double));
+	double sum = 0, sq = 0;
+	int produced = 0, failures = 0;
+
+	flushes = 0;
+	flushed_frame = 0;
+	nwaits = 0;
+	memset(clients, 0, sizeof(clients));
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	for (int c = 0; c < CLIENTS; c++) {
+		clients[c].next_send = now;
+		add_usec(&clients[c].next_send, rand() % BENCH_FRAME_INTERVAL);
+	}
+	next_frame = now;
+	add_usec(&next_frame, BENCH_FRAME_INTERVAL);
+	end = next_frame;
+	add_usec(&end, (long)BENCH_FRAME_INTERVAL * frames);
+
+	if (threaded && (renderthread_start() < 0)) {
+		printf("❌ render thread not started\n");
+		free(dev);
+		return 1;
+	}
+
+	while (elapsed_usec(&now, &end) > 0) {
+		const struct timespec *deadline = &next_frame;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (elapsed_usec(&next_frame, &now) >= 0) {
+			renderthread_begin_frame(&next_frame);
+			draw_frame(++produced);
+			add_usec(&next_frame, BENCH_FRAME_INTERVAL);
+		}
+
+		next_send = receive(&now);
+		if (elapsed_usec(&next_send, &next_frame) > 0)
+			deadline = &next_send;
+		run_commands(&next_frame);
+
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL);
+	}
+
+	renderthread_shutdown();
+
+	if ((broken_frames != 0) || (flushes < produced - 2) || (flushed_frame != produced)) {
+		printf("❌ %s: %d of %d frames sent, %d incomplete or out of order\n", name,
+		       flushes, produced, broken_frames);
+		failures++;
+	}
+
+	for (int i = 1; i < flushes; i++) {
+		double d = (flush_at[i] - flush_at[i - 1]) / 1e3 - BENCH_FRAME_INTERVAL;
+
+		dev[i - 1] = (d < 0) ? -d : d;
+		sum += d;
+		sq += d * d;
+	}
+	qsort(dev, flushes - 1, sizeof(double), cmp_double);
+	qsort(waits, nwaits, sizeof(long), cmp_long);
+
+	printf("  %-14s %8d %12.0f %12.0f %12.0f %12ld %12ld %12ld\n", name, flushes,
+	       sqrt(sq / (flushes - 1) - (sum / (flushes - 1)) * (sum / (flushes - 1))),
+	       dev[(flushes - 1) * 99 / 100], dev[flushes - 2], waits[nwaits / 2],
+	       waits[nwaits * 99 / 100], waits[nwaits - 1]);
+
+	free(dev);
+	return failures;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	int frames = (argc > 1) ? atoi(argv[1]) : DEFAULT_FRAMES;
+	int failures = 0;
+
+	if (frames < 10)
+		frames = 10;
+
+	flush_at = calloc(frames + 2, sizeof(double));
+	waits_size = (long)frames * CLIENTS * BIG_BURST;
+	waits = calloc(waits_size, sizeof(long));
+	srand(1);
+
+	printf("Frame timing, %d clients, %d us frames, 10-20 ms display writes\n", CLIENTS,
+	       BENCH_FRAME_INTERVAL);
+	printf("  %-14s %8s %12s %12s %12s %12s %12s %12s\n", "", "frames", "jitter us",
+	       "p99 dev us", "max dev us", "cmd wait us", "p99 wait us", "max wait us");
+
+	failures += run("main loop", frames, 0);
+	failures += run("render thread", frames, 1);
+
+	free(flush_at);
+	free(waits);
+
+	if (failures != 0)
+		return 1;
+	printf("✅ Frames replayed complete and in order\n");
+
+	return 0;
+}
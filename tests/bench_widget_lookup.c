@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_widget_lookup.c
+ * \brief Microbenchmark for widget id lookup in LCDd screens
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies every widget id resolves to its widget, also inside frames
+ * - Verifies frame sub-screens only see their own widgets
+ * - Verifies removed and unknown ids are not found
+ * - Verifies every interned id is released with its widget or screen
+ * - Measures lookup cost from 10 to 10,000 widgets per screen
+ * - Compares against the former recursive strcmp() list scan
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_widget_lookup [lookups]
+ *
+ * \details server/screen.c is compiled into this program directly; menu and
+ * screen list hooks are replaced by stubs so no server state is needed.
+ * Half of the widgets of each screen sit inside a frame added last, the
+ * layout that made the old scan slowest. A "full update" is one lookup per
+ * widget, i.e. what a client refreshing its whole dashboard costs.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "screen.c"
+
+/** \brief Default number of hashed lookups per screen size */
+#define DEFAULT_LOOKUPS 4000000L
+
+/** \brief Total strcmp() budget of the linear scan per screen size */
+#define LINEAR_BUDGET 200000000L
+
+// Stubs for the server modules screen.c calls into
+static DisplayProps bench_props = {20, 4, 5, 8};
+DisplayProps *display_props = &bench_props;
+
+void menuscreen_add_screen(Screen *s) { (void)s; }
+
+void menuscreen_remove_screen(Screen *s) { (void)s; }
+
+int screenlist_remove(Screen *s)
+{
+	(void)s;
+	return 0;
+}
+
+void widget_destroy(Widget *w)
+{
+	if (w->frame_screen != NULL)
+		screen_destroy(w->frame_screen);
+	intern_release(w->id);
+	free(w);
+}
+
+/**
+ * \brief Create a widget the way widget_create() does, minus the defaults
+ * \param id Widget id
+ * \param type Widget type
+ * \param s Screen the widget is created for
+ * \return New widget
+ */
+static Widget *bench_widget(const char *id, WidgetType type, Screen *s)
+{
+	Widget *w = calloc(1, sizeof(Widget));
+
+	w->id = intern(id);
+	w->type = type;
+	w->screen = s;
+	if (type == WID_FRAME) {
+		w->frame_screen = screen_create("frame_sub", s->client);
+		w->frame_screen->parent = s;
+	}
+	return w;
+}
+
+/**
+ * \brief Former lookup: scan the list, recurse into every frame
+ * \param s Screen to search
+ * \param id Widget id
+ * \return Widget or NULL
+ */
+static Widget *linear_find(Screen *s, const char *id)
+{
+	Widget *w;
+
+	ilist_foreach(w, &s->widgets, link) {
+		if (strcmp(w->id, id) == 0)
+			return w;
+		if (w->type == WID_FRAME) {
+			Widget *sub = linear_find(w->frame_screen, id);
+
+			if (sub != NULL)
+				return sub;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Build a screen with n widgets, half of them inside a frame
+static Screen *build_screen(int n, char ids[][16])
+{
+	Screen *s = screen_create("bench", NULL);
+	Widget *frame = bench_widget("frame", WID_FRAME, s);
+
+	for (int i = 0; i < n; i++) {
+		Screen *target = (i < n / 2) ? s : frame->frame_screen;
+
+		// The frame goes behind the top-level widgets, before its contents
+		if (i == n / 2)
+			screen_add_widget(s, frame);
+
+		snprintf(ids[i], 16, "w%d", i);
+		screen_add_widget(target, bench_widget(ids[i], WID_STRING, target));
+	}
+
+	return s;
+}
+
+// Check hashed lookups against the scan and the frame scoping rules
+static int verify_screen(Screen *s, int n, char ids[][16])
+{
+	Widget *frame = screen_find_widget(s, "frame");
+	Widget *dup;
+	int failures = 0;
+
+	for (int i = 0; i < n; i++) {
+		Widget *w = screen_find_widget(s, ids[i]);
+
+		if ((w == NULL) || (w != linear_find(s, ids[i]))) {
+			printf("❌ %s does not resolve to its widget\n", ids[i]);
+			failures++;
+		}
+		if ((i < n / 2) && (screen_find_widget(frame->frame_screen, ids[i]) != NULL)) {
+			printf("❌ %s is visible from inside the frame\n", ids[i]);
+			failures++;
+		}
+	}
+
+	if (screen_find_widget(s, "missing") != NULL) {
+		printf("❌ unknown id resolves\n");
+		failures++;
+	}
+
+	dup = bench_widget(ids[n - 1], WID_STRING, s);
+
+	if (screen_add_widget(s, dup) == 0) {
+		printf("❌ duplicate id %s accepted\n", ids[n - 1]);
+		failures++;
+	} else {
+		widget_destroy(dup);
+	}
+
+	return failures;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static const int sizes[] = {10, 30, 100, 300, 1000, 3000, 10000};
+	static char ids[10000][16];
+	long lookups = (argc > 1) ? atol(argv[1]) : DEFAULT_LOOKUPS;
+	volatile long sink = 0;
+	int failures = 0;
+
+	printf("Widget lookup, half of the widgets inside a frame\n");
+	printf("  %8s %12s %12s %16s %16s\n", "widgets", "hash ns", "scan ns", "hash update us",
+	       "scan update us");
+
+	for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+		int n = sizes[k];
+		long scans = LINEAR_BUDGET / n;
+		Screen *s = build_screen(n, ids);
+		Widget *frame;
+		double t0, t_hash, t_scan;
+
+		failures += verify_screen(s, n, ids);
+
+		t0 = now_ns();
+		for (long i = 0; i < lookups; i++)
+			sink += (screen_find_widget(s, ids[i % n]) != NULL);
+		t_hash = (now_ns() - t0) / lookups;
+
+		t0 = now_ns();
+		for (long i = 0; i < scans; i++)
+			sink += (linear_find(s, ids[i % n]) != NULL);
+		t_scan = (now_ns() - t0) / scans;
+
+		printf("  %8d %12.2f %12.2f %16.2f %16.2f\n", n, t_hash, t_scan, t_hash * n / 1000,
+		       t_scan * n / 1000);
+
+		// Removing the frame drops everything inside it from the index
+		frame = screen_find_widget(s, "frame");
+		screen_remove_widget(s, frame);
+		if (screen_find_widget(s, ids[n - 1]) != NULL) {
+			printf("❌ %s still found after its frame was removed\n", ids[n - 1]);
+			failures++;
+		}
+		widget_destroy(frame);
+		screen_destroy(s);
+	}
+
+	if (intern_count() != 0) {
+		printf("❌ %u ids still interned after destroying all screens\n", intern_count());
+		failures++;
+	}
+
+	if (failures != 0)
+		return 1;
+	printf("✅ All ids resolve, frames are scoped, duplicates rejected, ids released\n");
+
+	return (sink == 0);
+}
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: GPL-2.0+
+
+/**
+ * \file tests/bench_widget_update.c
+ * \brief Microbenchmark for widget string updates in LCDd
+ * \author n0vedad
+ * \date 2026
+ *
+ * \features
+ * - Verifies short strings are stored inline and long ones in the client arena
+ * - Verifies identical values are reported as unchanged and not rewritten
+ * - Verifies clearing and shrinking strings hands their arena blocks back
+ * - Counts heap allocations and screen touches per update
+ * - Compares against the former free() plus strdup() on every update
+ *
+ * \usage
+ * - Built together with the tests, run via 'make bench' in tests/
+ * - ./bench_widget_update [updates]
+ *
+ * \details server/screen.c and server/widget.c are compiled into this program
+ * directly; menu and screen list hooks are replaced by stubs. Heap
+ * allocations are counted by wrapping malloc(), calloc() and realloc() around
+ * the glibc implementations. The former path touched the screen on every
+ * widget_set, which made the renderer redraw even when nothing changed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "screen.c"
+#include "widget.c"
+
+/** \brief Default number of updates per workload */
+#define DEFAULT_UPDATES 2000000L
+
+/** \brief Number of distinct values cycled through by a workload */
+#define VALUES 64
+
+// Stubs for the server modules screen.c calls into
+static DisplayProps bench_props = {20, 4, 5, 8};
+DisplayProps *display_props = &bench_props;
+
+void menuscreen_add_screen(Screen *s) { (void)s; }
+
+void menuscreen_remove_screen(Screen *s) { (void)s; }
+
+int screenlist_remove(Screen *s)
+{
+	(void)s;
+	return 0;
+}
+
+/**
+ * \brief Heap allocations since start
+ * \details volatile, as the compiler assumes malloc() leaves globals alone.
+ */
+static volatile unsigned long heap_allocs;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+
+// Counting wrappers, free() needs none
+void *malloc(size_t size)
+{
+	heap_allocs++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+	heap_allocs++;
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size)
+{
+	heap_allocs++;
+	return __libc_realloc(p, size);
+}
+
+/**
+ * \brief Monotonic time in nanoseconds
+ * \return Current time
+ */
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * \brief Former update: replace the string unconditionally and touch the screen
+ * \param w Widget to update
+ * \param value New text
+ */
+static void legacy_set(Widget *w, const char *value)
+{
+	free(w->text);
+	w->text = strdup(value);
+	screen_touch(w->screen);
+}
+
+/**
+ * \brief Current update as done by widget_set_func()
+ * \param w Widget to update
+ * \param value New text
+ */
+static void current_set(Widget *w, const char *value)
+{
+	if (widget_set_string(w, &w->text, value) > 0)
+		screen_touch(w->screen);
+}
+
+// Check storage placement, change reporting and arena reuse
+static int verify(Screen *s)
+{
+	static const char long_a[] = "a value well beyond the inline limit";
+	static const char long_b[] = "another value well beyond the inline limit";
+	Widget *w = widget_create("check", WID_PBAR, s);
+	arena_usage before, after;
+	char *block;
+	int failures = 0;
+
+	if ((widget_set_string(w, &w->text, "42%") != 1) || (w->text != w->text_buf)) {
+		printf("❌ short text not stored inline\n");
+		failures++;
+	}
+	if (widget_set_string(w, &w->text, "42%") != 0) {
+		printf("❌ identical text reported as changed\n");
+		failures++;
+	}
+	if ((widget_set_string(w, &w->begin_label, "[") != 1) || (w->begin_label != w->begin_buf) ||
+	    (widget_set_string(w, &w->end_label, "]") != 1) || (w->end_label != w->end_buf)) {
+		printf("❌ short labels not stored inline\n");
+		failures++;
+	}
+
+	arena_get_usage(s->arena, &before);
+	widget_set_string(w, &w->text, long_a);
+	block = w->text;
+	if ((block == w->text_buf) || (strcmp(block, long_a) != 0)) {
+		printf("❌ long text not moved to the arena\n");
+		failures++;
+	}
+	if ((widget_set_string(w, &w->text, long_b) != 1) || (w->text != block) ||
+	    (strcmp(w->text, long_b) != 0)) {
+		printf("❌ long text not overwritten in place\n");
+		failures++;
+	}
+	if ((widget_set_string(w, &w->text, "7") != 1) || (w->text != w->text_buf) ||
+	    (widget_set_string(w, &w->end_label, NULL) != 1) || (w->end_label != NULL) ||
+	    (widget_set_string(w, &w->end_label, NULL) != 0)) {
+		printf("❌ shrinking or clearing strings misbehaves\n");
+		failures++;
+	}
+
+	arena_get_usage(s->arena, &after);
+	if (after.blocks != before.blocks) {
+		printf("❌ %ld arena blocks leaked by string updates\n",
+		       (long)after.blocks - (long)before.blocks);
+		failures++;
+	}
+
+	widget_destroy(w);
+
+	return failures;
+}
+
+// Run the benchmark
+int main(int argc, char *argv[])
+{
+	static const char *workloads[] = {"unchanged", "short", "long"};
+	static char values[3][VALUES][48];
+	long updates = (argc > 1) ? atol(argv[1]) : DEFAULT_UPDATES;
+	Client *client = calloc(1, sizeof(Client));
+	volatile long sink = 0;
+	int failures = 0;
+	Screen *s;
+
+	client->arena = arena_create();
+	s = screen_create("bench", client);
+	failures += verify(s);
+
+	for (int i = 0; i < VALUES; i++) {
+		snprintf(values[0][i], sizeof(values[0][i]), "CPU  42%%");
+		snprintf(values[1][i], sizeof(values[1][i]), "12:%02d:%02d", i / 60, i % 60);
+		snprintf(values[2][i], sizeof(values[2][i]), "Now playing: track %02d of %d", i,
+			 VALUES);
+	}
+
+	printf("Widget text updates, %ld per workload\n", updates);
+	printf("  %10s %10s %14s %14s %11s %15s %15s\n", "workload", "former ns", "former allocs",
+	       "former touches", "current ns", "current allocs", "current touches");
+
+	for (int k = 0; k < 3; k++) {
+		Screen *ls = screen_create("legacy", NULL);
+		Widget *legacy = widget_create("legacy", WID_STRING, ls);
+		Widget *w = widget_create("current", WID_STRING, s);
+		unsigned long allocs, legacy_allocs, version, touches, legacy_touches;
+		double t0, t_legacy, t_current;
+
+		allocs = heap_allocs;
+		legacy_touches = 0;
+		t0 = now_ns();
+		for (long i = 0; i < updates; i++) {
+			version = legacy->screen->version;
+			legacy_set(legacy, values[k][i % VALUES]);
+			legacy_touches += (legacy->screen->version != version);
+		}
+		t_legacy = (now_ns() - t0) / updates;
+		legacy_allocs = heap_allocs - allocs;
+
+		allocs = heap_allocs;
+		touches = 0;
+		t0 = now_ns();
+		for (long i = 0; i < updates; i++) {
+			version = s->version;
+			current_set(w, values[k][i % VALUES]);
+			touches += (s->version != version);
+		}
+		t_current = (now_ns() - t0) / updates;
+		allocs = heap_allocs - allocs;
+
+		if (strcmp(w->text, legacy->text) != 0) {
+			printf("❌ %s: texts differ after the run\n", workloads[k]);
+			failures++;
+		}
+		sink += w->text[0];
+
+		printf("  %10s %10.2f %14lu %14lu %11.2f %15lu %15lu\n", workloads[k], t_legacy,
+		       legacy_allocs, legacy_touches, t_current, allocs, touches);
+
+		widget_destroy(legacy);
+		screen_destroy(ls);
+		widget_destroy(w);
+	}
+
+	screen_destroy(s);
+	arena_destroy(client->arena);
+	free(client);
+
+	if (failures != 0)
+		return 1;
+	printf("✅ Short strings inline, long ones reused in place, unchanged values skipped\n");
+
+	return (sink == 0);
+}
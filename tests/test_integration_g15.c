@@ -9,10 +9,17 @@
  * \features
  * - LCDd server process management and lifecycle
  * - TCP socket communication and protocol handling
+ * - Unix domain socket listener for local clients
  * - LCDproc protocol handshake and command processing
  * - Screen and widget lifecycle management
  * - Client connection and disconnection handling
  * - Multiple concurrent client scenarios
+ * - Pipelined command floods split at arbitrary segment boundaries
+ * - Command batches answered with a single aggregated reply
+ * - Reply suppression through the client ack mode
+ * - A client that never reads must not stall the server for others
+ * - Fair command scheduling between a flooding and an interactive client
+ * - Shared-memory widget values passed as a memfd over the Unix socket
  * - Driver integration with various backends
  *
  * \details This file contains comprehensive integration tests for the complete
@@ -43,6 +50,7 @@
  * \ingroup ToDo_low
  */
 
+#define _GNU_SOURCE
 #define _DEFAULT_SOURCE
 #define _POSIX_C_SOURCE 200809L
 
@@ -51,17 +59,23 @@
 #include <fcntl.h>
 #include <locale.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <signal.h>
 #include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "shared/shmvalues.h"
+
 /** \brief Enable GNU extensions */
 #define _GNU_SOURCE
 /** \brief Enable POSIX.1-2008 functions */
@@ -74,6 +88,16 @@
 #define TEST_TIMEOUT 10
 /** \brief Process startup timeout in seconds */
 #define PROCESS_START_TIMEOUT 5
+/** \brief Number of pipelined commands sent by the flood test */
+#define FLOOD_COMMANDS 100000
+/** \brief Size of one write of the slow reader test, a multiple of "noop\\n" */
+#define SLOW_READER_CHUNK 65535
+/** \brief Upper bound of data sent by the slow reader test */
+#define SLOW_READER_MAX_BYTES (256 * 1024 * 1024)
+/** \brief Number of slots in the shared-memory value test region */
+#define SHM_TEST_SLOTS 4
+/** \brief Number of commands sent by the flooding client of the fairness test */
+#define FAIR_FLOOD_COMMANDS 200000
 
 // Global test state: test statistics counters, dynamic server port, spawned process IDs, and
 // temporary config directory path
@@ -83,6 +107,7 @@ static int test_server_port = 0;
 static pid_t lcdd_pid = 0;
 static pid_t client_pid = 0;
 static char temp_config_dir[256];
+static char unix_socket_path[320];
 
 // Test driver configuration
 typedef enum { DRIVER_DEBUG, DRIVER_G15, DRIVER_LINUX_INPUT } test_driver_t;
@@ -121,6 +146,7 @@ static int find_free_port(void);
 static int wait_for_tcp_port(const char *host, int port, int timeout);
 static int send_tcp_command(const char *host, int port, const char *command, char *response,
 			    size_t response_size);
+static int recv_until(int sock, const char *marker, char *response, size_t response_size);
 static int create_test_config_file(const char *filename, const char *content);
 static void setup_test_environment(void);
 static void cleanup_test_environment(void);
@@ -130,12 +156,19 @@ static void generate_driver_config(char *config, size_t config_size, const char
 static void test_lcdd_server_startup(void);
 static void test_lcdd_server_shutdown(void);
 static void test_tcp_connection_basic(void);
+static void test_unix_socket_connection(void);
 static void test_lcdproc_protocol_handshake(void);
 static void test_screen_lifecycle(void);
 static void test_widget_operations(void);
 static void test_client_disconnection(void);
 static void test_lcdproc_client_integration(void);
 static void test_multiple_clients(void);
+static void test_pipelined_command_flood(void);
+static void test_command_batch(void);
+static void test_ack_modes(void);
+static void test_slow_reader(void);
+static void test_fair_scheduling(void);
+static void test_shm_value_channel(void);
 static void test_g15_driver_integration(void);
 
 // Handle interrupt signals for clean shutdown
@@ -271,6 +304,31 @@ static int send_tcp_command(const char *host, int port, const char *command, cha
 	return bytes_received > 0 ? 0 : -1;
 }
 
+// Receive until the collected replies contain marker or TEST_TIMEOUT expires
+static int recv_until(int sock, const char *marker, char *response, size_t response_size)
+{
+	struct pollfd pfd = {.fd = sock, .events = POLLIN};
+	size_t len = 0;
+
+	response[0] = '\0';
+
+	while (strstr(response, marker) == NULL) {
+		ssize_t bytes;
+
+		if ((len + 1 >= response_size) || (poll(&pfd, 1, TEST_TIMEOUT * 1000) <= 0))
+			return -1;
+
+		bytes = recv(sock, response + len, response_size - 1 - len, 0);
+		if (bytes <= 0)
+			return -1;
+
+		len += bytes;
+		response[len] = '\0';
+	}
+
+	return 0;
+}
+
 // Create configuration file with specified content
 static int create_test_config_file(const char *filename, const char *content)
 {
@@ -303,9 +361,11 @@ static void setup_test_environment(void)
 		exit(1);
 	}
 
-	char lcdd_config[512];
+	// Room for the longest driver config with a full-length socket path
+	char lcdd_config[1024];
 	char config_path[320];
 
+	snprintf(unix_socket_path, sizeof(unix_socket_path), "%s/LCDd.sock", temp_config_dir);
 	snprintf(config_path, sizeof(config_path), "%s/LCDd.conf", temp_config_dir);
 	generate_driver_config(lcdd_config, sizeof(lcdd_config), TEST_SERVER_HOST,
 			       test_server_port);
@@ -369,13 +429,14 @@ static void generate_driver_config(char *config, size_t config_size, const char
 			 "DriverPath=../server/drivers/\n"
 			 "Bind=%s\n"
 			 "Port=%d\n"
+			 "UnixSocket=%s\n"
 			 "ReportLevel=3\n"
 			 "ReportToSyslog=false\n"
 			 "Foreground=true\n"
 			 "\n"
 			 "[debug]\n"
 			 "Size=20x4\n",
-			 host, port);
+			 host, port, unix_socket_path);
 		break;
 
 	// G15 driver configuration with hidraw interface
@@ -386,6 +447,7 @@ static void generate_driver_config(char *config, size_t config_size, const char
 			 "DriverPath=../server/drivers/\n"
 			 "Bind=%s\n"
 			 "Port=%d\n"
+			 "UnixSocket=%s\n"
 			 "ReportLevel=3\n"
 			 "ReportToSyslog=false\n"
 			 "Foreground=true\n"
@@ -393,7 +455,7 @@ static void generate_driver_config(char *config, size_t config_size, const char
 			 "[g15]\n"
 			 "# G15 driver configuration\n"
 			 "# Uses hidraw interface for G15/G510 keyboards\n",
-			 host, port);
+			 host, port, unix_socket_path);
 		break;
 
 	// Linux input driver configuration
@@ -404,6 +466,7 @@ static void generate_driver_config(char *config, size_t config_size, const char
 			 "DriverPath=../server/drivers/\n"
 			 "Bind=%s\n"
 			 "Port=%d\n"
+			 "UnixSocket=%s\n"
 			 "ReportLevel=3\n"
 			 "ReportToSyslog=false\n"
 			 "Foreground=true\n"
@@ -411,7 +474,7 @@ static void generate_driver_config(char *config, size_t config_size, const char
 			 "[linux_input]\n"
 			 "# Linux input driver configuration\n"
 			 "Device=/dev/input/event0\n",
-			 host, port);
+			 host, port, unix_socket_path);
 		break;
 	}
 }
@@ -476,6 +539,14 @@ static void test_lcdd_server_shutdown(void)
 		ASSERT_FALSE(wait_for_tcp_port(TEST_SERVER_HOST, test_server_port, 2),
 			     "TCP port no longer listening after shutdown");
 
+		struct sockaddr_un addr = {.sun_family = AF_UNIX};
+		int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		strncpy(addr.sun_path, unix_socket_path, sizeof(addr.sun_path) - 1);
+		ASSERT_TRUE(connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0,
+			    "Unix socket no longer listening after shutdown");
+		close(sock);
+
 	} else {
 		ASSERT_TRUE(0, "No LCDd server process to shutdown");
 	}
@@ -499,6 +570,57 @@ static void test_tcp_connection_basic(void)
 	ASSERT_TRUE(result == 0, "Second TCP connection successful");
 }
 
+// Test the Unix domain listener configured with UnixSocket
+static void test_unix_socket_connection(void)
+{
+	char response[MAX_BUFFER_SIZE];
+	char peer[96];
+	struct sockaddr_un addr;
+	struct stat st;
+	int sock;
+
+	printf("\n" COLOR_BLUE "🔌 Testing Unix domain socket..." COLOR_RESET "\n");
+
+	ASSERT_TRUE(stat(unix_socket_path, &st) == 0 && S_ISSOCK(st.st_mode),
+		    "Unix socket created at configured path");
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		ASSERT_TRUE(0, "Socket creation failed");
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, unix_socket_path, sizeof(addr.sun_path) - 1);
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ASSERT_TRUE(0, "Failed to connect to Unix socket");
+		close(sock);
+		return;
+	}
+
+	send(sock, "hello\n", 6, 0);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strncmp(response, "connect LCDproc", 15) == 0,
+		    "Handshake over Unix socket");
+
+	send(sock, "screen_add unix_screen\n", 23, 0);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "success\n") == 0,
+		    "Commands over Unix socket");
+
+	// LCDd runs as the same user, so the peer is this process
+	snprintf(peer, sizeof(peer), " pid %ld uid %lu gid %lu\n", (long)getpid(),
+		 (unsigned long)getuid(), (unsigned long)getgid());
+	send(sock, "client_stats\n", 13, 0);
+	ASSERT_TRUE(recv_until(sock, "client_stats complete\n", response, sizeof(response)) == 0 &&
+			strstr(response, peer) != NULL,
+		    "client_stats reports the Unix peer's pid and uid");
+
+	close(sock);
+}
+
 // Test LCDproc protocol handshake
 static void test_lcdproc_protocol_handshake(void)
 {
@@ -607,6 +729,26 @@ static void test_screen_lifecycle(void)
 				    "Screen deleted successfully");
 		}
 
+		// Priority changes reorder the screen list, the first screen of the top tier wins
+		const char *ranked = "screen_add rot_a\n"
+				     "screen_add rot_b\n"
+				     "screen_set rot_a -priority alert\n"
+				     "noop\n";
+		send(sock, ranked, strlen(ranked), 0);
+		ASSERT_TRUE(recv_until(sock, "listen rot_a\n", response, sizeof(response)) == 0,
+			    "Raised screen is shown");
+
+		const char *reranked = "screen_set rot_b -priority alert\n"
+				       "screen_set rot_a -priority foreground\n";
+		send(sock, reranked, strlen(reranked), 0);
+		ASSERT_TRUE(recv_until(sock, "listen rot_b\n", response, sizeof(response)) == 0 &&
+				strstr(response, "ignore rot_a\n") != NULL,
+			    "Lowered screen gives way to the rest of its former tier");
+
+		const char *cleanup = "screen_del rot_b\nscreen_del rot_a\nnoop\n";
+		send(sock, cleanup, strlen(cleanup), 0);
+		recv_until(sock, "noop complete\n", response, sizeof(response));
+
 		send(sock, "bye\n", 4, 0);
 	} else {
 		ASSERT_TRUE(0, "Failed to connect for screen lifecycle test");
@@ -683,6 +825,36 @@ static void test_widget_operations(void)
 				    "Title widget content set successfully");
 		}
 
+		// Test central argument count check of the dispatcher
+		send(sock, "widget_del widget_screen\n", 25, 0);
+		bytes = recv(sock, response, sizeof(response) - 1, 0);
+
+		if (bytes > 0) {
+			response[bytes] = '\0';
+			ASSERT_TRUE(strstr(response, "huh? Usage: widget_del") != NULL,
+				    "Wrong argument count is answered with usage");
+		}
+
+		// Widget ids are unique per screen, including widgets inside frames
+		send(sock, "widget_add widget_screen test_string string\n", 45, 0);
+		ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+				strstr(response, "Widget already exists") != NULL,
+			    "Duplicate widget id is rejected");
+
+		const char *framed = "widget_add widget_screen test_frame frame\n"
+				     "widget_add widget_screen inner string -in test_frame\n"
+				     "widget_add widget_screen inner string\n"
+				     "widget_set widget_screen inner 1 1 framed\n"
+				     "widget_del widget_screen inner\n"
+				     "widget_set widget_screen inner 1 1 gone\n"
+				     "noop\n";
+		send(sock, framed, strlen(framed), 0);
+		ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+				strstr(response, "success\nsuccess\nhuh? Widget already exists\n"
+						 "success\nsuccess\nhuh? Unknown widget id\n") !=
+				    NULL,
+			    "Widgets inside frames are found, unique and deletable");
+
 		send(sock, "bye\n", 4, 0);
 	} else {
 		ASSERT_TRUE(0, "Failed to connect for widget operations test");
@@ -731,6 +903,14 @@ static void test_client_disconnection(void)
 			send(sock2, "client_set -name client2\n", 25, 0);
 			recv(sock2, response, sizeof(response) - 1, 0);
 
+			// An exclusive key reservation blocks other clients while its owner lives
+			send(sock1, "client_add_key -exclusively Up\n", 31, 0);
+			recv_until(sock1, "\n", response, sizeof(response));
+			send(sock2, "client_add_key -exclusively Up\n", 31, 0);
+			recv_until(sock2, "\n", response, sizeof(response));
+			ASSERT_TRUE(strstr(response, "huh?") != NULL,
+				    "Exclusive key reservation rejected for a second client");
+
 			// Simulate abrupt client crash by closing socket
 			close(sock1);
 
@@ -744,6 +924,12 @@ static void test_client_disconnection(void)
 					    "Server handles client disconnection gracefully");
 			}
 
+			// The crashed client's reservations are gone
+			send(sock2, "client_add_key -exclusively Up\n", 31, 0);
+			recv_until(sock2, "\n", response, sizeof(response));
+			ASSERT_TRUE(strstr(response, "success") != NULL,
+				    "Disconnect releases the client's key reservations");
+
 			send(sock2, "bye\n", 4, 0);
 			close(sock2);
 
@@ -898,6 +1084,634 @@ static void test_multiple_clients(void)
 	}
 }
 
+// Test pipelined command flood sent in arbitrary segment sizes
+static void test_pipelined_command_flood(void)
+{
+	int sock;
+	int flag = 1;
+	struct sockaddr_in addr;
+	char response[MAX_BUFFER_SIZE];
+	char line[64];
+	size_t line_len = 0;
+	char *commands;
+	size_t commands_len = 0;
+	size_t sent = 0;
+	int successes = 0;
+	int failures = 0;
+	unsigned int seed = 0x15c0ffee;
+	time_t deadline;
+
+	printf("\n" COLOR_BLUE "🌊 Testing pipelined command flood..." COLOR_RESET "\n");
+
+	commands = malloc((size_t)FLOOD_COMMANDS * 48);
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (commands == NULL || sock < 0) {
+		ASSERT_TRUE(0, "Flood test setup failed");
+		free(commands);
+		if (sock >= 0)
+			close(sock);
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(test_server_port);
+	inet_pton(AF_INET, TEST_SERVER_HOST, &addr.sin_addr);
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ASSERT_TRUE(0, "Failed to connect for command flood test");
+		free(commands);
+		close(sock);
+		return;
+	}
+
+	// Create target widget, one request at a time
+	send(sock, "hello\n", 6, 0);
+	recv(sock, response, sizeof(response) - 1, 0);
+	send(sock, "client_set -name flood_client\n", 30, 0);
+	recv(sock, response, sizeof(response) - 1, 0);
+	send(sock, "screen_add flood_screen\n", 24, 0);
+	recv(sock, response, sizeof(response) - 1, 0);
+	send(sock, "widget_add flood_screen flood string\n", 37, 0);
+	recv(sock, response, sizeof(response) - 1, 0);
+
+	for (int i = 0; i < FLOOD_COMMANDS; i++) {
+		commands_len += sprintf(commands + commands_len,
+					"widget_set flood_screen flood 1 1 {flood %d}\n", i);
+	}
+
+	// Disable Nagle so every chunk leaves as its own segment and lines get split
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+	fcntl(sock, F_SETFL, O_NONBLOCK);
+
+	// Write random sized chunks while draining replies so neither side stalls
+	deadline = time(NULL) + TEST_TIMEOUT * 3;
+	while ((successes + failures) < FLOOD_COMMANDS && time(NULL) < deadline) {
+		struct pollfd pfd = {.fd = sock, .events = POLLIN};
+
+		if (sent < commands_len)
+			pfd.events |= POLLOUT;
+
+		if (poll(&pfd, 1, 1000) <= 0)
+			continue;
+
+		if ((pfd.revents & POLLOUT) && sent < commands_len) {
+			size_t chunk = (rand_r(&seed) % 4 == 0) ? 1 + rand_r(&seed) % 7
+								: 1 + rand_r(&seed) % 1500;
+
+			if (chunk > commands_len - sent)
+				chunk = commands_len - sent;
+
+			ssize_t n = send(sock, commands + sent, chunk, 0);
+			if (n > 0)
+				sent += n;
+		}
+
+		if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+			ssize_t n = recv(sock, response, sizeof(response), 0);
+
+			if (n <= 0)
+				break;
+
+			// Count reply lines; listen/ignore notifications are skipped
+			for (ssize_t j = 0; j < n; j++) {
+				if (response[j] != '\n') {
+					if (line_len < sizeof(line) - 1)
+						line[line_len++] = response[j];
+					continue;
+				}
+				line[line_len] = '\0';
+				if (strncmp(line, "success", 7) == 0)
+					successes++;
+				else if (strncmp(line, "huh?", 4) == 0)
+					failures++;
+				line_len = 0;
+			}
+		}
+	}
+
+	ASSERT_TRUE(sent == commands_len, "All flood commands were written");
+	ASSERT_TRUE(failures == 0, "No flood command was corrupted by segment splits");
+	ASSERT_TRUE(successes == FLOOD_COMMANDS, "Every flood command was acknowledged");
+
+	send(sock, "bye\n", 4, 0);
+	close(sock);
+	free(commands);
+}
+
+// Test that a command batch is answered with one aggregated reply
+static void test_command_batch(void)
+{
+	char response[MAX_BUFFER_SIZE];
+	int sock;
+	struct sockaddr_in addr;
+
+	printf("\n" COLOR_BLUE "📦 Testing command batches..." COLOR_RESET "\n");
+
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock < 0) {
+		ASSERT_TRUE(0, "Socket creation failed");
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(test_server_port);
+	inet_pton(AF_INET, TEST_SERVER_HOST, &addr.sin_addr);
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ASSERT_TRUE(0, "Failed to connect for command batch test");
+		close(sock);
+		return;
+	}
+
+	const char *setup = "hello\n"
+			    "screen_add batch_screen\n"
+			    "widget_add batch_screen a string\n"
+			    "widget_add batch_screen b string\n"
+			    "widget_add batch_screen c string\n"
+			    "noop\n";
+	send(sock, setup, strlen(setup), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0,
+		    "Batch test screen set up");
+
+	// noop is not part of the batch and marks the end of the replies
+	const char *batch = "batch_begin\n"
+			    "widget_set batch_screen a 1 1 {first}\n"
+			    "widget_set batch_screen b 1 2 {second}\n"
+			    "widget_set batch_screen c 1 3 {third}\n"
+			    "batch_end\n"
+			    "noop\n";
+	send(sock, batch, strlen(batch), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "success\nnoop complete\n") == 0,
+		    "Successful batch is answered with a single success");
+
+	const char *failing = "batch_begin\n"
+			      "widget_set batch_screen a 1 1 {ok}\n"
+			      "widget_set batch_screen missing 1 2 {fails}\n"
+			      "batch_end\n"
+			      "noop\n";
+	const char *expected = "huh? batch: 1 of 2 replies were errors\nnoop complete\n";
+	send(sock, failing, strlen(failing), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+			strcmp(response, expected) == 0,
+		    "Failing batch is answered with a single aggregated error");
+
+	send(sock, "batch_end\n", 10, 0);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strstr(response, "huh? No batch open") != NULL,
+		    "batch_end without batch_begin is rejected");
+
+	close(sock);
+}
+
+// Test that client_set -ack suppresses the selected replies
+static void test_ack_modes(void)
+{
+	char response[MAX_BUFFER_SIZE];
+	int sock;
+	struct sockaddr_in addr;
+
+	printf("\n" COLOR_BLUE "🔇 Testing reply ack modes..." COLOR_RESET "\n");
+
+	sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (sock < 0) {
+		ASSERT_TRUE(0, "Socket creation failed");
+		return;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(test_server_port);
+	inet_pton(AF_INET, TEST_SERVER_HOST, &addr.sin_addr);
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ASSERT_TRUE(0, "Failed to connect for ack mode test");
+		close(sock);
+		return;
+	}
+
+	// The reply to client_set already follows the new mode; noop marks the end
+	const char *errors_only = "hello\n"
+				  "client_set -name ack_client -ack errors\n"
+				  "screen_add ack_screen\n"
+				  "widget_add ack_screen w string\n"
+				  "widget_set ack_screen w 1 1 {quiet}\n"
+				  "widget_set ack_screen missing 1 1 {fails}\n"
+				  "noop\n";
+	send(sock, errors_only, strlen(errors_only), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+			strstr(response, "success") == NULL && strstr(response, "huh?") != NULL,
+		    "Ack mode errors sends only error replies");
+
+	const char *none = "client_set -ack none\n"
+			   "widget_set ack_screen w 1 1 {silent}\n"
+			   "widget_set ack_screen missing 1 1 {fails}\n"
+			   "noop\n";
+	send(sock, none, strlen(none), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "noop complete\n") == 0,
+		    "Ack mode none sends no replies");
+
+	send(sock, "client_set -ack all\n", 20, 0);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "success\n") == 0,
+		    "Ack mode all restores success replies");
+
+	close(sock);
+}
+
+// Test that a client which stops reading does not block other clients
+static void test_slow_reader(void)
+{
+	char response[MAX_BUFFER_SIZE];
+	char chunk[SLOW_READER_CHUNK];
+	struct sockaddr_in addr;
+	int slow, other;
+	int rcvbuf = 4096;
+	int stalled = 0;
+	size_t total = 0;
+
+	printf("\n" COLOR_BLUE "🐌 Testing slow reader isolation..." COLOR_RESET "\n");
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(test_server_port);
+	inet_pton(AF_INET, TEST_SERVER_HOST, &addr.sin_addr);
+
+	slow = socket(AF_INET, SOCK_STREAM, 0);
+	if (slow < 0) {
+		ASSERT_TRUE(0, "Socket creation failed");
+		return;
+	}
+
+	// Small receive buffer so the server's replies back up quickly
+	setsockopt(slow, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	if (connect(slow, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ASSERT_TRUE(0, "Failed to connect slow client");
+		close(slow);
+		return;
+	}
+
+	fcntl(slow, F_SETFL, fcntl(slow, F_GETFL) | O_NONBLOCK);
+	send(slow, "hello\n", 6, 0);
+
+	for (size_t i = 0; i + 5 <= sizeof(chunk); i += 5)
+		memcpy(chunk + i, "noop\n", 5);
+
+	// Send commands without ever reading the replies until the server stops taking them
+	while (total < SLOW_READER_MAX_BYTES) {
+		struct pollfd pfd = {.fd = slow, .events = POLLOUT};
+		ssize_t n = send(slow, chunk, sizeof(chunk), 0);
+
+		if (n > 0) {
+			total += n;
+			continue;
+		}
+
+		if ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+			break;
+
+		if (poll(&pfd, 1, 1000) == 0) {
+			stalled = 1;
+			break;
+		}
+	}
+
+	ASSERT_TRUE(stalled, "Server stopped accepting commands from the slow client");
+
+	other = socket(AF_INET, SOCK_STREAM, 0);
+	if ((other >= 0) && (connect(other, (struct sockaddr *)&addr, sizeof(addr)) == 0)) {
+		send(other, "hello\nnoop\n", 11, 0);
+		ASSERT_TRUE(recv_until(other, "noop complete\n", response, sizeof(response)) == 0,
+			    "Other clients are still served while one client does not read");
+	} else {
+		ASSERT_TRUE(0, "Failed to connect second client");
+	}
+
+	if (other >= 0)
+		close(other);
+	close(slow);
+}
+
+/**
+ * \brief Open a TCP connection to the test server and say hello
+ * \param name Client name to set
+ * \return Connected socket, or -1 on failure
+ */
+static int connect_named_client(const char *name)
+{
+	char response[MAX_BUFFER_SIZE];
+	char command[128];
+	struct sockaddr_in addr;
+	int sock = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (sock < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(test_server_port);
+	inet_pton(AF_INET, TEST_SERVER_HOST, &addr.sin_addr);
+
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(sock);
+		return -1;
+	}
+
+	snprintf(command, sizeof(command), "hello\nclient_set -name %s\nnoop\n", name);
+	send(sock, command, strlen(command), 0);
+	if (recv_until(sock, "noop complete\n", response, sizeof(response)) != 0) {
+		close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+// Test that a flooding client cannot starve others and shows up in client_stats
+static void test_fair_scheduling(void)
+{
+	char response[MAX_BUFFER_SIZE];
+	char *commands, *line;
+	size_t commands_len = 0;
+	size_t sent = 0;
+	long latency_ms = -1;
+	unsigned long parsed = 0;
+	struct timespec t0, t1;
+	time_t deadline;
+	int flooder, observer;
+
+	printf("\n" COLOR_BLUE "⚖️  Testing fair command scheduling..." COLOR_RESET "\n");
+
+	commands = malloc((size_t)FAIR_FLOOD_COMMANDS * 40 + 64);
+	flooder = connect_named_client("fair_flooder");
+	observer = connect_named_client("fair_observer");
+	if ((commands == NULL) || (flooder < 0) || (observer < 0)) {
+		ASSERT_TRUE(0, "Fair scheduling test setup failed");
+		goto out;
+	}
+
+	// Replies are suppressed so the flooder never has to read while it sends
+	commands_len += sprintf(commands, "client_set -ack none\n"
+					  "screen_add fair_screen\n"
+					  "widget_add fair_screen w string\n");
+	for (int i = 0; i < FAIR_FLOOD_COMMANDS; i++)
+		commands_len +=
+		    sprintf(commands + commands_len, "widget_set fair_screen w 1 1 {%d}\n", i);
+	commands_len += sprintf(commands + commands_len, "noop\n");
+
+	fcntl(flooder, F_SETFL, O_NONBLOCK);
+
+	deadline = time(NULL) + TEST_TIMEOUT * 3;
+	while ((sent < commands_len) && (time(NULL) < deadline)) {
+		struct pollfd pfd = {.fd = flooder, .events = POLLOUT};
+
+		if (poll(&pfd, 1, 1000) <= 0)
+			continue;
+
+		ssize_t n = send(flooder, commands + sent, commands_len - sent, 0);
+		if (n > 0)
+			sent += n;
+
+		// With the flooder's backlog queued, time a round trip of another client
+		if ((latency_ms < 0) && (sent > commands_len / 4)) {
+			clock_gettime(CLOCK_MONOTONIC, &t0);
+			send(observer, "noop\n", 5, 0);
+			if (recv_until(observer, "noop complete\n", response,
+				       sizeof(response)) == 0) {
+				clock_gettime(CLOCK_MONOTONIC, &t1);
+				latency_ms = (t1.tv_sec - t0.tv_sec) * 1000 +
+					     (t1.tv_nsec - t0.tv_nsec) / 1000000;
+			}
+		}
+	}
+
+	ASSERT_TRUE(sent == commands_len, "Flooding client wrote all commands");
+	ASSERT_TRUE((latency_ms >= 0) && (latency_ms < 1000),
+		    "Other client is served promptly during the flood");
+	ASSERT_TRUE(recv_until(flooder, "noop complete\n", response, sizeof(response)) == 0,
+		    "Flooding client's backlog fully processed");
+
+	send(observer, "client_stats\n", 13, 0);
+	ASSERT_TRUE(recv_until(observer, "client_stats complete\n", response,
+			       sizeof(response)) == 0,
+		    "client_stats answered");
+
+	line = strstr(response, "name {fair_flooder}");
+	if (line != NULL)
+		line = strstr(line, " commands ");
+	if (line != NULL)
+		parsed = strtoul(line + 10, NULL, 10);
+	ASSERT_TRUE(parsed >= FAIR_FLOOD_COMMANDS, "client_stats reports the flooder's commands");
+
+	// Every widget_set success was dropped by the flooder's ack mode
+	parsed = 0;
+	line = strstr(response, "name {fair_flooder}");
+	if (line != NULL)
+		line = strstr(line, " replies_suppressed ");
+	if (line != NULL)
+		parsed = strtoul(line + 20, NULL, 10);
+	ASSERT_TRUE(parsed >= FAIR_FLOOD_COMMANDS,
+		    "client_stats reports the flooder's suppressed replies");
+	ASSERT_TRUE(strstr(response, "name {fair_observer} queue 0") != NULL,
+		    "client_stats reports the observer with an empty queue");
+
+	// Thousands of widget_set calls must reuse the text's arena block
+	parsed = 0;
+	line = strstr(response, "name {fair_flooder}");
+	if (line != NULL)
+		line = strstr(line, " arena_used ");
+	if (line != NULL)
+		parsed = strtoul(line + 12, NULL, 10);
+	ASSERT_TRUE((parsed > 0) && (parsed < 4096),
+		    "client_stats reports the flooder's screen in a small arena");
+
+out:
+	free(commands);
+	if (flooder >= 0)
+		close(flooder);
+	if (observer >= 0)
+		close(observer);
+}
+
+/**
+ * \brief Send a command with a file descriptor attached
+ * \param sock Connected Unix domain socket
+ * \param command Command line including the newline
+ * \param fd Descriptor passed as SCM_RIGHTS
+ * \retval 0 Success
+ * \retval -1 sendmsg() failed
+ */
+static int send_with_fd(int sock, const char *command, int fd)
+{
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(int))];
+	} control;
+	struct iovec iov = {.iov_base = (void *)command, .iov_len = strlen(command)};
+	struct msghdr msg = {
+	    .msg_iov = &iov,
+	    .msg_iovlen = 1,
+	    .msg_control = control.buf,
+	    .msg_controllen = sizeof(control.buf),
+	};
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	return (sendmsg(sock, &msg, 0) == (ssize_t)iov.iov_len) ? 0 : -1;
+}
+
+/**
+ * \brief Create a value region as a client would
+ * \param nslots Number of slots
+ * \param seal Whether to seal the memfd against shrinking
+ * \param map Returns the writable mapping
+ * \return memfd, or -1 on failure
+ */
+static int create_value_region(uint32_t nslots, int seal, void **map)
+{
+	size_t size = sizeof(ShmValuesHeader) + nslots * sizeof(ShmValueSlot);
+	ShmValuesHeader *header;
+	int fd;
+
+	fd = memfd_create("lcdproc_test_values", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0)
+		return -1;
+
+	if ((ftruncate(fd, size) < 0) || (seal && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) < 0)) {
+		close(fd);
+		return -1;
+	}
+
+	*map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (*map == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+
+	header = *map;
+	header->magic = SHM_VALUES_MAGIC;
+	header->version = SHM_VALUES_VERSION;
+	header->nslots = nslots;
+	header->slot_size = sizeof(ShmValueSlot);
+
+	return fd;
+}
+
+// Test widget values taken from a client's shared memory region
+static void test_shm_value_channel(void)
+{
+	size_t size = sizeof(ShmValuesHeader) + SHM_TEST_SLOTS * sizeof(ShmValueSlot);
+	char response[MAX_BUFFER_SIZE];
+	struct sockaddr_un addr;
+	ShmValueSlot *slots;
+	void *map = MAP_FAILED;
+	void *unsealed_map = MAP_FAILED;
+	int sock, fd, unsealed_fd;
+
+	printf("\n" COLOR_BLUE "🧠 Testing shared-memory value channel..." COLOR_RESET "\n");
+
+	fd = create_value_region(SHM_TEST_SLOTS, 1, &map);
+	unsealed_fd = create_value_region(SHM_TEST_SLOTS, 0, &unsealed_map);
+	if ((fd < 0) || (unsealed_fd < 0)) {
+		ASSERT_TRUE(0, "memfd value region creation failed");
+		goto out;
+	}
+
+	ASSERT_TRUE(ftruncate(fd, sizeof(ShmValuesHeader)) < 0,
+		    "Sealed region cannot be shrunk under the server");
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, unix_socket_path, sizeof(addr.sun_path) - 1);
+
+	if ((sock < 0) || (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)) {
+		ASSERT_TRUE(0, "Failed to connect to Unix socket");
+		if (sock >= 0)
+			close(sock);
+		goto out;
+	}
+
+	const char *setup = "hello\n"
+			    "screen_add shm_screen\n"
+			    "widget_add shm_screen label string\n"
+			    "widget_add shm_screen level pbar\n"
+			    "widget_set shm_screen level 1 2 20 0\n"
+			    "noop\n";
+	send(sock, setup, strlen(setup), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0,
+		    "Value channel test screen set up");
+
+	send(sock, "shm_attach\n", 11, 0);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strncmp(response, "huh? No descriptor", 18) == 0,
+		    "shm_attach without a descriptor is rejected");
+
+	send_with_fd(sock, "shm_attach\n", unsealed_fd);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "huh? Invalid value region\n") == 0,
+		    "Region without F_SEAL_SHRINK is rejected");
+
+	send_with_fd(sock, "shm_attach\n", fd);
+	ASSERT_TRUE(recv_until(sock, "\n", response, sizeof(response)) == 0 &&
+			strcmp(response, "success\n") == 0,
+		    "Sealed memfd region attached");
+
+	const char *bind = "shm_bind shm_screen label 0\n"
+			   "shm_bind shm_screen level 1\n"
+			   "shm_bind shm_screen level 4\n"
+			   "noop\n";
+	const char *expected = "success\nsuccess\nhuh? Slot must be 0-3 or none\nnoop complete\n";
+	send(sock, bind, strlen(bind), 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0 &&
+			strcmp(response, expected) == 0,
+		    "Widgets bound to slots, out of range slot rejected");
+
+	// Update the slots the way a client does while the server renders
+	slots = (ShmValueSlot *)((char *)map + sizeof(ShmValuesHeader));
+	for (uint32_t i = 0; i < 50; i++) {
+		__atomic_store_n(&slots[0].seq, 2 * i + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		snprintf(slots[0].text, sizeof(slots[0].text), "update %u", i);
+		__atomic_store_n(&slots[0].seq, 2 * i + 2, __ATOMIC_RELEASE);
+
+		__atomic_store_n(&slots[1].seq, 2 * i + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		slots[1].value = i * 20;
+		__atomic_store_n(&slots[1].seq, 2 * i + 2, __ATOMIC_RELEASE);
+
+		usleep(10000);
+	}
+
+	send(sock, "noop\n", 5, 0);
+	ASSERT_TRUE(recv_until(sock, "noop complete\n", response, sizeof(response)) == 0,
+		    "Server keeps serving while rendering shared values");
+
+	close(sock);
+
+	ASSERT_TRUE(send_tcp_command(TEST_SERVER_HOST, test_server_port, "hello\n", response,
+				     sizeof(response)) == 0,
+		    "Server alive after value channel client left");
+
+out:
+	if (fd >= 0)
+		close(fd);
+	if (unsealed_fd >= 0)
+		close(unsealed_fd);
+	if (map != MAP_FAILED)
+		munmap(map, size);
+	if (unsealed_map != MAP_FAILED)
+		munmap(unsealed_map, size);
+}
+
 // Test G15 driver integration
 static void test_g15_driver_integration(void)
 {
@@ -944,11 +1758,18 @@ static void print_test_summary(void)
 	printf("\nIntegration test coverage:\n");
 	printf("✓ LCDd server process management\n");
 	printf("✓ TCP socket communication\n");
+	printf("✓ Unix domain socket listener\n");
 	printf("✓ LCDproc protocol handshake\n");
 	printf("✓ Screen and widget lifecycle\n");
 	printf("✓ Client disconnection handling\n");
 	printf("✓ lcdproc client integration\n");
 	printf("✓ Multiple concurrent clients\n");
+	printf("✓ Pipelined command flood with split lines\n");
+	printf("✓ Command batches with aggregated replies\n");
+	printf("✓ Reply suppression via ack modes\n");
+	printf("✓ Slow reader isolation via output queues\n");
+	printf("✓ Fair command scheduling and client_stats\n");
+	printf("✓ Shared-memory widget value channel\n");
 	printf("✓ Driver integration baseline\n");
 }
 
@@ -994,6 +1815,9 @@ int main(int argc, char *argv[])
 	if (shutdown_requested)
 		goto cleanup;
 	test_tcp_connection_basic();
+	if (shutdown_requested)
+		goto cleanup;
+	test_unix_socket_connection();
 	if (shutdown_requested)
 		goto cleanup;
 	test_lcdproc_protocol_handshake();
@@ -1012,6 +1836,24 @@ int main(int argc, char *argv[])
 	if (shutdown_requested)
 		goto cleanup;
 	test_multiple_clients();
+	if (shutdown_requested)
+		goto cleanup;
+	test_pipelined_command_flood();
+	if (shutdown_requested)
+		goto cleanup;
+	test_command_batch();
+	if (shutdown_requested)
+		goto cleanup;
+	test_ack_modes();
+	if (shutdown_requested)
+		goto cleanup;
+	test_slow_reader();
+	if (shutdown_requested)
+		goto cleanup;
+	test_fair_scheduling();
+	if (shutdown_requested)
+		goto cleanup;
+	test_shm_value_channel();
 	if (shutdown_requested)
 		goto cleanup;
 	test_g15_driver_integration();
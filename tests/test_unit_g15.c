@@ -12,6 +12,12 @@
  * - G-Key macro recording and playback functionality
  * - Error handling and edge case validation
  * - Debug driver integration testing
+ * - Canvas to LCD conversion kernels checked against the bitwise reference
+ * - Frame fill, blit and import checked against drawing on a libg15render style canvas
+ * - Glyph atlas loading and drawing checked against the same canvas drawing
+ * - Command dispatcher resolving every keyword and rejecting near misses
+ * - List sort stability and top-k selection checked against the sorted list
+ * - Hashed key reservation lookup checked against the former list scan
  *
  * \details This file contains comprehensive unit tests for G-Series keyboard functionality,
  * including device detection, RGB backlight control, and G-Key macro system testing.
@@ -25,6 +31,20 @@
 #include <string.h>
 
 #include "mock_hidraw_lib.h"
+#include "shared/LL.h"
+
+// The canvas conversion does not depend on libg15, so it is tested directly
+#include "g15-lcd.c"
+#include "g15-num.c"
+
+// The command dispatcher only maps keywords to handlers, which are stubbed below
+#include "commands/command_list.c"
+
+// Key reservations, with the screens and drivers stubbed below; the server's Driver is
+// renamed so that the mock Driver of the G15 tests can keep its name
+#define Driver ServerDriver
+#include "input.c"
+#undef Driver
 
 /** \brief Backlight on state for G15 driver testing */
 #define BACKLIGHT_ON 1
@@ -38,6 +58,90 @@ void report(int level, const char *format, ...)
 	(void)format;
 }
 
+/**
+ * \brief Define a command handler stub
+ * \param name Handler function name
+ */
+#define HANDLER_STUB(name)                                                                         \
+	int name(Client *c, int argc, char **argv)                                                 \
+	{                                                                                          \
+		(void)c;                                                                           \
+		(void)argc;                                                                        \
+		(void)argv;                                                                        \
+		return 0;                                                                          \
+	}
+
+HANDLER_STUB(test_func_func)
+HANDLER_STUB(hello_func)
+HANDLER_STUB(client_set_func)
+HANDLER_STUB(client_add_key_func)
+HANDLER_STUB(client_del_key_func)
+HANDLER_STUB(bye_func)
+HANDLER_STUB(batch_begin_func)
+HANDLER_STUB(batch_end_func)
+HANDLER_STUB(screen_add_func)
+HANDLER_STUB(screen_del_func)
+HANDLER_STUB(screen_set_func)
+HANDLER_STUB(key_add_func)
+HANDLER_STUB(key_del_func)
+HANDLER_STUB(widget_add_func)
+HANDLER_STUB(widget_del_func)
+HANDLER_STUB(widget_set_func)
+HANDLER_STUB(shm_attach_func)
+HANDLER_STUB(shm_bind_func)
+HANDLER_STUB(menu_add_item_func)
+HANDLER_STUB(menu_del_item_func)
+HANDLER_STUB(menu_set_item_func)
+HANDLER_STUB(menu_goto_func)
+HANDLER_STUB(menu_set_main_func)
+HANDLER_STUB(backlight_func)
+HANDLER_STUB(macro_leds_func)
+HANDLER_STUB(output_func)
+HANDLER_STUB(info_func)
+HANDLER_STUB(noop_func)
+HANDLER_STUB(client_stats_func)
+
+// Stubs for the server modules input.c calls into, no key is ever pressed
+int autorotate = 1;
+Screen *menuscreen = NULL;
+
+const char *drivers_get_key(void) { return NULL; }
+
+Screen *screenlist_current(void) { return NULL; }
+
+int screenlist_goto_next(void) { return 0; }
+
+int screenlist_goto_prev(void) { return 0; }
+
+char *screen_find_key(Screen *s, const char *key)
+{
+	(void)s;
+	(void)key;
+	return NULL;
+}
+
+int client_printf(Client *c, const char *format, ...)
+{
+	(void)c;
+	(void)format;
+	return 0;
+}
+
+bool is_menu_key(const char *key)
+{
+	(void)key;
+	return false;
+}
+
+void menuscreen_key_handler(const char *key) { (void)key; }
+
+int server_msg(const char *text, int expire)
+{
+	(void)text;
+	(void)expire;
+	return 0;
+}
+
 // Mock PrivateData structures
 typedef struct {
 	struct lib_hidraw_handle *hidraw_handle;
@@ -776,6 +880,728 @@ void test_debug_driver_error_handling(void)
 	printf("✅ Debug driver error handling test passed\n");
 }
 
+// Convert one canvas with every supported kernel and compare with the reference
+static int compare_lcd_kernels(const unsigned char *pixmap, const G15LcdKernel *reference)
+{
+	unsigned char expected[G15_LCD_DATA_LEN];
+	unsigned char actual[G15_LCD_DATA_LEN];
+	int mismatches = 0;
+
+	reference->convert(expected, pixmap);
+
+	for (const G15LcdKernel *k = g15_lcd_kernels; k != reference; k++) {
+		if ((k->supported != NULL) && !k->supported())
+			continue;
+
+		memset(actual, 0xa5, sizeof(actual));
+		k->convert(actual, pixmap);
+		if (memcmp(actual, expected, sizeof(expected)) != 0) {
+			printf("❌ %s kernel differs from the bitwise reference\n", k->name);
+			mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+// Test canvas to LCD conversion kernels against the bitwise reference
+void test_pixmap_to_lcd_equivalence(void)
+{
+	printf("🧪 Testing canvas to LCD conversion kernels...\n");
+
+	// Exactly the bytes a kernel may read, so AddressSanitizer catches over-reads
+	unsigned char *pixmap = malloc(G15_LCD_PIXMAP_LEN);
+	unsigned char report_buf[G15_LCD_REPORT_LEN];
+	unsigned char expected[G15_LCD_DATA_LEN];
+	const G15LcdKernel *reference = g15_lcd_kernels;
+	unsigned int state = 0x1510u;
+	int mismatches = 0;
+	int kernels = 0;
+
+	assert(pixmap != NULL);
+
+	while (reference[1].name != NULL) {
+		if ((reference->supported == NULL) || reference->supported())
+			kernels++;
+		reference++;
+	}
+	assert(strcmp(reference->name, "bitwise") == 0);
+
+	// Every byte value at every canvas position
+	for (int v = 0; v < 256; v++) {
+		for (int i = 0; i < G15_LCD_PIXMAP_LEN; i++)
+			pixmap[i] = (unsigned char)(v + i * 37);
+		mismatches += compare_lcd_kernels(pixmap, reference);
+	}
+
+	// Every single pixel, including the padding rows below the display
+	for (int bit = 0; bit < G15_LCD_PIXMAP_LEN * 8; bit++) {
+		memset(pixmap, 0, G15_LCD_PIXMAP_LEN);
+		pixmap[bit / 8] = (unsigned char)(0x80 >> (bit % 8));
+		mismatches += compare_lcd_kernels(pixmap, reference);
+	}
+
+	// Random canvases (xorshift32, fixed seed)
+	for (int n = 0; n < 2048; n++) {
+		for (int i = 0; i < G15_LCD_PIXMAP_LEN; i++) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			pixmap[i] = (unsigned char)(state >> 24);
+		}
+		mismatches += compare_lcd_kernels(pixmap, reference);
+	}
+	assert(mismatches == 0);
+
+	// Leftmost pixel of row 0 is bit 0 of column 0, rightmost of row 1 bit 1 of column 7
+	memset(pixmap, 0, G15_LCD_PIXMAP_LEN);
+	pixmap[0] = 0x80;
+	pixmap[G15_LCD_STRIDE] = 0x01;
+	reference->convert(expected, pixmap);
+	assert(expected[0] == 0x01);
+	assert(expected[7] == 0x02);
+
+	// The exported entry point adds the report header
+	memset(report_buf, 0xff, sizeof(report_buf));
+	g15_pixmap_to_lcd(report_buf, pixmap);
+	assert(report_buf[0] == G15_LCD_REPORT_ID);
+	for (int i = 1; i < G15_LCD_REPORT_OFFSET; i++)
+		assert(report_buf[i] == 0);
+	assert(memcmp(report_buf + G15_LCD_REPORT_OFFSET, expected, G15_LCD_DATA_LEN) == 0);
+
+	free(pixmap);
+	printf("✅ %d kernels match the bitwise reference, using %s\n", kernels,
+	       g15_lcd_kernel_name());
+}
+
+// Next value of the xorshift32 generator used by the frame tests
+static unsigned int test_random(unsigned int *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// Set a pixel of a row-major canvas the way g15r_setPixel() does
+static void canvas_set_pixel(unsigned char *canvas, int x, int y, int color)
+{
+	unsigned char bit = (unsigned char)(0x80 >> (x % 8));
+
+	if ((x < 0) || (y < 0) || (x >= G15_LCD_COLUMNS) || (y >= G15_LCD_ROWS))
+		return;
+
+	if (color)
+		canvas[y * G15_LCD_STRIDE + x / 8] |= bit;
+	else
+		canvas[y * G15_LCD_STRIDE + x / 8] &= (unsigned char)~bit;
+}
+
+// Compare a frame with the conversion of the canvas the same drawing went to
+static int frame_matches_canvas(G15LcdFrame *f, const unsigned char *canvas)
+{
+	unsigned char report_buf[G15_LCD_REPORT_LEN];
+
+	g15_pixmap_to_lcd(report_buf, canvas);
+	return memcmp(f->report, report_buf, G15_LCD_REPORT_LEN) == 0;
+}
+
+// Test frame drawing in report layout against drawing on a canvas
+void test_lcd_frame_drawing(void)
+{
+	printf("🧪 Testing frame drawing in LCD report layout...\n");
+
+	unsigned char *canvas = calloc(1, G15_LCD_PIXMAP_LEN);
+	unsigned char *ink = calloc(1, G15_LCD_PIXMAP_LEN);
+	unsigned char bits[43 * 4];
+	unsigned int state = 0x6510u;
+	G15LcdFrame frame;
+	int mismatches = 0;
+
+	assert((canvas != NULL) && (ink != NULL));
+
+	g15_lcd_frame_init(&frame);
+	assert(frame.report[0] == G15_LCD_REPORT_ID);
+	assert(frame_matches_canvas(&frame, canvas));
+
+	// Like g15r_clearScreen(), clearing covers the padding rows too
+	g15_lcd_clear(&frame, G15_LCD_BLACK);
+	memset(canvas, 0xff, G15_LCD_PIXMAP_LEN);
+	assert(frame_matches_canvas(&frame, canvas));
+
+	for (int n = 0; n < 4000; n++) {
+		int x1 = (int)(test_random(&state) % 200) - 20;
+		int y1 = (int)(test_random(&state) % 70) - 12;
+		int x2 = (int)(test_random(&state) % 200) - 20;
+		int y2 = (int)(test_random(&state) % 70) - 12;
+		int color = (int)(test_random(&state) & 1);
+
+		switch (n % 3) {
+
+		// Rectangles in any corner order, partly off screen
+		case 0:
+			g15_lcd_fill(&frame, x1, y1, x2, y2, color);
+			for (int x = min(x1, x2); x <= max(x1, x2); x++)
+				for (int y = min(y1, y2); y <= max(y1, y2); y++)
+					canvas_set_pixel(canvas, x, y, color);
+			break;
+
+		// Bitmaps up to 32x43 at any position, with and without background
+		case 1: {
+			int width = 1 + (int)(test_random(&state) % 32);
+			int height = 1 + (int)(test_random(&state) % 43);
+			int paint_bg = (int)(test_random(&state) & 1);
+
+			for (size_t i = 0; i < sizeof(bits); i++)
+				bits[i] = (unsigned char)test_random(&state);
+			g15_lcd_blit(&frame, x1, y1, width, height, bits, 4, color, paint_bg);
+			for (int r = 0; r < height; r++) {
+				for (int c = 0; c < width; c++) {
+					int set = (bits[r * 4 + c / 8] >> (7 - c % 8)) & 1;
+
+					if (set || paint_bg)
+						canvas_set_pixel(canvas, x1 + c, y1 + r,
+								 set ? color : !color);
+				}
+			}
+			break;
+		}
+
+		// Sparse libg15render ink imported for a range of rows
+		default:
+			memset(ink, 0, G15_LCD_PIXMAP_LEN);
+			for (int i = 0; i < 64; i++)
+				canvas_set_pixel(ink, (int)(test_random(&state) % 160),
+						 (int)(test_random(&state) % 43), 1);
+			g15_lcd_import(&frame, ink, y1, y2, color);
+			for (int y = max(y1, 0); y <= min(y2, G15_LCD_ROWS - 1); y++)
+				for (int x = 0; x < G15_LCD_COLUMNS; x++)
+					if (ink[y * G15_LCD_STRIDE + x / 8] & (0x80 >> (x % 8)))
+						canvas_set_pixel(canvas, x, y, color);
+			break;
+		}
+
+		if (!frame_matches_canvas(&frame, canvas)) {
+			printf("❌ frame differs from canvas after operation %d\n", n);
+			mismatches++;
+			break;
+		}
+	}
+	assert(mismatches == 0);
+
+	// Drawing stops at the last display row
+	g15_lcd_clear(&frame, G15_LCD_WHITE);
+	g15_lcd_fill(&frame, 0, 0, 159, 60, G15_LCD_BLACK);
+	assert(G15_LCD_FRAME_DATA(&frame)[5 * G15_LCD_STRIP_LEN] == 0x07);
+
+	free(ink);
+	free(canvas);
+	printf("✅ Frame fill, blit and import match canvas drawing\n");
+}
+
+// Test glyph atlas entries against drawing the glyph ink on a canvas
+void test_lcd_glyph_atlas(void)
+{
+	printf("🧪 Testing glyph atlas...\n");
+
+	unsigned char *canvas = calloc(1, G15_LCD_PIXMAP_LEN);
+	unsigned char *glyph_canvas = calloc(1, G15_LCD_PIXMAP_LEN);
+	unsigned char ink[G15_LCD_GLYPH_ROWS][G15_LCD_GLYPH_COLUMNS];
+	unsigned int state = 0x2310u;
+	G15LcdGlyph glyph;
+	G15LcdFrame frame;
+	int mismatches = 0;
+
+	assert((canvas != NULL) && (glyph_canvas != NULL));
+	g15_lcd_frame_init(&frame);
+
+	for (int n = 0; n < 2000; n++) {
+		int width = 1 + (int)(test_random(&state) % G15_LCD_GLYPH_COLUMNS);
+		int height = 1 + (int)(test_random(&state) % G15_LCD_GLYPH_ROWS);
+		int x = (int)(test_random(&state) % 180) - 10;
+		int y = (int)(test_random(&state) % 60) - 12;
+		int color = (int)(test_random(&state) & 1);
+
+		// A random glyph, drawn at the origin the driver uses for loading
+		memset(glyph_canvas, 0, G15_LCD_PIXMAP_LEN);
+		for (int r = 0; r < height; r++) {
+			for (int c = 0; c < width; c++) {
+				ink[r][c] = (test_random(&state) % 3) == 0;
+				if (ink[r][c])
+					canvas_set_pixel(glyph_canvas, G15_LCD_GLYPH_ORIGIN_X + c,
+							 G15_LCD_GLYPH_ORIGIN_Y + r, 1);
+			}
+		}
+		assert(g15_lcd_glyph_load(&glyph, glyph_canvas) == 0);
+		assert(glyph.valid && (glyph.width <= width));
+
+		g15_lcd_glyph_draw(&frame, &glyph, x, y, color);
+		for (int r = 0; r < height; r++)
+			for (int c = 0; c < width; c++)
+				if (ink[r][c])
+					canvas_set_pixel(canvas, x + c, y + r, color);
+
+		if (!frame_matches_canvas(&frame, canvas)) {
+			printf("❌ glyph %d drawn at (%d,%d) differs from canvas\n", n, x, y);
+			mismatches++;
+			break;
+		}
+	}
+	assert(mismatches == 0);
+
+	// Ink left of, above or beyond the atlas box cannot be cached
+	memset(glyph_canvas, 0, G15_LCD_PIXMAP_LEN);
+	canvas_set_pixel(glyph_canvas, G15_LCD_GLYPH_ORIGIN_X - 1, G15_LCD_GLYPH_ORIGIN_Y, 1);
+	assert(g15_lcd_glyph_load(&glyph, glyph_canvas) == -1 && !glyph.valid);
+
+	memset(glyph_canvas, 0, G15_LCD_PIXMAP_LEN);
+	canvas_set_pixel(glyph_canvas, G15_LCD_GLYPH_ORIGIN_X,
+			 G15_LCD_GLYPH_ORIGIN_Y + G15_LCD_GLYPH_ROWS, 1);
+	assert(g15_lcd_glyph_load(&glyph, glyph_canvas) == -1 && !glyph.valid);
+
+	// An empty glyph (space) is valid and draws nothing
+	memset(glyph_canvas, 0, G15_LCD_PIXMAP_LEN);
+	assert(g15_lcd_glyph_load(&glyph, glyph_canvas) == 0 && glyph.valid && glyph.width == 0);
+
+	free(glyph_canvas);
+	free(canvas);
+	printf("✅ Glyph atlas entries draw like the canvas\n");
+}
+
+// Test big number bitmaps copied in report layout against blitting their rows
+void test_lcd_big_numbers(void)
+{
+	printf("🧪 Testing big number column copy...\n");
+
+	unsigned char rows[G15_LCD_ROWS][G15_BIGNUM_WIDTH / 8];
+	unsigned int state = 0x4310u;
+	G15LcdFrame put, blit;
+	int mismatches = 0;
+
+	g15_lcd_frame_init(&put);
+	g15_lcd_frame_init(&blit);
+
+	for (int n = 0; n < 1000; n++) {
+		int num = (int)(test_random(&state) % 11);
+		int width = (num <= 9) ? G15_BIGNUM_WIDTH : 9;
+		int x = (int)(test_random(&state) % 200) - 30;
+		const unsigned char *columns = g15_bignum_data[num][0];
+
+		// Same bitmap unpacked into rows, leftmost pixel in the most significant bit
+		memset(rows, 0, sizeof(rows));
+		for (int y = 0; y < G15_LCD_ROWS; y++)
+			for (int c = 0; c < width; c++)
+				if ((columns[(y / 8) * G15_BIGNUM_WIDTH + c] >> (y % 8)) & 1)
+					rows[y][c / 8] |= (unsigned char)(0x80 >> (c % 8));
+
+		// Start from the same random frame, padding rows included
+		for (int i = 0; i < G15_LCD_DATA_LEN; i++)
+			G15_LCD_FRAME_DATA(&put)[i] = G15_LCD_FRAME_DATA(&blit)[i] =
+			    (unsigned char)test_random(&state);
+
+		g15_lcd_put_columns(&put, x, width, columns, G15_BIGNUM_WIDTH);
+		g15_lcd_blit(&blit, x, 0, width, G15_LCD_ROWS, rows[0], sizeof(rows[0]),
+			     G15_LCD_BLACK, 1);
+
+		if (memcmp(put.report, blit.report, G15_LCD_REPORT_LEN) != 0) {
+			printf("❌ big number %d at column %d differs from the blit\n", num, x);
+			mismatches++;
+			break;
+		}
+	}
+	assert(mismatches == 0);
+
+	// Nothing of the bitmaps lies below the LCD or right of the colon
+	for (int num = 0; num <= 10; num++) {
+		for (int c = 0; c < G15_BIGNUM_WIDTH; c++) {
+			assert((g15_bignum_data[num][G15_LCD_STRIPS - 1][c] & 0xf8) == 0);
+			if ((num == 10) && (c >= 9))
+				for (int strip = 0; strip < G15_LCD_STRIPS; strip++)
+					assert(g15_bignum_data[num][strip][c] == 0);
+		}
+	}
+
+	printf("✅ Big number columns match the row blit\n");
+}
+
+// Strips whose pixel data differs between a frame and a copy of its data
+static unsigned char changed_strips(G15LcdFrame *f, const unsigned char *before)
+{
+	unsigned char changed = 0;
+
+	for (int strip = 0; strip < G15_LCD_STRIPS; strip++)
+		if (memcmp(G15_LCD_FRAME_DATA(f) + strip * G15_LCD_STRIP_LEN,
+			   before + strip * G15_LCD_STRIP_LEN, G15_LCD_STRIP_LEN) != 0)
+			changed |= (unsigned char)(1 << strip);
+	return changed;
+}
+
+// Test the generation and dirty strips every drawing call records
+void test_lcd_frame_dirty(void)
+{
+	printf("🧪 Testing frame change tracking...\n");
+
+	unsigned char *ink = calloc(1, G15_LCD_PIXMAP_LEN);
+	unsigned char before[G15_LCD_DATA_LEN];
+	unsigned char bits[43 * 4];
+	unsigned int state = 0x5310u;
+	G15LcdGlyph glyph;
+	G15LcdFrame frame;
+	int mismatches = 0;
+
+	assert(ink != NULL);
+
+	// A new frame was never sent, all of it is dirty
+	g15_lcd_frame_init(&frame);
+	assert((frame.dirty == G15_LCD_ALL_STRIPS) && (frame.generation == 0));
+
+	for (int n = 0; n < 3000; n++) {
+		int x = (int)(test_random(&state) % 240) - 40;
+		int y = (int)(test_random(&state) % 100) - 30;
+		int color = (int)(test_random(&state) & 1);
+		unsigned int generation = frame.generation;
+		unsigned char changed;
+
+		memcpy(before, G15_LCD_FRAME_DATA(&frame), G15_LCD_DATA_LEN);
+		g15_lcd_frame_clean(&frame);
+
+		for (size_t i = 0; i < sizeof(bits); i++)
+			bits[i] = (unsigned char)test_random(&state);
+
+		switch (n % 6) {
+		case 0:
+			g15_lcd_fill(&frame, x, y, x + (int)(test_random(&state) % 40),
+				     y + (int)(test_random(&state) % 20), color);
+			break;
+		case 1:
+			g15_lcd_blit(&frame, x, y, 1 + (int)(test_random(&state) % 32),
+				     1 + (int)(test_random(&state) % 43), bits, 4, color,
+				     (int)(test_random(&state) & 1));
+			break;
+		case 2:
+			g15_lcd_put_columns(&frame, x, 1 + (int)(test_random(&state) % 24), bits,
+					    24);
+			break;
+		case 3:
+			memset(ink, 0, G15_LCD_PIXMAP_LEN);
+			for (int i = 0; i < 12; i++) {
+				int gx = G15_LCD_GLYPH_ORIGIN_X + (int)(bits[i] % 8);
+				int gy = G15_LCD_GLYPH_ORIGIN_Y + (int)(bits[i + 12] % 20);
+
+				canvas_set_pixel(ink, gx, gy, 1);
+			}
+			assert(g15_lcd_glyph_load(&glyph, ink) == 0);
+			g15_lcd_glyph_draw(&frame, &glyph, x, y, color);
+			break;
+		case 4:
+			memset(ink, 0, G15_LCD_PIXMAP_LEN);
+			for (int i = 0; i < 32; i++)
+				canvas_set_pixel(ink, bits[i] % 160, bits[i + 32] % 43, 1);
+			g15_lcd_import(&frame, ink, y, y + (int)(test_random(&state) % 20), color);
+			break;
+		default:
+			if ((test_random(&state) % 8) == 0)
+				g15_lcd_clear(&frame, color);
+			break;
+		}
+
+		// Dirty strips cover every change, and changes move the generation
+		changed = changed_strips(&frame, before);
+		if (((changed & ~frame.dirty) != 0) ||
+		    ((frame.dirty != 0) != (frame.generation != generation))) {
+			printf("❌ operation %d changed strips 0x%02x, dirty 0x%02x\n", n, changed,
+			       frame.dirty);
+			mismatches++;
+			break;
+		}
+	}
+	assert(mismatches == 0);
+
+	// Drawing that lies entirely off the LCD records nothing
+	g15_lcd_frame_clean(&frame);
+	unsigned int generation = frame.generation;
+
+	g15_lcd_fill(&frame, -20, 5, -1, 10, G15_LCD_BLACK);
+	g15_lcd_blit(&frame, 10, G15_LCD_ROWS, 8, 8, bits, 1, G15_LCD_BLACK, 1);
+	g15_lcd_put_columns(&frame, G15_LCD_COLUMNS, 24, bits, 24);
+	g15_lcd_import(&frame, ink, -10, -1, G15_LCD_BLACK);
+	assert((frame.dirty == 0) && (frame.generation == generation));
+
+	// A fill within one strip marks only that strip
+	g15_lcd_fill(&frame, 0, 9, 159, 14, G15_LCD_BLACK);
+	assert((frame.dirty == 0x02) && (frame.generation == generation + 1));
+
+	free(ink);
+	printf("✅ Dirty strips and generation track every change\n");
+}
+
+/**
+ * \brief Check that a keyword resolves to nothing or to an entry of exactly that name
+ * \param keyword Keyword a client might send
+ * \retval 1 get_command() returned an entry with another name
+ * \retval 0 Correct
+ */
+static int command_mismatch(const char *keyword)
+{
+	const client_function *cmd = get_command(keyword);
+
+	if ((cmd == NULL) || (strcmp(cmd->keyword, keyword) == 0))
+		return 0;
+
+	printf("❌ \"%s\" resolves to %s\n", keyword, cmd->keyword);
+	return 1;
+}
+
+// Test that the hand-written trie in command_index() agrees with the table
+void test_command_dispatch(void)
+{
+	printf("🧪 Testing command dispatch...\n");
+
+	static const char *rejects[] = {
+	    "", "x", "nope", "widget", "screen", "screen_bind", "menu_set_mains", "shm_binds",
+	    "client_statz", "batch_begun",
+	};
+	char variant[64];
+	int failures = 0;
+
+	// Every keyword finds its own entry
+	for (int i = 0; i < CMD_COUNT; i++) {
+		if (get_command(commands[i].keyword) != &commands[i]) {
+			printf("❌ \"%s\" does not resolve to its entry\n", commands[i].keyword);
+			failures++;
+		}
+	}
+
+	// Near misses of every keyword: one character dropped, added or changed
+	for (int i = 0; i < CMD_COUNT; i++) {
+		const char *kw = commands[i].keyword;
+		size_t len = strlen(kw);
+
+		assert(len + 2 <= sizeof(variant));
+		for (size_t pos = 0; pos < len; pos++) {
+			memcpy(variant, kw, pos);
+			strcpy(variant + pos, kw + pos + 1);
+			failures += command_mismatch(variant);
+
+			strcpy(variant, kw);
+			variant[pos] ^= 0x20;
+			failures += command_mismatch(variant);
+
+			variant[pos] = (char)(kw[pos] + 1);
+			failures += command_mismatch(variant);
+		}
+		snprintf(variant, sizeof(variant), "%s_", kw);
+		failures += command_mismatch(variant);
+	}
+
+	for (size_t i = 0; i < sizeof(rejects) / sizeof(rejects[0]); i++) {
+		if (get_command(rejects[i]) != NULL) {
+			printf("❌ \"%s\" must not resolve\n", rejects[i]);
+			failures++;
+		}
+	}
+
+	assert(failures == 0);
+	printf("✅ All %d keywords resolve, near misses rejected\n", CMD_COUNT);
+}
+
+/**
+ * \brief Sort record for the list tests
+ */
+typedef struct {
+	int size; ///< Sort key
+	int seq;  ///< Position in the unsorted list
+} SortRecord;
+
+// Descending by size, returns only 0 or 1 like sort_procs() of the lcdproc client
+static int sort_by_size(void *a, void *b)
+{
+	return ((SortRecord *)b)->size > ((SortRecord *)a)->size;
+}
+
+// Test that LL_Sort() is stable and LL_TopK() picks its first entries
+void test_ll_sort(void)
+{
+	printf("🧪 Testing list sort and top-k selection...\n");
+
+	static const int sizes[] = {0, 1, 2, 5, 6, 37, 300};
+	static const int ks[] = {1, 5, 64};
+	unsigned int state = 0x11a5u;
+	LinkedList *list = LL_new();
+	void *top[3][64];
+	int found[3];
+
+	assert(list != NULL);
+
+	for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++) {
+		int count = sizes[n];
+		SortRecord *recs = calloc(count + 1, sizeof(SortRecord));
+		SortRecord *prev = NULL;
+		int i = 0;
+
+		assert(recs != NULL);
+
+		// Few distinct sizes, so most records have equals
+		for (int j = 0; j < count; j++) {
+			recs[j].size = (int)(test_random(&state) % (count / 4 + 1));
+			recs[j].seq = j;
+			LL_Push(list, &recs[j]);
+		}
+
+		// LL_TopK() leaves the list as it is
+		for (int k = 0; k < 3; k++) {
+			found[k] = LL_TopK(list, sort_by_size, top[k], ks[k]);
+			assert(found[k] == ((count < ks[k]) ? count : ks[k]));
+			i = 0;
+			for (SortRecord *r = LL_GetFirst(list); r != NULL; r = LL_GetNext(list))
+				assert(r->seq == i++);
+			assert(i == count);
+		}
+
+		LL_Sort(list, sort_by_size);
+		assert(LL_Length(list) == count);
+
+		// Descending, equal sizes in their original order, top-k is the prefix
+		i = 0;
+		for (SortRecord *r = LL_GetFirst(list); r != NULL; r = LL_GetNext(list), i++) {
+			if (prev != NULL)
+				assert((prev->size > r->size) ||
+				       ((prev->size == r->size) && (prev->seq < r->seq)));
+			for (int k = 0; k < 3; k++)
+				assert((i >= found[k]) || (top[k][i] == r));
+			prev = r;
+		}
+
+		while (LL_Pop(list) != NULL)
+			;
+		free(recs);
+	}
+
+	LL_Destroy(list);
+	printf("✅ Sort is ordered and stable, top-k matches the sorted prefix\n");
+}
+
+/** \brief Number of clients reserving keys in the key lookup test */
+#define KEY_CLIENTS 5
+
+/**
+ * \brief Reservation in the former single list of all reservations
+ */
+typedef struct {
+	const char *key; ///< Key name
+	bool exclusive;	 ///< Reserved exclusively
+	Client *client;	 ///< Owning client
+} LegacyReservation;
+
+/** \brief Former reservation list, in reservation order */
+static LegacyReservation legacy_keys[KEY_CLIENTS * 19 + 4];
+
+/** \brief Used entries of legacy_keys */
+static int legacy_count;
+
+// Reserve a key with input_reserve_key() and, if accepted, in the former list
+static int legacy_reserve(const char *key, bool exclusive, Client *client)
+{
+	if (input_reserve_key(key, exclusive, client) < 0)
+		return -1;
+
+	assert(legacy_count < (int)(sizeof(legacy_keys) / sizeof(legacy_keys[0])));
+	legacy_keys[legacy_count].key = intern(key);
+	legacy_keys[legacy_count].exclusive = exclusive;
+	legacy_keys[legacy_count].client = client;
+	legacy_count++;
+
+	return 0;
+}
+
+// Former input_find_key(): first reservation of the key that is exclusive or the client's
+static LegacyReservation *legacy_find_key(const char *key, Client *client)
+{
+	for (int i = 0; i < legacy_count; i++) {
+		LegacyReservation *kr = &legacy_keys[i];
+
+		if ((strcmp(kr->key, key) == 0) && (kr->exclusive || (kr->client == client)))
+			return kr;
+	}
+	return NULL;
+}
+
+// Test the hashed key reservations against the former scan over all reservations
+void test_key_reservations(void)
+{
+	printf("🧪 Testing key reservation lookup...\n");
+
+	static const char *modes[] = {"M1", "M2", "M3", "MR"};
+	static const char *presses[] = {"G1", "G7", "G18", "M1", "M2", "MR", "G12",
+					"Left", "G9", "M3", "Down", "Stop", "G19", "g1"};
+	static Client clients[KEY_CLIENTS];
+	char key[8];
+
+	assert(input_init() == 0);
+	legacy_count = 0;
+
+	// Every client shares the G-keys, the first one holds the M-keys exclusively
+	for (int c = 0; c < KEY_CLIENTS; c++) {
+		clients[c].sock = c + 1;
+		ilist_init(&clients[c].keys);
+
+		for (int g = 1; g <= 18; g++) {
+			snprintf(key, sizeof(key), "G%d", g);
+			assert(legacy_reserve(key, false, &clients[c]) == 0);
+		}
+		if (c == 0) {
+			for (int m = 0; m < 4; m++)
+				assert(legacy_reserve(modes[m], true, &clients[c]) == 0);
+		} else {
+			assert(legacy_reserve(modes[c % 4], true, &clients[c]) < 0);
+			assert(legacy_reserve(modes[c % 4], false, &clients[c]) < 0);
+		}
+	}
+	assert(legacy_reserve("G1", true, &clients[0]) < 0);
+
+	// Each press finds what the former scan found, for every client
+	for (int c = 0; c < KEY_CLIENTS; c++) {
+		for (size_t k = 0; k < sizeof(presses) / sizeof(presses[0]); k++) {
+			KeyReservation *kr = input_find_key(presses[k], &clients[c]);
+			LegacyReservation *old = legacy_find_key(presses[k], &clients[c]);
+
+			assert((kr == NULL) == (old == NULL));
+			if (kr == NULL)
+				continue;
+			assert((kr->client == old->client) && (kr->exclusive == old->exclusive));
+			assert(strcmp(kr->key, old->key) == 0);
+		}
+	}
+
+	// Release half per client and half per key, nothing may be left
+	for (int c = 0; c < KEY_CLIENTS; c++) {
+		if (c % 2 == 0) {
+			input_release_client_keys(&clients[c]);
+			continue;
+		}
+		for (int g = 1; g <= 18; g++) {
+			snprintf(key, sizeof(key), "G%d", g);
+			input_release_key(key, &clients[c]);
+		}
+	}
+	for (int c = 0; c < KEY_CLIENTS; c++)
+		assert(clients[c].keys.count == 0);
+	assert((keytable->count == 0) && (keyentries.count == 0));
+	assert(input_find_key("G1", &clients[0]) == NULL);
+
+	// Shutdown drops what is still reserved, keys with several holders included
+	for (int c = 0; c < 3; c++)
+		assert(input_reserve_key("G1", false, &clients[c]) == 0);
+	assert(input_reserve_key("M1", true, NULL) == 0);
+	input_shutdown();
+
+	for (int i = 0; i < legacy_count; i++)
+		intern_release(legacy_keys[i].key);
+	assert(intern_count() == 0);
+
+	printf("✅ Lookups match the list scan, conflicts rejected, all keys released\n");
+}
+
 // Print test execution summary
 void print_test_summary(int tests_run, int tests_passed)
 {
@@ -1069,6 +1895,55 @@ int main(int argc, char *argv[])
 		test_debug_driver_error_handling();
 		tests_passed++;
 
+		// Canvas conversion kernels
+		if (verbose_mode)
+			printf("📍 Running canvas conversion kernel test...\n");
+		tests_run++;
+		test_pixmap_to_lcd_equivalence();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running frame drawing test...\n");
+		tests_run++;
+		test_lcd_frame_drawing();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running glyph atlas test...\n");
+		tests_run++;
+		test_lcd_glyph_atlas();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running big number test...\n");
+		tests_run++;
+		test_lcd_big_numbers();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running frame change tracking test...\n");
+		tests_run++;
+		test_lcd_frame_dirty();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running command dispatch test...\n");
+		tests_run++;
+		test_command_dispatch();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running list sort test...\n");
+		tests_run++;
+		test_ll_sort();
+		tests_passed++;
+
+		if (verbose_mode)
+			printf("📍 Running key reservation test...\n");
+		tests_run++;
+		test_key_reservations();
+		tests_passed++;
+
 		// Mock library and argument parsing tests
 		if (verbose_mode)
 			printf("📍 Running mock error conditions test...\n");